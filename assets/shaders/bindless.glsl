@@ -0,0 +1,11 @@
+// The global bindless set, set 0 of every pipeline that reads it. Must match
+// BindlessDescriptors. Indices come from the CPU through buffers or push
+// constants, and only registered elements may be read.
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Plain textures are registered as 2D arrays of one layer.
+layout(set = 0, binding = 0) uniform sampler2DArray bindlessTextures[];
+
+layout(set = 0, binding = 1) readonly buffer BindlessWords {
+    uint words[];
+} bindlessBuffers[];
@@ -0,0 +1,26 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+
+#include "bindless.glsl"
+
+layout(location = 0) in vec3 inNormal;
+layout(location = 1) in float inAo;
+layout(location = 2) flat in uint inLayer;
+layout(location = 3) in vec2 inUv;
+
+layout(location = 0) out vec4 outFragColor;
+
+// The fragment stage's part of chunk.vert's push constants.
+layout(push_constant) uniform constants {
+    // A layer for each of mesh::TEXTURE_NAMES.
+    layout(offset = 16) uint blockTextures;
+} PushConstants;
+
+const vec3 SUN_DIRECTION = vec3(0.3, 0.9, 0.4);
+
+void main() {
+    vec3 albedo = texture(bindlessTextures[PushConstants.blockTextures], vec3(inUv, float(inLayer))).rgb;
+    float sun = max(dot(inNormal, normalize(SUN_DIRECTION)), 0.0);
+    float light = (0.45 + 0.55 * sun) * inAo;
+    outFragColor = vec4(albedo * light, 1.0);
+}
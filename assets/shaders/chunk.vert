@@ -0,0 +1,67 @@
+#version 460
+#extension GL_EXT_buffer_reference : require
+#extension GL_GOOGLE_include_directive : require
+
+#include "chunk_common.glsl"
+
+// Chunks are drawn indirectly, with the chunk's slot as the first instance.
+layout(push_constant) uniform constants {
+    SceneData scene;
+    ChunkBuffer chunkBuffer;
+    uint blockTextures;
+} PushConstants;
+
+layout(location = 0) out vec3 outNormal;
+layout(location = 1) out float outAo;
+layout(location = 2) flat out uint outLayer;
+layout(location = 3) out vec2 outUv;
+
+// Corner offsets along the quad's u and v axes. Negative faces walk them the
+// other way round so every face winds counter-clockwise seen from outside.
+const uvec2 CORNERS[4] = uvec2[](uvec2(0, 0), uvec2(1, 0), uvec2(1, 1), uvec2(0, 1));
+const uvec2 CORNERS_FLIPPED[4] = uvec2[](uvec2(0, 0), uvec2(0, 1), uvec2(1, 1), uvec2(1, 0));
+
+// How much each level of ambient occlusion darkens a corner.
+const float AO_LEVELS[4] = float[](1.0, 0.75, 0.55, 0.4);
+
+void main() {
+    uint quadIndex = uint(gl_VertexIndex) >> 2;
+    uint corner = uint(gl_VertexIndex) & 3u;
+    GpuChunk chunk = PushConstants.chunkBuffer.chunks[gl_InstanceIndex];
+    uvec2 quad = chunk.quadBuffer.quads[quadIndex];
+
+    uvec3 block = uvec3(quad.x & 31u, (quad.x >> 5) & 31u, (quad.x >> 10) & 31u);
+    uint width = ((quad.x >> 15) & 31u) + 1u;
+    uint height = ((quad.x >> 20) & 31u) + 1u;
+    uint face = (quad.x >> 25) & 7u;
+    uint axis = face >> 1;
+    bool negative = (face & 1u) != 0u;
+    uint u = (axis + 1u) % 3u;
+    uint v = (axis + 2u) % 3u;
+
+    uvec2 uv = negative ? CORNERS_FLIPPED[corner] : CORNERS[corner];
+    vec3 position = vec3(block);
+    position[axis] += negative ? 0.0 : 1.0;
+    position[u] += float(uv.x * width);
+    position[v] += float(uv.y * height);
+
+    // Occlusion is stored per corner in (0, 0), (1, 0), (1, 1), (0, 1) order.
+    uint aoCorner = uv.y == 0u ? uv.x : 3u - uv.x;
+    uint ao = (quad.y >> (16u + aoCorner * 2u)) & 3u;
+
+    vec3 normal = vec3(0.0);
+    normal[axis] = negative ? -1.0 : 1.0;
+
+    // coarser levels of detail mesh bigger blocks
+    position *= float(1u << chunk.lod);
+
+    // textures repeat every block, upright on the sides
+    vec2 texCoord = axis == 1u ? position.xz : vec2(position[axis == 0u ? 2u : 0u], -position.y);
+
+    vec3 offset = chunkOffset(PushConstants.scene, chunk.position.xyz);
+    gl_Position = PushConstants.scene.viewProj * vec4(position + offset, 1.0);
+    outNormal = normal;
+    outAo = AO_LEVELS[ao];
+    outLayer = quad.y & 0xFFFFu;
+    outUv = texCoord;
+}
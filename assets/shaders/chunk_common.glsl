@@ -0,0 +1,35 @@
+// Buffers shared by the chunk culling and drawing shaders. Layouts must match
+// GpuSceneData and GpuChunk in vk_engine.h.
+
+// Quads are packed as described by mesh::PackedQuad.
+layout(buffer_reference, std430, buffer_reference_align = 8) readonly buffer QuadBuffer {
+    uvec2 quads[];
+};
+
+struct GpuChunk {
+    // Position of the first chunk of the mesh's level of detail cell in
+    // chunks, and the number of quads in w. Empty slots have no quads.
+    ivec4 position;
+    QuadBuffer quadBuffer;
+    // Each block of the mesh is 2^lod blocks across.
+    uint lod;
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer ChunkBuffer {
+    GpuChunk chunks[];
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer SceneData {
+    mat4 viewProj;
+    // The camera position split into the block it is in and where within
+    // that block, so chunk offsets can be found in integers first.
+    ivec4 cameraBlock;
+    vec4 cameraFraction;
+};
+
+const int CHUNK_SIZE = 32;
+
+// The origin of a chunk relative to the camera.
+vec3 chunkOffset(SceneData scene, ivec3 chunkPosition) {
+    return vec3(chunkPosition * CHUNK_SIZE - scene.cameraBlock.xyz) - scene.cameraFraction.xyz;
+}
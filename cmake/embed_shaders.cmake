@@ -0,0 +1,51 @@
+# Packs compiled shaders into one C++ source, for `embeddedShaders()` in
+# src/engine/graphics/shader_bundle.h.
+#
+# Run in script mode with
+#   SPIRV_FILES  the .spv files to pack, named after their GLSL sources
+#   HEADER       absolute path of shader_bundle.h
+#   OUTPUT       the source to write
+
+list(SORT SPIRV_FILES)
+
+set(WORDS "")
+set(ENTRIES "")
+set(OFFSET 0)
+foreach(SPIRV ${SPIRV_FILES})
+    get_filename_component(FILE_NAME ${SPIRV} NAME)
+    string(REGEX REPLACE "\\.spv$" "" SHADER_NAME ${FILE_NAME})
+
+    file(READ ${SPIRV} HEX HEX)
+    string(LENGTH "${HEX}" HEX_LENGTH)
+    math(EXPR SIZE "${HEX_LENGTH} / 8")
+
+    # SPIR-V is little endian words, so each group of 4 bytes is reversed into one
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])"
+        "0x\\4\\3\\2\\1u," HEX "${HEX}")
+    string(REPEAT "0x[0-9a-f]+u," 8 LINE)
+    string(REGEX REPLACE "(${LINE})" "\\1\n    " HEX "${HEX}")
+
+    string(APPEND WORDS "    // ${SHADER_NAME}\n    ${HEX}\n")
+    string(APPEND ENTRIES "    ShaderBundleEntry{\"${SHADER_NAME}\", ${OFFSET}, ${SIZE}},\n")
+    math(EXPR OFFSET "${OFFSET} + ${SIZE}")
+endforeach()
+
+list(LENGTH SPIRV_FILES COUNT)
+
+file(WRITE ${OUTPUT}
+"// Generated by cmake/embed_shaders.cmake, do not edit.
+#include \"${HEADER}\"
+#include <array>
+
+namespace {
+constexpr std::array<uint32_t, ${OFFSET}> WORDS = {
+${WORDS}};
+
+constexpr std::array<ShaderBundleEntry, ${COUNT}> ENTRIES = {
+${ENTRIES}};
+
+constexpr ShaderBundle BUNDLE(WORDS, ENTRIES);
+} // namespace
+
+const ShaderBundle& embeddedShaders() { return BUNDLE; }
+")
@@ -73,14 +73,25 @@
 //     }
 // }
 
+#include "engine/graphics/launch_options.h"
 #include "engine/graphics/vulkan/vk_engine.h"
+#include "engine/jobs/job_system.h"
 #include <iostream>
+#include <span>
 #include <vma_usage.h>
 #include <vulkan/vulkan.h>
 
-int main() {
+int main(int argc, char* argv[]) {
+    const std::optional<LaunchOptions> options = parseLaunchOptions(std::span(argv + 1, static_cast<size_t>(argc - 1)));
+    if (!options.has_value()) {
+        return 1;
+    }
+
+    jobs::JobSystem jobSystem;
+
     VulkanEngine engine;
-    engine.init();
-    engine.run();
+    engine.init(jobSystem, *options);
+    const int exitCode = engine.run();
     engine.cleanup();
+    return exitCode;
 }
@@ -0,0 +1,279 @@
+#include "block_textures.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+namespace {
+struct Rgb {
+    uint32_t r;
+    uint32_t g;
+    uint32_t b;
+};
+
+/// Base colour of each layer, in `mesh::TEXTURE_NAMES` order.
+constexpr std::array<Rgb, 8> LAYER_COLORS = {
+    Rgb{128, 128, 128}, // stone
+    Rgb{115, 79, 51},   // dirt
+    Rgb{92, 153, 64},   // grass_top
+    Rgb{115, 79, 51},   // grass_side, under a strip of grass_top
+    Rgb{219, 204, 140}, // sand
+    Rgb{191, 224, 235}, // glass
+    Rgb{250, 217, 115}, // glowstone
+    Rgb{255, 179, 77},  // torch
+};
+
+constexpr uint32_t GRASS_SIDE = 3;
+constexpr uint32_t GLASS = 5;
+constexpr uint32_t GLOWSTONE = 6;
+
+/// Rows of grass along the top of `grass_side`.
+constexpr uint32_t GRASS_SIDE_ROWS = 3;
+
+/// @return A hash of a pixel, so the noise is the same every run.
+uint32_t pixelHash(uint32_t layer, uint32_t x, uint32_t y) {
+    uint32_t hash = layer * 0x9E3779B9u ^ x * 0x85EBCA6Bu ^ y * 0xC2B2AE35u;
+    hash ^= hash >> 16;
+    hash *= 0x7FEB352Du;
+    hash ^= hash >> 15;
+    return hash;
+}
+
+uint32_t packPixel(Rgb color, uint32_t percent) {
+    const auto shade = [&](uint32_t channel) { return std::min(channel * percent / 100u, 255u); };
+    return shade(color.r) | shade(color.g) << 8 | shade(color.b) << 16 | 0xFFu << 24;
+}
+
+constexpr uint32_t DDS_MAGIC = 0x20534444;   // "DDS "
+constexpr uint32_t FOURCC_DX10 = 0x30315844; // "DX10"
+constexpr uint32_t DDPF_FOURCC = 0x4;
+constexpr uint32_t DXGI_FORMAT_BC7_UNORM = 98;
+constexpr uint32_t DXGI_FORMAT_BC7_UNORM_SRGB = 99;
+constexpr uint32_t RESOURCE_DIMENSION_TEXTURE2D = 3;
+constexpr uint32_t RESOURCE_MISC_TEXTURECUBE = 0x4;
+/// Larger than any block texture needs, which keeps the sizes far from overflowing.
+constexpr uint32_t MAX_DIMENSION = 16384;
+
+struct DdsPixelFormat {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t fourCC;
+    uint32_t rgbBitCount;
+    uint32_t rBitMask;
+    uint32_t gBitMask;
+    uint32_t bBitMask;
+    uint32_t aBitMask;
+};
+
+/// `DDS_HEADER`, which follows the magic number.
+struct DdsHeader {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitchOrLinearSize;
+    uint32_t depth;
+    uint32_t mipMapCount;
+    uint32_t reserved1[11];
+    DdsPixelFormat pixelFormat;
+    uint32_t caps;
+    uint32_t caps2;
+    uint32_t caps3;
+    uint32_t caps4;
+    uint32_t reserved2;
+};
+
+static_assert(sizeof(DdsHeader) == 124);
+
+/// `DDS_HEADER_DXT10`, which follows the header when its four CC is "DX10".
+struct DdsHeaderDx10 {
+    uint32_t dxgiFormat;
+    uint32_t resourceDimension;
+    uint32_t miscFlag;
+    uint32_t arraySize;
+    uint32_t miscFlags2;
+};
+
+constexpr size_t DDS_DATA_OFFSET = sizeof(uint32_t) + sizeof(DdsHeader) + sizeof(DdsHeaderDx10);
+} // namespace
+
+uint32_t mipLevelCount(uint32_t width, uint32_t height) { return std::bit_width(std::max(width, height)); }
+
+std::vector<uint32_t> generateBlockTextures(uint32_t size) {
+    const auto layerCount = static_cast<uint32_t>(LAYER_COLORS.size());
+    std::vector<uint32_t> pixels(static_cast<size_t>(size) * size * layerCount);
+
+    for (uint32_t layer = 0; layer < layerCount; layer++) {
+        uint32_t* out = pixels.data() + static_cast<size_t>(size) * size * layer;
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++) {
+                const uint32_t hash = pixelHash(layer, x, y);
+                // within 12% either way of the base colour
+                uint32_t percent = 88 + hash % 25;
+                Rgb color = LAYER_COLORS[layer];
+
+                const bool border = x == 0 || y == 0 || x == size - 1 || y == size - 1;
+                if (layer == GRASS_SIDE && y < GRASS_SIDE_ROWS + (hash >> 8) % 2) {
+                    color = LAYER_COLORS[2];
+                } else if (layer == GLASS && !border) {
+                    // the pane is darker than its frame
+                    percent -= 30;
+                } else if (layer == GLOWSTONE && (hash >> 8) % 5 == 0) {
+                    percent += 20;
+                }
+                out[y * size + x] = packPixel(color, percent);
+            }
+        }
+    }
+    return pixels;
+}
+
+size_t Bc7Texture::levelSize(uint32_t level) const {
+    // 4x4 pixels to a 16 byte block, with partial blocks rounded up
+    const size_t blocksWide = std::max(1u, ((width >> level) + 3) / 4);
+    const size_t blocksHigh = std::max(1u, ((height >> level) + 3) / 4);
+    return blocksWide * blocksHigh * 16;
+}
+
+size_t Bc7Texture::levelOffset(uint32_t layer, uint32_t level) const {
+    size_t layerSize = 0;
+    size_t offset = 0;
+    for (uint32_t i = 0; i < mipLevels; i++) {
+        offset += i < level ? levelSize(i) : 0;
+        layerSize += levelSize(i);
+    }
+    return layer * layerSize + offset;
+}
+
+std::optional<Bc7Texture> decodeBc7Dds(std::span<const uint8_t> file) {
+    if (file.size() < DDS_DATA_OFFSET) {
+        return std::nullopt;
+    }
+
+    uint32_t magic;
+    DdsHeader header;
+    DdsHeaderDx10 dx10;
+    std::memcpy(&magic, file.data(), sizeof(magic));
+    std::memcpy(&header, file.data() + sizeof(magic), sizeof(header));
+    std::memcpy(&dx10, file.data() + sizeof(magic) + sizeof(header), sizeof(dx10));
+
+    if (magic != DDS_MAGIC || header.size != sizeof(DdsHeader) || (header.pixelFormat.flags & DDPF_FOURCC) == 0 ||
+        header.pixelFormat.fourCC != FOURCC_DX10) {
+        return std::nullopt;
+    }
+    if (dx10.dxgiFormat != DXGI_FORMAT_BC7_UNORM && dx10.dxgiFormat != DXGI_FORMAT_BC7_UNORM_SRGB) {
+        return std::nullopt;
+    }
+    if (dx10.resourceDimension != RESOURCE_DIMENSION_TEXTURE2D || (dx10.miscFlag & RESOURCE_MISC_TEXTURECUBE) != 0) {
+        return std::nullopt;
+    }
+    if (header.width == 0 || header.height == 0 || header.width > MAX_DIMENSION || header.height > MAX_DIMENSION ||
+        dx10.arraySize == 0 || dx10.arraySize > MAX_DIMENSION) {
+        return std::nullopt;
+    }
+
+    Bc7Texture texture{};
+    texture.width = header.width;
+    texture.height = header.height;
+    texture.layers = dx10.arraySize;
+    // files without mips may leave the count at 0
+    texture.mipLevels = std::max(header.mipMapCount, 1u);
+    texture.srgb = dx10.dxgiFormat == DXGI_FORMAT_BC7_UNORM_SRGB;
+    if (texture.mipLevels > mipLevelCount(texture.width, texture.height)) {
+        return std::nullopt;
+    }
+
+    const size_t dataSize = texture.levelOffset(texture.layers, 0);
+    if (file.size() - DDS_DATA_OFFSET < dataSize) {
+        return std::nullopt;
+    }
+    texture.data = file.subspan(DDS_DATA_OFFSET, dataSize);
+    return texture;
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+namespace {
+std::vector<uint8_t> makeDds(uint32_t width, uint32_t height, uint32_t mips, uint32_t layers, uint32_t format) {
+    DdsHeader header{};
+    header.size = sizeof(DdsHeader);
+    header.width = width;
+    header.height = height;
+    header.mipMapCount = mips;
+    header.pixelFormat.size = sizeof(DdsPixelFormat);
+    header.pixelFormat.flags = DDPF_FOURCC;
+    header.pixelFormat.fourCC = FOURCC_DX10;
+    DdsHeaderDx10 dx10{format, RESOURCE_DIMENSION_TEXTURE2D, 0, layers, 0};
+
+    const Bc7Texture texture{width, height, layers, std::max(mips, 1u), false, {}};
+    std::vector<uint8_t> file(DDS_DATA_OFFSET + texture.levelOffset(layers, 0));
+    std::memcpy(file.data(), &DDS_MAGIC, sizeof(DDS_MAGIC));
+    std::memcpy(file.data() + sizeof(DDS_MAGIC), &header, sizeof(header));
+    std::memcpy(file.data() + sizeof(DDS_MAGIC) + sizeof(header), &dx10, sizeof(dx10));
+    // each byte of data holds its own offset, to check where levels land
+    for (size_t i = DDS_DATA_OFFSET; i < file.size(); i++) {
+        file[i] = static_cast<uint8_t>(i - DDS_DATA_OFFSET);
+    }
+    return file;
+}
+} // namespace
+
+TEST_SUITE("BlockTextures") {
+    TEST_CASE("mip chains go down to one pixel") {
+        CHECK(mipLevelCount(1, 1) == 1);
+        CHECK(mipLevelCount(16, 16) == 5);
+        CHECK(mipLevelCount(16, 4) == 5);
+        CHECK(mipLevelCount(17, 3) == 5);
+    }
+
+    TEST_CASE("generated layers are opaque and repeatable") {
+        const std::vector<uint32_t> pixels = generateBlockTextures(BLOCK_TEXTURE_SIZE);
+        REQUIRE(pixels.size() == BLOCK_TEXTURE_SIZE * BLOCK_TEXTURE_SIZE * LAYER_COLORS.size());
+        CHECK(std::all_of(pixels.begin(), pixels.end(), [](uint32_t pixel) { return pixel >> 24 == 0xFF; }));
+        CHECK(generateBlockTextures(BLOCK_TEXTURE_SIZE) == pixels);
+
+        // grass_side is green along the top and brown at the bottom
+        const uint32_t* grassSide = pixels.data() + BLOCK_TEXTURE_SIZE * BLOCK_TEXTURE_SIZE * GRASS_SIDE;
+        const uint32_t top = grassSide[0];
+        const uint32_t bottom = grassSide[BLOCK_TEXTURE_SIZE * (BLOCK_TEXTURE_SIZE - 1)];
+        CHECK((top >> 8 & 0xFF) > (top & 0xFF));
+        CHECK((bottom >> 8 & 0xFF) < (bottom & 0xFF));
+    }
+
+    TEST_CASE("bc7 dds arrays are decoded") {
+        const std::vector<uint8_t> file = makeDds(16, 8, 5, 3, DXGI_FORMAT_BC7_UNORM_SRGB);
+        const std::optional<Bc7Texture> texture = decodeBc7Dds(file);
+        REQUIRE(texture.has_value());
+        CHECK(texture->width == 16);
+        CHECK(texture->height == 8);
+        CHECK(texture->layers == 3);
+        CHECK(texture->mipLevels == 5);
+        CHECK(texture->srgb);
+
+        // 4x2, 2x1, then 1x1 blocks for the rest
+        CHECK(texture->levelSize(0) == 8 * 16);
+        CHECK(texture->levelSize(1) == 2 * 16);
+        CHECK(texture->levelSize(4) == 16);
+        const size_t layerSize = (8 + 2 + 1 + 1 + 1) * 16;
+        CHECK(texture->data.size() == 3 * layerSize);
+        CHECK(texture->levelOffset(0, 1) == 8 * 16);
+        CHECK(texture->levelOffset(2, 2) == 2 * layerSize + 10 * 16);
+        CHECK(texture->data[texture->levelOffset(1, 0)] == static_cast<uint8_t>(layerSize));
+    }
+
+    TEST_CASE("other dds files are rejected") {
+        CHECK(decodeBc7Dds(makeDds(16, 16, 1, 1, DXGI_FORMAT_BC7_UNORM)).has_value());
+        CHECK_FALSE(decodeBc7Dds(makeDds(16, 16, 1, 1, 71)).has_value()); // BC1
+        CHECK_FALSE(decodeBc7Dds(makeDds(16, 16, 6, 1, DXGI_FORMAT_BC7_UNORM)).has_value());
+        CHECK_FALSE(decodeBc7Dds(makeDds(16, 16, 1, 0, DXGI_FORMAT_BC7_UNORM)).has_value());
+
+        std::vector<uint8_t> truncated = makeDds(16, 16, 5, 2, DXGI_FORMAT_BC7_UNORM);
+        truncated.pop_back();
+        CHECK_FALSE(decodeBc7Dds(truncated).has_value());
+        CHECK_FALSE(decodeBc7Dds(std::span<const uint8_t>()).has_value());
+    }
+}
+
+#endif
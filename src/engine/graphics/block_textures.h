@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+/// Pixels along each side of a generated block texture.
+constexpr uint32_t BLOCK_TEXTURE_SIZE = 16;
+
+/// @return How many mip levels a full chain down to 1x1 has.
+uint32_t mipLevelCount(uint32_t width, uint32_t height);
+
+/// @brief Draws every block texture layer, in `mesh::TEXTURE_NAMES` order,
+/// for when there is no precompressed texture file.
+/// @return `size * size` RGBA8 pixels per layer, red in the lowest byte,
+/// layer after layer.
+std::vector<uint32_t> generateBlockTextures(uint32_t size);
+
+/// @brief A texture array of BC7 blocks read from a DDS file, with its data
+/// laid out layer after layer, each with every mip level from largest down.
+struct Bc7Texture {
+    uint32_t width;
+    uint32_t height;
+    uint32_t layers;
+    uint32_t mipLevels;
+    /// Whether the file holds `BC7_UNORM_SRGB` rather than `BC7_UNORM`.
+    bool srgb;
+    /// Points into the file that was decoded.
+    std::span<const uint8_t> data;
+
+    /// @return Bytes of `level` for one layer.
+    size_t levelSize(uint32_t level) const;
+
+    /// @return Where `level` of `layer` starts in `data`.
+    size_t levelOffset(uint32_t layer, uint32_t level) const;
+};
+
+/// @return The BC7 texture array in `file`, or empty if the file is not a
+/// complete DX10 DDS file of 2D BC7 textures.
+std::optional<Bc7Texture> decodeBc7Dds(std::span<const uint8_t> file);
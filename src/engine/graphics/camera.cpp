@@ -0,0 +1,61 @@
+#include "camera.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <glm/gtc/quaternion.hpp>
+
+namespace {
+constexpr float MOUSE_SENSITIVITY = 1.f / 200.f;
+constexpr float MAX_PITCH = 1.55f;
+} // namespace
+
+glm::mat4 Camera::getViewMatrix() const { return glm::inverse(getRotationMatrix()); }
+
+glm::mat4 Camera::getRotationMatrix() const {
+    const glm::quat pitchRotation = glm::angleAxis(pitch_, glm::vec3{1.f, 0.f, 0.f});
+    const glm::quat yawRotation = glm::angleAxis(yaw_, glm::vec3{0.f, -1.f, 0.f});
+    return glm::mat4_cast(yawRotation) * glm::mat4_cast(pitchRotation);
+}
+
+void Camera::processSDLEvent(const SDL_Event& e) {
+    if (e.type == SDL_EVENT_KEY_DOWN || e.type == SDL_EVENT_KEY_UP) {
+        const float pressed = e.type == SDL_EVENT_KEY_DOWN ? 1.f : 0.f;
+        switch (e.key.key) {
+        case SDLK_W:
+            velocity_.z = -pressed;
+            break;
+        case SDLK_S:
+            velocity_.z = pressed;
+            break;
+        case SDLK_A:
+            velocity_.x = -pressed;
+            break;
+        case SDLK_D:
+            velocity_.x = pressed;
+            break;
+        case SDLK_SPACE:
+            velocity_.y = pressed;
+            break;
+        case SDLK_LSHIFT:
+            velocity_.y = -pressed;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (e.type == SDL_EVENT_MOUSE_BUTTON_DOWN && e.button.button == SDL_BUTTON_RIGHT) {
+        looking_ = true;
+    }
+    if (e.type == SDL_EVENT_MOUSE_BUTTON_UP && e.button.button == SDL_BUTTON_RIGHT) {
+        looking_ = false;
+    }
+    if (e.type == SDL_EVENT_MOUSE_MOTION && looking_) {
+        yaw_ += e.motion.xrel * MOUSE_SENSITIVITY;
+        pitch_ = std::clamp(pitch_ - e.motion.yrel * MOUSE_SENSITIVITY, -MAX_PITCH, MAX_PITCH);
+    }
+}
+
+void Camera::update(float deltaTime) {
+    const glm::vec3 move = glm::vec3(getRotationMatrix() * glm::vec4(velocity_ * speed_ * deltaTime, 0.f));
+    position_ += glm::dvec3(move);
+}
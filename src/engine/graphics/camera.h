@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+union SDL_Event;
+
+/// @brief A free flying camera, moved with WASD and turned by dragging with
+/// the right mouse button held.
+///
+/// The position is kept in doubles so it stays exact far from the origin.
+/// Nothing is drawn at world coordinates: geometry is offset by the camera
+/// position on the CPU, and `getViewMatrix()` only rotates.
+class Camera {
+  public:
+    glm::dvec3 position_{0.0};
+    /// Movement input along the camera's own axes, each -1, 0 or 1.
+    glm::vec3 velocity_{0.f};
+    /// In radians.
+    float pitch_ = 0.f;
+    /// In radians.
+    float yaw_ = 0.f;
+    /// In blocks per second.
+    float speed_ = 20.f;
+
+    /// @return The view matrix of a camera at the origin, for geometry that
+    /// was already made relative to `position_`.
+    glm::mat4 getViewMatrix() const;
+
+    glm::mat4 getRotationMatrix() const;
+
+    void processSDLEvent(const SDL_Event& e);
+
+    /// @param deltaTime Seconds since the last update.
+    void update(float deltaTime);
+
+  private:
+    bool looking_ = false;
+};
@@ -0,0 +1,163 @@
+#include "captured_image.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <format>
+#include <string_view>
+
+namespace {
+/// @brief Reads the next number of a PPM header, after any whitespace and
+/// comments.
+/// @return False if there is no number.
+bool readHeaderNumber(std::span<const uint8_t> file, size_t& offset, uint32_t& out) {
+    while (offset < file.size()) {
+        if (file[offset] == '#') {
+            while (offset < file.size() && file[offset] != '\n') {
+                offset++;
+            }
+        } else if (std::isspace(file[offset])) {
+            offset++;
+        } else {
+            break;
+        }
+    }
+
+    uint64_t value = 0;
+    const size_t start = offset;
+    while (offset < file.size() && file[offset] >= '0' && file[offset] <= '9' && value <= UINT32_MAX) {
+        value = value * 10 + (file[offset] - '0');
+        offset++;
+    }
+    out = static_cast<uint32_t>(value);
+    return offset != start && value <= UINT32_MAX;
+}
+} // namespace
+
+float halfToFloat(uint16_t half) {
+    const float sign = (half & 0x8000) != 0 ? -1.f : 1.f;
+    const int exponent = half >> 10 & 0x1F;
+    const int mantissa = half & 0x3FF;
+    if (exponent == 0) {
+        // subnormal
+        return sign * std::ldexp(static_cast<float>(mantissa), -24);
+    }
+    if (exponent == 0x1F) {
+        return mantissa == 0 ? sign * INFINITY : NAN;
+    }
+    return sign * std::ldexp(static_cast<float>(mantissa + 0x400), exponent - 25);
+}
+
+CapturedImage CapturedImage::fromHalfFloats(uint32_t width, uint32_t height, std::span<const uint16_t> rgba) {
+    CapturedImage image{width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height * 3)};
+    for (size_t pixel = 0; pixel < static_cast<size_t>(width) * height; pixel++) {
+        for (size_t channel = 0; channel < 3; channel++) {
+            const float value = halfToFloat(rgba[pixel * 4 + channel]);
+            // NaN goes to 0, like the blit to the swapchain
+            const float clamped = value > 0.f ? std::min(value, 1.f) : 0.f;
+            image.pixels[pixel * 3 + channel] = static_cast<uint8_t>(std::lround(clamped * 255.f));
+        }
+    }
+    return image;
+}
+
+std::vector<uint8_t> encodePpm(const CapturedImage& image) {
+    const std::string header = std::format("P6\n{} {}\n255\n", image.width, image.height);
+    std::vector<uint8_t> file(header.begin(), header.end());
+    file.insert(file.end(), image.pixels.begin(), image.pixels.end());
+    return file;
+}
+
+std::optional<CapturedImage> decodePpm(std::span<const uint8_t> file) {
+    if (file.size() < 2 || file[0] != 'P' || file[1] != '6') {
+        return std::nullopt;
+    }
+
+    size_t offset = 2;
+    CapturedImage image;
+    uint32_t maxValue = 0;
+    if (!readHeaderNumber(file, offset, image.width) || !readHeaderNumber(file, offset, image.height) ||
+        !readHeaderNumber(file, offset, maxValue) || maxValue != 255) {
+        return std::nullopt;
+    }
+    // a single whitespace character ends the header
+    if (offset == file.size() || !std::isspace(file[offset])) {
+        return std::nullopt;
+    }
+    offset++;
+
+    const uint64_t size = static_cast<uint64_t>(image.width) * image.height * 3;
+    if (file.size() - offset != size) {
+        return std::nullopt;
+    }
+    image.pixels.assign(file.begin() + static_cast<ptrdiff_t>(offset), file.end());
+    return image;
+}
+
+uint32_t maxDifference(const CapturedImage& a, const CapturedImage& b) {
+    if (a.width != b.width || a.height != b.height) {
+        return UINT32_MAX;
+    }
+    uint32_t difference = 0;
+    for (size_t i = 0; i < a.pixels.size(); i++) {
+        difference = std::max(difference, static_cast<uint32_t>(std::abs(a.pixels[i] - b.pixels[i])));
+    }
+    return difference;
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+TEST_SUITE("CapturedImage") {
+    TEST_CASE("half floats convert") {
+        CHECK(halfToFloat(0x0000) == 0.f);
+        CHECK(halfToFloat(0x3C00) == 1.f);
+        CHECK(halfToFloat(0xC000) == -2.f);
+        CHECK(halfToFloat(0x3800) == 0.5f);
+        CHECK(halfToFloat(0x0001) == std::ldexp(1.f, -24));
+        CHECK(std::isinf(halfToFloat(0x7C00)));
+        CHECK(std::isnan(halfToFloat(0x7E00)));
+    }
+
+    TEST_CASE("frames are clamped to 8 bits") {
+        // 1.0, 0.5, 2.0 then -2.0, 0.0, NaN, with alpha ignored
+        const uint16_t rgba[] = {0x3C00, 0x3800, 0x4000, 0x0000, 0xC000, 0x0000, 0x7E00, 0x3C00};
+        const CapturedImage image = CapturedImage::fromHalfFloats(2, 1, rgba);
+        CHECK(image.pixels == std::vector<uint8_t>{255, 128, 255, 0, 0, 0});
+    }
+
+    TEST_CASE("ppm files round trip") {
+        const CapturedImage image{2, 2, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}};
+        const std::vector<uint8_t> file = encodePpm(image);
+        const std::optional<CapturedImage> decoded = decodePpm(file);
+        REQUIRE(decoded.has_value());
+        CHECK(decoded->width == 2);
+        CHECK(decoded->height == 2);
+        CHECK(decoded->pixels == image.pixels);
+        CHECK(maxDifference(image, *decoded) == 0);
+
+        // written by other tools, with a comment
+        const std::string_view other = "P6 # golden\n1 1 255\n\x0A\x14\x1E";
+        const std::optional<CapturedImage> commented =
+            decodePpm(std::span(reinterpret_cast<const uint8_t*>(other.data()), other.size()));
+        REQUIRE(commented.has_value());
+        CHECK(commented->pixels == std::vector<uint8_t>{10, 20, 30});
+
+        std::vector<uint8_t> truncated = file;
+        truncated.pop_back();
+        CHECK_FALSE(decodePpm(truncated).has_value());
+        const std::string_view ascii = "P3\n1 1\n255\n1 2 3\n";
+        CHECK_FALSE(decodePpm(std::span(reinterpret_cast<const uint8_t*>(ascii.data()), ascii.size())).has_value());
+    }
+
+    TEST_CASE("differences are per channel") {
+        const CapturedImage a{1, 2, {10, 20, 30, 40, 50, 60}};
+        CapturedImage b = a;
+        b.pixels[4] = 47;
+        b.pixels[0] = 11;
+        CHECK(maxDifference(a, b) == 3);
+        CHECK(maxDifference(a, CapturedImage{2, 1, a.pixels}) == UINT32_MAX);
+    }
+}
+
+#endif
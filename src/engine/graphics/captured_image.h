@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+/// @brief A frame read back from the GPU, as 8 bit RGB, for writing to disk
+/// and comparing against golden images.
+struct CapturedImage {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    /// Red, green and blue of each pixel, row after row from the top.
+    std::vector<uint8_t> pixels;
+
+    /// @brief Converts pixels in `VK_FORMAT_R16G16B16A16_SFLOAT`, as the
+    /// draw image holds them, clamping to [0, 1] the way copying to a unorm
+    /// swapchain image does. Alpha is dropped.
+    static CapturedImage fromHalfFloats(uint32_t width, uint32_t height, std::span<const uint16_t> rgba);
+};
+
+/// @return `half` as a float.
+float halfToFloat(uint16_t half);
+
+/// @return `image` as a binary PPM file.
+std::vector<uint8_t> encodePpm(const CapturedImage& image);
+
+/// @return The image in a binary PPM file with 8 bit channels, or empty if
+/// `file` is not one.
+std::optional<CapturedImage> decodePpm(std::span<const uint8_t> file);
+
+/// @return The largest difference of any channel of any pixel, or
+/// `UINT32_MAX` if the images are not the same size.
+uint32_t maxDifference(const CapturedImage& a, const CapturedImage& b);
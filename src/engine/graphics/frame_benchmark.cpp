@@ -0,0 +1,229 @@
+#include "frame_benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <glm/geometric.hpp>
+#include <string_view>
+
+namespace {
+struct PathKey {
+    double seconds;
+    glm::dvec3 offset;
+    float yaw;
+    float pitch;
+};
+
+// yaw only ever increases, so turning between keys never goes the long way round
+constexpr PathKey PATH[] = {
+    {0.0, {0.0, 0.0, 0.0}, 0.f, 0.f},
+    {6.0, {0.0, 40.0, -60.0}, 0.f, -0.3f},
+    {14.0, {180.0, 60.0, -180.0}, 0.78f, -0.2f},
+    {20.0, {280.0, 50.0, 40.0}, 2.36f, -0.2f},
+    {26.0, {120.0, 30.0, 200.0}, 3.93f, -0.1f},
+    {34.0, {-60.0, 12.0, 60.0}, 5.9f, 0.f},
+    {BENCHMARK_PATH_SECONDS, {0.0, 0.0, 0.0}, 6.2831853f, 0.f},
+};
+
+double percentile(std::span<const double> sorted, double percent) {
+    // nearest rank, so every percentile is a frame that actually happened
+    const auto rank = static_cast<size_t>(std::ceil(percent / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+std::string json_string(std::string_view text) {
+    std::string out = "\"";
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += std::format("\\u{:04x}", static_cast<unsigned int>(c));
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+std::string summary_json(std::span<const double> milliseconds) {
+    const FrameTimeSummary s = summarizeFrameTimes(milliseconds);
+    return std::format("{{\"frames\": {}, \"mean\": {:.4f}, \"p50\": {:.4f}, \"p95\": {:.4f}, \"p99\": {:.4f}, "
+                       "\"max\": {:.4f}, \"hitches\": {}}}",
+                       s.frames, s.mean, s.p50, s.p95, s.p99, s.max, s.hitches);
+}
+
+std::string series_json(const FrameSeries& series) {
+    std::string out = std::format("{{\n    \"frame\": {},\n    \"phases\": {{", summary_json(series.frames()));
+    for (size_t i = 0; i < series.phases().size(); i++) {
+        const FrameSeries::Phase& phase = series.phases()[i];
+        out += std::format("{}\n      {}: {}", i == 0 ? "" : ",", json_string(phase.name),
+                           summary_json(phase.milliseconds));
+    }
+    out += series.phases().empty() ? "}\n  }" : "\n    }\n  }";
+    return out;
+}
+} // namespace
+
+CameraPose benchmarkCameraPose(glm::dvec3 start, double seconds) {
+    const double time = std::fmod(std::max(seconds, 0.0), BENCHMARK_PATH_SECONDS);
+    const PathKey* next = std::upper_bound(std::begin(PATH), std::end(PATH), time,
+                                           [](double t, const PathKey& key) { return t < key.seconds; });
+    const PathKey& from = *(next - 1);
+    const PathKey& to = *next;
+
+    const double t = (time - from.seconds) / (to.seconds - from.seconds);
+    const auto tf = static_cast<float>(t);
+    return CameraPose{start + from.offset + (to.offset - from.offset) * t, from.yaw + (to.yaw - from.yaw) * tf,
+                      from.pitch + (to.pitch - from.pitch) * tf};
+}
+
+FrameTimeSummary summarizeFrameTimes(std::span<const double> milliseconds) {
+    FrameTimeSummary summary;
+    if (milliseconds.empty()) {
+        return summary;
+    }
+
+    std::vector<double> sorted(milliseconds.begin(), milliseconds.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    summary.frames = static_cast<uint32_t>(sorted.size());
+    double sum = 0;
+    for (const double time : sorted) {
+        sum += time;
+    }
+    summary.mean = sum / static_cast<double>(sorted.size());
+    summary.p50 = percentile(sorted, 50.0);
+    summary.p95 = percentile(sorted, 95.0);
+    summary.p99 = percentile(sorted, 99.0);
+    summary.max = sorted.back();
+    const double hitch = summary.p50 * HITCH_FACTOR;
+    summary.hitches = static_cast<uint32_t>(sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), hitch));
+    return summary;
+}
+
+void FrameSeries::addFrame(double frameMilliseconds, std::span<const PhaseTiming> phases) {
+    frames_.push_back(frameMilliseconds);
+
+    for (const PhaseTiming& timing : phases) {
+        auto found = std::find_if(phases_.begin(), phases_.end(),
+                                  [&](const Phase& phase) { return phase.name == timing.name; });
+        if (found == phases_.end()) {
+            // took no time in the frames before it was first seen
+            phases_.push_back(Phase{timing.name, std::vector<double>(frames_.size() - 1, 0.0)});
+            found = phases_.end() - 1;
+        }
+        if (found->milliseconds.size() < frames_.size()) {
+            found->milliseconds.push_back(0.0);
+        }
+        found->milliseconds.back() += timing.milliseconds;
+    }
+
+    for (Phase& phase : phases_) {
+        phase.milliseconds.resize(frames_.size(), 0.0);
+    }
+}
+
+std::string benchmarkJson(const BenchmarkInfo& info, const FrameSeries& cpu, const FrameSeries& gpu) {
+    return std::format("{{\n  \"device\": {},\n  \"resolution\": [{}, {}],\n  \"seed\": {},\n  \"headless\": {},\n"
+                       "  \"hitch_factor\": {},\n  \"cpu\": {},\n  \"gpu\": {}\n}}\n",
+                       json_string(info.device), info.width, info.height, info.seed, info.headless, HITCH_FACTOR,
+                       series_json(cpu), series_json(gpu));
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+TEST_SUITE("FrameBenchmark") {
+    TEST_CASE("the camera path loops back to the start") {
+        const glm::dvec3 start{10.0, 50.0, -4.0};
+        const CameraPose first = benchmarkCameraPose(start, 0.0);
+        CHECK(first.position == start);
+        CHECK(first.yaw == 0.f);
+
+        const CameraPose looped = benchmarkCameraPose(start, BENCHMARK_PATH_SECONDS);
+        CHECK(looped.position == start);
+        const CameraPose again = benchmarkCameraPose(start, BENCHMARK_PATH_SECONDS + 3.0);
+        const CameraPose once = benchmarkCameraPose(start, 3.0);
+        CHECK(again.position.y == doctest::Approx(once.position.y));
+        CHECK(again.pitch == doctest::Approx(once.pitch));
+    }
+
+    TEST_CASE("the camera path is interpolated between keys") {
+        // halfway to the second key
+        const CameraPose pose = benchmarkCameraPose(glm::dvec3(0.0), 3.0);
+        CHECK(pose.position.x == doctest::Approx(0.0));
+        CHECK(pose.position.y == doctest::Approx(20.0));
+        CHECK(pose.position.z == doctest::Approx(-30.0));
+        CHECK(pose.pitch == doctest::Approx(-0.15f));
+
+        // never jumps from one frame to the next
+        CameraPose last = benchmarkCameraPose(glm::dvec3(0.0), 0.0);
+        for (int frame = 1; frame < 60 * 40; frame++) {
+            const CameraPose next = benchmarkCameraPose(glm::dvec3(0.0), frame / 60.0);
+            CHECK(glm::length(next.position - last.position) < 1.0);
+            last = next;
+        }
+    }
+
+    TEST_CASE("percentiles are by nearest rank") {
+        std::vector<double> times;
+        for (int i = 100; i >= 1; i--) {
+            times.push_back(static_cast<double>(i));
+        }
+        const FrameTimeSummary summary = summarizeFrameTimes(times);
+        CHECK(summary.frames == 100);
+        CHECK(summary.mean == doctest::Approx(50.5));
+        CHECK(summary.p50 == 50.0);
+        CHECK(summary.p95 == 95.0);
+        CHECK(summary.p99 == 99.0);
+        CHECK(summary.max == 100.0);
+        // twice the median is not a hitch, only past it
+        CHECK(summary.hitches == 0);
+
+        CHECK(summarizeFrameTimes({}).frames == 0);
+        const double one[] = {4.0};
+        CHECK(summarizeFrameTimes(one).p99 == 4.0);
+    }
+
+    TEST_CASE("hitches are counted against the median") {
+        const double times[] = {5.0, 5.0, 6.0, 5.0, 30.0, 5.0, 10.0, 11.0, 5.0};
+        const FrameTimeSummary summary = summarizeFrameTimes(times);
+        CHECK(summary.p50 == 5.0);
+        CHECK(summary.hitches == 2);
+        CHECK(summary.max == 30.0);
+    }
+
+    TEST_CASE("phases line up with frames") {
+        FrameSeries series;
+        const PhaseTiming first[] = {{"record", 1.0}};
+        series.addFrame(2.0, first);
+        const PhaseTiming second[] = {{"submit", 0.5}, {"record", 1.5}, {"record", 0.5}};
+        series.addFrame(3.0, second);
+        series.addFrame(1.0, {});
+
+        REQUIRE(series.frames().size() == 3);
+        REQUIRE(series.phases().size() == 2);
+        CHECK(series.phases()[0].name == "record");
+        CHECK(series.phases()[0].milliseconds == std::vector<double>{1.0, 2.0, 0.0});
+        CHECK(series.phases()[1].name == "submit");
+        CHECK(series.phases()[1].milliseconds == std::vector<double>{0.0, 0.5, 0.0});
+    }
+
+    TEST_CASE("results are written as json") {
+        FrameSeries cpu;
+        const PhaseTiming phases[] = {{"record", 1.0}};
+        cpu.addFrame(2.0, phases);
+        const std::string json = benchmarkJson({"GPU \"9000\"", 640, 360, 1337, true}, cpu, FrameSeries{});
+
+        CHECK(json.find("\"device\": \"GPU \\\"9000\\\"\"") != std::string::npos);
+        CHECK(json.find("\"resolution\": [640, 360]") != std::string::npos);
+        CHECK(json.find("\"headless\": true") != std::string::npos);
+        CHECK(json.find("\"record\": {\"frames\": 1, \"mean\": 1.0000") != std::string::npos);
+        CHECK(json.find("\"gpu\": {\n    \"frame\": {\"frames\": 0") != std::string::npos);
+        CHECK(std::count(json.begin(), json.end(), '{') == std::count(json.begin(), json.end(), '}'));
+    }
+}
+
+#endif
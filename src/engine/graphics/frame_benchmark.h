@@ -0,0 +1,90 @@
+#pragma once
+
+#include "gpu_timings.h"
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <span>
+#include <string>
+#include <vector>
+
+/// @brief How long a named phase of a frame took, on the CPU or the GPU.
+using PhaseTiming = GpuZoneTiming;
+
+/// Frames over this many times the median frame time count as hitches.
+inline constexpr double HITCH_FACTOR = 2.0;
+
+/// How long the benchmark camera path takes before it starts over.
+inline constexpr double BENCHMARK_PATH_SECONDS = 40.0;
+
+/// @brief Where the camera is and which way it looks.
+struct CameraPose {
+    glm::dvec3 position;
+    /// In radians, as `Camera::yaw_`.
+    float yaw;
+    /// In radians, as `Camera::pitch_`.
+    float pitch;
+};
+
+/// @brief The scripted flight of the benchmark. It climbs over the terrain,
+/// flies out far enough that every level of detail swaps in and out, turns
+/// and comes back low, looping every `BENCHMARK_PATH_SECONDS`.
+/// @param start Where the camera starts, which the path is relative to.
+/// @param seconds Time along the path.
+CameraPose benchmarkCameraPose(glm::dvec3 start, double seconds);
+
+/// @brief Frame times by nearest rank percentile.
+struct FrameTimeSummary {
+    uint32_t frames = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+    double max = 0;
+    /// Frames over `HITCH_FACTOR` times `p50`.
+    uint32_t hitches = 0;
+};
+
+/// @return The summary of `milliseconds`, all zero if it is empty.
+FrameTimeSummary summarizeFrameTimes(std::span<const double> milliseconds);
+
+/// @brief The frame times and phase times of every frame of a benchmark, on
+/// one clock.
+///
+/// As in `GpuTimingHistory`, phases sharing a name add up, and a phase
+/// missing from a frame counts as taking no time.
+///
+/// # Thread Safety
+///
+/// Not thread safe.
+class FrameSeries {
+  public:
+    struct Phase {
+        std::string name;
+        /// One per frame.
+        std::vector<double> milliseconds;
+    };
+
+    void addFrame(double frameMilliseconds, std::span<const PhaseTiming> phases);
+
+    std::span<const double> frames() const { return frames_; }
+
+    /// @return In the order they were first seen.
+    const std::vector<Phase>& phases() const { return phases_; }
+
+  private:
+    std::vector<double> frames_;
+    std::vector<Phase> phases_;
+};
+
+/// @brief What a benchmark ran on, written next to its results.
+struct BenchmarkInfo {
+    std::string device;
+    uint32_t width;
+    uint32_t height;
+    int32_t seed;
+    bool headless;
+};
+
+/// @return `info` and the summaries of each series and each of their phases
+/// as a JSON object.
+std::string benchmarkJson(const BenchmarkInfo& info, const FrameSeries& cpu, const FrameSeries& gpu);
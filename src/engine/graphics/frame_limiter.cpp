@@ -0,0 +1,84 @@
+#include "frame_limiter.h"
+#include <thread>
+
+void FrameLimiter::setTarget(double framesPerSecond) {
+    target_ = framesPerSecond > 0 ? framesPerSecond : 0;
+    period_ = target_ > 0 ? std::chrono::round<Clock::duration>(std::chrono::duration<double>(1.0 / target_))
+                          : Clock::duration(0);
+    deadline_.reset();
+}
+
+FrameLimiter::Clock::time_point FrameLimiter::nextDeadline(Clock::time_point now) {
+    if (period_ == Clock::duration(0)) {
+        return now;
+    }
+    if (deadline_.has_value() && *deadline_ + 2 * period_ >= now) {
+        *deadline_ += period_;
+    } else {
+        deadline_ = now;
+    }
+    return *deadline_;
+}
+
+void FrameLimiter::wait() {
+    const Clock::time_point deadline = nextDeadline(Clock::now());
+
+    // sleeping can overshoot by a millisecond or more, so sleep most of the way and spin the rest
+    constexpr auto SPIN_TIME = std::chrono::milliseconds(2);
+    if (deadline - Clock::now() > SPIN_TIME) {
+        std::this_thread::sleep_until(deadline - SPIN_TIME);
+    }
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+using namespace std::chrono_literals;
+
+TEST_SUITE("FrameLimiter") {
+    TEST_CASE("no limit never waits") {
+        FrameLimiter limiter;
+        const FrameLimiter::Clock::time_point now{};
+        CHECK(limiter.nextDeadline(now) == now);
+        CHECK(limiter.nextDeadline(now + 5ms) == now + 5ms);
+    }
+
+    TEST_CASE("deadlines keep a steady cadence") {
+        FrameLimiter limiter;
+        limiter.setTarget(100);
+        const FrameLimiter::Clock::time_point start{};
+
+        CHECK(limiter.nextDeadline(start) == start);
+        // finished early, so held to the next period
+        CHECK(limiter.nextDeadline(start + 3ms) == start + 10ms);
+        // finished a little late, which the next frame makes up for
+        CHECK(limiter.nextDeadline(start + 22ms) == start + 20ms);
+        CHECK(limiter.nextDeadline(start + 24ms) == start + 30ms);
+    }
+
+    TEST_CASE("falling a whole period behind starts over") {
+        FrameLimiter limiter;
+        limiter.setTarget(100);
+        const FrameLimiter::Clock::time_point start{};
+
+        CHECK(limiter.nextDeadline(start) == start);
+        CHECK(limiter.nextDeadline(start + 50ms) == start + 50ms);
+        CHECK(limiter.nextDeadline(start + 51ms) == start + 60ms);
+    }
+
+    TEST_CASE("turning the limit off") {
+        FrameLimiter limiter;
+        limiter.setTarget(60);
+        CHECK(limiter.target() == 60);
+        limiter.setTarget(0);
+        CHECK(limiter.target() == 0);
+        const FrameLimiter::Clock::time_point now{};
+        CHECK(limiter.nextDeadline(now) == now);
+    }
+}
+
+#endif
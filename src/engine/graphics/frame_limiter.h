@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+
+/// @brief Caps the frame rate by holding each frame back until its deadline.
+///
+/// Deadlines are spaced exactly one period apart, so the rate does not drift
+/// with how long each sleep overshoots. A frame that finishes late keeps to
+/// the same cadence, but one that falls a whole period behind starts a new
+/// cadence instead of rushing to catch up.
+class FrameLimiter {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @param framesPerSecond `0` turns the limit off.
+    void setTarget(double framesPerSecond);
+
+    /// @return The frame rate being held to, or `0` if there is no limit.
+    double target() const { return target_; }
+
+    /// @brief Advances to the next frame's deadline.
+    /// @param now When the previous frame finished.
+    /// @return When the next frame may start, which is `now` if there is
+    /// no limit.
+    Clock::time_point nextDeadline(Clock::time_point now);
+
+    /// @brief Blocks until the next frame's deadline.
+    void wait();
+
+  private:
+    double target_ = 0;
+    Clock::duration period_{0};
+    std::optional<Clock::time_point> deadline_;
+};
@@ -0,0 +1,183 @@
+#include "frustum.h"
+#include <cmath>
+#include <exception>
+#include <iostream>
+
+namespace {
+glm::vec4 row(const glm::mat4& m, int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); }
+
+glm::vec4 normalizePlane(const glm::vec4& plane) {
+    const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    return plane / length;
+}
+
+frustum_detail::CullFn kernelFor(noise::SimdLevel level) {
+    switch (level) {
+    case noise::SimdLevel::Avx2:
+        return frustum_detail::avx2Cull();
+    case noise::SimdLevel::Sse41:
+        return frustum_detail::sse41Cull();
+    case noise::SimdLevel::Scalar:
+    default:
+        return &frustum_detail::cullScalar;
+    }
+}
+
+frustum_detail::CullFn bestKernel() {
+    static const frustum_detail::CullFn kernel = [] {
+        const frustum_detail::CullFn simd = kernelFor(noise::detectSimdLevel());
+        return simd != nullptr ? simd : &frustum_detail::cullScalar;
+    }();
+    return kernel;
+}
+} // namespace
+
+void AabbSoA::clear() {
+    minX.clear();
+    minY.clear();
+    minZ.clear();
+    maxX.clear();
+    maxY.clear();
+    maxZ.clear();
+}
+
+void AabbSoA::push(const glm::vec3& min, const glm::vec3& max) {
+    minX.push_back(min.x);
+    minY.push_back(min.y);
+    minZ.push_back(min.z);
+    maxX.push_back(max.x);
+    maxY.push_back(max.y);
+    maxZ.push_back(max.z);
+}
+
+Frustum Frustum::fromMatrix(const glm::mat4& viewProj) {
+    // A point is inside when -w <= x <= w, -w <= y <= w and 0 <= z <= w in
+    // clip space, each of which is a plane made from the rows of the matrix.
+    const glm::vec4 x = row(viewProj, 0);
+    const glm::vec4 y = row(viewProj, 1);
+    const glm::vec4 z = row(viewProj, 2);
+    const glm::vec4 w = row(viewProj, 3);
+
+    Frustum frustum;
+    frustum.planes[Left] = normalizePlane(w + x);
+    frustum.planes[Right] = normalizePlane(w - x);
+    frustum.planes[Bottom] = normalizePlane(w + y);
+    frustum.planes[Top] = normalizePlane(w - y);
+    frustum.planes[DepthZero] = normalizePlane(z);
+    frustum.planes[DepthOne] = normalizePlane(w - z);
+    return frustum;
+}
+
+bool Frustum::intersectsAabb(const glm::vec3& min, const glm::vec3& max) const {
+    for (const glm::vec4& plane : planes) {
+        // the corner furthest along the plane's normal
+        const float px = plane.x >= 0.f ? max.x : min.x;
+        const float py = plane.y >= 0.f ? max.y : min.y;
+        const float pz = plane.z >= 0.f ? max.z : min.z;
+        if (plane.x * px + plane.y * py + plane.z * pz + plane.w < 0.f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Frustum::cullAabbs(const AabbSoA& boxes, uint8_t* visible) const {
+    bestKernel()(*this, boxes, 0, boxes.size(), visible);
+}
+
+void Frustum::cullAabbs(const AabbSoA& boxes, uint8_t* visible, noise::SimdLevel level) const {
+    const frustum_detail::CullFn kernel = kernelFor(level);
+    if (kernel == nullptr || !noise::isSimdLevelSupported(level)) {
+        try {
+            std::cerr << "Frustum culling for " << noise::simdLevelName(level)
+                      << " is not available on this CPU or build" << std::endl;
+        } catch (...) {
+        }
+        std::terminate();
+    }
+    kernel(*this, boxes, 0, boxes.size(), visible);
+}
+
+void frustum_detail::cullScalar(const Frustum& frustum, const AabbSoA& boxes, uint32_t begin, uint32_t end,
+                                uint8_t* visible) {
+    for (uint32_t i = begin; i < end; i++) {
+        const glm::vec3 min(boxes.minX[i], boxes.minY[i], boxes.minZ[i]);
+        const glm::vec3 max(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]);
+        visible[i] = frustum.intersectsAabb(min, max) ? 1 : 0;
+    }
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+TEST_SUITE("Frustum") {
+    TEST_CASE("reversed depth perspective") {
+        // 90 degrees, so at 10 blocks away the view is 20 blocks across
+        glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(90.f), 1.f, 1000.f, 0.1f);
+        projection[1][1] *= -1;
+        const Frustum frustum = Frustum::fromMatrix(projection);
+
+        // the camera looks down -z
+        CHECK(frustum.intersectsAabb(glm::vec3(-1.f, -1.f, -11.f), glm::vec3(1.f, 1.f, -9.f)));
+        CHECK_FALSE(frustum.intersectsAabb(glm::vec3(-1.f, -1.f, 9.f), glm::vec3(1.f, 1.f, 11.f)));
+
+        CHECK_FALSE(frustum.intersectsAabb(glm::vec3(12.f, -1.f, -11.f), glm::vec3(14.f, 1.f, -9.f)));
+        CHECK_FALSE(frustum.intersectsAabb(glm::vec3(-1.f, -14.f, -11.f), glm::vec3(1.f, -12.f, -9.f)));
+        CHECK(frustum.intersectsAabb(glm::vec3(9.f, -1.f, -11.f), glm::vec3(14.f, 1.f, -9.f)));
+
+        CHECK_FALSE(frustum.intersectsAabb(glm::vec3(-1.f, -1.f, -1100.f), glm::vec3(1.f, 1.f, -1010.f)));
+        CHECK(frustum.intersectsAabb(glm::vec3(-1.f, -1.f, -1010.f), glm::vec3(1.f, 1.f, -990.f)));
+
+        // a box around the camera
+        CHECK(frustum.intersectsAabb(glm::vec3(-1.f), glm::vec3(1.f)));
+    }
+
+    TEST_CASE("planes follow the view") {
+        const glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(90.f), 1.f, 1000.f, 0.1f);
+        // camera at x = 100, so the world moves by -100
+        const glm::mat4 view = glm::translate(glm::mat4(1.f), glm::vec3(-100.f, 0.f, 0.f));
+        const Frustum frustum = Frustum::fromMatrix(projection * view);
+
+        CHECK(frustum.intersectsAabb(glm::vec3(99.f, -1.f, -11.f), glm::vec3(101.f, 1.f, -9.f)));
+        CHECK_FALSE(frustum.intersectsAabb(glm::vec3(-1.f, -1.f, -11.f), glm::vec3(1.f, 1.f, -9.f)));
+    }
+
+    TEST_CASE("batched culling matches one box at a time") {
+        glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(70.f), 16.f / 9.f, 1000.f, 0.1f);
+        projection[1][1] *= -1;
+        const glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.3f, -0.2f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+        const Frustum frustum = Frustum::fromMatrix(projection * view);
+
+        // enough boxes that every kernel has a partial batch left over
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> position(-300.f, 300.f);
+        AabbSoA boxes;
+        std::vector<uint8_t> expected;
+        for (int i = 0; i < 1003; i++) {
+            const glm::vec3 min(position(rng), position(rng), position(rng));
+            const glm::vec3 max = min + glm::vec3(32.f);
+            boxes.push(min, max);
+            expected.push_back(frustum.intersectsAabb(min, max) ? 1 : 0);
+        }
+
+        for (const noise::SimdLevel level :
+             {noise::SimdLevel::Scalar, noise::SimdLevel::Sse41, noise::SimdLevel::Avx2}) {
+            if (!noise::isSimdLevelSupported(level)) {
+                continue;
+            }
+            CAPTURE(noise::simdLevelName(level));
+            std::vector<uint8_t> visible(boxes.size(), 2);
+            frustum.cullAabbs(boxes, visible.data(), level);
+            CHECK(visible == expected);
+        }
+
+        std::vector<uint8_t> visible(boxes.size(), 2);
+        frustum.cullAabbs(boxes, visible.data());
+        CHECK(visible == expected);
+    }
+}
+
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../noise/noise.h"
+#include <array>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+/// @brief Axis aligned boxes with each coordinate in its own array, so
+/// `Frustum::cullAabbs()` can load several boxes' worth of one coordinate at
+/// once.
+struct AabbSoA {
+    std::vector<float> minX;
+    std::vector<float> minY;
+    std::vector<float> minZ;
+    std::vector<float> maxX;
+    std::vector<float> maxY;
+    std::vector<float> maxZ;
+
+    void clear();
+
+    void push(const glm::vec3& min, const glm::vec3& max);
+
+    uint32_t size() const { return static_cast<uint32_t>(minX.size()); }
+};
+
+/// @brief The six planes bounding what a camera can see.
+///
+/// Each plane is stored as `(normal, distance)` with the normal pointing
+/// inwards, so a point `p` is on the visible side when
+/// `dot(normal, p) + distance >= 0`. Planes are in whatever space the matrix
+/// they were extracted from takes its input in. The engine extracts them from
+/// a camera relative view projection, so they are camera relative too.
+struct Frustum {
+    enum Plane {
+        Left,
+        Right,
+        Bottom,
+        Top,
+        /// Clip space depth 0, which is the far plane with reversed depth.
+        DepthZero,
+        /// Clip space depth w, which is the near plane with reversed depth.
+        DepthOne,
+    };
+
+    static constexpr int PLANE_COUNT = 6;
+
+    std::array<glm::vec4, PLANE_COUNT> planes;
+
+    /// @brief Extracts the planes of `viewProj`, a projection with a clip
+    /// space depth range of 0 to 1 as Vulkan uses.
+    static Frustum fromMatrix(const glm::mat4& viewProj);
+
+    /// @return `false` if the box from `min` to `max` is entirely outside,
+    /// and `true` if it may be inside. Boxes near the frustum's corners can
+    /// pass without being visible.
+    bool intersectsAabb(const glm::vec3& min, const glm::vec3& max) const;
+
+    /// @brief Tests every box as `intersectsAabb()` does, four or eight at a
+    /// time where the CPU can.
+    /// @param visible Set to `1` for each box that may be inside and `0` for
+    /// each that is not. Must hold `boxes.size()` values.
+    void cullAabbs(const AabbSoA& boxes, uint8_t* visible) const;
+
+    /// @brief Same as `cullAabbs()`, but forces a specific kernel. Terminates
+    /// if `level` is not supported. Mainly for tests.
+    void cullAabbs(const AabbSoA& boxes, uint8_t* visible, noise::SimdLevel level) const;
+};
+
+namespace frustum_detail {
+/// @brief Tests boxes `[begin, end)`.
+using CullFn = void (*)(const Frustum& frustum, const AabbSoA& boxes, uint32_t begin, uint32_t end,
+                        uint8_t* visible);
+
+void cullScalar(const Frustum& frustum, const AabbSoA& boxes, uint32_t begin, uint32_t end, uint8_t* visible);
+/// @return The SSE4.1 kernel, or null if it was not compiled for this target.
+CullFn sse41Cull();
+/// @return The AVX2 kernel, or null if it was not compiled for this target.
+CullFn avx2Cull();
+} // namespace frustum_detail
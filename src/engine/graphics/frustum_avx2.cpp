@@ -0,0 +1,60 @@
+#include "frustum.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#include <immintrin.h>
+
+namespace {
+void cullAvx2(const Frustum& frustum, const AabbSoA& boxes, uint32_t begin, uint32_t end, uint8_t* visible) {
+    struct PlaneLanes {
+        __m256 x;
+        __m256 y;
+        __m256 z;
+        __m256 w;
+        // the coordinates of the corner furthest along the normal
+        const float* cornerX;
+        const float* cornerY;
+        const float* cornerZ;
+    };
+
+    std::array<PlaneLanes, Frustum::PLANE_COUNT> planes;
+    for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+        const glm::vec4& plane = frustum.planes[p];
+        planes[p] = PlaneLanes{_mm256_set1_ps(plane.x),
+                               _mm256_set1_ps(plane.y),
+                               _mm256_set1_ps(plane.z),
+                               _mm256_set1_ps(plane.w),
+                               plane.x >= 0.f ? boxes.maxX.data() : boxes.minX.data(),
+                               plane.y >= 0.f ? boxes.maxY.data() : boxes.minY.data(),
+                               plane.z >= 0.f ? boxes.maxZ.data() : boxes.minZ.data()};
+    }
+
+    const __m256 zero = _mm256_setzero_ps();
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const PlaneLanes& plane : planes) {
+            // summed in the same order as the scalar test, so both agree to the bit
+            const __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane.x, _mm256_loadu_ps(plane.cornerX + i)),
+                                      _mm256_mul_ps(plane.y, _mm256_loadu_ps(plane.cornerY + i))),
+                           _mm256_mul_ps(plane.z, _mm256_loadu_ps(plane.cornerZ + i))),
+                plane.w);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+        }
+        const int mask = _mm256_movemask_ps(inside);
+        for (uint32_t lane = 0; lane < 8; lane++) {
+            visible[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+        }
+    }
+    frustum_detail::cullScalar(frustum, boxes, i, end, visible);
+}
+} // namespace
+
+frustum_detail::CullFn frustum_detail::avx2Cull() { return &cullAvx2; }
+
+#else
+
+frustum_detail::CullFn frustum_detail::avx2Cull() { return nullptr; }
+
+#endif
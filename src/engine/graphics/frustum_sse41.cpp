@@ -0,0 +1,60 @@
+#include "frustum.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#include <smmintrin.h>
+
+namespace {
+void cullSse41(const Frustum& frustum, const AabbSoA& boxes, uint32_t begin, uint32_t end, uint8_t* visible) {
+    struct PlaneLanes {
+        __m128 x;
+        __m128 y;
+        __m128 z;
+        __m128 w;
+        // the coordinates of the corner furthest along the normal
+        const float* cornerX;
+        const float* cornerY;
+        const float* cornerZ;
+    };
+
+    std::array<PlaneLanes, Frustum::PLANE_COUNT> planes;
+    for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+        const glm::vec4& plane = frustum.planes[p];
+        planes[p] = PlaneLanes{_mm_set1_ps(plane.x),
+                               _mm_set1_ps(plane.y),
+                               _mm_set1_ps(plane.z),
+                               _mm_set1_ps(plane.w),
+                               plane.x >= 0.f ? boxes.maxX.data() : boxes.minX.data(),
+                               plane.y >= 0.f ? boxes.maxY.data() : boxes.minY.data(),
+                               plane.z >= 0.f ? boxes.maxZ.data() : boxes.minZ.data()};
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const PlaneLanes& plane : planes) {
+            // summed in the same order as the scalar test, so both agree to the bit
+            const __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.x, _mm_loadu_ps(plane.cornerX + i)),
+                                      _mm_mul_ps(plane.y, _mm_loadu_ps(plane.cornerY + i))),
+                           _mm_mul_ps(plane.z, _mm_loadu_ps(plane.cornerZ + i))),
+                plane.w);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+        }
+        const int mask = _mm_movemask_ps(inside);
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            visible[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+        }
+    }
+    frustum_detail::cullScalar(frustum, boxes, i, end, visible);
+}
+} // namespace
+
+frustum_detail::CullFn frustum_detail::sse41Cull() { return &cullSse41; }
+
+#else
+
+frustum_detail::CullFn frustum_detail::sse41Cull() { return nullptr; }
+
+#endif
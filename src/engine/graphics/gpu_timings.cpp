@@ -0,0 +1,108 @@
+#include "gpu_timings.h"
+#include <algorithm>
+#include <string_view>
+
+double timestampMilliseconds(uint64_t begin, uint64_t end, double period, uint32_t validBits) {
+    const uint64_t mask = validBits >= 64 ? ~uint64_t(0) : (uint64_t(1) << validBits) - 1;
+    // unsigned subtraction wraps the same way the counter does, once masked
+    const uint64_t ticks = (end - begin) & mask;
+    return static_cast<double>(ticks) * period / 1e6;
+}
+
+void GpuTimingHistory::addFrame(double frameMilliseconds, std::span<const GpuZoneTiming> zones) {
+    frameTimes_[frameCount_ % FRAME_COUNT] = static_cast<float>(frameMilliseconds);
+
+    for (const GpuZoneTiming& timing : zones) {
+        const auto found = std::find_if(zones_.begin(), zones_.end(),
+                                        [&](const Zone& zone) { return zone.name == timing.name; });
+        if (found == zones_.end()) {
+            Zone zone;
+            zone.name = timing.name;
+            zone.average = 0;
+            zone.latest = 0;
+            zone.max = 0;
+            zone.samples_.fill(0);
+            zone.sum_ = 0;
+            zone.count_ = 0;
+            zones_.push_back(std::move(zone));
+        }
+    }
+
+    for (Zone& zone : zones_) {
+        double milliseconds = 0;
+        for (const GpuZoneTiming& timing : zones) {
+            if (std::string_view(timing.name) == zone.name) {
+                milliseconds += timing.milliseconds;
+            }
+        }
+
+        double& sample = zone.samples_[zone.count_ % AVERAGE_FRAMES];
+        zone.sum_ += milliseconds - sample;
+        sample = milliseconds;
+        zone.count_++;
+
+        const uint32_t samples = std::min(zone.count_, AVERAGE_FRAMES);
+        zone.average = zone.sum_ / samples;
+        zone.latest = milliseconds;
+        zone.max = *std::max_element(zone.samples_.begin(), zone.samples_.begin() + samples);
+    }
+
+    frameCount_++;
+}
+
+float GpuTimingHistory::maxFrameTime() const { return *std::max_element(frameTimes_.begin(), frameTimes_.end()); }
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+TEST_SUITE("GpuTimings") {
+    TEST_CASE("timestamps convert with the tick period") {
+        CHECK(timestampMilliseconds(1000, 3000, 1.0, 64) == doctest::Approx(0.002));
+        CHECK(timestampMilliseconds(0, 1'000'000, 2.5, 64) == doctest::Approx(2.5));
+    }
+
+    TEST_CASE("timestamps wrap around their valid bits") {
+        // a 32 bit counter that wrapped from near the top to 10
+        CHECK(timestampMilliseconds(0xFFFF'FFF0, 10, 1e6, 32) == doctest::Approx(26.0));
+    }
+
+    TEST_CASE("zones average over the last frames") {
+        GpuTimingHistory history;
+        const GpuZoneTiming first[] = {{"sky", 1.0}, {"chunks", 4.0}};
+        history.addFrame(5.0, first);
+        const GpuZoneTiming second[] = {{"sky", 3.0}, {"chunks", 2.0}, {"chunks", 2.0}};
+        history.addFrame(7.0, second);
+
+        REQUIRE(history.zones().size() == 2);
+        CHECK(history.zones()[0].name == "sky");
+        CHECK(history.zones()[0].average == doctest::Approx(2.0));
+        CHECK(history.zones()[0].latest == doctest::Approx(3.0));
+        CHECK(history.zones()[0].max == doctest::Approx(3.0));
+        // zones sharing a name add up
+        CHECK(history.zones()[1].latest == doctest::Approx(4.0));
+
+        for (uint32_t i = 0; i < GpuTimingHistory::AVERAGE_FRAMES; i++) {
+            const GpuZoneTiming frame[] = {{"sky", 1.0}};
+            history.addFrame(1.0, frame);
+        }
+        CHECK(history.zones()[0].average == doctest::Approx(1.0));
+        CHECK(history.zones()[0].max == doctest::Approx(1.0));
+        // a zone that stops running averages down to nothing
+        CHECK(history.zones()[1].average == doctest::Approx(0.0));
+    }
+
+    TEST_CASE("frame times wrap around for plotting") {
+        GpuTimingHistory history;
+        for (uint32_t i = 0; i < GpuTimingHistory::FRAME_COUNT + 2; i++) {
+            history.addFrame(static_cast<double>(i), {});
+        }
+        CHECK(history.frameOffset() == 2);
+        CHECK(history.frameTimes()[history.frameOffset()] == 2.f);
+        CHECK(history.frameTimes()[1] == static_cast<float>(GpuTimingHistory::FRAME_COUNT + 1));
+        CHECK(history.latestFrameTime() == static_cast<float>(GpuTimingHistory::FRAME_COUNT + 1));
+        CHECK(history.maxFrameTime() == static_cast<float>(GpuTimingHistory::FRAME_COUNT + 1));
+    }
+}
+
+#endif
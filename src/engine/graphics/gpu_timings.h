@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+/// @brief How long the GPU spent in a named zone of a frame.
+struct GpuZoneTiming {
+    const char* name;
+    double milliseconds;
+};
+
+/// @brief Converts the ticks between two timestamps to milliseconds.
+/// @param period Nanoseconds per tick, `VkPhysicalDeviceLimits::timestampPeriod`.
+/// @param validBits How many low bits of a timestamp the queue writes, which
+/// `end` may have wrapped around.
+double timestampMilliseconds(uint64_t begin, uint64_t end, double period, uint32_t validBits);
+
+/// @brief Keeps the last few seconds of GPU frame times and a rolling
+/// average of each zone, for graphs.
+///
+/// Zones are kept in the order they were first seen. A zone missing from a
+/// frame counts as taking no time, so one that only runs now and then
+/// averages to what it costs per frame.
+///
+/// # Thread Safety
+///
+/// Not thread safe.
+class GpuTimingHistory {
+  public:
+    /// Frame times kept for the graph.
+    static constexpr uint32_t FRAME_COUNT = 240;
+    /// Frames each zone is averaged over.
+    static constexpr uint32_t AVERAGE_FRAMES = 60;
+
+    struct Zone {
+        std::string name;
+        /// Over the last `AVERAGE_FRAMES` frames, or as many as there were.
+        double average;
+        double latest;
+        double max;
+
+      private:
+        friend class GpuTimingHistory;
+
+        std::array<double, AVERAGE_FRAMES> samples_;
+        double sum_;
+        uint32_t count_;
+    };
+
+    /// @brief Adds a frame. Zones sharing a name are added together.
+    void addFrame(double frameMilliseconds, std::span<const GpuZoneTiming> zones);
+
+    /// @return Every frame time kept, starting at `frameOffset()` and
+    /// wrapping around, as ImGui's plots take them. Missing frames are `0`.
+    std::span<const float> frameTimes() const { return frameTimes_; }
+
+    /// @return Where the oldest frame time is in `frameTimes()`.
+    uint32_t frameOffset() const { return static_cast<uint32_t>(frameCount_ % FRAME_COUNT); }
+
+    /// @return The frame time added last, or `0` if there is none.
+    float latestFrameTime() const { return frameTimes_[(frameCount_ + FRAME_COUNT - 1) % FRAME_COUNT]; }
+
+    /// @return The longest frame time kept.
+    float maxFrameTime() const;
+
+    const std::vector<Zone>& zones() const { return zones_; }
+
+  private:
+    std::array<float, FRAME_COUNT> frameTimes_{};
+    uint64_t frameCount_ = 0;
+    std::vector<Zone> zones_;
+};
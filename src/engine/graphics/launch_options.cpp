@@ -0,0 +1,111 @@
+#include "launch_options.h"
+#include <charconv>
+#include <print>
+#include <string_view>
+
+namespace {
+bool parseNumber(std::string_view text, uint32_t& out) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), out);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+bool parseResolution(std::string_view text, uint32_t& width, uint32_t& height) {
+    const size_t x = text.find('x');
+    return x != std::string_view::npos && parseNumber(text.substr(0, x), width) &&
+           parseNumber(text.substr(x + 1), height) && width != 0 && height != 0;
+}
+} // namespace
+
+std::optional<LaunchOptions> parseLaunchOptions(std::span<const char* const> args) {
+    LaunchOptions options;
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string_view arg = args[i];
+        if (arg == "--headless") {
+            options.headless = true;
+            continue;
+        }
+
+        // every other option takes a value
+        if (i + 1 == args.size()) {
+            std::println("Unknown option or missing value: {}\n{}", arg, LAUNCH_USAGE);
+            return std::nullopt;
+        }
+        const std::string_view value = args[++i];
+
+        bool valid = true;
+        if (arg == "--resolution") {
+            valid = parseResolution(value, options.width, options.height);
+        } else if (arg == "--frames") {
+            valid = parseNumber(value, options.frames) && options.frames != 0;
+        } else if (arg == "--capture") {
+            options.capturePath = value;
+        } else if (arg == "--compare") {
+            options.comparePath = value;
+        } else if (arg == "--tolerance") {
+            valid = parseNumber(value, options.tolerance);
+        } else if (arg == "--benchmark") {
+            options.benchmarkPath = value;
+        } else {
+            std::println("Unknown option: {}\n{}", arg, LAUNCH_USAGE);
+            return std::nullopt;
+        }
+
+        if (!valid) {
+            std::println("Invalid value for {}: {}\n{}", arg, value, LAUNCH_USAGE);
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+#include <vector>
+
+TEST_SUITE("LaunchOptions") {
+    TEST_CASE("no arguments is a window") {
+        const std::optional<LaunchOptions> options = parseLaunchOptions({});
+        REQUIRE(options.has_value());
+        CHECK_FALSE(options->headless);
+        CHECK(options->capturePath.empty());
+        CHECK(options->benchmarkPath.empty());
+    }
+
+    TEST_CASE("benchmarks work with or without a window") {
+        const std::vector<const char*> args = {"--benchmark", "frames.json", "--frames", "600"};
+        const std::optional<LaunchOptions> options = parseLaunchOptions(args);
+        REQUIRE(options.has_value());
+        CHECK_FALSE(options->headless);
+        CHECK(options->benchmarkPath == "frames.json");
+        CHECK(options->frames == 600);
+    }
+
+    TEST_CASE("headless options are read") {
+        const std::vector<const char*> args = {"--headless", "--resolution", "640x360", "--frames",
+                                               "30",         "--capture",    "out.ppm", "--tolerance",
+                                               "0"};
+        const std::optional<LaunchOptions> options = parseLaunchOptions(args);
+        REQUIRE(options.has_value());
+        CHECK(options->headless);
+        CHECK(options->width == 640);
+        CHECK(options->height == 360);
+        CHECK(options->frames == 30);
+        CHECK(options->capturePath == "out.ppm");
+        CHECK(options->comparePath.empty());
+        CHECK(options->tolerance == 0);
+    }
+
+    TEST_CASE("bad command lines are rejected") {
+        const std::vector<std::vector<const char*>> bad = {
+            {"--resolution", "640"},  {"--resolution", "0x360"}, {"--resolution", "640x360x2"},
+            {"--frames", "0"},        {"--frames", "-3"},        {"--frames"},
+            {"--fullscreen", "true"}, {"--tolerance", "1.5"},
+        };
+        for (const std::vector<const char*>& args : bad) {
+            CHECK_FALSE(parseLaunchOptions(args).has_value());
+        }
+    }
+}
+
+#endif
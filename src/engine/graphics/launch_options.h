@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+/// @brief How the client is started, from its command line.
+struct LaunchOptions {
+    /// Draw into the draw image alone, without a window, surface or
+    /// swapchain, for build machines and devices that cannot present.
+    bool headless = false;
+    /// Of the window, or of the draw image when headless.
+    uint32_t width = 1700;
+    uint32_t height = 900;
+    /// How many frames to draw before exiting when headless or
+    /// benchmarking.
+    uint32_t frames = 100;
+    /// Where to write the last headless frame as a PPM image, if anywhere.
+    std::string capturePath;
+    /// A PPM image the last headless frame must match, if any.
+    std::string comparePath;
+    /// How far any channel of the last frame may be from `comparePath`, out
+    /// of 255.
+    uint32_t tolerance = 2;
+    /// Where to write the frame times of a benchmark as JSON, if benchmarking.
+    /// The camera then flies the benchmark path instead of taking input, and
+    /// frames are not limited.
+    std::string benchmarkPath;
+};
+
+/// Describes the options `parseLaunchOptions()` takes.
+inline constexpr const char* LAUNCH_USAGE = "options:\n"
+                                            "  --headless            draw without a window\n"
+                                            "  --resolution WxH      window or headless size\n"
+                                            "  --frames N            frames to draw when headless or benchmarking\n"
+                                            "  --capture FILE.ppm    write the last headless frame\n"
+                                            "  --compare FILE.ppm    fail unless the last headless frame matches\n"
+                                            "  --tolerance N         per channel difference --compare allows\n"
+                                            "  --benchmark FILE.json fly a scripted path and write frame times";
+
+/// @param args The command line without the program name.
+/// @return The options, or empty with the problem printed if the command
+/// line is not understood.
+std::optional<LaunchOptions> parseLaunchOptions(std::span<const char* const> args);
@@ -0,0 +1,109 @@
+#include "lod_selector.h"
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+void LodSelector::select(const glm::dvec3& camera, mesh::LodCell root, std::vector<mesh::LodCell>& leaves) {
+    if (root.level == 0) {
+        leaves.push_back(root);
+        return;
+    }
+
+    const world::ChunkPos first = root.firstChunk();
+    const glm::dvec3 min = glm::dvec3(first.x, first.y, first.z) * double(world::CHUNK_SIZE);
+    const glm::dvec3 max = min + glm::dvec3(double(world::CHUNK_SIZE * root.scale()));
+    const double distance = glm::length(glm::clamp(camera, min, max) - camera);
+
+    const bool wasSplit = split_.contains(root);
+    const double threshold = splitDistance(root.level) * (wasSplit ? HYSTERESIS : 1.0);
+    if (distance >= threshold) {
+        if (wasSplit) {
+            merge(root);
+        }
+        leaves.push_back(root);
+        return;
+    }
+
+    split_.insert(root);
+    for (uint32_t i = 0; i < 8; i++) {
+        select(camera, root.child(i), leaves);
+    }
+}
+
+void LodSelector::merge(mesh::LodCell cell) {
+    if (split_.erase(cell) == 0 || cell.level == 1) {
+        return;
+    }
+    for (uint32_t i = 0; i < 8; i++) {
+        merge(cell.child(i));
+    }
+}
+
+#ifndef NO_TESTS
+
+#include <algorithm>
+#include <doctest.h>
+
+namespace {
+uint32_t countLevel(const std::vector<mesh::LodCell>& leaves, uint32_t level) {
+    return static_cast<uint32_t>(
+        std::count_if(leaves.begin(), leaves.end(), [&](const mesh::LodCell& cell) { return cell.level == level; }));
+}
+} // namespace
+
+TEST_SUITE("LodSelector") {
+    TEST_CASE("cells split near the camera") {
+        LodSelector selector(100.0);
+        const mesh::LodCell root{world::ChunkPos{0, 0, 0}, 3};
+        std::vector<mesh::LodCell> leaves;
+
+        // far outside the 256 block root
+        selector.select(glm::dvec3(2000.0, 0.0, 0.0), root, leaves);
+        REQUIRE(leaves.size() == 1);
+        CHECK(leaves[0] == root);
+
+        // in a corner of the root, everything nearby is full resolution
+        leaves.clear();
+        selector.select(glm::dvec3(1.0), root, leaves);
+        CHECK(countLevel(leaves, 0) > 0);
+        CHECK(countLevel(leaves, 3) == 0);
+        // the cell across from the camera stays coarse
+        CHECK(std::find(leaves.begin(), leaves.end(), mesh::LodCell{world::ChunkPos{1, 1, 1}, 2}) != leaves.end());
+
+        // the leaves cover the root once each, as chunk volumes add up
+        uint64_t chunks = 0;
+        for (const mesh::LodCell& cell : leaves) {
+            chunks += static_cast<uint64_t>(cell.scale()) * cell.scale() * cell.scale();
+        }
+        CHECK(chunks == 8 * 8 * 8);
+    }
+
+    TEST_CASE("merging waits for the hysteresis") {
+        LodSelector selector(100.0);
+        const mesh::LodCell root{world::ChunkPos{0, 0, 0}, 1};
+        std::vector<mesh::LodCell> leaves;
+
+        // the root is 64 blocks, so a camera at x = 64 + d is d away
+        selector.select(glm::dvec3(64.0 + 110.0, 0.0, 0.0), root, leaves);
+        CHECK(leaves.size() == 1);
+
+        leaves.clear();
+        selector.select(glm::dvec3(64.0 + 90.0, 0.0, 0.0), root, leaves);
+        CHECK(leaves.size() == 8);
+
+        // back past the split distance, but not the hysteresis
+        leaves.clear();
+        selector.select(glm::dvec3(64.0 + 110.0, 0.0, 0.0), root, leaves);
+        CHECK(leaves.size() == 8);
+
+        leaves.clear();
+        selector.select(glm::dvec3(64.0 + 130.0, 0.0, 0.0), root, leaves);
+        CHECK(leaves.size() == 1);
+
+        // and merged cells need the plain split distance again
+        leaves.clear();
+        selector.select(glm::dvec3(64.0 + 110.0, 0.0, 0.0), root, leaves);
+        CHECK(leaves.size() == 1);
+    }
+}
+
+#endif
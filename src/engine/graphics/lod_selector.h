@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../mesh/chunk_lod.h"
+#include <glm/vec3.hpp>
+#include <unordered_set>
+#include <vector>
+
+/// @brief Picks the level of detail to draw the world at, as an octree of
+/// `mesh::LodCell`s split wherever the camera is close.
+///
+/// A cell splits into its 8 finer cells once the camera is within
+/// `splitDistance()` of it, and only merges back once the camera is
+/// `HYSTERESIS` times as far, so moving back and forth across the line does
+/// not keep swapping meshes.
+///
+/// # Thread Safety
+///
+/// Not thread safe.
+class LodSelector {
+  public:
+    /// How much further the camera must move away before split cells merge.
+    static constexpr double HYSTERESIS = 1.25;
+
+    /// @param detailDistance Blocks from the camera within which chunks are
+    /// drawn at full resolution.
+    explicit LodSelector(double detailDistance) : detailDistance_(detailDistance) {}
+
+    double detailDistance() const { return detailDistance_; }
+
+    void setDetailDistance(double detailDistance) { detailDistance_ = detailDistance; }
+
+    /// @return Blocks from the camera within which a cell of `level` splits,
+    /// which doubles with each level.
+    double splitDistance(uint32_t level) const { return detailDistance_ * static_cast<double>(1u << (level - 1)); }
+
+    /// @brief Finds the cells to draw within `root`, which together cover
+    /// it once each.
+    /// @param camera Position in blocks.
+    /// @param leaves The cells are added to the end.
+    void select(const glm::dvec3& camera, mesh::LodCell root, std::vector<mesh::LodCell>& leaves);
+
+  private:
+    /// @brief Forgets that `cell` and every cell within it was split.
+    void merge(mesh::LodCell cell);
+
+    double detailDistance_;
+    std::unordered_set<mesh::LodCell, mesh::LodCellHash> split_;
+};
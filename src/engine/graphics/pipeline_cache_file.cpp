@@ -0,0 +1,154 @@
+#include "pipeline_cache_file.h"
+#include <cstring>
+
+namespace {
+constexpr uint32_t MAGIC = 0x43505856; // "VXPC"
+constexpr uint32_t FORMAT_VERSION = 1;
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t formatVersion;
+    PipelineCacheKey key;
+    uint64_t dataSize;
+    uint64_t checksum;
+};
+
+/// Matches `VkPipelineCacheHeaderVersionOne`, which starts the data of every
+/// Vulkan pipeline cache.
+struct DriverHeader {
+    uint32_t headerSize;
+    uint32_t headerVersion;
+    uint32_t vendorId;
+    uint32_t deviceId;
+    std::array<uint8_t, 16> cacheUuid;
+};
+
+constexpr uint32_t DRIVER_HEADER_VERSION_ONE = 1;
+
+/// FNV-1a, enough to catch truncated or partly written files.
+uint64_t checksum(std::span<const uint8_t> data) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (const uint8_t byte : data) {
+        hash = (hash ^ byte) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+bool sameKey(const PipelineCacheKey& a, const PipelineCacheKey& b) {
+    return a.vendorId == b.vendorId && a.deviceId == b.deviceId && a.driverVersion == b.driverVersion &&
+           a.cacheUuid == b.cacheUuid;
+}
+} // namespace
+
+std::vector<uint8_t> encodePipelineCache(const PipelineCacheKey& key, std::span<const uint8_t> data) {
+    FileHeader header{};
+    header.magic = MAGIC;
+    header.formatVersion = FORMAT_VERSION;
+    header.key = key;
+    header.dataSize = data.size();
+    header.checksum = checksum(data);
+
+    std::vector<uint8_t> file(sizeof(FileHeader) + data.size());
+    std::memcpy(file.data(), &header, sizeof(FileHeader));
+    if (!data.empty()) {
+        std::memcpy(file.data() + sizeof(FileHeader), data.data(), data.size());
+    }
+    return file;
+}
+
+std::optional<std::span<const uint8_t>> decodePipelineCache(const PipelineCacheKey& key,
+                                                            std::span<const uint8_t> file) {
+    if (file.size() < sizeof(FileHeader)) {
+        return std::nullopt;
+    }
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(FileHeader));
+    if (header.magic != MAGIC || header.formatVersion != FORMAT_VERSION || !sameKey(header.key, key) ||
+        header.dataSize != file.size() - sizeof(FileHeader)) {
+        return std::nullopt;
+    }
+
+    const std::span<const uint8_t> data = file.subspan(sizeof(FileHeader));
+    if (header.checksum != checksum(data) || data.size() < sizeof(DriverHeader)) {
+        return std::nullopt;
+    }
+
+    DriverHeader driverHeader;
+    std::memcpy(&driverHeader, data.data(), sizeof(DriverHeader));
+    if (driverHeader.headerVersion != DRIVER_HEADER_VERSION_ONE || driverHeader.vendorId != key.vendorId ||
+        driverHeader.deviceId != key.deviceId || driverHeader.cacheUuid != key.cacheUuid) {
+        return std::nullopt;
+    }
+    return data;
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+namespace {
+PipelineCacheKey testKey() {
+    PipelineCacheKey key{};
+    key.vendorId = 0x10DE;
+    key.deviceId = 0x2684;
+    key.driverVersion = 12345;
+    for (uint8_t i = 0; i < 16; i++) {
+        key.cacheUuid[i] = i;
+    }
+    return key;
+}
+
+std::vector<uint8_t> testData(const PipelineCacheKey& key) {
+    DriverHeader driverHeader{sizeof(DriverHeader), DRIVER_HEADER_VERSION_ONE, key.vendorId, key.deviceId,
+                              key.cacheUuid};
+    std::vector<uint8_t> data(sizeof(DriverHeader) + 100, 7);
+    std::memcpy(data.data(), &driverHeader, sizeof(DriverHeader));
+    return data;
+}
+} // namespace
+
+TEST_SUITE("PipelineCacheFile") {
+    TEST_CASE("round trip") {
+        const PipelineCacheKey key = testKey();
+        const std::vector<uint8_t> data = testData(key);
+        const std::vector<uint8_t> file = encodePipelineCache(key, data);
+
+        const auto decoded = decodePipelineCache(key, file);
+        REQUIRE(decoded.has_value());
+        CHECK(std::vector<uint8_t>(decoded->begin(), decoded->end()) == data);
+    }
+
+    TEST_CASE("rejects another driver") {
+        const PipelineCacheKey key = testKey();
+        const std::vector<uint8_t> file = encodePipelineCache(key, testData(key));
+
+        PipelineCacheKey newDriver = key;
+        newDriver.driverVersion += 1;
+        CHECK_FALSE(decodePipelineCache(newDriver, file).has_value());
+
+        PipelineCacheKey otherDevice = key;
+        otherDevice.cacheUuid[3] = 99;
+        CHECK_FALSE(decodePipelineCache(otherDevice, file).has_value());
+    }
+
+    TEST_CASE("rejects damaged files") {
+        const PipelineCacheKey key = testKey();
+        std::vector<uint8_t> file = encodePipelineCache(key, testData(key));
+
+        CHECK_FALSE(decodePipelineCache(key, std::span(file).first(file.size() - 1)).has_value());
+        CHECK_FALSE(decodePipelineCache(key, std::span(file).first(10)).has_value());
+
+        file.back() ^= 1;
+        CHECK_FALSE(decodePipelineCache(key, file).has_value());
+    }
+
+    TEST_CASE("rejects data the driver did not write for this device") {
+        const PipelineCacheKey key = testKey();
+        std::vector<uint8_t> data = testData(key);
+        // the driver header's device id
+        data[12] ^= 1;
+        CHECK_FALSE(decodePipelineCache(key, encodePipelineCache(key, data)).has_value());
+    }
+}
+
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+/// @brief What a pipeline cache saved to disk was built for. Driver caches
+/// are only valid on the same device with the same driver.
+struct PipelineCacheKey {
+    uint32_t vendorId;
+    uint32_t deviceId;
+    uint32_t driverVersion;
+    /// `VkPhysicalDeviceProperties::pipelineCacheUUID`.
+    std::array<uint8_t, 16> cacheUuid;
+};
+
+/// @brief Wraps the data of a pipeline cache in a header recording its key,
+/// size and checksum, to be written to disk.
+std::vector<uint8_t> encodePipelineCache(const PipelineCacheKey& key, std::span<const uint8_t> data);
+
+/// @return The pipeline cache data in `file`, or empty if the file is not a
+/// complete pipeline cache for `key`. Both the header and the driver's own
+/// header inside the data have to match.
+std::optional<std::span<const uint8_t>> decodePipelineCache(const PipelineCacheKey& key,
+                                                            std::span<const uint8_t> file);
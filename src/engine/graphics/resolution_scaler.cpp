@@ -0,0 +1,141 @@
+#include "resolution_scaler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+/// Fractions of the target frame time. Above `OVER_BUDGET` the scale is
+/// lowered, below `UNDER_BUDGET` it is raised, and either way it aims for
+/// `AIM` so that it settles between the two.
+constexpr double OVER_BUDGET = 0.9;
+constexpr double UNDER_BUDGET = 0.7;
+constexpr double AIM = 0.8;
+/// How much of each new GPU time goes into the smoothed one.
+constexpr double SMOOTHING = 0.15;
+/// Largest change in one step, so a single slow frame cannot halve the resolution.
+constexpr float MAX_STEP = 0.1f;
+/// Smaller changes are not worth the image visibly shifting.
+constexpr float MIN_STEP = 0.02f;
+/// More than the frames that can be in flight, whose times predate a change.
+constexpr uint32_t SETTLE_FRAMES = 6;
+} // namespace
+
+void ResolutionScaler::setTarget(double framesPerSecond) { target_ = std::max(framesPerSecond, 1.0); }
+
+void ResolutionScaler::setRange(float minScale, float maxScale) {
+    maxScale_ = std::clamp(maxScale, MIN_SCALE, 1.f);
+    minScale_ = std::clamp(minScale, MIN_SCALE, maxScale_);
+    scale_ = std::clamp(scale_, minScale_, maxScale_);
+}
+
+void ResolutionScaler::setFixedScale(std::optional<float> scale) {
+    if (scale.has_value()) {
+        scale = std::clamp(*scale, MIN_SCALE, 1.f);
+    }
+    fixedScale_ = scale;
+}
+
+float ResolutionScaler::addFrame(double gpuMilliseconds) {
+    if (!(gpuMilliseconds > 0)) {
+        return scale();
+    }
+    smoothedFrameTime_ = smoothedFrameTime_ == 0
+                             ? gpuMilliseconds
+                             : smoothedFrameTime_ + (gpuMilliseconds - smoothedFrameTime_) * SMOOTHING;
+
+    if (settling_ > 0) {
+        settling_--;
+        return scale();
+    }
+    if (fixedScale_.has_value()) {
+        return scale();
+    }
+
+    const double frameTime = 1000.0 / target_;
+    if (smoothedFrameTime_ <= frameTime * OVER_BUDGET && smoothedFrameTime_ >= frameTime * UNDER_BUDGET) {
+        return scale_;
+    }
+
+    // GPU time grows with the pixel count, which is the square of the scale
+    const double ideal = scale_ * std::sqrt(frameTime * AIM / smoothedFrameTime_);
+    const float next =
+        std::clamp(std::clamp(static_cast<float>(ideal), scale_ - MAX_STEP, scale_ + MAX_STEP), minScale_, maxScale_);
+    // the range's ends are always reachable, however close
+    if (next == scale_ || (std::abs(next - scale_) < MIN_STEP && next != minScale_ && next != maxScale_)) {
+        return scale_;
+    }
+
+    // until the new scale shows in the GPU times, assume they change as it would predict
+    smoothedFrameTime_ *= (next / scale_) * (next / scale_);
+    scale_ = next;
+    settling_ = SETTLE_FRAMES;
+    return scale_;
+}
+
+uint32_t ResolutionScaler::scaledSize(uint32_t size) const {
+    return std::max(static_cast<uint32_t>(std::lround(size * static_cast<double>(scale()))), 1u);
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+namespace {
+/// Runs `frames` frames of a GPU that takes `fullScaleMs` at a scale of 1.
+float run_frames(ResolutionScaler& scaler, double fullScaleMs, int frames) {
+    for (int i = 0; i < frames; i++) {
+        const double scale = scaler.scale();
+        scaler.addFrame(fullScaleMs * scale * scale);
+    }
+    return scaler.scale();
+}
+} // namespace
+
+TEST_SUITE("ResolutionScaler") {
+    TEST_CASE("an over budget GPU is scaled down to fit, then back up once it has time") {
+        ResolutionScaler scaler;
+        scaler.setTarget(60);
+        scaler.setRange(0.5f, 1.f);
+
+        CHECK(run_frames(scaler, 10.0, 200) == 1.f);
+
+        // 25 ms at full scale takes 80% of 16.7 ms at about 0.73
+        const float lowered = run_frames(scaler, 25.0, 400);
+        CHECK(lowered < 0.8f);
+        CHECK(lowered > 0.65f);
+        const double frameTime = 25.0 * lowered * lowered;
+        CHECK(frameTime < 1000.0 / 60 * 0.9);
+        CHECK(frameTime > 1000.0 / 60 * 0.7);
+
+        CHECK(run_frames(scaler, 10.0, 400) == 1.f);
+    }
+
+    TEST_CASE("the scale stays within its range and moves in limited steps") {
+        ResolutionScaler scaler;
+        scaler.setTarget(60);
+        scaler.setRange(0.6f, 0.9f);
+        CHECK(scaler.scale() == 0.9f);
+
+        float previous = scaler.scale();
+        for (int i = 0; i < 300; i++) {
+            const float scale = scaler.addFrame(200.0);
+            CHECK(previous - scale <= 0.1f + 1e-6f);
+            previous = scale;
+        }
+        CHECK(scaler.scale() == 0.6f);
+    }
+
+    TEST_CASE("a fixed scale overrides the GPU time") {
+        ResolutionScaler scaler;
+        scaler.setFixedScale(0.1f);
+        CHECK(scaler.scale() == ResolutionScaler::MIN_SCALE);
+        scaler.setFixedScale(0.5f);
+        CHECK(run_frames(scaler, 1.0, 100) == 0.5f);
+        CHECK(scaler.scaledSize(1920) == 960);
+
+        scaler.setFixedScale(std::nullopt);
+        CHECK(scaler.scale() == 1.f);
+        CHECK(scaler.scaledSize(0) == 1);
+    }
+}
+
+#endif
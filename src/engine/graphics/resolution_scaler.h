@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+/// @brief Picks how much of the screen's resolution to draw at, lowering it
+/// while the GPU takes longer than a frame should and raising it again once
+/// there is time to spare.
+///
+/// The scale applies to both axes, so GPU time is taken to grow with its
+/// square. Changes are limited in size and followed by a few frames without
+/// one, as the GPU times of the frames still in flight do not show them yet.
+/// It lowers the scale as soon as frames are over budget, but raises it only
+/// once they are well under, so it does not flip between two scales.
+///
+/// # Thread Safety
+///
+/// Not thread safe.
+class ResolutionScaler {
+  public:
+    /// Lowest scale that can be asked for, below which the image is too
+    /// blurry to be worth the time saved.
+    static constexpr float MIN_SCALE = 0.25f;
+
+    /// @param framesPerSecond The frame rate the GPU should keep up with.
+    void setTarget(double framesPerSecond);
+
+    double target() const { return target_; }
+
+    /// @brief Limits how far the scale can go, each clamped to
+    /// `[MIN_SCALE, 1]`.
+    void setRange(float minScale, float maxScale);
+
+    float minScale() const { return minScale_; }
+
+    float maxScale() const { return maxScale_; }
+
+    /// @param scale Drawn at instead of adapting to GPU time, or empty to
+    /// adapt again.
+    void setFixedScale(std::optional<float> scale);
+
+    std::optional<float> fixedScale() const { return fixedScale_; }
+
+    /// @brief Adapts the scale to the time the GPU took for a frame.
+    /// @param gpuMilliseconds Ignored unless positive.
+    /// @return The scale to draw the next frame at.
+    float addFrame(double gpuMilliseconds);
+
+    /// @return The scale to draw at, in `[minScale(), maxScale()]` unless
+    /// fixed.
+    float scale() const { return fixedScale_.value_or(scale_); }
+
+    /// @return The GPU frame time the scale adapts to, smoothed over recent
+    /// frames.
+    double smoothedFrameTime() const { return smoothedFrameTime_; }
+
+    /// @return `size` scaled by `scale()`, at least one pixel.
+    uint32_t scaledSize(uint32_t size) const;
+
+  private:
+    double target_ = 60;
+    float minScale_ = 0.5f;
+    float maxScale_ = 1.f;
+    std::optional<float> fixedScale_;
+    float scale_ = 1.f;
+    /// Zero until the first frame.
+    double smoothedFrameTime_ = 0;
+    /// Frames left before the last change shows in the GPU times.
+    uint32_t settling_ = 0;
+};
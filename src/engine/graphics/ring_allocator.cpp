@@ -0,0 +1,106 @@
+#include "ring_allocator.h"
+#include <cassert>
+
+RingAllocator::RingAllocator(uint64_t capacity, uint64_t alignment) : capacity_(capacity), alignment_(alignment) {
+    assert((alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+}
+
+std::optional<uint64_t> RingAllocator::allocate(uint64_t size) {
+    if (size > capacity_) {
+        return std::nullopt;
+    }
+    if (used() == 0 && head_ % capacity_ != 0) {
+        // nothing is live, so start the next lap at the front rather than
+        // count the skipped end of the buffer against the free space. Moving
+        // forward keeps positions taken from `head()` earlier valid
+        head_ += capacity_ - head_ % capacity_;
+        tail_ = head_;
+    }
+
+    uint64_t start = (head_ + alignment_ - 1) & ~(alignment_ - 1);
+    const uint64_t offset = start % capacity_;
+    if (offset + size > capacity_) {
+        // skip what is left at the end rather than splitting the range
+        start += capacity_ - offset;
+    }
+    const uint64_t end = start + size;
+    if (end - tail_ > capacity_) {
+        return std::nullopt;
+    }
+
+    head_ = end;
+    return start % capacity_;
+}
+
+void RingAllocator::releaseUpTo(uint64_t position) {
+    assert(position <= head_);
+    if (position > tail_) {
+        tail_ = position;
+    }
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+TEST_SUITE("RingAllocator") {
+    TEST_CASE("allocates in order") {
+        RingAllocator ring(256, 16);
+        CHECK(ring.allocate(10) == 0);
+        CHECK(ring.allocate(16) == 16);
+        CHECK(ring.allocate(1) == 32);
+        CHECK(ring.used() == 33);
+    }
+
+    TEST_CASE("full until released") {
+        RingAllocator ring(256, 16);
+        CHECK(ring.allocate(200).has_value());
+        const uint64_t first = ring.head();
+        CHECK(ring.allocate(48) == 208);
+        CHECK_FALSE(ring.allocate(16).has_value());
+
+        ring.releaseUpTo(first);
+        // including the padding before the second range
+        CHECK(ring.used() == 56);
+        CHECK(ring.allocate(100) == 0);
+    }
+
+    TEST_CASE("ranges never wrap") {
+        RingAllocator ring(256, 16);
+        CHECK(ring.allocate(160).has_value());
+        const uint64_t first = ring.head();
+        CHECK(ring.allocate(16) == 160);
+        ring.releaseUpTo(first);
+
+        // 80 bytes are left at the end, which is not enough, so they are skipped
+        CHECK(ring.allocate(128) == 0);
+        CHECK(ring.used() == 16 + 80 + 128);
+        CHECK_FALSE(ring.allocate(64).has_value());
+        CHECK(ring.allocate(32) == 128);
+    }
+
+    TEST_CASE("an empty ring fits anything up to its capacity") {
+        RingAllocator ring(256, 16);
+        CHECK(ring.allocate(160).has_value());
+        ring.releaseUpTo(ring.head());
+
+        // more than the 96 bytes left at the end
+        const uint64_t before = ring.head();
+        CHECK(ring.allocate(200) == 0);
+        // positions from before still release nothing
+        ring.releaseUpTo(before);
+        CHECK(ring.used() == 200);
+        ring.releaseUpTo(ring.head());
+        CHECK(ring.used() == 0);
+        CHECK(ring.allocate(256) == 0);
+    }
+
+    TEST_CASE("too big") {
+        RingAllocator ring(256, 16);
+        CHECK_FALSE(ring.allocate(257).has_value());
+        CHECK(ring.allocate(256) == 0);
+        CHECK_FALSE(ring.allocate(1).has_value());
+    }
+}
+
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+/// @brief Hands out ranges of a fixed size ring buffer in order, and frees
+/// them in the same order.
+///
+/// Positions only ever grow, so a range is freed by releasing everything up
+/// to a position taken from `head()` after it was allocated. The offset of a
+/// position in the buffer is the position modulo the capacity. A range never
+/// wraps around the end of the buffer: if it would, the bytes left at the end
+/// are skipped. Once everything is released the next range starts at offset 0.
+///
+/// # Thread Safety
+///
+/// Not thread safe.
+class RingAllocator {
+  public:
+    /// @param alignment Every offset handed out is a multiple of this. Must
+    /// be a power of two.
+    explicit RingAllocator(uint64_t capacity, uint64_t alignment = 16);
+
+    /// @return The offset of `size` free bytes, or empty if there is not
+    /// enough space until more is released. Sizes bigger than the whole
+    /// buffer never fit.
+    std::optional<uint64_t> allocate(uint64_t size);
+
+    /// @return The position just past the last allocation.
+    uint64_t head() const { return head_; }
+
+    /// @brief Frees everything allocated before `position`, which must come
+    /// from `head()`.
+    void releaseUpTo(uint64_t position);
+
+    uint64_t capacity() const { return capacity_; }
+
+    /// @return Bytes allocated and not yet released, including any skipped
+    /// at the end of the buffer.
+    uint64_t used() const { return head_ - tail_; }
+
+  private:
+    uint64_t capacity_;
+    uint64_t alignment_;
+    uint64_t head_ = 0;
+    uint64_t tail_ = 0;
+};
@@ -0,0 +1,46 @@
+#include "shader_bundle.h"
+#include <algorithm>
+
+std::optional<std::span<const uint32_t>> ShaderBundle::find(std::string_view name) const {
+    const auto found = std::lower_bound(entries_.begin(), entries_.end(), name,
+                                        [](const ShaderBundleEntry& entry, std::string_view name) {
+                                            return entry.name < name;
+                                        });
+    if (found == entries_.end() || found->name != name) {
+        return std::nullopt;
+    }
+    return words_.subspan(found->offset, found->size);
+}
+
+#ifndef NO_TESTS
+
+#include <array>
+#include <doctest.h>
+
+TEST_SUITE("ShaderBundle") {
+    TEST_CASE("shaders are found by name") {
+        constexpr std::array<uint32_t, 6> words = {0x07230203, 1, 2, 0x07230203, 3, 4};
+        constexpr std::array<ShaderBundleEntry, 3> entries = {
+            ShaderBundleEntry{"a.comp", 0, 3},
+            ShaderBundleEntry{"b.frag", 3, 2},
+            ShaderBundleEntry{"b.vert", 5, 1},
+        };
+        const ShaderBundle bundle(words, entries);
+
+        const auto a = bundle.find("a.comp");
+        REQUIRE(a.has_value());
+        CHECK(a->data() == words.data());
+        CHECK(a->size() == 3);
+
+        const auto vert = bundle.find("b.vert");
+        REQUIRE(vert.has_value());
+        CHECK(vert->size() == 1);
+        CHECK(vert->front() == 4);
+
+        CHECK_FALSE(bundle.find("b").has_value());
+        CHECK_FALSE(bundle.find("c.comp").has_value());
+        CHECK_FALSE(bundle.find("").has_value());
+    }
+}
+
+#endif
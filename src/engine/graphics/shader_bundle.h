@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+/// @brief Where the SPIR-V of one shader sits in a `ShaderBundle`.
+struct ShaderBundleEntry {
+    /// File name of the GLSL source, such as "chunk.vert".
+    std::string_view name;
+    /// In words from the start of the bundle.
+    uint32_t offset;
+    /// In words.
+    uint32_t size;
+};
+
+/// @brief The SPIR-V of every shader packed into one block of words, with an
+/// index sorted by name, so loading a shader is a lookup rather than a file
+/// read.
+///
+/// # Thread Safety
+///
+/// Never changes, so any thread may read it.
+class ShaderBundle {
+  public:
+    /// @param entries Sorted by name.
+    constexpr ShaderBundle(std::span<const uint32_t> words, std::span<const ShaderBundleEntry> entries)
+        : words_(words), entries_(entries) {}
+
+    /// @return The SPIR-V of the shader built from `name`, or empty if the
+    /// bundle does not have it.
+    std::optional<std::span<const uint32_t>> find(std::string_view name) const;
+
+    std::span<const ShaderBundleEntry> entries() const { return entries_; }
+
+  private:
+    std::span<const uint32_t> words_;
+    std::span<const ShaderBundleEntry> entries_;
+};
+
+/// @return Every shader in `assets/shaders`, embedded in the executable by
+/// the build. Defined in the source `cmake/embed_shaders.cmake` generates.
+const ShaderBundle& embeddedShaders();
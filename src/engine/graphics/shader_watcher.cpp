@@ -0,0 +1,140 @@
+#include "shader_watcher.h"
+#include <algorithm>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <print>
+
+namespace {
+bool isSource(const std::filesystem::path& path) {
+    const std::filesystem::path extension = path.extension();
+    return extension == ".vert" || extension == ".frag" || extension == ".comp";
+}
+
+bool isInclude(const std::filesystem::path& path) { return path.extension() == ".glsl"; }
+} // namespace
+
+ShaderWatcher::ShaderWatcher(std::filesystem::path sourceDir, std::string compiler)
+    : sourceDir_(std::move(sourceDir)), compiler_(std::move(compiler)) {
+    // everything starts out as it was built
+    poll();
+}
+
+std::vector<std::string> ShaderWatcher::poll() {
+    std::vector<std::string> changed;
+    std::vector<std::string> sources;
+    bool includeChanged = false;
+
+    // sources are only ever edited, so errors mean a file is halfway through being saved and is seen next poll
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator(sourceDir_, error)) {
+        const std::filesystem::path& path = file.path();
+        if (!isSource(path) && !isInclude(path)) {
+            continue;
+        }
+        const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+        if (error) {
+            continue;
+        }
+
+        std::string name = path.filename().string();
+        const auto [found, inserted] = writeTimes_.try_emplace(name, writeTime);
+        const bool modified = inserted || found->second != writeTime;
+        found->second = writeTime;
+
+        if (isInclude(path)) {
+            includeChanged |= modified;
+        } else {
+            if (modified) {
+                changed.push_back(name);
+            }
+            sources.push_back(std::move(name));
+        }
+    }
+
+    if (includeChanged) {
+        changed = std::move(sources);
+    }
+    std::sort(changed.begin(), changed.end());
+    return changed;
+}
+
+std::optional<std::vector<uint32_t>> ShaderWatcher::compile(std::string_view name) const {
+    const std::filesystem::path source = sourceDir_ / name;
+    std::filesystem::path output = source;
+    output += ".spv";
+
+    std::string command = std::format("\"{}\" -V \"{}\" -o \"{}\"", compiler_, source.string(), output.string());
+#ifdef _WIN32
+    // cmd.exe drops the outer quotes of a command that starts with one
+    command = "\"" + command + "\"";
+#endif
+    // the compiler prints its own errors
+    if (std::system(command.c_str()) != 0) {
+        std::println("Failed to compile shader {}", name);
+        return std::nullopt;
+    }
+
+    std::ifstream in(output, std::ios::binary);
+    const std::vector<char> bytes{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    if (bytes.empty() || bytes.size() % sizeof(uint32_t) != 0) {
+        std::println("Failed to read compiled shader {}", output.string());
+        return std::nullopt;
+    }
+    std::vector<uint32_t> code(bytes.size() / sizeof(uint32_t));
+    std::copy(bytes.begin(), bytes.end(), reinterpret_cast<char*>(code.data()));
+    return code;
+}
+
+#ifndef NO_TESTS
+
+#include <chrono>
+#include <doctest.h>
+
+namespace {
+void writeFile(const std::filesystem::path& path, std::string_view text) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << text;
+}
+
+/// @brief Moves the write time of `path` forward, as file times may be too
+/// coarse to see two writes in a row.
+void touch(const std::filesystem::path& path) {
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(2));
+}
+} // namespace
+
+TEST_SUITE("ShaderWatcher") {
+    TEST_CASE("changed sources are found") {
+        const std::filesystem::path dir = std::filesystem::temp_directory_path() / "voxel_shader_watcher_test";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        writeFile(dir / "a.vert", "");
+        writeFile(dir / "a.frag", "");
+        writeFile(dir / "b.comp", "");
+        writeFile(dir / "common.glsl", "");
+        writeFile(dir / "a.vert.spv", "");
+
+        ShaderWatcher watcher(dir, "glslangValidator");
+        CHECK(watcher.poll().empty());
+
+        touch(dir / "a.frag");
+        // compiled output is not a source
+        touch(dir / "a.vert.spv");
+        CHECK(watcher.poll() == std::vector<std::string>{"a.frag"});
+        CHECK(watcher.poll().empty());
+
+        writeFile(dir / "c.comp", "");
+        CHECK(watcher.poll() == std::vector<std::string>{"c.comp"});
+
+        // anything may include a shared file
+        touch(dir / "common.glsl");
+        CHECK(watcher.poll() == std::vector<std::string>{"a.frag", "a.vert", "b.comp", "c.comp"});
+        CHECK(watcher.poll().empty());
+
+        std::filesystem::remove_all(dir);
+    }
+}
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Watches the GLSL sources in a directory and recompiles the ones
+/// that change, so shaders can be reloaded while the game runs.
+///
+/// Sources are `.vert`, `.frag` and `.comp` files. A change to any `.glsl`
+/// file counts as a change to every source, as any of them may include it.
+///
+/// # Thread Safety
+///
+/// `poll()` is not thread safe. `compile()` only runs the compiler, so any
+/// number of threads may call it, as long as none compile the same shader.
+class ShaderWatcher {
+  public:
+    /// @param compiler Path of `glslangValidator`.
+    ShaderWatcher(std::filesystem::path sourceDir, std::string compiler);
+
+    /// @return File names of the sources that changed since the last poll,
+    /// or since the watcher was created, sorted.
+    std::vector<std::string> poll();
+
+    /// @brief Compiles the source `name` to a `.spv` file next to it, as the
+    /// build does.
+    /// @return The SPIR-V, or empty if the source did not compile, with the
+    /// compiler's errors printed.
+    std::optional<std::vector<uint32_t>> compile(std::string_view name) const;
+
+  private:
+    std::filesystem::path sourceDir_;
+    std::string compiler_;
+    /// Of every source and include, by file name.
+    std::unordered_map<std::string, std::filesystem::file_time_type> writeTimes_;
+};
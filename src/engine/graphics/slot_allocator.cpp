@@ -0,0 +1,83 @@
+#include "slot_allocator.h"
+
+std::optional<SlotHandle> SlotAllocator::allocate() {
+    uint32_t index;
+    if (!free_.empty()) {
+        index = free_.back();
+        free_.pop_back();
+    } else if (generations_.size() < capacity_) {
+        index = static_cast<uint32_t>(generations_.size());
+        generations_.push_back(0);
+    } else {
+        return std::nullopt;
+    }
+    return SlotHandle{index, ++generations_[index]};
+}
+
+bool SlotAllocator::free(SlotHandle handle) {
+    if (!valid(handle)) {
+        return false;
+    }
+    generations_[handle.index]++;
+    free_.push_back(handle.index);
+    return true;
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+TEST_SUITE("SlotAllocator") {
+    TEST_CASE("freed slots are reused last freed first") {
+        SlotAllocator slots(8);
+        const SlotHandle a = *slots.allocate();
+        const SlotHandle b = *slots.allocate();
+        const SlotHandle c = *slots.allocate();
+        CHECK(a.index == 0);
+        CHECK(b.index == 1);
+        CHECK(c.index == 2);
+        CHECK(slots.highWater() == 3);
+
+        CHECK(slots.free(a));
+        CHECK(slots.free(c));
+        CHECK(slots.used() == 1);
+        CHECK(slots.allocate()->index == 2);
+        CHECK(slots.allocate()->index == 0);
+        CHECK(slots.allocate()->index == 3);
+        CHECK(slots.highWater() == 4);
+    }
+
+    TEST_CASE("stale handles are caught") {
+        SlotAllocator slots(8);
+        const SlotHandle first = *slots.allocate();
+        CHECK(slots.valid(first));
+        CHECK(slots.free(first));
+        CHECK_FALSE(slots.valid(first));
+        // a second free would hand the slot out twice
+        CHECK_FALSE(slots.free(first));
+
+        const SlotHandle second = *slots.allocate();
+        CHECK(second.index == first.index);
+        CHECK(second.generation != first.generation);
+        CHECK(slots.valid(second));
+        CHECK_FALSE(slots.valid(first));
+        // nor may the old handle free the new owner's slot
+        CHECK_FALSE(slots.free(first));
+        CHECK(slots.valid(second));
+
+        CHECK_FALSE(slots.valid(SlotHandle{}));
+        CHECK_FALSE(slots.valid(SlotHandle{5, 1}));
+    }
+
+    TEST_CASE("capacity is a hard limit") {
+        SlotAllocator slots(2);
+        const SlotHandle a = *slots.allocate();
+        CHECK(slots.allocate().has_value());
+        CHECK_FALSE(slots.allocate().has_value());
+        slots.free(a);
+        CHECK(slots.allocate().has_value());
+        CHECK(slots.highWater() == 2);
+    }
+}
+
+#endif
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/// @brief An index handed out by `SlotAllocator`, with the generation it was
+/// handed out in, so a handle kept after its slot was freed and reused can
+/// be told apart from the one the slot has now.
+struct SlotHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator==(const SlotHandle& other) const = default;
+};
+
+/// @brief Hands out the indices below a fixed capacity, reusing the last one
+/// freed first so the used range stays dense.
+///
+/// Each index counts its generations: odd while handed out, even while
+/// free. Freeing a handle twice, or freeing or checking one whose slot was
+/// freed and handed out again, is caught instead of silently hitting
+/// whatever uses the slot now.
+///
+/// # Thread Safety
+///
+/// Not thread safe.
+class SlotAllocator {
+  public:
+    explicit SlotAllocator(uint32_t capacity) : capacity_(capacity) {}
+
+    /// @return A free slot, or empty if all `capacity()` are in use.
+    std::optional<SlotHandle> allocate();
+
+    /// @return False, freeing nothing, if `handle` is not currently valid.
+    bool free(SlotHandle handle);
+
+    /// @return True if `handle` was handed out and not freed since.
+    bool valid(SlotHandle handle) const {
+        return handle.index < generations_.size() && generations_[handle.index] == handle.generation &&
+               (handle.generation & 1) != 0;
+    }
+
+    /// @return One past the highest index ever handed out.
+    uint32_t highWater() const { return static_cast<uint32_t>(generations_.size()); }
+
+    uint32_t capacity() const { return capacity_; }
+
+    /// @return How many slots are handed out.
+    uint32_t used() const { return highWater() - static_cast<uint32_t>(free_.size()); }
+
+  private:
+    uint32_t capacity_;
+    std::vector<uint32_t> generations_;
+    /// Freed indices below `highWater()`, the last freed at the back.
+    std::vector<uint32_t> free_;
+};
@@ -0,0 +1,292 @@
+#include "tlsf_allocator.h"
+#include <bit>
+#include <cassert>
+
+TlsfAllocator::TlsfAllocator(uint32_t size, uint32_t alignment)
+    : capacity_(size), alignmentShift_(static_cast<uint32_t>(std::countr_zero(alignment))) {
+    assert(std::has_single_bit(alignment) && "alignment must be a power of two");
+    for (auto& heads : freeHeads_) {
+        heads.fill(NONE);
+    }
+
+    const uint32_t units = size >> alignmentShift_;
+    if (units == 0) {
+        return;
+    }
+    const uint32_t block = newBlock();
+    blocks_[block] = Block{0, units, NONE, NONE, NONE, NONE, true};
+    insertFree(block);
+}
+
+std::optional<TlsfAllocator::Allocation> TlsfAllocator::allocate(uint32_t size) {
+    const uint64_t rounded = (static_cast<uint64_t>(size) + (1u << alignmentShift_) - 1) >> alignmentShift_;
+    if (rounded == 0 || rounded > (capacity_ >> alignmentShift_)) {
+        return std::nullopt;
+    }
+    const uint32_t units = static_cast<uint32_t>(rounded);
+
+    const uint32_t block = findFree(units);
+    if (block == NONE) {
+        return std::nullopt;
+    }
+    removeFree(block);
+
+    if (blocks_[block].size > units) {
+        // give the rest back as a free block right after this one
+        const uint32_t rest = newBlock();
+        Block& b = blocks_[block];
+        blocks_[rest] = Block{b.offset + units, b.size - units, block, b.nextPhysical, NONE, NONE, true};
+        if (b.nextPhysical != NONE) {
+            blocks_[b.nextPhysical].prevPhysical = rest;
+        }
+        b.nextPhysical = rest;
+        b.size = units;
+        insertFree(rest);
+    }
+
+    Block& b = blocks_[block];
+    b.free = false;
+    allocationCount_ += 1;
+    usedUnits_ += units;
+    return Allocation{b.offset << alignmentShift_, units << alignmentShift_, block};
+}
+
+void TlsfAllocator::free(const Allocation& allocation) {
+    uint32_t block = allocation.node;
+    assert(block < blocks_.size() && !blocks_[block].free && "freeing something that is not allocated");
+
+    allocationCount_ -= 1;
+    usedUnits_ -= blocks_[block].size;
+    blocks_[block].free = true;
+
+    const uint32_t prev = blocks_[block].prevPhysical;
+    if (prev != NONE && blocks_[prev].free) {
+        removeFree(prev);
+        blocks_[prev].size += blocks_[block].size;
+        blocks_[prev].nextPhysical = blocks_[block].nextPhysical;
+        if (blocks_[block].nextPhysical != NONE) {
+            blocks_[blocks_[block].nextPhysical].prevPhysical = prev;
+        }
+        unusedBlocks_.push_back(block);
+        block = prev;
+    }
+
+    const uint32_t next = blocks_[block].nextPhysical;
+    if (next != NONE && blocks_[next].free) {
+        removeFree(next);
+        blocks_[block].size += blocks_[next].size;
+        blocks_[block].nextPhysical = blocks_[next].nextPhysical;
+        if (blocks_[next].nextPhysical != NONE) {
+            blocks_[blocks_[next].nextPhysical].prevPhysical = block;
+        }
+        unusedBlocks_.push_back(next);
+    }
+
+    insertFree(block);
+}
+
+TlsfAllocator::Stats TlsfAllocator::stats() const {
+    Stats stats{};
+    stats.allocationCount = allocationCount_;
+    stats.usedBytes = static_cast<uint64_t>(usedUnits_) << alignmentShift_;
+    stats.freeBytes = capacity_ - stats.usedBytes;
+
+    for (uint32_t fl = 0; fl < FL_COUNT; fl++) {
+        for (uint32_t sl = 0; sl < SL_COUNT; sl++) {
+            for (uint32_t block = freeHeads_[fl][sl]; block != NONE; block = blocks_[block].nextFree) {
+                stats.freeBlockCount += 1;
+                const uint64_t size = static_cast<uint64_t>(blocks_[block].size) << alignmentShift_;
+                if (size > stats.largestFreeBlock) {
+                    stats.largestFreeBlock = size;
+                }
+            }
+        }
+    }
+    return stats;
+}
+
+void TlsfAllocator::mapping(uint32_t size, uint32_t& fl, uint32_t& sl) {
+    if (size < SL_COUNT) {
+        // small sizes get a bin each
+        fl = 0;
+        sl = size;
+        return;
+    }
+    const uint32_t log2 = static_cast<uint32_t>(std::bit_width(size)) - 1;
+    fl = log2 - SL_BITS + 1;
+    sl = (size >> (log2 - SL_BITS)) ^ SL_COUNT;
+}
+
+uint32_t TlsfAllocator::newBlock() {
+    if (!unusedBlocks_.empty()) {
+        const uint32_t block = unusedBlocks_.back();
+        unusedBlocks_.pop_back();
+        return block;
+    }
+    blocks_.emplace_back();
+    return static_cast<uint32_t>(blocks_.size() - 1);
+}
+
+void TlsfAllocator::insertFree(uint32_t block) {
+    uint32_t fl;
+    uint32_t sl;
+    mapping(blocks_[block].size, fl, sl);
+
+    const uint32_t head = freeHeads_[fl][sl];
+    blocks_[block].prevFree = NONE;
+    blocks_[block].nextFree = head;
+    if (head != NONE) {
+        blocks_[head].prevFree = block;
+    }
+    freeHeads_[fl][sl] = block;
+    flBitmap_ |= 1u << fl;
+    slBitmaps_[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::removeFree(uint32_t block) {
+    const Block& b = blocks_[block];
+    if (b.prevFree != NONE) {
+        blocks_[b.prevFree].nextFree = b.nextFree;
+    }
+    if (b.nextFree != NONE) {
+        blocks_[b.nextFree].prevFree = b.prevFree;
+    }
+
+    uint32_t fl;
+    uint32_t sl;
+    mapping(b.size, fl, sl);
+    if (freeHeads_[fl][sl] == block) {
+        freeHeads_[fl][sl] = b.nextFree;
+        if (b.nextFree == NONE) {
+            slBitmaps_[fl] &= ~(1u << sl);
+            if (slBitmaps_[fl] == 0) {
+                flBitmap_ &= ~(1u << fl);
+            }
+        }
+    }
+}
+
+uint32_t TlsfAllocator::findFree(uint32_t size) const {
+    // round up to the next bin boundary, so any block in the bin found is big enough
+    uint32_t search = size;
+    if (size >= SL_COUNT) {
+        const uint32_t log2 = static_cast<uint32_t>(std::bit_width(size)) - 1;
+        const uint64_t rounded = static_cast<uint64_t>(size) + (1u << (log2 - SL_BITS)) - 1;
+        if (rounded > UINT32_MAX) {
+            return NONE;
+        }
+        search = static_cast<uint32_t>(rounded);
+    }
+
+    uint32_t fl;
+    uint32_t sl;
+    mapping(search, fl, sl);
+    if (fl >= FL_COUNT) {
+        return NONE;
+    }
+
+    uint32_t slMap = slBitmaps_[fl] & (~0u << sl);
+    if (slMap == 0) {
+        const uint32_t flMap = fl + 1 < 32 ? flBitmap_ & (~0u << (fl + 1)) : 0;
+        if (flMap == 0) {
+            return NONE;
+        }
+        fl = static_cast<uint32_t>(std::countr_zero(flMap));
+        slMap = slBitmaps_[fl];
+    }
+    sl = static_cast<uint32_t>(std::countr_zero(slMap));
+    return freeHeads_[fl][sl];
+}
+
+#ifndef NO_TESTS
+
+#include <algorithm>
+#include <doctest.h>
+#include <random>
+
+TEST_SUITE("TlsfAllocator") {
+    TEST_CASE("allocate and free") {
+        TlsfAllocator tlsf(1024, 16);
+        const auto a = tlsf.allocate(100);
+        const auto b = tlsf.allocate(16);
+        REQUIRE(a.has_value());
+        REQUIRE(b.has_value());
+        CHECK(a->offset == 0);
+        CHECK(a->size == 112);
+        CHECK(b->offset == 112);
+        CHECK(tlsf.allocationCount() == 2);
+
+        tlsf.free(*a);
+        tlsf.free(*b);
+        const TlsfAllocator::Stats stats = tlsf.stats();
+        CHECK(stats.allocationCount == 0);
+        CHECK(stats.freeBlockCount == 1);
+        CHECK(stats.largestFreeBlock == 1024);
+    }
+
+    TEST_CASE("full") {
+        TlsfAllocator tlsf(1024, 16);
+        CHECK_FALSE(tlsf.allocate(1025).has_value());
+        const auto all = tlsf.allocate(1024);
+        REQUIRE(all.has_value());
+        CHECK_FALSE(tlsf.allocate(1).has_value());
+        tlsf.free(*all);
+        CHECK(tlsf.allocate(1024).has_value());
+    }
+
+    TEST_CASE("reuses freed holes") {
+        TlsfAllocator tlsf(4096, 16);
+        const auto a = tlsf.allocate(1024);
+        const auto b = tlsf.allocate(1024);
+        const auto c = tlsf.allocate(1024);
+        REQUIRE(a.has_value());
+        REQUIRE(b.has_value());
+        REQUIRE(c.has_value());
+        tlsf.free(*b);
+        const auto d = tlsf.allocate(512);
+        REQUIRE(d.has_value());
+        CHECK(d->offset == 1024);
+    }
+
+    TEST_CASE("random allocations never overlap and merge back") {
+        constexpr uint32_t SIZE = 1u << 20;
+        TlsfAllocator tlsf(SIZE, 16);
+        std::mt19937 rng(7);
+        std::vector<TlsfAllocator::Allocation> live;
+
+        for (int i = 0; i < 20000; i++) {
+            if (live.empty() || rng() % 3 != 0) {
+                const auto allocation = tlsf.allocate(1 + rng() % 8192);
+                if (allocation.has_value()) {
+                    live.push_back(*allocation);
+                }
+            } else {
+                const size_t index = rng() % live.size();
+                tlsf.free(live[index]);
+                live[index] = live.back();
+                live.pop_back();
+            }
+        }
+
+        std::sort(live.begin(), live.end(), [](const auto& a, const auto& b) { return a.offset < b.offset; });
+        uint64_t used = 0;
+        for (size_t i = 0; i < live.size(); i++) {
+            CHECK(live[i].offset % 16 == 0);
+            CHECK(live[i].offset + live[i].size <= SIZE);
+            if (i + 1 < live.size()) {
+                CHECK(live[i].offset + live[i].size <= live[i + 1].offset);
+            }
+            used += live[i].size;
+        }
+        CHECK(tlsf.stats().usedBytes == used);
+
+        for (const auto& allocation : live) {
+            tlsf.free(allocation);
+        }
+        const TlsfAllocator::Stats stats = tlsf.stats();
+        CHECK(stats.freeBlockCount == 1);
+        CHECK(stats.largestFreeBlock == SIZE);
+    }
+}
+
+#endif
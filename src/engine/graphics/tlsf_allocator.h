@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/// @brief Sub-allocates ranges of some larger resource, such as a GPU
+/// buffer, with a two level segregated fit (TLSF) allocator.
+///
+/// Free ranges are kept in lists binned by size: the first level by power of
+/// two, the second splitting each power of two into `SL_COUNT` steps. A
+/// bitmap per level finds a big enough bin in constant time, so allocating
+/// and freeing never search. Freed ranges merge with free neighbours right
+/// away.
+///
+/// Only offsets are handed out, the allocator never touches the memory.
+///
+/// # Thread Safety
+///
+/// Not thread safe.
+class TlsfAllocator {
+  public:
+    struct Allocation {
+        uint32_t offset;
+        uint32_t size;
+        /// Identifies the allocation to `free()`.
+        uint32_t node;
+    };
+
+    struct Stats {
+        uint32_t allocationCount;
+        uint32_t freeBlockCount;
+        uint64_t usedBytes;
+        uint64_t freeBytes;
+        uint64_t largestFreeBlock;
+    };
+
+    /// @param size Bytes to hand out, from offset 0.
+    /// @param alignment Every offset and size is rounded up to a multiple of
+    /// this. Must be a power of two.
+    explicit TlsfAllocator(uint32_t size, uint32_t alignment = 16);
+
+    /// @return The new range, or empty if no free range is big enough.
+    std::optional<Allocation> allocate(uint32_t size);
+
+    void free(const Allocation& allocation);
+
+    uint32_t capacity() const { return capacity_; }
+
+    uint32_t allocationCount() const { return allocationCount_; }
+
+    Stats stats() const;
+
+  private:
+    static constexpr uint32_t SL_BITS = 4;
+    static constexpr uint32_t SL_COUNT = 1u << SL_BITS;
+    static constexpr uint32_t FL_COUNT = 32 - SL_BITS + 1;
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Block {
+        /// In units of `alignment_`, as are all sizes below.
+        uint32_t offset;
+        uint32_t size;
+        uint32_t prevPhysical;
+        uint32_t nextPhysical;
+        uint32_t prevFree;
+        uint32_t nextFree;
+        bool free;
+    };
+
+    /// @brief The bin a free block of `size` units belongs in.
+    static void mapping(uint32_t size, uint32_t& fl, uint32_t& sl);
+
+    uint32_t newBlock();
+
+    void insertFree(uint32_t block);
+
+    void removeFree(uint32_t block);
+
+    /// @return A free block of at least `size` units, or `NONE`.
+    uint32_t findFree(uint32_t size) const;
+
+    uint32_t capacity_;
+    uint32_t alignmentShift_;
+    uint32_t allocationCount_ = 0;
+    uint32_t usedUnits_ = 0;
+
+    std::vector<Block> blocks_;
+    /// Indices into `blocks_` that are not part of the range.
+    std::vector<uint32_t> unusedBlocks_;
+
+    uint32_t flBitmap_ = 0;
+    std::array<uint32_t, FL_COUNT> slBitmaps_{};
+    std::array<std::array<uint32_t, SL_COUNT>, FL_COUNT> freeHeads_;
+};
@@ -0,0 +1,272 @@
+#include "visibility_graph.h"
+#include <cmath>
+
+namespace {
+constexpr std::array<world::ChunkPos, mesh::FACE_COUNT> FACE_OFFSETS = {
+    world::ChunkPos{1, 0, 0}, world::ChunkPos{-1, 0, 0}, world::ChunkPos{0, 1, 0},
+    world::ChunkPos{0, -1, 0}, world::ChunkPos{0, 0, 1}, world::ChunkPos{0, 0, -1},
+};
+
+/// @return The face on the other side of `face`, as `Face` pairs are stored
+/// positive then negative.
+constexpr uint32_t opposite(uint32_t face) { return face ^ 1; }
+} // namespace
+
+void VisibilityGraph::setChunk(world::ChunkPos pos, mesh::ChunkVisibility visibility) {
+    if (const auto found = indices_.find(pos); found != indices_.end()) {
+        nodes_[found->second].visibility = visibility;
+        return;
+    }
+
+    const auto index = static_cast<uint32_t>(nodes_.size());
+    Node node{pos, visibility, NO_SLOT, {}};
+    for (uint32_t face = 0; face < mesh::FACE_COUNT; face++) {
+        const world::ChunkPos offset = FACE_OFFSETS[face];
+        const auto neighbour = indices_.find(pos.offset(offset.x, offset.y, offset.z));
+        if (neighbour == indices_.end()) {
+            node.neighbours[face] = NO_NODE;
+            continue;
+        }
+        node.neighbours[face] = neighbour->second;
+        nodes_[neighbour->second].neighbours[opposite(face)] = index;
+    }
+    nodes_.push_back(node);
+    indices_.emplace(pos, index);
+}
+
+void VisibilityGraph::setSlot(world::ChunkPos pos, uint32_t slot) {
+    if (const auto found = indices_.find(pos); found != indices_.end()) {
+        nodes_[found->second].slot = slot;
+    }
+}
+
+void VisibilityGraph::removeChunk(world::ChunkPos pos) {
+    const auto found = indices_.find(pos);
+    if (found == indices_.end()) {
+        return;
+    }
+    const uint32_t index = found->second;
+    indices_.erase(found);
+
+    for (uint32_t face = 0; face < mesh::FACE_COUNT; face++) {
+        if (const uint32_t neighbour = nodes_[index].neighbours[face]; neighbour != NO_NODE) {
+            nodes_[neighbour].neighbours[opposite(face)] = NO_NODE;
+        }
+    }
+
+    // the last node takes the removed one's place, so its neighbours are relinked
+    const auto last = static_cast<uint32_t>(nodes_.size() - 1);
+    if (index != last) {
+        nodes_[index] = nodes_[last];
+        for (uint32_t face = 0; face < mesh::FACE_COUNT; face++) {
+            if (const uint32_t neighbour = nodes_[index].neighbours[face]; neighbour != NO_NODE) {
+                nodes_[neighbour].neighbours[opposite(face)] = index;
+            }
+        }
+        indices_[nodes_[index].pos] = index;
+    }
+    nodes_.pop_back();
+}
+
+void VisibilityGraph::findVisible(const glm::dvec3& camera, const Frustum& frustum, std::vector<uint32_t>& slots) {
+    slots.clear();
+    stats_ = Stats{chunkCount(), 0, 0};
+
+    // camera relative, so the boxes stay precise far from the origin
+    boxes_.clear();
+    for (const Node& node : nodes_) {
+        const glm::dvec3 min = glm::dvec3(node.pos.x, node.pos.y, node.pos.z) * double(world::CHUNK_SIZE) - camera;
+        boxes_.push(glm::vec3(min), glm::vec3(min + glm::dvec3(world::CHUNK_SIZE)));
+    }
+    inFrustum_.resize(nodes_.size());
+    frustum.cullAabbs(boxes_, inFrustum_.data());
+    for (const uint8_t inside : inFrustum_) {
+        stats_.inFrustum += inside;
+    }
+
+    const world::ChunkPos cameraChunk{
+        static_cast<int32_t>(std::floor(camera.x / world::CHUNK_SIZE)),
+        static_cast<int32_t>(std::floor(camera.y / world::CHUNK_SIZE)),
+        static_cast<int32_t>(std::floor(camera.z / world::CHUNK_SIZE)),
+    };
+    const auto start = indices_.find(cameraChunk);
+    if (start == indices_.end()) {
+        // outside the loaded world there is nowhere to search from
+        for (uint32_t i = 0; i < nodes_.size(); i++) {
+            if (inFrustum_[i] != 0 && nodes_[i].slot != NO_SLOT) {
+                slots.push_back(nodes_[i].slot);
+            }
+        }
+        stats_.reached = stats_.inFrustum;
+        return;
+    }
+
+    reached_.assign(nodes_.size(), 0);
+    queue_.clear();
+    queue_.push_back(Step{start->second, mesh::Face::PosX, 0});
+    reached_[start->second] = 1;
+
+    for (size_t head = 0; head < queue_.size(); head++) {
+        const Step step = queue_[head];
+        const Node& node = nodes_[step.node];
+        if (node.slot != NO_SLOT) {
+            slots.push_back(node.slot);
+        }
+
+        for (uint32_t face = 0; face < mesh::FACE_COUNT; face++) {
+            // stepping back along an axis already crossed can only reach
+            // chunks hidden behind ones already visited
+            if ((step.directions >> opposite(face) & 1) != 0) {
+                continue;
+            }
+            const uint32_t neighbour = node.neighbours[face];
+            if (neighbour == NO_NODE || reached_[neighbour] != 0 || inFrustum_[neighbour] == 0) {
+                continue;
+            }
+            // the camera's own chunk is seen from inside, so any face will do
+            if (step.directions != 0 && !node.visibility.connects(step.entry, static_cast<mesh::Face>(face))) {
+                continue;
+            }
+            reached_[neighbour] = 1;
+            queue_.push_back(Step{neighbour, static_cast<mesh::Face>(opposite(face)), step.directions | 1u << face});
+        }
+    }
+    stats_.reached = static_cast<uint32_t>(queue_.size());
+}
+
+#ifndef NO_TESTS
+
+#include <algorithm>
+#include <doctest.h>
+
+namespace {
+/// @return A frustum every box is inside.
+Frustum everything() {
+    Frustum frustum;
+    frustum.planes.fill(glm::vec4(0.f, 0.f, 0.f, 1.f));
+    return frustum;
+}
+
+std::vector<uint32_t> sorted(std::vector<uint32_t> slots) {
+    std::sort(slots.begin(), slots.end());
+    return slots;
+}
+} // namespace
+
+TEST_SUITE("VisibilityGraph") {
+    TEST_CASE("open chunks are all reached") {
+        VisibilityGraph graph;
+        uint32_t slot = 0;
+        for (int32_t x = 0; x < 3; x++) {
+            for (int32_t z = 0; z < 3; z++) {
+                graph.setChunk(world::ChunkPos{x, 0, z}, mesh::ChunkVisibility::all());
+                graph.setSlot(world::ChunkPos{x, 0, z}, slot++);
+            }
+        }
+
+        std::vector<uint32_t> slots;
+        graph.findVisible(glm::dvec3(48.0, 16.0, 48.0), everything(), slots);
+        CHECK(sorted(slots) == std::vector<uint32_t>{0, 1, 2, 3, 4, 5, 6, 7, 8});
+        // the camera's chunk comes first
+        CHECK(slots.front() == 4);
+        CHECK(graph.stats().chunks == 9);
+        CHECK(graph.stats().reached == 9);
+    }
+
+    TEST_CASE("sealed chunks block the search") {
+        // a row along x, with the middle chunk solid
+        VisibilityGraph graph;
+        for (int32_t x = 0; x < 3; x++) {
+            graph.setChunk(world::ChunkPos{x, 0, 0}, mesh::ChunkVisibility::all());
+            graph.setSlot(world::ChunkPos{x, 0, 0}, static_cast<uint32_t>(x));
+        }
+        graph.setChunk(world::ChunkPos{1, 0, 0}, mesh::ChunkVisibility());
+
+        std::vector<uint32_t> slots;
+        graph.findVisible(glm::dvec3(16.0), everything(), slots);
+        // the solid chunk itself can be seen, but not through
+        CHECK(sorted(slots) == std::vector<uint32_t>{0, 1});
+
+        // a tunnel from -x to +x lets the search through
+        mesh::ChunkVisibility tunnel;
+        tunnel.connectFaces(1u << static_cast<uint32_t>(mesh::Face::PosX) |
+                            1u << static_cast<uint32_t>(mesh::Face::NegX));
+        graph.setChunk(world::ChunkPos{1, 0, 0}, tunnel);
+        graph.findVisible(glm::dvec3(16.0), everything(), slots);
+        CHECK(sorted(slots) == std::vector<uint32_t>{0, 1, 2});
+
+        // but not round a corner it does not connect
+        graph.setChunk(world::ChunkPos{1, 1, 0}, mesh::ChunkVisibility::all());
+        graph.setSlot(world::ChunkPos{1, 1, 0}, 3);
+        graph.findVisible(glm::dvec3(16.0), everything(), slots);
+        CHECK(sorted(slots) == std::vector<uint32_t>{0, 1, 2});
+    }
+
+    TEST_CASE("the search stays inside the frustum") {
+        VisibilityGraph graph;
+        for (int32_t x = -2; x <= 2; x++) {
+            graph.setChunk(world::ChunkPos{x, 0, 0}, mesh::ChunkVisibility::all());
+            graph.setSlot(world::ChunkPos{x, 0, 0}, static_cast<uint32_t>(x + 2));
+        }
+
+        // only x >= -20 blocks from the camera, which is 16 blocks into its chunk
+        Frustum frustum = everything();
+        frustum.planes[0] = glm::vec4(1.f, 0.f, 0.f, 20.f);
+        std::vector<uint32_t> slots;
+        graph.findVisible(glm::dvec3(16.0), frustum, slots);
+        CHECK(sorted(slots) == std::vector<uint32_t>{1, 2, 3, 4});
+        CHECK(graph.stats().inFrustum == 4);
+    }
+
+    TEST_CASE("chunks without a slot are searched through") {
+        VisibilityGraph graph;
+        for (int32_t y = 0; y < 3; y++) {
+            graph.setChunk(world::ChunkPos{0, y, 0}, mesh::ChunkVisibility::all());
+        }
+        graph.setSlot(world::ChunkPos{0, 2, 0}, 7);
+
+        std::vector<uint32_t> slots;
+        graph.findVisible(glm::dvec3(16.0), everything(), slots);
+        CHECK(slots == std::vector<uint32_t>{7});
+        CHECK(graph.stats().reached == 3);
+
+        graph.setSlot(world::ChunkPos{0, 2, 0}, VisibilityGraph::NO_SLOT);
+        graph.findVisible(glm::dvec3(16.0), everything(), slots);
+        CHECK(slots.empty());
+    }
+
+    TEST_CASE("removing chunks relinks the rest") {
+        VisibilityGraph graph;
+        for (int32_t x = 0; x < 4; x++) {
+            graph.setChunk(world::ChunkPos{x, 0, 0}, mesh::ChunkVisibility::all());
+            graph.setSlot(world::ChunkPos{x, 0, 0}, static_cast<uint32_t>(x));
+        }
+
+        graph.removeChunk(world::ChunkPos{1, 0, 0});
+        CHECK(graph.chunkCount() == 3);
+        std::vector<uint32_t> slots;
+        graph.findVisible(glm::dvec3(16.0), everything(), slots);
+        CHECK(slots == std::vector<uint32_t>{0});
+        graph.findVisible(glm::dvec3(80.0, 16.0, 16.0), everything(), slots);
+        CHECK(sorted(slots) == std::vector<uint32_t>{2, 3});
+
+        graph.setChunk(world::ChunkPos{1, 0, 0}, mesh::ChunkVisibility::all());
+        graph.setSlot(world::ChunkPos{1, 0, 0}, 1);
+        graph.findVisible(glm::dvec3(16.0), everything(), slots);
+        CHECK(sorted(slots) == std::vector<uint32_t>{0, 1, 2, 3});
+    }
+
+    TEST_CASE("a camera outside the loaded chunks sees the frustum") {
+        VisibilityGraph graph;
+        graph.setChunk(world::ChunkPos{0, 0, 0}, mesh::ChunkVisibility());
+        graph.setSlot(world::ChunkPos{0, 0, 0}, 0);
+        graph.setChunk(world::ChunkPos{5, 0, 0}, mesh::ChunkVisibility());
+        graph.setSlot(world::ChunkPos{5, 0, 0}, 1);
+
+        std::vector<uint32_t> slots;
+        graph.findVisible(glm::dvec3(0.0, 100.0, 0.0), everything(), slots);
+        CHECK(sorted(slots) == std::vector<uint32_t>{0, 1});
+    }
+}
+
+#endif
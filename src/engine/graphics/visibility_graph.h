@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../mesh/chunk_mesher.h"
+#include "../world/chunk.h"
+#include "frustum.h"
+#include <array>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Finds the chunks the camera may see, so no others are drawn.
+///
+/// Every loaded chunk is a node, linked to the six chunks beside it. Each
+/// frame the chunk boxes are first tested against the frustum in SIMD batches.
+/// A breadth first search then spreads out from the camera's chunk, only
+/// into chunks inside the frustum, only leaving a chunk through a face its
+/// `mesh::ChunkVisibility` connects to the face it was entered by, and never
+/// turning back towards the camera along an axis. Caves that are sealed off
+/// from the camera are never reached.
+///
+/// # Thread Safety
+///
+/// Not thread safe.
+class VisibilityGraph {
+  public:
+    /// A chunk with nothing to draw.
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    struct Stats {
+        uint32_t chunks;
+        uint32_t inFrustum;
+        /// Chunks reached by the search, drawn or not.
+        uint32_t reached;
+    };
+
+    /// @brief Adds a chunk, or replaces how its faces connect.
+    void setChunk(world::ChunkPos pos, mesh::ChunkVisibility visibility);
+
+    /// @brief Sets what `findVisible()` returns for the chunk, if it has
+    /// been added.
+    void setSlot(world::ChunkPos pos, uint32_t slot);
+
+    void removeChunk(world::ChunkPos pos);
+
+    uint32_t chunkCount() const { return static_cast<uint32_t>(nodes_.size()); }
+
+    /// @brief Finds the chunks that may be visible.
+    /// @param camera Position in blocks.
+    /// @param frustum Relative to `camera`.
+    /// @param slots Replaced with the slot of every visible chunk that has
+    /// one, roughly nearest first. If the camera is not in a loaded chunk,
+    /// every chunk in the frustum is visible.
+    void findVisible(const glm::dvec3& camera, const Frustum& frustum, std::vector<uint32_t>& slots);
+
+    /// @return What the last `findVisible()` found.
+    const Stats& stats() const { return stats_; }
+
+  private:
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+    struct Node {
+        world::ChunkPos pos;
+        mesh::ChunkVisibility visibility;
+        uint32_t slot;
+        /// The chunk beside this one through each `mesh::Face`, or `NO_NODE`.
+        std::array<uint32_t, mesh::FACE_COUNT> neighbours;
+    };
+
+    struct Step {
+        uint32_t node;
+        /// The face of `node` the search came in through.
+        mesh::Face entry;
+        /// The faces stepped out of so far, one bit per `mesh::Face`.
+        uint32_t directions;
+    };
+
+    std::vector<Node> nodes_;
+    std::unordered_map<world::ChunkPos, uint32_t, world::ChunkPosHash> indices_;
+
+    AabbSoA boxes_;
+    std::vector<uint8_t> inFrustum_;
+    std::vector<uint8_t> reached_;
+    std::vector<Step> queue_;
+    Stats stats_{};
+};
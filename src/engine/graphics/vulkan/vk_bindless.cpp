@@ -0,0 +1,85 @@
+#include "vk_bindless.h"
+#include <cstdlib>
+#include <iterator>
+
+void BindlessDescriptors::init(VkDevice device) {
+    device_ = device;
+
+    DescriptorLayoutBuilder builder;
+    builder.addBinding(TEXTURE_BINDING, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_TEXTURES);
+    builder.addBinding(STORAGE_BUFFER_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MAX_STORAGE_BUFFERS);
+
+    const VkDescriptorBindingFlags bindingFlags[] = {
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
+    };
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO};
+    flagsInfo.bindingCount = static_cast<uint32_t>(std::size(bindingFlags));
+    flagsInfo.pBindingFlags = bindingFlags;
+
+    layout_ = builder.build(device_, VK_SHADER_STAGE_ALL, &flagsInfo,
+                            VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT);
+
+    const VkDescriptorPoolSize poolSizes[] = {
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_TEXTURES},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MAX_STORAGE_BUFFERS},
+    };
+    VkDescriptorPoolCreateInfo poolInfo = {.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(std::size(poolSizes));
+    poolInfo.pPoolSizes = poolSizes;
+    VK_CHECK(vkCreateDescriptorPool(device_, &poolInfo, nullptr, &pool_));
+
+    VkDescriptorSetAllocateInfo allocInfo = {.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    allocInfo.descriptorPool = pool_;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout_;
+    VK_CHECK(vkAllocateDescriptorSets(device_, &allocInfo, &set_));
+}
+
+void BindlessDescriptors::destroy() {
+    vkDestroyDescriptorPool(device_, pool_, nullptr);
+    vkDestroyDescriptorSetLayout(device_, layout_, nullptr);
+    pool_ = VK_NULL_HANDLE;
+    layout_ = VK_NULL_HANDLE;
+    set_ = VK_NULL_HANDLE;
+}
+
+uint32_t BindlessDescriptors::addTexture(VkImageView view, VkSampler sampler) {
+    const uint32_t index = takeIndex(freeTextures_, textureCount_, MAX_TEXTURES);
+
+    writer_.clear();
+    writer_.writeImage(TEXTURE_BINDING, view, sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, index);
+    writer_.updateSet(device_, set_);
+    return index;
+}
+
+uint32_t BindlessDescriptors::addStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+    const uint32_t index = takeIndex(freeStorageBuffers_, storageBufferCount_, MAX_STORAGE_BUFFERS);
+
+    writer_.clear();
+    writer_.writeBuffer(STORAGE_BUFFER_BINDING, buffer, range, offset, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, index);
+    writer_.updateSet(device_, set_);
+    return index;
+}
+
+void BindlessDescriptors::bind(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout layout,
+                               uint32_t firstSet) const {
+    vkCmdBindDescriptorSets(cmd, bindPoint, layout, firstSet, 1, &set_, 0, nullptr);
+}
+
+uint32_t BindlessDescriptors::takeIndex(std::vector<uint32_t>& freeIndices, uint32_t& count, uint32_t max) {
+    if (!freeIndices.empty()) {
+        const uint32_t index = freeIndices.back();
+        freeIndices.pop_back();
+        return index;
+    }
+    if (count == max) {
+        std::println("Out of bindless descriptors, the limit is {}", max);
+        abort();
+    }
+    return count++;
+}
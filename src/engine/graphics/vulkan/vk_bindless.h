@@ -0,0 +1,66 @@
+#pragma once
+
+#include "vk_descriptors.h"
+#include "vk_types.h"
+#include <cstdint>
+#include <vector>
+
+/// @brief One global descriptor set holding every texture and storage buffer
+/// shaders index by number, so a frame binds it once and draws never touch
+/// descriptors. Must match `bindless.glsl`.
+///
+/// The set is created with update after bind, so registering a resource
+/// never needs the set bound again, even while frames using it are in
+/// flight. Elements that were never written are left unbound, which is fine
+/// as long as no shader reads them.
+///
+/// # Thread Safety
+///
+/// Not thread safe. An index that is removed must no longer be read by any
+/// frame in flight, so remove through a frame's deletion queue.
+class BindlessDescriptors {
+  public:
+    static constexpr uint32_t TEXTURE_BINDING = 0;
+    static constexpr uint32_t STORAGE_BUFFER_BINDING = 1;
+
+    static constexpr uint32_t MAX_TEXTURES = 1024;
+    static constexpr uint32_t MAX_STORAGE_BUFFERS = 1024;
+
+    void init(VkDevice device);
+
+    void destroy();
+
+    VkDescriptorSetLayout layout() const { return layout_; }
+
+    VkDescriptorSet set() const { return set_; }
+
+    /// @param view Read in `VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL`.
+    /// @return The index of the texture in `bindlessTextures`.
+    uint32_t addTexture(VkImageView view, VkSampler sampler);
+
+    /// @return The index of the buffer in `bindlessBuffers`.
+    uint32_t addStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+    void removeTexture(uint32_t index) { freeTextures_.push_back(index); }
+
+    void removeStorageBuffer(uint32_t index) { freeStorageBuffers_.push_back(index); }
+
+    /// @brief Binds the set as set `firstSet` of `layout`.
+    void bind(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout layout,
+              uint32_t firstSet = 0) const;
+
+  private:
+    /// @return An unused index below `max`, preferring ones that were freed.
+    static uint32_t takeIndex(std::vector<uint32_t>& freeIndices, uint32_t& count, uint32_t max);
+
+    VkDevice device_ = VK_NULL_HANDLE;
+    VkDescriptorPool pool_ = VK_NULL_HANDLE;
+    VkDescriptorSetLayout layout_ = VK_NULL_HANDLE;
+    VkDescriptorSet set_ = VK_NULL_HANDLE;
+    DescriptorWriter writer_;
+
+    std::vector<uint32_t> freeTextures_;
+    uint32_t textureCount_ = 0;
+    std::vector<uint32_t> freeStorageBuffers_;
+    uint32_t storageBufferCount_ = 0;
+};
@@ -0,0 +1,50 @@
+#include "vk_command_pools.h"
+#include "vk_initializers.h"
+
+void SecondaryCommandPools::init(VkDevice device, uint32_t queueFamily, uint32_t threadCount) {
+    // buffers are only ever reset with their pool
+    const VkCommandPoolCreateInfo poolInfo =
+        vkinit::command_pool_create_info(queueFamily, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+
+    threads_.resize(threadCount);
+    for (ThreadPool& thread : threads_) {
+        VK_CHECK(vkCreateCommandPool(device, &poolInfo, nullptr, &thread.pool));
+    }
+}
+
+void SecondaryCommandPools::destroy(VkDevice device) {
+    // frees the buffers too
+    for (ThreadPool& thread : threads_) {
+        vkDestroyCommandPool(device, thread.pool, nullptr);
+    }
+    threads_.clear();
+}
+
+void SecondaryCommandPools::reset(VkDevice device) {
+    for (ThreadPool& thread : threads_) {
+        if (thread.used != 0) {
+            VK_CHECK(vkResetCommandPool(device, thread.pool, 0));
+            thread.used = 0;
+        }
+    }
+}
+
+VkCommandBuffer SecondaryCommandPools::begin(VkDevice device, uint32_t thread) {
+    ThreadPool& pool = threads_[thread];
+    if (pool.used == pool.buffers.size()) {
+        VkCommandBufferAllocateInfo allocInfo = vkinit::command_buffer_allocate_info(pool.pool, 1);
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        VkCommandBuffer buffer;
+        VK_CHECK(vkAllocateCommandBuffers(device, &allocInfo, &buffer));
+        pool.buffers.push_back(buffer);
+    }
+    VkCommandBuffer cmd = pool.buffers[pool.used++];
+
+    // nothing is inherited, each pass begins its own rendering and binds its own state
+    VkCommandBufferInheritanceInfo inheritance{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+    VkCommandBufferBeginInfo beginInfo =
+        vkinit::command_buffer_begin_info(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    beginInfo.pInheritanceInfo = &inheritance;
+    VK_CHECK(vkBeginCommandBuffer(cmd, &beginInfo));
+    return cmd;
+}
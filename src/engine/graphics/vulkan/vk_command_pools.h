@@ -0,0 +1,47 @@
+#pragma once
+
+#include "vk_types.h"
+#include <cstdint>
+#include <vector>
+
+/// @brief Secondary command buffers for one frame in flight, with a command
+/// pool for each thread that records them, since a pool may only be used by
+/// one thread at a time.
+///
+/// Buffers are kept from frame to frame, and the pools reset together once
+/// the frame's fence says the GPU is done with them.
+///
+/// # Thread Safety
+///
+/// `begin()` may be called from every thread at once, as long as each uses
+/// its own thread index. Everything else is not thread safe.
+class SecondaryCommandPools {
+  public:
+    /// @param threadCount How many threads record at most, each with an
+    /// index below it.
+    void init(VkDevice device, uint32_t queueFamily, uint32_t threadCount);
+
+    void destroy(VkDevice device);
+
+    /// @brief Makes every buffer free to record again. The GPU must be done
+    /// with them.
+    void reset(VkDevice device);
+
+    /// @return A secondary command buffer from the pool of `thread`, begun
+    /// for one submit outside any render pass. Passes record whole dynamic
+    /// rendering instances into it.
+    VkCommandBuffer begin(VkDevice device, uint32_t thread);
+
+    uint32_t threadCount() const { return static_cast<uint32_t>(threads_.size()); }
+
+  private:
+    // one cache line each, as every thread bumps its own `used`
+    struct alignas(64) ThreadPool {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> buffers;
+        /// Buffers handed out since the last reset.
+        uint32_t used = 0;
+    };
+
+    std::vector<ThreadPool> threads_;
+};
@@ -0,0 +1,95 @@
+#include "vk_deletion_queue.h"
+
+// handles are told apart by type, which 32 bit builds do not give non-dispatchable handles
+static_assert(sizeof(VkBuffer) == sizeof(uint64_t) && sizeof(void*) == sizeof(uint64_t));
+
+namespace {
+template <typename T> T handle_as(const DeletionQueue::Deletion& deletion) {
+    return reinterpret_cast<T>(deletion.handle);
+}
+
+void destroy(VkDevice device, VmaAllocator allocator, const DeletionQueue::Deletion& deletion) {
+    switch (deletion.type) {
+    case VK_OBJECT_TYPE_BUFFER:
+        if (deletion.allocation != VK_NULL_HANDLE) {
+            vmaDestroyBuffer(allocator, handle_as<VkBuffer>(deletion), deletion.allocation);
+        } else {
+            vkDestroyBuffer(device, handle_as<VkBuffer>(deletion), nullptr);
+        }
+        break;
+    case VK_OBJECT_TYPE_IMAGE:
+        if (deletion.allocation != VK_NULL_HANDLE) {
+            vmaDestroyImage(allocator, handle_as<VkImage>(deletion), deletion.allocation);
+        } else {
+            vkDestroyImage(device, handle_as<VkImage>(deletion), nullptr);
+        }
+        break;
+    case VK_OBJECT_TYPE_IMAGE_VIEW:
+        vkDestroyImageView(device, handle_as<VkImageView>(deletion), nullptr);
+        break;
+    case VK_OBJECT_TYPE_SAMPLER:
+        vkDestroySampler(device, handle_as<VkSampler>(deletion), nullptr);
+        break;
+    case VK_OBJECT_TYPE_PIPELINE:
+        vkDestroyPipeline(device, handle_as<VkPipeline>(deletion), nullptr);
+        break;
+    case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+        vkDestroyPipelineLayout(device, handle_as<VkPipelineLayout>(deletion), nullptr);
+        break;
+    case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+        vkDestroyDescriptorSetLayout(device, handle_as<VkDescriptorSetLayout>(deletion), nullptr);
+        break;
+    case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+        vkDestroyDescriptorPool(device, handle_as<VkDescriptorPool>(deletion), nullptr);
+        break;
+    case VK_OBJECT_TYPE_COMMAND_POOL:
+        vkDestroyCommandPool(device, handle_as<VkCommandPool>(deletion), nullptr);
+        break;
+    case VK_OBJECT_TYPE_FENCE:
+        vkDestroyFence(device, handle_as<VkFence>(deletion), nullptr);
+        break;
+    case VK_OBJECT_TYPE_SEMAPHORE:
+        vkDestroySemaphore(device, handle_as<VkSemaphore>(deletion), nullptr);
+        break;
+    case VK_OBJECT_TYPE_DEVICE_MEMORY:
+        vmaFreeMemory(allocator, deletion.allocation);
+        break;
+    default:
+        std::println("Cannot destroy a {}", string_VkObjectType(deletion.type));
+        abort();
+    }
+}
+} // namespace
+
+void DeletionQueue::flush(VkDevice device, VmaAllocator allocator) {
+    for (auto it = deletions_.rbegin(); it != deletions_.rend(); it++) {
+        destroy(device, allocator, *it);
+    }
+    // keeps the capacity, so the next frame pushes without allocating
+    deletions_.clear();
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+TEST_SUITE("DeletionQueue") {
+    TEST_CASE("handles are recorded with their type and memory") {
+        DeletionQueue queue;
+        const VmaAllocation memory = reinterpret_cast<VmaAllocation>(uintptr_t(3));
+        queue.push(reinterpret_cast<VkImage>(uintptr_t(1)), memory);
+        queue.push(reinterpret_cast<VkImageView>(uintptr_t(2)));
+        queue.pushMemory(memory);
+
+        const std::vector<DeletionQueue::Deletion>& deletions = queue.deletions();
+        REQUIRE(deletions.size() == 3);
+        CHECK(deletions[0].type == VK_OBJECT_TYPE_IMAGE);
+        CHECK(deletions[0].handle == 1);
+        CHECK(deletions[0].allocation == memory);
+        CHECK(deletions[1].type == VK_OBJECT_TYPE_IMAGE_VIEW);
+        CHECK(deletions[1].allocation == VK_NULL_HANDLE);
+        CHECK(deletions[2].type == VK_OBJECT_TYPE_DEVICE_MEMORY);
+    }
+}
+
+#endif
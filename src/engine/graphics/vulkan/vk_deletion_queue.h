@@ -0,0 +1,62 @@
+#pragma once
+
+#include "vk_types.h"
+#include <cstdint>
+#include <vector>
+
+/// @brief The object type of each Vulkan handle a `DeletionQueue` takes.
+template <typename T> inline constexpr VkObjectType OBJECT_TYPE = VK_OBJECT_TYPE_UNKNOWN;
+template <> inline constexpr VkObjectType OBJECT_TYPE<VkBuffer> = VK_OBJECT_TYPE_BUFFER;
+template <> inline constexpr VkObjectType OBJECT_TYPE<VkImage> = VK_OBJECT_TYPE_IMAGE;
+template <> inline constexpr VkObjectType OBJECT_TYPE<VkImageView> = VK_OBJECT_TYPE_IMAGE_VIEW;
+template <> inline constexpr VkObjectType OBJECT_TYPE<VkSampler> = VK_OBJECT_TYPE_SAMPLER;
+template <> inline constexpr VkObjectType OBJECT_TYPE<VkPipeline> = VK_OBJECT_TYPE_PIPELINE;
+template <> inline constexpr VkObjectType OBJECT_TYPE<VkPipelineLayout> = VK_OBJECT_TYPE_PIPELINE_LAYOUT;
+template <>
+inline constexpr VkObjectType OBJECT_TYPE<VkDescriptorSetLayout> = VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT;
+template <> inline constexpr VkObjectType OBJECT_TYPE<VkDescriptorPool> = VK_OBJECT_TYPE_DESCRIPTOR_POOL;
+template <> inline constexpr VkObjectType OBJECT_TYPE<VkCommandPool> = VK_OBJECT_TYPE_COMMAND_POOL;
+template <> inline constexpr VkObjectType OBJECT_TYPE<VkFence> = VK_OBJECT_TYPE_FENCE;
+template <> inline constexpr VkObjectType OBJECT_TYPE<VkSemaphore> = VK_OBJECT_TYPE_SEMAPHORE;
+
+/// @brief Vulkan objects to destroy later, such as once the frames in flight
+/// that may use them are done.
+///
+/// Each is kept as a plain record rather than a closure, so pushing never
+/// allocates once the queue has grown to what a frame frees, and nothing can
+/// be captured that is gone by the time it is flushed.
+///
+/// # Thread Safety
+///
+/// Not thread safe.
+class DeletionQueue {
+  public:
+    struct Deletion {
+        VkObjectType type;
+        uint64_t handle;
+        /// The memory the object was created in by VMA, freed with it.
+        VmaAllocation allocation;
+    };
+
+    /// @param allocation For a buffer or image created by VMA, its memory.
+    template <typename T> void push(T handle, VmaAllocation allocation = VK_NULL_HANDLE) {
+        static_assert(OBJECT_TYPE<T> != VK_OBJECT_TYPE_UNKNOWN, "not a handle the queue can destroy");
+        deletions_.push_back(Deletion{OBJECT_TYPE<T>, reinterpret_cast<uint64_t>(handle), allocation});
+    }
+
+    void push(const AllocatedBuffer& buffer) { push(buffer.buffer, buffer.allocation); }
+
+    /// @brief Frees memory allocated by VMA with no object of its own.
+    void pushMemory(VmaAllocation allocation) {
+        deletions_.push_back(Deletion{VK_OBJECT_TYPE_DEVICE_MEMORY, 0, allocation});
+    }
+
+    /// @brief Destroys everything, the last pushed first, as later objects
+    /// may be built on earlier ones.
+    void flush(VkDevice device, VmaAllocator allocator);
+
+    const std::vector<Deletion>& deletions() const { return deletions_; }
+
+  private:
+    std::vector<Deletion> deletions_;
+};
@@ -1,9 +1,10 @@
 #include "vk_descriptors.h"
+#include <algorithm>
 
-void DescriptorLayoutBuilder::addBinding(uint32_t binding, VkDescriptorType type) {
+void DescriptorLayoutBuilder::addBinding(uint32_t binding, VkDescriptorType type, uint32_t count) {
     VkDescriptorSetLayoutBinding newbind{};
     newbind.binding = binding;
-    newbind.descriptorCount = 1;
+    newbind.descriptorCount = count;
     newbind.descriptorType = type;
 
     bindings.push_back(newbind);
@@ -62,3 +63,136 @@ VkDescriptorSet DescriptorAllocator::allocate(VkDevice device, VkDescriptorSetLa
 
     return ds;
 }
+
+void DescriptorAllocatorGrowable::init(VkDevice device, uint32_t initialSets,
+                                       std::span<const PoolSizeRatio> poolRatios) {
+    ratios_.assign(poolRatios.begin(), poolRatios.end());
+
+    readyPools_.push_back(createPool(device, initialSets));
+    setsPerPool_ = std::min(initialSets + initialSets / 2, MAX_SETS_PER_POOL);
+}
+
+void DescriptorAllocatorGrowable::clearPools(VkDevice device) {
+    for (VkDescriptorPool pool : readyPools_) {
+        vkResetDescriptorPool(device, pool, 0);
+    }
+    for (VkDescriptorPool pool : fullPools_) {
+        vkResetDescriptorPool(device, pool, 0);
+        readyPools_.push_back(pool);
+    }
+    fullPools_.clear();
+}
+
+void DescriptorAllocatorGrowable::destroyPools(VkDevice device) {
+    for (VkDescriptorPool pool : readyPools_) {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+    for (VkDescriptorPool pool : fullPools_) {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+    readyPools_.clear();
+    fullPools_.clear();
+}
+
+VkDescriptorSet DescriptorAllocatorGrowable::allocate(VkDevice device, VkDescriptorSetLayout layout, void* pNext) {
+    VkDescriptorPool pool = getPool(device);
+
+    VkDescriptorSetAllocateInfo allocInfo = {.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    allocInfo.pNext = pNext;
+    allocInfo.descriptorPool = pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    VkDescriptorSet ds;
+    VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &ds);
+
+    // a full pool is retired until the next clear, and the set comes from a fresh one instead
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+        fullPools_.push_back(pool);
+
+        pool = getPool(device);
+        allocInfo.descriptorPool = pool;
+        VK_CHECK(vkAllocateDescriptorSets(device, &allocInfo, &ds));
+    } else {
+        VK_CHECK(result);
+    }
+
+    readyPools_.push_back(pool);
+    return ds;
+}
+
+VkDescriptorPool DescriptorAllocatorGrowable::getPool(VkDevice device) {
+    if (!readyPools_.empty()) {
+        VkDescriptorPool pool = readyPools_.back();
+        readyPools_.pop_back();
+        return pool;
+    }
+
+    VkDescriptorPool pool = createPool(device, setsPerPool_);
+    setsPerPool_ = std::min(setsPerPool_ + setsPerPool_ / 2, MAX_SETS_PER_POOL);
+    return pool;
+}
+
+VkDescriptorPool DescriptorAllocatorGrowable::createPool(VkDevice device, uint32_t setCount) {
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    for (PoolSizeRatio ratio : ratios_) {
+        poolSizes.push_back(VkDescriptorPoolSize{
+            .type = ratio.type, .descriptorCount = std::max(static_cast<uint32_t>(ratio.ratio * setCount), 1u)});
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo = {.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    poolInfo.flags = 0;
+    poolInfo.maxSets = setCount;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+
+    VkDescriptorPool newPool;
+    VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &newPool));
+    return newPool;
+}
+
+void DescriptorWriter::writeImage(uint32_t binding, VkImageView image, VkSampler sampler, VkImageLayout layout,
+                                  VkDescriptorType type, uint32_t arrayElement) {
+    VkDescriptorImageInfo& info =
+        imageInfos.emplace_back(VkDescriptorImageInfo{.sampler = sampler, .imageView = image, .imageLayout = layout});
+
+    VkWriteDescriptorSet write = {.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+    write.dstBinding = binding;
+    write.dstArrayElement = arrayElement;
+    write.dstSet = VK_NULL_HANDLE; // filled in by updateSet()
+    write.descriptorCount = 1;
+    write.descriptorType = type;
+    write.pImageInfo = &info;
+
+    writes.push_back(write);
+}
+
+void DescriptorWriter::writeBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize size, VkDeviceSize offset,
+                                   VkDescriptorType type, uint32_t arrayElement) {
+    VkDescriptorBufferInfo& info =
+        bufferInfos.emplace_back(VkDescriptorBufferInfo{.buffer = buffer, .offset = offset, .range = size});
+
+    VkWriteDescriptorSet write = {.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+    write.dstBinding = binding;
+    write.dstArrayElement = arrayElement;
+    write.dstSet = VK_NULL_HANDLE; // filled in by updateSet()
+    write.descriptorCount = 1;
+    write.descriptorType = type;
+    write.pBufferInfo = &info;
+
+    writes.push_back(write);
+}
+
+void DescriptorWriter::clear() {
+    imageInfos.clear();
+    bufferInfos.clear();
+    writes.clear();
+}
+
+void DescriptorWriter::updateSet(VkDevice device, VkDescriptorSet set) {
+    for (VkWriteDescriptorSet& write : writes) {
+        write.dstSet = set;
+    }
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
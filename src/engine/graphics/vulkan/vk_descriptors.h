@@ -1,13 +1,16 @@
 #pragma once
 
 #include "vk_types.h"
+#include <deque>
 #include <span>
 #include <vector>
 
 struct DescriptorLayoutBuilder {
     std::vector<VkDescriptorSetLayoutBinding> bindings;
 
-    void addBinding(uint32_t binding, VkDescriptorType type);
+    /// @param count More than one makes the binding an array, such as the
+    /// bindless arrays of `BindlessDescriptors`.
+    void addBinding(uint32_t binding, VkDescriptorType type, uint32_t count = 1);
     void clear();
 
     VkDescriptorSetLayout build(VkDevice device, VkShaderStageFlags shaderStages, void* pNext = nullptr,
@@ -30,3 +33,67 @@ struct DescriptorAllocator {
 
     VkDescriptorSet allocate(VkDevice device, VkDescriptorSetLayout layout);
 };
+
+/// @brief Allocates descriptor sets from a chain of pools, creating a bigger
+/// pool whenever the current one runs out rather than failing.
+///
+/// Sets are freed all at once by `clearPools()`, which keeps every pool for
+/// reuse. `FrameData` holds one for sets that only live for a frame.
+///
+/// # Thread Safety
+///
+/// Not thread safe, give each thread its own.
+class DescriptorAllocatorGrowable {
+  public:
+    struct PoolSizeRatio {
+        VkDescriptorType type;
+        /// Descriptors of `type` per set in each pool.
+        float ratio;
+    };
+
+    /// @param initialSets How many sets the first pool holds. Each new pool
+    /// holds half again as many as the last, up to `MAX_SETS_PER_POOL`.
+    void init(VkDevice device, uint32_t initialSets, std::span<const PoolSizeRatio> poolRatios);
+
+    /// @brief Frees every set allocated so far. The caller must make sure the
+    /// GPU is done with them.
+    void clearPools(VkDevice device);
+
+    void destroyPools(VkDevice device);
+
+    VkDescriptorSet allocate(VkDevice device, VkDescriptorSetLayout layout, void* pNext = nullptr);
+
+    static constexpr uint32_t MAX_SETS_PER_POOL = 4092;
+
+  private:
+    /// @return A pool with space left, creating one if there is none.
+    VkDescriptorPool getPool(VkDevice device);
+
+    VkDescriptorPool createPool(VkDevice device, uint32_t setCount);
+
+    std::vector<PoolSizeRatio> ratios_;
+    /// Pools that ran out since the last `clearPools()`.
+    std::vector<VkDescriptorPool> fullPools_;
+    std::vector<VkDescriptorPool> readyPools_;
+    uint32_t setsPerPool_ = 0;
+};
+
+/// @brief Collects descriptor writes so a set is updated in one call.
+struct DescriptorWriter {
+    /// Held in deques so that the writes can point into them as they grow.
+    std::deque<VkDescriptorImageInfo> imageInfos;
+    std::deque<VkDescriptorBufferInfo> bufferInfos;
+    std::vector<VkWriteDescriptorSet> writes;
+
+    /// @param arrayElement The element to write, for array bindings.
+    void writeImage(uint32_t binding, VkImageView image, VkSampler sampler, VkImageLayout layout,
+                    VkDescriptorType type, uint32_t arrayElement = 0);
+
+    void writeBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize size, VkDeviceSize offset,
+                     VkDescriptorType type, uint32_t arrayElement = 0);
+
+    void clear();
+
+    /// @brief Applies every write to `set`.
+    void updateSet(VkDevice device, VkDescriptorSet set);
+};
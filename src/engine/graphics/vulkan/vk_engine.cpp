@@ -1,43 +1,106 @@
 #include "vk_engine.h"
+#include "../block_textures.h"
+#include "../frustum.h"
+#include "../shader_bundle.h"
 #include "vk_images.h"
 #include "vk_initializers.h"
 #include "vk_pipelines.h"
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_vulkan.h>
 #include <VkBootstrap.h>
+#include <algorithm>
 #include <assert.h>
 #include <backends/imgui_impl_sdl3.h>
 #include <backends/imgui_impl_vulkan.h>
 #include <chrono>
+#include <cstring>
+#include <fstream>
+#include <glm/common.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <imgui.h>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <thread>
 
 constexpr bool bUseValidationLayers = false;
 
 VulkanEngine* loadedEngine = nullptr;
 
+namespace {
+void memory_barrier(VkCommandBuffer cmd, VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+                    VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask) {
+    VkMemoryBarrier2 barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+    barrier.srcStageMask = srcStageMask;
+    barrier.srcAccessMask = srcAccessMask;
+    barrier.dstStageMask = dstStageMask;
+    barrier.dstAccessMask = dstAccessMask;
+
+    VkDependencyInfo depInfo{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    depInfo.memoryBarrierCount = 1;
+    depInfo.pMemoryBarriers = &barrier;
+
+    vkCmdPipelineBarrier2(cmd, &depInfo);
+}
+
+double milliseconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// the step headless frames and the benchmark camera take, so the same command line draws the same frames however
+// long each takes
+constexpr float FIXED_FRAME_TIME = 1.f / 60.f;
+
+GpuChunk gpu_chunk(mesh::LodCell cell, const ChunkMeshBuffer& chunkMesh) {
+    const world::ChunkPos first = cell.firstChunk();
+    GpuChunk gpuChunk{};
+    gpuChunk.position = glm::ivec4(first.x, first.y, first.z, static_cast<int32_t>(chunkMesh.quadCount));
+    if (chunkMesh.quadCount != 0) {
+        gpuChunk.quadBuffer = chunkMesh.geometry.address;
+    }
+    gpuChunk.lod = cell.level;
+    return gpuChunk;
+}
+} // namespace
+
 VulkanEngine& VulkanEngine::get() { return *loadedEngine; }
 
-void VulkanEngine::init() {
+void VulkanEngine::init(jobs::JobSystem& jobSystem, const LaunchOptions& options) {
     // only one engine initialization is allowed with the application.
     assert(loadedEngine == nullptr);
     loadedEngine = this;
 
-    // We initialize SDL and create a window with it.
-    SDL_Init(SDL_INIT_VIDEO);
+    jobSystem_ = &jobSystem;
+    options_ = options;
+    benchmarking_ = !options.benchmarkPath.empty();
+    windowExtent_ = {options.width, options.height};
+    initStart_ = std::chrono::steady_clock::now();
 
-    SDL_WindowFlags window_flags = SDL_WINDOW_VULKAN;
+    if (!options_.headless) {
+        // We initialize SDL and create a window with it.
+        SDL_Init(SDL_INIT_VIDEO);
 
-    window_ = SDL_CreateWindow("Vulkan Engine", windowExtent_.width, windowExtent_.height, window_flags);
+        SDL_WindowFlags window_flags = SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE;
+
+        window_ = SDL_CreateWindow("Vulkan Engine", windowExtent_.width, windowExtent_.height, window_flags);
+    }
 
     initVulkan();
+    startupTimes_.vulkan = milliseconds_since(initStart_);
     initSwapchain();
     initCommands();
     initSyncStructures();
     initDescriptors();
     initPipelines();
-    initImgui();
+    if (!options_.headless) {
+        initImgui();
+    }
+    initChunkBuffers();
+    initBlockTextures();
+    const auto worldStart = std::chrono::steady_clock::now();
+    initWorld();
+    startupTimes_.world = milliseconds_since(worldStart);
+    benchmarkStart_ = mainCamera_.position_;
 
     // everything went fine
     isInitialized_ = true;
@@ -45,27 +108,72 @@ void VulkanEngine::init() {
 
 void VulkanEngine::cleanup() {
     if (isInitialized_) {
+        // workers may still be meshing the world
+        jobSystem_->wait(lodJobs_);
+#ifdef SHADER_HOT_RELOAD
+        jobSystem_->wait(shaderJobs_);
+#endif
         vkDeviceWaitIdle(device_);
-        for (unsigned int i = 0; i < FRAME_OVERLAP; i++) {
+#ifdef SHADER_HOT_RELOAD
+        // built, but never swapped in
+        for (const auto& [target, pipeline] : reloadedPipelines_) {
+            vkDestroyPipeline(device_, pipeline, nullptr);
+        }
+#endif
+        for (unsigned int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
             vkDestroyCommandPool(device_, frames_[i].commandPool_, nullptr);
+            frames_[i].secondaryPools_.destroy(device_);
+            frames_[i].timestamps_.destroy(device_);
 
             // destroy sync objects
             vkDestroyFence(device_, frames_[i].renderFence_, nullptr);
             vkDestroySemaphore(device_, frames_[i].renderSemaphore_, nullptr);
             vkDestroySemaphore(device_, frames_[i].swapchainSemaphore_, nullptr);
 
-            frames_[i].deletionQueue_.flush();
+            flushDeletions(frames_[i]);
         }
+        destroyRetiredSwapchains(true);
 
-        mainDeletionQueue_.flush();
+        // their geometry goes with the heap
+        chunkMeshes_.clear();
+        pendingChunkMeshes_.clear();
+        lodResults_.clear();
+
+        // what the queue cannot destroy from a handle alone goes around it, in reverse order of creation
+        if (!options_.headless) {
+            ImGui_ImplVulkan_Shutdown();
+        }
+        bindless_.removeTexture(blockTextureIndex_);
+        // hot reload may have replaced the pipelines first built, so the ones in use now are destroyed
+        for (const ReloadablePipeline& reloadable : pipelines_) {
+            vkDestroyPipeline(device_, *reloadable.pipeline, nullptr);
+        }
 
-        destroySwapchain();
+        mainDeletionQueue_.flush(device_, allocator_);
 
-        vkDestroySurfaceKHR(instance_, surface_, nullptr);
+        chunkHeap_.destroy();
+        for (unsigned int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            frames_[i].frameDescriptors_.destroyPools(device_);
+        }
+        bindless_.destroy();
+        globalDescriptorAllocator.destroyPools(device_);
+        // after the pipelines, so it holds everything they added
+        vkutil::save_pipeline_cache(device_, chosenGPU_, pipelineCache_, pipelineCachePath_.c_str());
+        vkDestroyPipelineCache(device_, pipelineCache_, nullptr);
+        renderGraph_.destroy();
+        uploadQueue_.destroy();
+        vmaDestroyAllocator(allocator_);
+
+        if (!options_.headless) {
+            destroySwapchain();
+            vkDestroySurfaceKHR(instance_, surface_, nullptr);
+        }
         vkDestroyDevice(device_, nullptr);
 
         vkb::destroy_debug_utils_messenger(instance_, debugMessenger_);
-        SDL_DestroyWindow(window_);
+        if (window_ != nullptr) {
+            SDL_DestroyWindow(window_);
+        }
 
         vkDestroyInstance(instance_, nullptr);
     }
@@ -75,15 +183,74 @@ void VulkanEngine::cleanup() {
 }
 
 void VulkanEngine::draw() {
+    cpuPhases_.clear();
+    auto phaseStart = std::chrono::steady_clock::now();
+    const auto endPhase = [&](const char* name) {
+        cpuPhases_.push_back(PhaseTiming{name, milliseconds_since(phaseStart)});
+        phaseStart = std::chrono::steady_clock::now();
+    };
+
     VK_CHECK(vkWaitForFences(device_, 1, &get_current_frame().renderFence_, true, 1000000000));
+    endPhase("fence wait");
+
+    flushDeletions(get_current_frame());
+    get_current_frame().frameDescriptors_.clearPools(device_);
+    get_current_frame().secondaryPools_.reset(device_);
+    destroyRetiredSwapchains(false);
+
+    // the fence says the last frame to use this frame data is done, so its timings are ready
+    std::vector<GpuZoneTiming> zones;
+    double gpuFrameTime;
+    if (get_current_frame().timestamps_.collect(device_, timestampPeriod_, timestampValidBits_, zones,
+                                                gpuFrameTime)) {
+        gpuTimings_.addFrame(gpuFrameTime, zones);
+        if (benchmarking_) {
+            benchmarkGpu_.addFrame(gpuFrameTime, zones);
+        }
+        resolutionScaler_.addFrame(gpuFrameTime);
+    }
 
-    get_current_frame().deletionQueue_.flush();
+    updateChunkLods();
+    // submit whatever was uploaded since the last frame, to be drawn once it has arrived
+    uploadQueue_.flush();
+    endPhase("chunk updates");
+
+    // headless frames stay in the draw image
+    std::optional<uint32_t> swapchainImageIndex;
+    if (!options_.headless) {
+        if (resizeRequested_) {
+            recreateSwapchain();
+            if (resizeRequested_) {
+                // the window has no area to draw to, so try again next frame
+                return;
+            }
+        }
 
+        uint32_t imageIndex;
+        const VkResult acquireResult = vkAcquireNextImageKHR(
+            device_, swapchain_, 100000000000, get_current_frame().swapchainSemaphore_, nullptr, &imageIndex);
+        if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR) {
+            // nothing was acquired and the fence is still signalled, so the frame can simply start over
+            resizeRequested_ = true;
+            return;
+        }
+        if (acquireResult == VK_SUBOPTIMAL_KHR) {
+            // the image is still usable, and has to be presented now that it is acquired
+            resizeRequested_ = true;
+        } else {
+            VK_CHECK(acquireResult);
+        }
+        swapchainImageIndex = imageIndex;
+        endPhase("acquire");
+    }
+
+    // only reset once a frame is sure to be submitted, or the next wait on it would never return
     VK_CHECK(vkResetFences(device_, 1, &get_current_frame().renderFence_));
 
-    uint32_t swapchainImageIndex;
-    VK_CHECK(vkAcquireNextImageKHR(device_, swapchain_, 100000000000, get_current_frame().swapchainSemaphore_, nullptr,
-                                   &swapchainImageIndex));
+#ifdef SHADER_HOT_RELOAD
+    // also only once the frame is sure to be submitted, as it is what frees the pipelines swapped out
+    reloadShaders();
+#endif
 
     VkCommandBuffer cmd = get_current_frame().mainCommandBuffer_;
 
@@ -92,60 +259,98 @@ void VulkanEngine::draw() {
     VkCommandBufferBeginInfo cmdBeginInfo =
         vkinit::command_buffer_begin_info(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
-    drawExtent_.width = drawImage_.imageExtent.width;
-    drawExtent_.height = drawImage_.imageExtent.height;
+    // the draw image is sized for the display, but only the part the swapchain covers is drawn, scaled down while
+    // the GPU cannot keep up. Benchmarks always draw at full size, or they would measure the scaling instead.
+    if (swapchainImageIndex.has_value()) {
+        drawExtent_.width = std::min(swapchainExtent_.width, drawImage_.imageExtent.width);
+        drawExtent_.height = std::min(swapchainExtent_.height, drawImage_.imageExtent.height);
+        if (!benchmarking_) {
+            drawExtent_ = {resolutionScaler_.scaledSize(drawExtent_.width),
+                           resolutionScaler_.scaledSize(drawExtent_.height)};
+        }
+    } else {
+        drawExtent_ = {drawImage_.imageExtent.width, drawImage_.imageExtent.height};
+    }
 
     VK_CHECK(vkBeginCommandBuffer(cmd, &cmdBeginInfo));
 
-    vkutil::transition_image(cmd, swapchainImages_[swapchainImageIndex], VK_IMAGE_LAYOUT_UNDEFINED,
-                             VK_IMAGE_LAYOUT_GENERAL);
-
-    this->drawBackground(cmd);
-
-    vkutil::transition_image(cmd, drawImage_.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-    vkutil::transition_image(cmd, swapchainImages_[swapchainImageIndex], VK_IMAGE_LAYOUT_UNDEFINED,
-                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-    vkutil::copy_image_to_image(cmd, drawImage_.image, swapchainImages_[swapchainImageIndex], drawExtent_,
-                                swapchainExtent_);
-
-    draw_imgui(cmd, swapchainImageViews_[swapchainImageIndex]);
+    GpuTimestamps* timestamps = nullptr;
+    if (timestampValidBits_ != 0) {
+        timestamps = &get_current_frame().timestamps_;
+        timestamps->beginFrame(cmd);
+    }
 
-    vkutil::transition_image(cmd, swapchainImages_[swapchainImageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                             VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    buildRenderGraph(swapchainImageIndex);
+    renderGraph_.compile(get_current_frame().deletionQueue_);
+    renderGraph_.execute(cmd, timestamps, jobSystem_, &get_current_frame().secondaryPools_);
 
     VK_CHECK(vkEndCommandBuffer(cmd));
+    endPhase("record");
 
     VkCommandBufferSubmitInfo cmdInfo = vkinit::command_buffer_submit_info(cmd);
 
-    VkSemaphoreSubmitInfo waitInfo = vkinit::semaphore_submit_info(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
-                                                                   get_current_frame().swapchainSemaphore_);
+    VkSemaphoreSubmitInfo waitInfos[2];
+    // the swapchain image is first written by the copy into it, see `ResourceAccess::SwapchainAcquire`
+    waitInfos[0] = vkinit::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+                                                 get_current_frame().swapchainSemaphore_);
+    // the uploads applied this frame have already finished, so this never stalls, but it makes their writes
+    // visible to this queue
+    waitInfos[1] =
+        vkinit::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, uploadQueue_.timelineSemaphore());
+    waitInfos[1].value = uploadValue_;
     VkSemaphoreSubmitInfo signalInfo =
         vkinit::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, get_current_frame().renderSemaphore_);
 
-    VkSubmitInfo2 submit = vkinit::submit_info(&cmdInfo, &signalInfo, &waitInfo);
+    VkSubmitInfo2 submit;
+    if (swapchainImageIndex.has_value()) {
+        submit = vkinit::submit_info(&cmdInfo, &signalInfo, &waitInfos[0]);
+        submit.waitSemaphoreInfoCount = 2;
+    } else {
+        // nothing to acquire or present
+        submit = vkinit::submit_info(&cmdInfo, nullptr, &waitInfos[1]);
+    }
 
     VK_CHECK(vkQueueSubmit2(graphicsQueue_, 1, &submit, get_current_frame().renderFence_));
 
-    VkPresentInfoKHR presentInfo{};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.pNext = nullptr;
-    presentInfo.pSwapchains = &swapchain_;
-    presentInfo.swapchainCount = 1;
+    if (swapchainImageIndex.has_value()) {
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.pNext = nullptr;
+        presentInfo.pSwapchains = &swapchain_;
+        presentInfo.swapchainCount = 1;
 
-    presentInfo.pWaitSemaphores = &get_current_frame().renderSemaphore_;
-    presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &get_current_frame().renderSemaphore_;
+        presentInfo.waitSemaphoreCount = 1;
 
-    presentInfo.pImageIndices = &swapchainImageIndex;
+        presentInfo.pImageIndices = &*swapchainImageIndex;
 
-    VK_CHECK(vkQueuePresentKHR(graphicsQueue_, &presentInfo));
+        const VkResult presentResult = vkQueuePresentKHR(graphicsQueue_, &presentInfo);
+        if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR) {
+            resizeRequested_ = true;
+        } else {
+            VK_CHECK(presentResult);
+        }
+    }
+    endPhase("submit");
+
+    if (frameNumber_ == 0) {
+        startupTimes_.firstFrame = milliseconds_since(initStart_);
+        std::println("First frame after {:.1f} ms (vulkan {:.1f} ms, pipelines {:.1f} ms, world {:.1f} ms)",
+                     startupTimes_.firstFrame, startupTimes_.vulkan, startupTimes_.pipelines,
+                     startupTimes_.world);
+    }
 
     frameNumber_ += 1;
 }
 
-void VulkanEngine::run() {
+int VulkanEngine::run() {
+    if (options_.headless) {
+        return runHeadless();
+    }
+
     SDL_Event e;
     bool bQuit = false;
+    auto lastFrame = std::chrono::steady_clock::now();
 
     // main loop
     while (!bQuit) {
@@ -167,10 +372,22 @@ void VulkanEngine::run() {
                 std::cout << "Restored\n";
                 stopRendering_ = false;
             }
+            if (e.type == static_cast<decltype(e.type)>(SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED)) {
+                resizeRequested_ = true;
+            }
 
+            mainCamera_.processSDLEvent(e);
             ImGui_ImplSDL3_ProcessEvent(&e);
         }
 
+        const auto now = std::chrono::steady_clock::now();
+        if (benchmarking_) {
+            stepBenchmarkCamera();
+        } else {
+            mainCamera_.update(std::chrono::duration<float>(now - lastFrame).count());
+        }
+        lastFrame = now;
+
         // do not draw if we are minimized
         if (stopRendering_) {
             // throttle the speed to avoid the endless spinning
@@ -198,9 +415,312 @@ void VulkanEngine::run() {
         }
         ImGui::End();
 
+        if (ImGui::Begin("chunk memory")) {
+            constexpr double MIB = 1024.0 * 1024.0;
+            const GeometryHeapStats stats = chunkHeap_.stats();
+            ImGui::Text("meshes: %zu drawable, %zu uploading", chunkMeshes_.size(), pendingChunkMeshes_.size());
+            ImGui::Text("pages: %u, %.1f MiB", stats.pageCount, static_cast<double>(stats.capacity) / MIB);
+            ImGui::Text("used: %.1f MiB in %u allocations", static_cast<double>(stats.usedBytes) / MIB,
+                        stats.allocationCount);
+            ImGui::Text("free: %u blocks, largest %.1f MiB", stats.freeBlockCount,
+                        static_cast<double>(stats.largestFreeBlock) / MIB);
+            ImGui::Text("compacted: %.1f MiB", static_cast<double>(compactedBytes_) / MIB);
+            const VisibilityGraph::Stats& visibility = chunkVisibility_.stats();
+            ImGui::Text("visibility: %u chunks, %u in frustum, %u reached", visibility.chunks, visibility.inFrustum,
+                        visibility.reached);
+
+            std::array<uint32_t, mesh::LOD_LEVELS> cellsDrawn{};
+            bool swapping = false;
+            for (const LodRoot& root : lodRoots_) {
+                for (const mesh::LodCell cell : root.drawn) {
+                    cellsDrawn[cell.level]++;
+                }
+                swapping |= root.drawn != root.wanted;
+            }
+            ImGui::Text("cells by level of detail:");
+            for (const uint32_t cells : cellsDrawn) {
+                ImGui::SameLine();
+                ImGui::Text("%u", cells);
+            }
+            if (swapping) {
+                ImGui::SameLine();
+                ImGui::Text("(meshing)");
+            }
+            float detailDistance = static_cast<float>(lodSelector_.detailDistance());
+            if (ImGui::SliderFloat("full detail distance", &detailDistance, 32.f, 512.f)) {
+                lodSelector_.setDetailDistance(detailDistance);
+            }
+        }
+        ImGui::End();
+
+        if (ImGui::Begin("frame pacing")) {
+            if (ImGui::BeginCombo("present mode", string_VkPresentModeKHR(presentMode_))) {
+                for (VkPresentModeKHR mode : supportedPresentModes_) {
+                    if (ImGui::Selectable(string_VkPresentModeKHR(mode), mode == presentMode_)) {
+                        setPresentMode(mode);
+                    }
+                }
+                ImGui::EndCombo();
+            }
+
+            int framesInFlight = static_cast<int>(framesInFlight_);
+            if (ImGui::SliderInt("frames in flight", &framesInFlight, 1, static_cast<int>(MAX_FRAMES_IN_FLIGHT))) {
+                setFramesInFlight(static_cast<uint32_t>(framesInFlight));
+            }
+
+            float frameLimit = static_cast<float>(frameLimiter_.target());
+            if (ImGui::InputFloat("frame limit", &frameLimit, 10.f, 30.f, "%.0f fps")) {
+                frameLimiter_.setTarget(frameLimit);
+            }
+        }
+        ImGui::End();
+
+        if (ImGui::Begin("resolution")) {
+            ImGui::Text("drawing %ux%u of %ux%u", drawExtent_.width, drawExtent_.height, swapchainExtent_.width,
+                        swapchainExtent_.height);
+            ImGui::Text("gpu %.2f ms smoothed", resolutionScaler_.smoothedFrameTime());
+
+            float target = static_cast<float>(resolutionScaler_.target());
+            if (ImGui::InputFloat("target", &target, 10.f, 30.f, "%.0f fps")) {
+                resolutionScaler_.setTarget(target);
+            }
+            float range[2] = {resolutionScaler_.minScale(), resolutionScaler_.maxScale()};
+            if (ImGui::SliderFloat2("scale range", range, ResolutionScaler::MIN_SCALE, 1.f)) {
+                resolutionScaler_.setRange(range[0], range[1]);
+            }
+
+            bool fixed = resolutionScaler_.fixedScale().has_value();
+            if (ImGui::Checkbox("fixed scale", &fixed)) {
+                resolutionScaler_.setFixedScale(fixed ? std::optional(resolutionScaler_.scale()) : std::nullopt);
+            }
+            if (fixed) {
+                float scale = resolutionScaler_.scale();
+                if (ImGui::SliderFloat("scale", &scale, ResolutionScaler::MIN_SCALE, 1.f)) {
+                    resolutionScaler_.setFixedScale(scale);
+                }
+            }
+            if (timestampValidBits_ == 0) {
+                ImGui::Text("the graphics queue has no timestamps, so the scale cannot adapt");
+            }
+        }
+        ImGui::End();
+
+        if (ImGui::Begin("gpu timings")) {
+            const std::span<const float> frameTimes = gpuTimings_.frameTimes();
+            const std::string overlay = std::format("{:.2f} ms", gpuTimings_.latestFrameTime());
+            ImGui::PlotLines("frame", frameTimes.data(), static_cast<int>(frameTimes.size()),
+                             static_cast<int>(gpuTimings_.frameOffset()), overlay.c_str(), 0.f,
+                             std::max(gpuTimings_.maxFrameTime(), 1.f), ImVec2(0, 80));
+            for (const GpuTimingHistory::Zone& zone : gpuTimings_.zones()) {
+                ImGui::Text("%-18s %6.3f ms avg %6.3f ms max", zone.name.c_str(), zone.average, zone.max);
+            }
+            if (timestampValidBits_ == 0) {
+                ImGui::Text("the graphics queue has no timestamps");
+            }
+        }
+        ImGui::End();
+
         ImGui::Render();
 
         draw();
+
+        if (benchmarking_) {
+            // unlimited, so the frame times are the engine's own
+            if (addBenchmarkFrame(now)) {
+                return finishBenchmark() ? 0 : 1;
+            }
+            continue;
+        }
+        frameLimiter_.wait();
+    }
+    return 0;
+}
+
+int VulkanEngine::runHeadless() {
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < options_.frames; i++) {
+        const auto frameStart = std::chrono::steady_clock::now();
+        if (benchmarking_) {
+            stepBenchmarkCamera();
+            draw();
+            addBenchmarkFrame(frameStart);
+        } else {
+            mainCamera_.update(FIXED_FRAME_TIME);
+            draw();
+        }
+    }
+    if (benchmarking_ && !finishBenchmark()) {
+        return 1;
+    }
+    // the last frame may not depend on how far the workers got with meshing
+    while (!chunkLodsSettled()) {
+        jobSystem_->wait(lodJobs_);
+        mainCamera_.update(FIXED_FRAME_TIME);
+        draw();
+    }
+    std::println("Drew {} frames at {}x{} in {:.1f} ms", frameNumber_, drawExtent_.width, drawExtent_.height,
+                 milliseconds_since(start));
+
+    if (options_.capturePath.empty() && options_.comparePath.empty()) {
+        return 0;
+    }
+    const CapturedImage frame = captureDrawImage();
+
+    if (!options_.capturePath.empty()) {
+        const std::vector<uint8_t> file = encodePpm(frame);
+        std::ofstream out(options_.capturePath, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+        if (!out) {
+            std::println("Failed to write the last frame to {}", options_.capturePath);
+            return 1;
+        }
+    }
+
+    if (!options_.comparePath.empty()) {
+        std::ifstream in(options_.comparePath, std::ios::binary);
+        const std::vector<uint8_t> file{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        const std::optional<CapturedImage> expected = decodePpm(file);
+        if (!expected.has_value()) {
+            std::println("{} is not a binary PPM image", options_.comparePath);
+            return 1;
+        }
+        const uint32_t difference = maxDifference(frame, *expected);
+        if (difference == UINT32_MAX) {
+            std::println("The last frame is {}x{}, but {} is {}x{}", frame.width, frame.height,
+                         options_.comparePath, expected->width, expected->height);
+            return 1;
+        }
+        if (difference > options_.tolerance) {
+            std::println("The last frame differs from {} by up to {}, more than the {} allowed", options_.comparePath,
+                         difference, options_.tolerance);
+            return 1;
+        }
+        std::println("The last frame matches {} to within {}", options_.comparePath, difference);
+    }
+    return 0;
+}
+
+CapturedImage VulkanEngine::captureDrawImage() {
+    // the last frame left the draw image ready to copy from, see `buildRenderGraph()`
+    VK_CHECK(vkDeviceWaitIdle(device_));
+
+    const uint32_t width = drawImage_.imageExtent.width;
+    const uint32_t height = drawImage_.imageExtent.height;
+    const size_t size = static_cast<size_t>(width) * height * 4 * sizeof(uint16_t);
+    const AllocatedBuffer readback = createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU);
+
+    immediateSubmit([&](VkCommandBuffer cmd) {
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {width, height, 1};
+        vkCmdCopyImageToBuffer(cmd, drawImage_.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1,
+                               &region);
+        memory_barrier(cmd, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_HOST_BIT,
+                       VK_ACCESS_2_HOST_READ_BIT);
+    });
+    VK_CHECK(vmaInvalidateAllocation(allocator_, readback.allocation, 0, VK_WHOLE_SIZE));
+
+    const CapturedImage frame = CapturedImage::fromHalfFloats(
+        width, height, std::span(static_cast<const uint16_t*>(readback.info.pMappedData), size / sizeof(uint16_t)));
+    destroyBuffer(readback);
+    return frame;
+}
+
+void VulkanEngine::stepBenchmarkCamera() {
+    const double seconds = static_cast<double>(benchmarkCpu_.frames().size()) * FIXED_FRAME_TIME;
+    const CameraPose pose = benchmarkCameraPose(benchmarkStart_, seconds);
+    mainCamera_.position_ = pose.position;
+    mainCamera_.yaw_ = pose.yaw;
+    mainCamera_.pitch_ = pose.pitch;
+}
+
+bool VulkanEngine::addBenchmarkFrame(std::chrono::steady_clock::time_point frameStart) {
+    benchmarkCpu_.addFrame(milliseconds_since(frameStart), cpuPhases_);
+    return benchmarkCpu_.frames().size() >= options_.frames;
+}
+
+bool VulkanEngine::finishBenchmark() {
+    benchmarking_ = false;
+
+    // the frames still in flight have not been read, oldest first
+    VK_CHECK(vkDeviceWaitIdle(device_));
+    std::vector<GpuZoneTiming> zones;
+    double gpuFrameTime;
+    for (uint32_t i = 0; i < framesInFlight_; i++) {
+        FrameData& frame = frames_[(frameNumber_ + i) % framesInFlight_];
+        if (frame.timestamps_.collect(device_, timestampPeriod_, timestampValidBits_, zones, gpuFrameTime)) {
+            benchmarkGpu_.addFrame(gpuFrameTime, zones);
+        }
+    }
+
+    const BenchmarkInfo info{deviceName_, drawExtent_.width, drawExtent_.height, terrain_.settings().seed,
+                             options_.headless};
+    std::ofstream out(options_.benchmarkPath);
+    out << benchmarkJson(info, benchmarkCpu_, benchmarkGpu_);
+    if (!out) {
+        std::println("Failed to write the benchmark to {}", options_.benchmarkPath);
+        return false;
+    }
+
+    const FrameTimeSummary cpu = summarizeFrameTimes(benchmarkCpu_.frames());
+    const FrameTimeSummary gpu = summarizeFrameTimes(benchmarkGpu_.frames());
+    std::println("Benchmark of {} frames written to {}", cpu.frames, options_.benchmarkPath);
+    std::println("  cpu p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms, {} hitches", cpu.p50, cpu.p99, cpu.max,
+                 cpu.hitches);
+    std::println("  gpu p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms, {} hitches", gpu.p50, gpu.p99, gpu.max,
+                 gpu.hitches);
+    return true;
+}
+
+bool VulkanEngine::chunkLodsSettled() {
+    {
+        std::lock_guard lock(lodResultsMutex_);
+        if (!lodResults_.empty()) {
+            return false;
+        }
+    }
+    if (!pendingChunkMeshes_.empty() || !lodJobs_.isDone()) {
+        return false;
+    }
+    return std::all_of(lodRoots_.begin(), lodRoots_.end(),
+                       [](const LodRoot& root) { return root.drawn == root.wanted; });
+}
+
+void VulkanEngine::setFramesInFlight(uint32_t count) {
+    count = std::clamp(count, 1u, MAX_FRAMES_IN_FLIGHT);
+    if (count == framesInFlight_) {
+        return;
+    }
+
+    // which frame data each frame uses changes, so let every frame finish first
+    VkFence fences[MAX_FRAMES_IN_FLIGHT];
+    for (unsigned int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        fences[i] = frames_[i].renderFence_;
+    }
+    VK_CHECK(vkWaitForFences(device_, MAX_FRAMES_IN_FLIGHT, fences, true, 1000000000));
+
+    for (unsigned int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        flushDeletions(frames_[i]);
+        frames_[i].frameDescriptors_.clearPools(device_);
+    }
+    destroyRetiredSwapchains(true);
+
+    framesInFlight_ = count;
+}
+
+void VulkanEngine::flushDeletions(FrameData& frame) {
+    frame.deletionQueue_.flush(device_, allocator_);
+    for (const GeometryAllocation& geometry : frame.freedGeometry_) {
+        chunkHeap_.free(geometry);
+    }
+    frame.freedGeometry_.clear();
+}
+
+void VulkanEngine::setPresentMode(VkPresentModeKHR mode) {
+    if (mode != presentMode_) {
+        presentMode_ = mode;
+        resizeRequested_ = true;
     }
 }
 
@@ -227,6 +747,223 @@ void VulkanEngine::immediateSubmit(std::function<void(VkCommandBuffer cmd)>&& fu
     VK_CHECK(vkWaitForFences(device_, 1, &immFence_, true, 999999999999));
 }
 
+AllocatedBuffer VulkanEngine::createBuffer(size_t allocSize, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage) {
+    VkBufferCreateInfo bufferInfo = {.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    bufferInfo.pNext = nullptr;
+    bufferInfo.size = allocSize;
+    bufferInfo.usage = usage;
+
+    // buffers may be written by the upload queue, which can be in another family
+    const uint32_t queueFamilies[] = {graphicsQueueFamily_, uploadQueue_.queueFamily()};
+    if (queueFamilies[0] != queueFamilies[1]) {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = 2;
+        bufferInfo.pQueueFamilyIndices = queueFamilies;
+    }
+
+    VmaAllocationCreateInfo vmaallocInfo = {};
+    vmaallocInfo.usage = memoryUsage;
+    vmaallocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    AllocatedBuffer newBuffer;
+    VK_CHECK(vmaCreateBuffer(allocator_, &bufferInfo, &vmaallocInfo, &newBuffer.buffer, &newBuffer.allocation,
+                             &newBuffer.info));
+    return newBuffer;
+}
+
+void VulkanEngine::destroyBuffer(const AllocatedBuffer& buffer) {
+    vmaDestroyBuffer(allocator_, buffer.buffer, buffer.allocation);
+}
+
+VkDeviceAddress VulkanEngine::getBufferAddress(const AllocatedBuffer& buffer) {
+    VkBufferDeviceAddressInfo addressInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO};
+    addressInfo.buffer = buffer.buffer;
+    return vkGetBufferDeviceAddress(device_, &addressInfo);
+}
+
+uint64_t VulkanEngine::uploadChunkMesh(mesh::LodCell cell, std::span<const mesh::PackedQuad> quads) {
+    PendingChunkMesh pending{};
+    pending.cell = cell;
+    if (quads.empty()) {
+        // nothing to copy, but it must not overtake earlier uploads of the same chunk
+        pending.uploadValue = uploadQueue_.lastUploadValue();
+    } else {
+        const auto size = static_cast<uint32_t>(quads.size_bytes());
+        std::optional<GeometryAllocation> geometry = chunkHeap_.allocate(size, compactingPage_);
+        if (!geometry.has_value()) {
+            std::println("Out of chunk geometry memory, not drawing chunk {} {} {} at level {}", cell.pos.x,
+                         cell.pos.y, cell.pos.z, cell.level);
+            return uploadQueue_.lastUploadValue();
+        }
+        pending.mesh.quadCount = static_cast<uint32_t>(quads.size());
+        pending.mesh.geometry = *geometry;
+        pending.uploadValue =
+            uploadQueue_.uploadBuffer(geometry->buffer, geometry->range.offset, quads.data(), quads.size_bytes());
+    }
+    pendingChunkMeshes_.push_back(pending);
+    return pending.uploadValue;
+}
+
+void VulkanEngine::buildRenderGraph(std::optional<uint32_t> swapchainImageIndex) {
+    RenderGraph& graph = renderGraph_;
+    graph.reset();
+
+    // the previous frame's copy may still be reading the draw image, but nothing needs what it holds
+    const RenderGraph::ImageHandle drawImage = graph.importImage(
+        drawImage_.image, drawImage_.imageView, VK_IMAGE_ASPECT_COLOR_BIT, {ResourceAccess::TransferRead});
+    const RenderGraph::ImageHandle depthImage =
+        graph.createImage({depthFormat_, {drawImage_.imageExtent.width, drawImage_.imageExtent.height},
+                           VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT});
+
+    // shared with the frames still in flight, which may be reading them
+    const RenderGraph::BufferHandle chunkSlots =
+        graph.importBuffer({ResourceAccess::ComputeStorageRead, ResourceAccess::VertexStorageRead});
+    const RenderGraph::BufferHandle chunkGeometry = graph.importBuffer({ResourceAccess::VertexStorageRead});
+    // the frame's fence was waited on, so nothing uses its own buffers
+    const RenderGraph::BufferHandle drawCommands = graph.importBuffer({});
+    const RenderGraph::BufferHandle drawCount = graph.importBuffer({});
+
+    uploadValue_ = uploadQueue_.completedValue();
+    if (!pendingChunkMeshes_.empty() && pendingChunkMeshes_.front().uploadValue <= uploadValue_) {
+        graph.addPass("chunk uploads", [this](VkCommandBuffer cmd) { applyChunkUploads(cmd); })
+            .use(chunkSlots, ResourceAccess::TransferWrite);
+    }
+
+    compactingPage_ = chunkHeap_.compactionCandidate();
+    if (compactingPage_.has_value()) {
+        graph.addPass("chunk compaction", [this](VkCommandBuffer cmd) { compactChunkHeap(cmd); })
+            .use(chunkGeometry, ResourceAccess::TransferRead)
+            .use(chunkGeometry, ResourceAccess::TransferWrite)
+            .use(chunkSlots, ResourceAccess::TransferWrite);
+    }
+
+    // from here on passes only read what the CPU changed above, so they are recorded at the same time, with the
+    // visibility search in culling the longest
+    graph.addPass("background", [this](VkCommandBuffer cmd) { drawBackground(cmd); })
+        .use(drawImage, ResourceAccess::ComputeImageWrite)
+        .parallel();
+
+    graph.addPass("chunk cull", [this](VkCommandBuffer cmd) { cullChunks(cmd); })
+        .use(chunkSlots, ResourceAccess::ComputeStorageRead)
+        .use(drawCommands, ResourceAccess::ComputeStorageWrite)
+        .use(drawCount, ResourceAccess::TransferWrite)
+        .use(drawCount, ResourceAccess::ComputeStorageWrite)
+        .parallel();
+
+    graph.addPass("chunks",
+                  [this, depthImage](VkCommandBuffer cmd) { drawChunks(cmd, renderGraph_.imageView(depthImage)); })
+        .use(drawImage, ResourceAccess::ColorAttachmentWrite)
+        .use(depthImage, ResourceAccess::DepthAttachmentWrite)
+        .use(drawCommands, ResourceAccess::IndirectRead)
+        .use(drawCount, ResourceAccess::IndirectRead)
+        .use(chunkSlots, ResourceAccess::VertexStorageRead)
+        .use(chunkGeometry, ResourceAccess::VertexStorageRead)
+        .parallel();
+
+    if (!swapchainImageIndex.has_value()) {
+        // left for `captureDrawImage()` to copy from
+        graph.exportImage(drawImage, ResourceAccess::TransferRead);
+        return;
+    }
+
+    const uint32_t imageIndex = *swapchainImageIndex;
+    const RenderGraph::ImageHandle swapchainImage =
+        graph.importImage(swapchainImages_[imageIndex], swapchainImageViews_[imageIndex], VK_IMAGE_ASPECT_COLOR_BIT,
+                          {ResourceAccess::SwapchainAcquire});
+    graph.exportImage(swapchainImage, ResourceAccess::Present);
+
+    graph.addPass("present copy",
+                  [this, imageIndex](VkCommandBuffer cmd) {
+                      vkutil::copy_image_to_image(cmd, drawImage_.image, swapchainImages_[imageIndex], drawExtent_,
+                                                  swapchainExtent_);
+                  })
+        .use(drawImage, ResourceAccess::TransferRead)
+        .use(swapchainImage, ResourceAccess::TransferWrite)
+        .parallel();
+
+    graph.addPass("imgui",
+                  [this, imageIndex](VkCommandBuffer cmd) { draw_imgui(cmd, swapchainImageViews_[imageIndex]); })
+        .use(swapchainImage, ResourceAccess::ColorAttachmentWrite)
+        .parallel();
+}
+
+void VulkanEngine::applyChunkUploads(VkCommandBuffer cmd) {
+    while (!pendingChunkMeshes_.empty() && pendingChunkMeshes_.front().uploadValue <= uploadValue_) {
+        const PendingChunkMesh pending = pendingChunkMeshes_.front();
+        pendingChunkMeshes_.pop_front();
+        appliedUploadValue_ = pending.uploadValue;
+
+        ChunkMeshBuffer chunkMesh = pending.mesh;
+        SlotHandle slot;
+        if (auto found = chunkMeshes_.find(pending.cell); found != chunkMeshes_.end()) {
+            // frames still in flight may be drawing the old mesh
+            get_current_frame().freedGeometry_.push_back(found->second.geometry);
+            slot = found->second.slot;
+            chunkMeshes_.erase(found);
+            if (chunkMesh.quadCount == 0) {
+                [[maybe_unused]] const bool freed = chunkSlots_.free(slot);
+                assert(freed);
+            }
+        } else if (chunkMesh.quadCount == 0) {
+            continue;
+        } else if (const std::optional<SlotHandle> allocated = chunkSlots_.allocate(); allocated.has_value()) {
+            slot = *allocated;
+        } else {
+            std::println("Out of GPU chunk slots, not drawing chunk {} {} {} at level {}", pending.cell.pos.x,
+                         pending.cell.pos.y, pending.cell.pos.z, pending.cell.level);
+            chunkHeap_.free(chunkMesh.geometry);
+            continue;
+        }
+
+        const GpuChunk gpuChunk = gpu_chunk(pending.cell, chunkMesh);
+        if (chunkMesh.quadCount != 0) {
+            chunkMesh.slot = slot;
+            chunkMeshes_.emplace(pending.cell, chunkMesh);
+        }
+        vkCmdUpdateBuffer(cmd, chunkBuffer_.buffer, slot.index * sizeof(GpuChunk), sizeof(GpuChunk), &gpuChunk);
+    }
+}
+
+void VulkanEngine::compactChunkHeap(VkCommandBuffer cmd) {
+    // bounds how much copying one frame takes on
+    constexpr uint32_t COMPACTION_BYTES_PER_FRAME = 4u * 1024 * 1024;
+
+    uint32_t moved = 0;
+    for (auto& [cell, chunkMesh] : chunkMeshes_) {
+        if (moved >= COMPACTION_BYTES_PER_FRAME) {
+            break;
+        }
+        if (chunkMesh.geometry.page != *compactingPage_) {
+            continue;
+        }
+
+        const std::optional<GeometryAllocation> target =
+            chunkHeap_.allocateOutside(*compactingPage_, chunkMesh.geometry.range.size);
+        if (!target.has_value()) {
+            break;
+        }
+
+        VkBufferCopy copy{};
+        copy.srcOffset = chunkMesh.geometry.range.offset;
+        copy.dstOffset = target->range.offset;
+        copy.size = chunkMesh.quadCount * sizeof(mesh::PackedQuad);
+        vkCmdCopyBuffer(cmd, chunkMesh.geometry.buffer, target->buffer, 1, &copy);
+
+        // frames in flight still draw from the old place
+        get_current_frame().freedGeometry_.push_back(chunkMesh.geometry);
+        chunkMesh.geometry = *target;
+
+        assert(chunkSlots_.valid(chunkMesh.slot));
+        const GpuChunk gpuChunk = gpu_chunk(cell, chunkMesh);
+        vkCmdUpdateBuffer(cmd, chunkBuffer_.buffer, chunkMesh.slot.index * sizeof(GpuChunk), sizeof(GpuChunk),
+                          &gpuChunk);
+
+        moved += static_cast<uint32_t>(copy.size);
+    }
+
+    compactedBytes_ += moved;
+}
+
 void VulkanEngine::initVulkan() {
     vkb::InstanceBuilder builder;
 
@@ -234,6 +971,7 @@ void VulkanEngine::initVulkan() {
                        .request_validation_layers(bUseValidationLayers)
                        .use_default_debug_messenger()
                        .require_api_version(1, 3, 0)
+                       .set_headless(options_.headless)
                        .build();
 
     vkb::Instance vkbInst = instRet.value();
@@ -241,7 +979,9 @@ void VulkanEngine::initVulkan() {
     instance_ = vkbInst.instance;
     debugMessenger_ = vkbInst.debug_messenger;
 
-    SDL_Vulkan_CreateSurface(window_, instance_, nullptr, &surface_);
+    if (!options_.headless) {
+        SDL_Vulkan_CreateSurface(window_, instance_, nullptr, &surface_);
+    }
 
     VkPhysicalDeviceVulkan13Features features{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES};
     features.dynamicRendering = true;
@@ -250,14 +990,35 @@ void VulkanEngine::initVulkan() {
     VkPhysicalDeviceVulkan12Features features12{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
     features12.bufferDeviceAddress = true;
     features12.descriptorIndexing = true;
+    // for the bindless set, written while frames using it are in flight and only partly filled
+    features12.runtimeDescriptorArray = true;
+    features12.descriptorBindingPartiallyBound = true;
+    features12.descriptorBindingSampledImageUpdateAfterBind = true;
+    features12.descriptorBindingStorageBufferUpdateAfterBind = true;
+    features12.shaderSampledImageArrayNonUniformIndexing = true;
+    features12.shaderStorageBufferArrayNonUniformIndexing = true;
+    features12.drawIndirectCount = true;
+    features12.timelineSemaphore = true;
+
+    // chunks are drawn with one indirect draw, each finding its data through its first instance
+    VkPhysicalDeviceFeatures features10{};
+    features10.multiDrawIndirect = true;
+    features10.drawIndirectFirstInstance = true;
 
     vkb::PhysicalDeviceSelector selector(vkbInst);
-    vkb::PhysicalDevice physicalDevice = selector.set_minimum_version(1, 3)
-                                             .set_required_features_13(features)
-                                             .set_required_features_12(features12)
-                                             .set_surface(surface_)
-                                             .select()
-                                             .value();
+    selector.set_minimum_version(1, 3)
+        .set_required_features_13(features)
+        .set_required_features_12(features12)
+        .set_required_features(features10);
+    if (!options_.headless) {
+        selector.set_surface(surface_);
+    }
+    vkb::PhysicalDevice physicalDevice = selector.select().value();
+
+    // block textures are read precompressed where the device can sample them
+    VkPhysicalDeviceFeatures compressionFeatures{};
+    compressionFeatures.textureCompressionBC = true;
+    textureCompressionBc_ = physicalDevice.enable_features_if_present(compressionFeatures);
 
     vkb::DeviceBuilder deviceBuilder(physicalDevice);
     vkb::Device vkbDevice = deviceBuilder.build().value();
@@ -268,6 +1029,20 @@ void VulkanEngine::initVulkan() {
     graphicsQueue_ = vkbDevice.get_queue(vkb::QueueType::graphics).value();
     graphicsQueueFamily_ = vkbDevice.get_queue_index(vkb::QueueType::graphics).value();
 
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(chosenGPU_, &properties);
+    timestampPeriod_ = properties.limits.timestampPeriod;
+    deviceName_ = properties.deviceName;
+    timestampValidBits_ = physicalDevice.get_queue_families()[graphicsQueueFamily_].timestampValidBits;
+
+    // uploads run on a transfer only queue where there is one, next to rendering rather than between it
+    VkQueue uploadQueue = graphicsQueue_;
+    uint32_t uploadQueueFamily = graphicsQueueFamily_;
+    if (auto transferQueue = vkbDevice.get_dedicated_queue(vkb::QueueType::transfer); transferQueue.has_value()) {
+        uploadQueue = transferQueue.value();
+        uploadQueueFamily = vkbDevice.get_dedicated_queue_index(vkb::QueueType::transfer).value();
+    }
+
     VmaAllocatorCreateInfo allocatorInfo{};
     allocatorInfo.physicalDevice = chosenGPU_;
     allocatorInfo.device = device_;
@@ -275,14 +1050,34 @@ void VulkanEngine::initVulkan() {
     allocatorInfo.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
     VK_CHECK(vmaCreateAllocator(&allocatorInfo, &allocator_));
 
-    mainDeletionQueue_.pushFunction([&]() { vmaDestroyAllocator(allocator_); });
+    uploadQueue_.init(device_, allocator_, uploadQueue, uploadQueueFamily);
+
+    renderGraph_.init(device_, allocator_);
 }
 
 void VulkanEngine::initSwapchain() {
-    createSwapchain(windowExtent_.width, windowExtent_.height);
-
+    // headless, the draw image is exactly the size asked for, and there is nothing else
     VkExtent3D drawImageExtent = {windowExtent_.width, windowExtent_.height, 1};
 
+    if (!options_.headless) {
+        uint32_t presentModeCount = 0;
+        VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(chosenGPU_, surface_, &presentModeCount, nullptr));
+        supportedPresentModes_.resize(presentModeCount);
+        VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(chosenGPU_, surface_, &presentModeCount,
+                                                           supportedPresentModes_.data()));
+
+        createSwapchain(windowExtent_.width, windowExtent_.height);
+
+        // sized for the whole display, so the window can grow without the draw image being recreated
+        const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window_));
+        if (mode != nullptr) {
+            drawImageExtent.width =
+                std::max(drawImageExtent.width, static_cast<uint32_t>(mode->w * mode->pixel_density));
+            drawImageExtent.height =
+                std::max(drawImageExtent.height, static_cast<uint32_t>(mode->h * mode->pixel_density));
+        }
+    }
+
     // TODO probably change this?
     drawImage_.imageFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
     drawImage_.imageExtent = drawImageExtent;
@@ -306,13 +1101,11 @@ void VulkanEngine::initSwapchain() {
 
     VK_CHECK(vkCreateImageView(device_, &rview_info, nullptr, &drawImage_.imageView));
 
-    mainDeletionQueue_.pushFunction([=]() {
-        vkDestroyImageView(device_, drawImage_.imageView, nullptr);
-        vmaDestroyImage(allocator_, drawImage_.image, drawImage_.allocation);
-    });
+    mainDeletionQueue_.push(drawImage_.image, drawImage_.allocation);
+    mainDeletionQueue_.push(drawImage_.imageView);
 }
 
-void VulkanEngine::createSwapchain(uint32_t width, uint32_t height) {
+void VulkanEngine::createSwapchain(uint32_t width, uint32_t height, VkSwapchainKHR oldSwapchain) {
     vkb::SwapchainBuilder swapchainBuilder(chosenGPU_, device_, surface_);
     swapchainImageFormat_ = VK_FORMAT_B8G8R8A8_UNORM;
 
@@ -320,8 +1113,12 @@ void VulkanEngine::createSwapchain(uint32_t width, uint32_t height) {
         swapchainBuilder
             .set_desired_format(
                 VkSurfaceFormatKHR{.format = swapchainImageFormat_, .colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR})
-            .set_desired_present_mode(VK_PRESENT_MODE_FIFO_KHR)
+            .set_desired_present_mode(presentMode_)
+            // FIFO is the one mode every surface has
+            .add_fallback_present_mode(VK_PRESENT_MODE_FIFO_KHR)
+            .set_desired_min_image_count(vkb::SwapchainBuilder::TRIPLE_BUFFERING)
             .set_desired_extent(width, height)
+            .set_old_swapchain(oldSwapchain)
             .add_image_usage_flags(VK_IMAGE_USAGE_TRANSFER_DST_BIT)
             .build()
             .value();
@@ -330,6 +1127,39 @@ void VulkanEngine::createSwapchain(uint32_t width, uint32_t height) {
     swapchain_ = vkbSwapchain.swapchain;
     swapchainImages_ = vkbSwapchain.get_images().value();
     swapchainImageViews_ = vkbSwapchain.get_image_views().value();
+    presentMode_ = vkbSwapchain.present_mode;
+}
+
+void VulkanEngine::recreateSwapchain() {
+    int width = 0;
+    int height = 0;
+    SDL_GetWindowSizeInPixels(window_, &width, &height);
+    if (width == 0 || height == 0) {
+        return;
+    }
+    windowExtent_.width = static_cast<uint32_t>(width);
+    windowExtent_.height = static_cast<uint32_t>(height);
+
+    RetiredSwapchain retired{swapchain_, std::move(swapchainImageViews_), frameNumber_};
+    createSwapchain(windowExtent_.width, windowExtent_.height, retired.swapchain);
+    retiredSwapchains_.push_back(std::move(retired));
+
+    resizeRequested_ = false;
+}
+
+void VulkanEngine::destroyRetiredSwapchains(bool all) {
+    // frames up to `frameNumber_ - framesInFlight_` have finished, as this frame's fence has been waited on.
+    // Presenting has no fence of its own, so that is taken to be done with the old images too.
+    std::erase_if(retiredSwapchains_, [&](RetiredSwapchain& retired) {
+        if (!all && frameNumber_ + 1 < retired.retiredFrame + static_cast<int>(framesInFlight_)) {
+            return false;
+        }
+        for (VkImageView view : retired.imageViews) {
+            vkDestroyImageView(device_, view, nullptr);
+        }
+        vkDestroySwapchainKHR(device_, retired.swapchain, nullptr);
+        return true;
+    });
 }
 
 void VulkanEngine::destroySwapchain() {
@@ -348,7 +1178,7 @@ void VulkanEngine::initCommands() {
     VkCommandPoolCreateInfo commandPoolInfo =
         vkinit::command_pool_create_info(graphicsQueueFamily_, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 
-    for (int i = 0; i < FRAME_OVERLAP; i++) {
+    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
 
         VK_CHECK(vkCreateCommandPool(device_, &commandPoolInfo, nullptr, &frames_[i].commandPool_));
 
@@ -356,6 +1186,10 @@ void VulkanEngine::initCommands() {
         VkCommandBufferAllocateInfo cmdAllocInfo = vkinit::command_buffer_allocate_info(frames_[i].commandPool_, 1);
 
         VK_CHECK(vkAllocateCommandBuffers(device_, &cmdAllocInfo, &frames_[i].mainCommandBuffer_));
+
+        frames_[i].timestamps_.init(device_);
+
+        frames_[i].secondaryPools_.init(device_, graphicsQueueFamily_, jobSystem_->workerCount() + 1);
     }
 
     {
@@ -365,7 +1199,7 @@ void VulkanEngine::initCommands() {
 
         VK_CHECK(vkAllocateCommandBuffers(device_, &cmdAllocInfo, &immCommandBuffer_));
 
-        mainDeletionQueue_.pushFunction([=]() { vkDestroyCommandPool(device_, immCommandPool_, nullptr); });
+        mainDeletionQueue_.push(immCommandPool_);
     }
 }
 
@@ -373,7 +1207,7 @@ void VulkanEngine::initSyncStructures() {
     VkFenceCreateInfo fenceCreateInfo = vkinit::fence_create_info(VK_FENCE_CREATE_SIGNALED_BIT);
     VkSemaphoreCreateInfo semaphoreCreateInfo = vkinit::semaphore_create_info();
 
-    for (unsigned int i = 0; i < FRAME_OVERLAP; i++) {
+    for (unsigned int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         VK_CHECK(vkCreateFence(device_, &fenceCreateInfo, nullptr, &frames_[i].renderFence_));
 
         VK_CHECK(vkCreateSemaphore(device_, &semaphoreCreateInfo, nullptr, &frames_[i].swapchainSemaphore_));
@@ -382,14 +1216,14 @@ void VulkanEngine::initSyncStructures() {
 
     {
         VK_CHECK(vkCreateFence(device_, &fenceCreateInfo, nullptr, &immFence_));
-        mainDeletionQueue_.pushFunction([=]() { vkDestroyFence(device_, immFence_, nullptr); });
+        mainDeletionQueue_.push(immFence_);
     }
 }
 
 void VulkanEngine::initDescriptors() {
-    std::vector<DescriptorAllocator::PoolSizeRatio> sizes = {{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1}};
+    std::vector<DescriptorAllocatorGrowable::PoolSizeRatio> sizes = {{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1}};
 
-    globalDescriptorAllocator.initPool(device_, 10, sizes);
+    globalDescriptorAllocator.init(device_, 10, sizes);
 
     {
         DescriptorLayoutBuilder builder;
@@ -415,14 +1249,116 @@ void VulkanEngine::initDescriptors() {
 
     vkUpdateDescriptorSets(device_, 1, &drawImageWrite, 0, nullptr);
 
-    mainDeletionQueue_.pushFunction([&]() {
-        globalDescriptorAllocator.destroyPool(device_);
+    bindless_.init(device_);
+
+    // sets that only live for a frame, freed together once the frame's fence says the GPU is done with them
+    const DescriptorAllocatorGrowable::PoolSizeRatio frameSizes[] = {
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 3},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4},
+    };
+    for (unsigned int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        frames_[i].frameDescriptors_.init(device_, 1000, frameSizes);
+    }
 
-        vkDestroyDescriptorSetLayout(device_, drawImageDescriptorLayout_, nullptr);
-    });
+    mainDeletionQueue_.push(drawImageDescriptorLayout_);
+}
+
+void VulkanEngine::initPipelines() {
+    const auto start = std::chrono::steady_clock::now();
+
+    // the pref path is per user and writable wherever the game is installed
+    if (char* prefPath = SDL_GetPrefPath("gabkhanfig", "VoxelGame"); prefPath != nullptr) {
+        pipelineCachePath_ = std::string(prefPath) + "pipeline_cache.bin";
+        SDL_free(prefPath);
+    } else {
+        pipelineCachePath_ = "pipeline_cache.bin";
+    }
+    pipelineCache_ = vkutil::load_pipeline_cache(device_, chosenGPU_, pipelineCachePath_.c_str());
+
+    // layouts are cheap and created here, while each job loads its shaders and compiles one pipeline
+    initBackgroundPipelines();
+    initChunkPipeline();
+
+    jobSystem_->parallelFor(0, static_cast<uint32_t>(pipelines_.size()), 1,
+                            [&](uint32_t i) { *pipelines_[i].pipeline = pipelines_[i].build(); });
+
+    vkutil::save_pipeline_cache(device_, chosenGPU_, pipelineCache_, pipelineCachePath_.c_str());
+
+    startupTimes_.pipelines = milliseconds_since(start);
+    std::println("Built {} pipelines in {:.1f} ms", pipelines_.size(), startupTimes_.pipelines);
+
+#ifdef SHADER_HOT_RELOAD
+    shaderWatcher_.emplace(ASSET_PATH "shaders", GLSL_VALIDATOR_PATH);
+    lastShaderPoll_ = std::chrono::steady_clock::now();
+#endif
+}
+
+std::span<const uint32_t> VulkanEngine::shaderCode(std::string_view name) const {
+#ifdef SHADER_HOT_RELOAD
+    if (const auto found = reloadedShaders_.find(std::string(name)); found != reloadedShaders_.end()) {
+        return found->second;
+    }
+#endif
+    return embeddedShaders().find(name).value_or(std::span<const uint32_t>());
 }
 
-void VulkanEngine::initPipelines() { initBackgroundPipelines(); }
+#ifdef SHADER_HOT_RELOAD
+void VulkanEngine::reloadShaders() {
+    if (reloadingShaders_) {
+        if (!shaderJobs_.isDone()) {
+            return;
+        }
+        // the frame being recorded is the first to use the new pipelines, so the old ones go once it is done
+        for (const auto& [target, pipeline] : reloadedPipelines_) {
+            get_current_frame().deletionQueue_.push(*target);
+            *target = pipeline;
+        }
+        std::println("Reloaded {} pipelines", reloadedPipelines_.size());
+        reloadedPipelines_.clear();
+        reloadingShaders_ = false;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - lastShaderPoll_ < SHADER_POLL_INTERVAL) {
+        return;
+    }
+    lastShaderPoll_ = now;
+
+    std::vector<std::string> changed = shaderWatcher_->poll();
+    if (changed.empty()) {
+        return;
+    }
+
+    // compiling and building take far longer than a frame, so a worker does both while frames go on
+    reloadingShaders_ = true;
+    jobSystem_->submit(
+        [this, changed = std::move(changed)]() {
+            std::vector<std::string_view> compiled;
+            for (const std::string& name : changed) {
+                if (std::optional<std::vector<uint32_t>> code = shaderWatcher_->compile(name); code.has_value()) {
+                    reloadedShaders_[name] = std::move(*code);
+                    compiled.push_back(name);
+                }
+            }
+
+            for (const ReloadablePipeline& reloadable : pipelines_) {
+                const bool recompiled = std::ranges::any_of(reloadable.shaders, [&](std::string_view shader) {
+                    return std::ranges::find(compiled, shader) != compiled.end();
+                });
+                if (!recompiled) {
+                    continue;
+                }
+                // a pipeline that fails to build keeps the one it had
+                if (const VkPipeline pipeline = reloadable.build(); pipeline != VK_NULL_HANDLE) {
+                    reloadedPipelines_.emplace_back(reloadable.pipeline, pipeline);
+                }
+            }
+        },
+        &shaderJobs_, jobs::JobPriority::Low);
+}
+#endif
 
 void VulkanEngine::initBackgroundPipelines() {
     VkPipelineLayoutCreateInfo computeLayout{};
@@ -442,62 +1378,209 @@ void VulkanEngine::initBackgroundPipelines() {
 
     VK_CHECK(vkCreatePipelineLayout(device_, &computeLayout, nullptr, &gradientPipelineLayout_));
 
-    VkShaderModule gradientShader;
-    if (!vkutil::load_shader_module(ASSET_PATH "shaders/gradient_color.comp.spv", device_, &gradientShader)) {
-        std::println("Error when building the coloured compute shader");
-    }
-
-    VkShaderModule skyShader;
-    if (!vkutil::load_shader_module(ASSET_PATH "shaders/gradient_color.comp.spv", device_, &skyShader)) {
-        std::println("Error when building the coloured compute shader");
-    }
-
-    VkPipelineShaderStageCreateInfo stageinfo{};
-    stageinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    stageinfo.pNext = nullptr;
-    stageinfo.stage = VK_SHADER_STAGE_COMPUTE_BIT; // makes compute shader
-    stageinfo.module = gradientShader;
-    stageinfo.pName = "main"; // entry point
-
-    VkComputePipelineCreateInfo computePipelineCreateInfo{};
-    computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-    computePipelineCreateInfo.pNext = nullptr;
-    computePipelineCreateInfo.layout = gradientPipelineLayout_;
-    computePipelineCreateInfo.stage = stageinfo;
-
     ComputeEffect gradient;
     gradient.layout = gradientPipelineLayout_;
     gradient.name = "gradient";
+    gradient.pipeline = VK_NULL_HANDLE;
     gradient.data = {};
 
     gradient.data.data1 = glm::vec4(1, 0, 0, 1);
     gradient.data.data2 = glm::vec4(0, 0, 1, 1);
 
-    VK_CHECK(
-        vkCreateComputePipelines(device_, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &gradient.pipeline));
-
-    computePipelineCreateInfo.stage.module = skyShader;
-
     ComputeEffect sky;
     sky.layout = gradientPipelineLayout_;
     sky.name = "sky";
+    sky.pipeline = VK_NULL_HANDLE;
     sky.data = {};
     // default sky parameters
     sky.data.data1 = glm::vec4(0.1, 0.2, 0.4, 0.97);
 
-    VK_CHECK(vkCreateComputePipelines(device_, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &sky.pipeline));
-
+    // sized up front, as the jobs write the pipelines straight into it
     backgroundEffects_.push_back(gradient);
     backgroundEffects_.push_back(sky);
 
-    vkDestroyShaderModule(device_, gradientShader, nullptr);
-    vkDestroyShaderModule(device_, skyShader, nullptr);
+    const std::string_view shaderNames[] = {"gradient_color.comp", "sky.comp"};
+    for (size_t i = 0; i < backgroundEffects_.size(); i++) {
+        pipelines_.push_back(ReloadablePipeline{{shaderNames[i]}, [this, i, shaderName = shaderNames[i]]() {
+            VkShaderModule shader;
+            if (!vkutil::load_shader_module(shaderCode(shaderName), device_, &shader)) {
+                std::println("Error when building the {} compute shader", backgroundEffects_[i].name);
+                return VkPipeline(VK_NULL_HANDLE);
+            }
+
+            VkComputePipelineCreateInfo computePipelineCreateInfo{};
+            computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            computePipelineCreateInfo.pNext = nullptr;
+            computePipelineCreateInfo.layout = gradientPipelineLayout_;
+            computePipelineCreateInfo.stage =
+                vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, shader);
+
+            VkPipeline pipeline;
+            VK_CHECK(
+                vkCreateComputePipelines(device_, pipelineCache_, 1, &computePipelineCreateInfo, nullptr, &pipeline));
+
+            vkDestroyShaderModule(device_, shader, nullptr);
+            return pipeline;
+        }, &backgroundEffects_[i].pipeline});
+    }
+
+    // the pipelines themselves are destroyed through `pipelines_`, as hot reload replaces them
+    mainDeletionQueue_.push(gradientPipelineLayout_);
+}
+
+void VulkanEngine::initChunkPipeline() {
+    VkPushConstantRange bufferRange{};
+    bufferRange.offset = 0;
+    bufferRange.size = sizeof(ChunkPushConstants);
+    bufferRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // set 0 is the bindless set, bound once for the whole frame
+    const VkDescriptorSetLayout bindlessLayout = bindless_.layout();
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = vkinit::pipeline_layout_create_info();
+    pipelineLayoutInfo.pPushConstantRanges = &bufferRange;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &bindlessLayout;
+    pipelineLayoutInfo.setLayoutCount = 1;
+
+    VK_CHECK(vkCreatePipelineLayout(device_, &pipelineLayoutInfo, nullptr, &chunkPipelineLayout_));
+
+    VkPushConstantRange cullRange{};
+    cullRange.offset = 0;
+    cullRange.size = sizeof(CullPushConstants);
+    cullRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkPipelineLayoutCreateInfo cullLayoutInfo = vkinit::pipeline_layout_create_info();
+    cullLayoutInfo.pPushConstantRanges = &cullRange;
+    cullLayoutInfo.pushConstantRangeCount = 1;
+
+    VK_CHECK(vkCreatePipelineLayout(device_, &cullLayoutInfo, nullptr, &chunkCullPipelineLayout_));
+
+    chunkPipeline_ = VK_NULL_HANDLE;
+    chunkCullPipeline_ = VK_NULL_HANDLE;
+
+    pipelines_.push_back(ReloadablePipeline{{"chunk.vert", "chunk.frag"}, [this]() {
+        VkShaderModule chunkVertexShader;
+        if (!vkutil::load_shader_module(shaderCode("chunk.vert"), device_, &chunkVertexShader)) {
+            std::println("Error when building the chunk vertex shader");
+            return VkPipeline(VK_NULL_HANDLE);
+        }
+
+        VkShaderModule chunkFragmentShader;
+        if (!vkutil::load_shader_module(shaderCode("chunk.frag"), device_, &chunkFragmentShader)) {
+            std::println("Error when building the chunk fragment shader");
+            vkDestroyShaderModule(device_, chunkVertexShader, nullptr);
+            return VkPipeline(VK_NULL_HANDLE);
+        }
 
-    mainDeletionQueue_.pushFunction([&]() {
-        vkDestroyPipelineLayout(device_, gradientPipelineLayout_, nullptr);
-        vkDestroyPipeline(device_, sky.pipeline, nullptr);
-        vkDestroyPipeline(device_, gradient.pipeline, nullptr);
+        PipelineBuilder pipelineBuilder;
+        pipelineBuilder.pipelineLayout_ = chunkPipelineLayout_;
+        pipelineBuilder.setShaders(chunkVertexShader, chunkFragmentShader);
+        pipelineBuilder.setInputTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+        pipelineBuilder.setPolygonMode(VK_POLYGON_MODE_FILL);
+        // chunk.vert winds every face counter-clockwise seen from outside
+        pipelineBuilder.setCullMode(VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE);
+        pipelineBuilder.setMultisamplingNone();
+        pipelineBuilder.disableBlending();
+        pipelineBuilder.enableDepthtest(true, VK_COMPARE_OP_GREATER_OR_EQUAL);
+        pipelineBuilder.setColorAttachmentFormat(drawImage_.imageFormat);
+        pipelineBuilder.setDepthFormat(depthFormat_);
+
+        const VkPipeline pipeline = pipelineBuilder.buildPipeline(device_, pipelineCache_);
+
+        vkDestroyShaderModule(device_, chunkVertexShader, nullptr);
+        vkDestroyShaderModule(device_, chunkFragmentShader, nullptr);
+        return pipeline;
+    }, &chunkPipeline_});
+
+    pipelines_.push_back(ReloadablePipeline{{"chunk_cull.comp"}, [this]() {
+        VkShaderModule cullShader;
+        if (!vkutil::load_shader_module(shaderCode("chunk_cull.comp"), device_, &cullShader)) {
+            std::println("Error when building the chunk culling compute shader");
+            return VkPipeline(VK_NULL_HANDLE);
+        }
+
+        VkComputePipelineCreateInfo cullPipelineInfo{.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+        cullPipelineInfo.layout = chunkCullPipelineLayout_;
+        cullPipelineInfo.stage = vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, cullShader);
+
+        VkPipeline pipeline;
+        VK_CHECK(vkCreateComputePipelines(device_, pipelineCache_, 1, &cullPipelineInfo, nullptr, &pipeline));
+
+        vkDestroyShaderModule(device_, cullShader, nullptr);
+        return pipeline;
+    }, &chunkCullPipeline_});
+
+    mainDeletionQueue_.push(chunkPipelineLayout_);
+    mainDeletionQueue_.push(chunkCullPipelineLayout_);
+}
+
+void VulkanEngine::initChunkBuffers() {
+    chunkBuffer_ = createBuffer(sizeof(GpuChunk) * MAX_GPU_CHUNKS,
+                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                    VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                                VMA_MEMORY_USAGE_GPU_ONLY);
+    chunkBufferAddress_ = getBufferAddress(chunkBuffer_);
+
+    std::vector<uint32_t> indices;
+    mesh::buildQuadIndices(mesh::MAX_QUADS_PER_CHUNK, indices);
+    const size_t indexBufferSize = indices.size() * sizeof(uint32_t);
+
+    quadIndexBuffer_ = createBuffer(indexBufferSize,
+                                    VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    VMA_MEMORY_USAGE_GPU_ONLY);
+
+    AllocatedBuffer staging =
+        createBuffer(indexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+    std::memcpy(staging.info.pMappedData, indices.data(), indexBufferSize);
+
+    immediateSubmit([&](VkCommandBuffer cmd) {
+        VkBufferCopy copy{};
+        copy.dstOffset = 0;
+        copy.srcOffset = 0;
+        copy.size = indexBufferSize;
+        vkCmdCopyBuffer(cmd, staging.buffer, quadIndexBuffer_.buffer, 1, &copy);
+
+        // slots nobody has used yet are never culled, but start them empty anyway
+        vkCmdFillBuffer(cmd, chunkBuffer_.buffer, 0, VK_WHOLE_SIZE, 0);
     });
+
+    destroyBuffer(staging);
+
+    for (unsigned int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        frames_[i].sceneDataBuffer_ = createBuffer(sizeof(GpuSceneData),
+                                                   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                                                       VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                                                   VMA_MEMORY_USAGE_CPU_TO_GPU);
+        frames_[i].drawCommandBuffer_ = createBuffer(sizeof(VkDrawIndexedIndirectCommand) * MAX_GPU_CHUNKS,
+                                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                         VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                                         VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                                                     VMA_MEMORY_USAGE_GPU_ONLY);
+        frames_[i].drawCountBuffer_ = createBuffer(sizeof(uint32_t),
+                                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                       VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                                       VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                                       VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                                                   VMA_MEMORY_USAGE_GPU_ONLY);
+        frames_[i].visibleSlotBuffer_ = createBuffer(sizeof(uint32_t) * MAX_GPU_CHUNKS,
+                                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                         VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                                                     VMA_MEMORY_USAGE_CPU_TO_GPU);
+    }
+
+    const uint32_t queueFamilies[] = {graphicsQueueFamily_, uploadQueue_.queueFamily()};
+    chunkHeap_.init(device_, allocator_,
+                    std::span(queueFamilies, queueFamilies[0] == queueFamilies[1] ? 1 : 2));
+
+    mainDeletionQueue_.push(chunkBuffer_);
+    for (unsigned int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        mainDeletionQueue_.push(frames_[i].sceneDataBuffer_);
+        mainDeletionQueue_.push(frames_[i].drawCommandBuffer_);
+        mainDeletionQueue_.push(frames_[i].drawCountBuffer_);
+        mainDeletionQueue_.push(frames_[i].visibleSlotBuffer_);
+    }
+    mainDeletionQueue_.push(quadIndexBuffer_);
 }
 
 void VulkanEngine::initImgui() {
@@ -547,10 +1630,148 @@ void VulkanEngine::initImgui() {
 
     // ImGui_ImplVulkan_CreateFontsTexture(); no longer necessary supposedly
 
-    mainDeletionQueue_.pushFunction([=]() {
-        ImGui_ImplVulkan_Shutdown();
-        vkDestroyDescriptorPool(device_, imguiPool, nullptr);
-    });
+    // shut down in cleanup, before the queue destroys its pool
+    mainDeletionQueue_.push(imguiPool);
+}
+
+void VulkanEngine::initWorld() {
+    // twice as far as full resolution chunks alone could be drawn, with coarser levels of detail further out
+    constexpr int32_t RADIUS = 12;
+    constexpr int32_t MIN_Y = 0;
+    constexpr int32_t MAX_Y = 2;
+
+    std::vector<world::ChunkPos> positions;
+    for (int32_t y = MIN_Y; y <= MAX_Y; y++) {
+        for (int32_t z = -RADIUS; z <= RADIUS; z++) {
+            for (int32_t x = -RADIUS; x <= RADIUS; x++) {
+                positions.push_back(world::ChunkPos{x, y, z});
+            }
+        }
+    }
+
+    // creating chunks is not thread safe, filling them in is
+    std::vector<world::Chunk*> chunks;
+    chunks.reserve(positions.size());
+    for (const world::ChunkPos pos : positions) {
+        chunks.push_back(&world_.getOrCreateChunk(pos));
+        // how its faces connect is only known once it is meshed at full resolution
+        chunkVisibility_.setChunk(pos, mesh::ChunkVisibility::all());
+
+        const mesh::LodCell root = mesh::LodCell::containing(pos, mesh::LOD_LEVELS - 1);
+        if (std::none_of(lodRoots_.begin(), lodRoots_.end(), [&](const LodRoot& r) { return r.cell == root; })) {
+            lodRoots_.push_back(LodRoot{root, {}, {}});
+        }
+    }
+    const auto count = static_cast<uint32_t>(positions.size());
+    jobSystem_->parallelFor(0, count, 4, [&](uint32_t i) { terrain_.generate(*chunks[i]); });
+
+    // one mesher per worker, plus one for this thread, which helps out
+    const uint32_t mesherCount = jobSystem_->workerCount() + 1;
+    for (uint32_t i = 0; i < mesherCount; i++) {
+        lodMeshers_.push_back(std::make_unique<mesh::LodMesher>());
+    }
+
+    mainCamera_.position_ = glm::dvec3(0.5, terrain_.surfaceHeight(0, 0) + 8.0, 0.5);
+
+    // mesh what the camera starts out seeing before the first frame, which then swaps it in
+    updateChunkLods();
+    jobSystem_->wait(lodJobs_);
+    updateChunkLods();
+    uploadQueue_.flush();
+}
+
+void VulkanEngine::updateChunkLods() {
+    {
+        std::lock_guard lock(lodResultsMutex_);
+        std::swap(lodResults_, lodResultScratch_);
+    }
+    for (LodMeshResult& result : lodResultScratch_) {
+        const auto found = lodMeshes_.find(result.cell);
+        if (found == lodMeshes_.end()) {
+            // released while a worker was meshing it
+            continue;
+        }
+        found->second = uploadChunkMesh(result.cell, result.quads);
+        if (result.cell.level == 0) {
+            chunkVisibility_.setChunk(result.cell.pos, result.visibility);
+        }
+    }
+    lodResultScratch_.clear();
+
+    const auto ready = [&](mesh::LodCell cell) {
+        const auto found = lodMeshes_.find(cell);
+        return found != lodMeshes_.end() && found->second <= appliedUploadValue_;
+    };
+    const auto contains = [](const std::vector<mesh::LodCell>& cells, mesh::LodCell cell) {
+        return std::find(cells.begin(), cells.end(), cell) != cells.end();
+    };
+
+    for (LodRoot& root : lodRoots_) {
+        lodLeafScratch_.clear();
+        lodSelector_.select(mainCamera_.position_, root.cell, lodLeafScratch_);
+        if (lodLeafScratch_ != root.wanted) {
+            // cells wanted before, but neither drawn nor wanted now, are not needed after all
+            for (const mesh::LodCell cell : root.wanted) {
+                if (!contains(lodLeafScratch_, cell) && !contains(root.drawn, cell)) {
+                    releaseLodMesh(cell);
+                }
+            }
+            std::swap(root.wanted, lodLeafScratch_);
+            for (const mesh::LodCell cell : root.wanted) {
+                if (!lodMeshes_.contains(cell)) {
+                    requestLodMesh(cell);
+                }
+            }
+        }
+
+        if (root.drawn == root.wanted || !std::all_of(root.wanted.begin(), root.wanted.end(), ready)) {
+            continue;
+        }
+        for (const mesh::LodCell cell : root.drawn) {
+            if (!contains(root.wanted, cell)) {
+                if (cell.level == 0) {
+                    chunkVisibility_.setSlot(cell.pos, VisibilityGraph::NO_SLOT);
+                }
+                releaseLodMesh(cell);
+            }
+        }
+        root.drawn = root.wanted;
+        for (const mesh::LodCell cell : root.drawn) {
+            if (cell.level == 0) {
+                const auto found = chunkMeshes_.find(cell);
+                chunkVisibility_.setSlot(cell.pos, found != chunkMeshes_.end() ? found->second.slot.index
+                                                                               : VisibilityGraph::NO_SLOT);
+            }
+        }
+    }
+}
+
+void VulkanEngine::requestLodMesh(mesh::LodCell cell) {
+    lodMeshes_.emplace(cell, LOD_MESHING);
+    // the nearest cells matter most, and they are the finest
+    const jobs::JobPriority priority = cell.level == 0 ? jobs::JobPriority::Normal : jobs::JobPriority::Low;
+    jobSystem_->submit(
+        [this, cell]() {
+            uint32_t worker = jobs::JobSystem::currentWorkerIndex();
+            if (worker == jobs::JobSystem::NOT_A_WORKER) {
+                worker = static_cast<uint32_t>(lodMeshers_.size() - 1);
+            }
+            mesh::ChunkMesh chunkMesh;
+            lodMeshers_[worker]->mesh(world_, cell, chunkMesh);
+
+            LodMeshResult result{cell, {}, chunkMesh.visibility};
+            mesh::packMesh(chunkMesh, result.quads);
+            std::lock_guard lock(lodResultsMutex_);
+            lodResults_.push_back(std::move(result));
+        },
+        &lodJobs_, priority);
+}
+
+void VulkanEngine::releaseLodMesh(mesh::LodCell cell) {
+    if (lodMeshes_.erase(cell) != 0) {
+        // frees the slot, and the geometry once no frame draws it
+        uploadChunkMesh(cell, {});
+    }
 }
 
 void VulkanEngine::drawBackground(VkCommandBuffer cmd) {
@@ -576,6 +1797,237 @@ void VulkanEngine::drawBackground(VkCommandBuffer cmd) {
                   static_cast<uint32_t>(std::ceil(drawExtent_.height / 16.0)), 1);
 }
 
+void VulkanEngine::cullChunks(VkCommandBuffer cmd) {
+    FrameData& frame = get_current_frame();
+
+    // vulkan depth is 0 to 1, near and far are swapped for reversed depth, and y is flipped to match vulkan
+    glm::mat4 projection = glm::perspectiveRH_ZO(
+        glm::radians(70.f), static_cast<float>(drawExtent_.width) / static_cast<float>(drawExtent_.height), 10000.f,
+        0.1f);
+    projection[1][1] *= -1;
+
+    // the view matrix has no translation, everything is drawn relative to the camera
+    GpuSceneData sceneData;
+    sceneData.viewProj = projection * mainCamera_.getViewMatrix();
+    const glm::dvec3 cameraBlock = glm::floor(mainCamera_.position_);
+    sceneData.cameraBlock = glm::ivec4(glm::ivec3(cameraBlock), 0);
+    sceneData.cameraFraction = glm::vec4(glm::vec3(mainCamera_.position_ - cameraBlock), 0.f);
+    // the frame's fence was waited on, so the GPU is done with the last contents
+    std::memcpy(frame.sceneDataBuffer_.info.pMappedData, &sceneData, sizeof(GpuSceneData));
+
+    // only the chunks the camera may see get as far as the GPU
+    const Frustum frustum = Frustum::fromMatrix(sceneData.viewProj);
+    chunkVisibility_.findVisible(mainCamera_.position_, frustum, visibleSlots_);
+
+    // coarser cells are far away, so there are few of them, and only the frustum culls them
+    lodBoxes_.clear();
+    lodSlots_.clear();
+    for (const LodRoot& root : lodRoots_) {
+        for (const mesh::LodCell cell : root.drawn) {
+            const auto found = cell.level != 0 ? chunkMeshes_.find(cell) : chunkMeshes_.end();
+            if (found == chunkMeshes_.end()) {
+                continue;
+            }
+            const world::ChunkPos first = cell.firstChunk();
+            const glm::dvec3 min =
+                glm::dvec3(first.x, first.y, first.z) * double(world::CHUNK_SIZE) - mainCamera_.position_;
+            lodBoxes_.push(glm::vec3(min), glm::vec3(min + glm::dvec3(double(world::CHUNK_SIZE * cell.scale()))));
+            lodSlots_.push_back(found->second.slot.index);
+        }
+    }
+    lodInFrustum_.resize(lodSlots_.size());
+    frustum.cullAabbs(lodBoxes_, lodInFrustum_.data());
+    for (size_t i = 0; i < lodSlots_.size(); i++) {
+        if (lodInFrustum_[i] != 0) {
+            visibleSlots_.push_back(lodSlots_[i]);
+        }
+    }
+
+    const auto visibleCount = static_cast<uint32_t>(visibleSlots_.size());
+    std::memcpy(frame.visibleSlotBuffer_.info.pMappedData, visibleSlots_.data(), visibleCount * sizeof(uint32_t));
+
+    vkCmdFillBuffer(cmd, frame.drawCountBuffer_.buffer, 0, sizeof(uint32_t), 0);
+    // both halves are one render graph pass, so the count is ordered by hand
+    memory_barrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                   VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                   VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+    CullPushConstants pushConstants{};
+    pushConstants.sceneData = getBufferAddress(frame.sceneDataBuffer_);
+    pushConstants.chunkBuffer = chunkBufferAddress_;
+    pushConstants.drawBuffer = getBufferAddress(frame.drawCommandBuffer_);
+    pushConstants.countBuffer = getBufferAddress(frame.drawCountBuffer_);
+    pushConstants.visibleBuffer = getBufferAddress(frame.visibleSlotBuffer_);
+    pushConstants.visibleCount = visibleCount;
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, chunkCullPipeline_);
+    vkCmdPushConstants(cmd, chunkCullPipelineLayout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants),
+                       &pushConstants);
+
+    // 64 chunks per workgroup
+    if (visibleCount != 0) {
+        vkCmdDispatch(cmd, (visibleCount + 63) / 64, 1, 1);
+    }
+}
+
+void VulkanEngine::initBlockTextures() {
+    const auto layerCount = static_cast<uint32_t>(mesh::TEXTURE_NAMES.size());
+
+    std::vector<uint8_t> file;
+    if (std::ifstream in(ASSET_PATH "textures/blocks.dds", std::ios::binary); in.is_open()) {
+        file.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::optional<Bc7Texture> compressed = decodeBc7Dds(file);
+    if (compressed.has_value() && !textureCompressionBc_) {
+        std::println("Ignoring textures/blocks.dds, the device cannot sample BC7");
+        compressed.reset();
+    } else if (compressed.has_value() && compressed->layers != layerCount) {
+        std::println("Ignoring textures/blocks.dds, it has {} layers for {} block textures", compressed->layers,
+                     layerCount);
+        compressed.reset();
+    } else if (!compressed.has_value() && !file.empty()) {
+        std::println("Ignoring textures/blocks.dds, it is not an array of BC7 textures");
+    }
+
+    // compressed files bring their own mips, generated textures get theirs on the GPU
+    std::vector<uint32_t> pixels;
+    VkExtent3D extent{BLOCK_TEXTURE_SIZE, BLOCK_TEXTURE_SIZE, 1};
+    uint32_t mipLevels = mipLevelCount(BLOCK_TEXTURE_SIZE, BLOCK_TEXTURE_SIZE);
+    std::span<const uint8_t> data;
+    if (compressed.has_value()) {
+        extent = VkExtent3D{compressed->width, compressed->height, 1};
+        mipLevels = compressed->mipLevels;
+        data = compressed->data;
+        blockTextures_.imageFormat = compressed->srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+    } else {
+        pixels = generateBlockTextures(BLOCK_TEXTURE_SIZE);
+        data = std::span(reinterpret_cast<const uint8_t*>(pixels.data()), pixels.size() * sizeof(uint32_t));
+        // unorm like the colours they replace, as the draw image is shown without conversion
+        blockTextures_.imageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    }
+    blockTextures_.imageExtent = extent;
+
+    VkImageUsageFlags usages = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (!compressed.has_value()) {
+        usages |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    VkImageCreateInfo imageInfo = vkinit::image_create_info(blockTextures_.imageFormat, usages, extent);
+    imageInfo.mipLevels = mipLevels;
+    imageInfo.arrayLayers = layerCount;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    allocInfo.requiredFlags = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    VK_CHECK(vmaCreateImage(allocator_, &imageInfo, &allocInfo, &blockTextures_.image, &blockTextures_.allocation,
+                            nullptr));
+
+    VkImageViewCreateInfo viewInfo =
+        vkinit::imageview_create_info(blockTextures_.imageFormat, blockTextures_.image, VK_IMAGE_ASPECT_COLOR_BIT);
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    viewInfo.subresourceRange.levelCount = mipLevels;
+    viewInfo.subresourceRange.layerCount = layerCount;
+    VK_CHECK(vkCreateImageView(device_, &viewInfo, nullptr, &blockTextures_.imageView));
+
+    AllocatedBuffer staging = createBuffer(data.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+    std::memcpy(staging.info.pMappedData, data.data(), data.size());
+
+    // one copy per level of every layer, or just level 0 when the GPU makes the rest
+    std::vector<VkBufferImageCopy> copies;
+    for (uint32_t layer = 0; layer < layerCount; layer++) {
+        for (uint32_t level = 0; level < (compressed.has_value() ? mipLevels : 1); level++) {
+            VkBufferImageCopy copy{};
+            copy.bufferOffset = compressed.has_value()
+                                    ? compressed->levelOffset(layer, level)
+                                    : sizeof(uint32_t) * BLOCK_TEXTURE_SIZE * BLOCK_TEXTURE_SIZE * layer;
+            copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            copy.imageSubresource.mipLevel = level;
+            copy.imageSubresource.baseArrayLayer = layer;
+            copy.imageSubresource.layerCount = 1;
+            copy.imageExtent = VkExtent3D{std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u), 1};
+            copies.push_back(copy);
+        }
+    }
+
+    immediateSubmit([&](VkCommandBuffer cmd) {
+        vkutil::transition_image(cmd, blockTextures_.image, VK_IMAGE_LAYOUT_UNDEFINED,
+                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        vkCmdCopyBufferToImage(cmd, staging.buffer, blockTextures_.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(copies.size()), copies.data());
+        if (compressed.has_value()) {
+            vkutil::transition_image(cmd, blockTextures_.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        } else {
+            vkutil::generate_mipmaps(cmd, blockTextures_.image, VkExtent2D{extent.width, extent.height}, mipLevels,
+                                     layerCount);
+        }
+    });
+
+    destroyBuffer(staging);
+
+    // sharp texels up close, blended mips in the distance
+    VkSamplerCreateInfo samplerInfo{.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+    VK_CHECK(vkCreateSampler(device_, &samplerInfo, nullptr, &blockSampler_));
+
+    blockTextureIndex_ = bindless_.addTexture(blockTextures_.imageView, blockSampler_);
+
+    // its bindless slot is given back in cleanup
+    mainDeletionQueue_.push(blockTextures_.image, blockTextures_.allocation);
+    mainDeletionQueue_.push(blockTextures_.imageView);
+    mainDeletionQueue_.push(blockSampler_);
+}
+
+void VulkanEngine::drawChunks(VkCommandBuffer cmd, VkImageView depthView) {
+    FrameData& frame = get_current_frame();
+
+    VkRenderingAttachmentInfo colorAttachment =
+        vkinit::attachment_info(drawImage_.imageView, nullptr, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    VkRenderingAttachmentInfo depthAttachment =
+        vkinit::depth_attachment_info(depthView, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+
+    VkRenderingInfo renderInfo = vkinit::rendering_info(drawExtent_, &colorAttachment, &depthAttachment);
+    vkCmdBeginRendering(cmd, &renderInfo);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, chunkPipeline_);
+    bindless_.bind(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, chunkPipelineLayout_);
+    vkCmdBindIndexBuffer(cmd, quadIndexBuffer_.buffer, 0, VK_INDEX_TYPE_UINT32);
+
+    VkViewport viewport = {};
+    viewport.x = 0;
+    viewport.y = 0;
+    viewport.width = static_cast<float>(drawExtent_.width);
+    viewport.height = static_cast<float>(drawExtent_.height);
+    viewport.minDepth = 0.f;
+    viewport.maxDepth = 1.f;
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+
+    VkRect2D scissor = {};
+    scissor.offset.x = 0;
+    scissor.offset.y = 0;
+    scissor.extent.width = drawExtent_.width;
+    scissor.extent.height = drawExtent_.height;
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+    ChunkPushConstants pushConstants;
+    pushConstants.sceneData = getBufferAddress(frame.sceneDataBuffer_);
+    pushConstants.chunkBuffer = chunkBufferAddress_;
+    pushConstants.blockTextures = blockTextureIndex_;
+    vkCmdPushConstants(cmd, chunkPipelineLayout_, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+                       sizeof(ChunkPushConstants), &pushConstants);
+
+    // however many chunks are in view, this is the only draw
+    vkCmdDrawIndexedIndirectCount(cmd, frame.drawCommandBuffer_.buffer, 0, frame.drawCountBuffer_.buffer, 0,
+                                  chunkSlots_.highWater(), sizeof(VkDrawIndexedIndirectCommand));
+
+    vkCmdEndRendering(cmd);
+}
+
 void VulkanEngine::draw_imgui(VkCommandBuffer cmd, VkImageView targetImageView) {
     VkRenderingAttachmentInfo colorAttachment =
         vkinit::attachment_info(targetImageView, nullptr, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
@@ -1,35 +1,75 @@
 #pragma once
 
+#include "../../jobs/job_system.h"
+#include "../../mesh/chunk_lod.h"
+#include "../../mesh/packed_quad.h"
+#include "../../world/terrain.h"
+#include "../../world/world.h"
+#include "../camera.h"
+#include "../captured_image.h"
+#include "../frame_benchmark.h"
+#include "../frame_limiter.h"
+#include "../gpu_timings.h"
+#include "../launch_options.h"
+#include "../lod_selector.h"
+#include "../resolution_scaler.h"
+#include "../shader_watcher.h"
+#include "../slot_allocator.h"
+#include "../visibility_graph.h"
+#include "vk_bindless.h"
+#include "vk_command_pools.h"
+#include "vk_deletion_queue.h"
 #include "vk_descriptors.h"
+#include "vk_geometry_heap.h"
+#include "vk_render_graph.h"
+#include "vk_timestamps.h"
 #include "vk_types.h"
+#include "vk_upload.h"
+#include <array>
+#include <chrono>
 #include <cstdint>
 #include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <glm/mat4x4.hpp>
 #include <glm/vec4.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
-struct DeletionQueue {
-    std::deque<std::function<void()>> deletors;
-
-    void pushFunction(std::function<void()>&& function) { deletors.push_back(function); }
-
-    void flush() {
-        // reverse iterate the deletion queue to execute all the functions
-        for (auto it = deletors.rbegin(); it != deletors.rend(); it++) {
-            (*it)(); // call functors
-        }
-
-        deletors.clear();
-    }
-};
-
 struct FrameData {
     VkCommandPool commandPool_;
     VkCommandBuffer mainCommandBuffer_;
+    /// For the render graph passes recorded in parallel, a pool per worker
+    /// and one for the render thread.
+    SecondaryCommandPools secondaryPools_;
     VkSemaphore swapchainSemaphore_;
     VkSemaphore renderSemaphore_;
     VkFence renderFence_;
     DeletionQueue deletionQueue_;
+    /// Chunk geometry replaced while this frame was recorded, given back to
+    /// the heap once the frame is done drawing from it.
+    std::vector<GeometryAllocation> freedGeometry_;
+    /// For descriptor sets used by this frame only, all freed when the frame
+    /// comes round again.
+    DescriptorAllocatorGrowable frameDescriptors_;
+
+    /// Host visible `GpuSceneData`, written before the frame is recorded.
+    AllocatedBuffer sceneDataBuffer_;
+    /// A `VkDrawIndexedIndirectCommand` per visible chunk, written by the
+    /// culling shader.
+    AllocatedBuffer drawCommandBuffer_;
+    /// How many commands the culling shader wrote.
+    AllocatedBuffer drawCountBuffer_;
+    /// Host visible slots of the chunks that may be visible, which the
+    /// culling shader turns into draw commands.
+    AllocatedBuffer visibleSlotBuffer_;
+    /// Times each render graph pass, read when the frame comes round again.
+    GpuTimestamps timestamps_;
 };
 
 struct ComputePushConstants {
@@ -39,6 +79,18 @@ struct ComputePushConstants {
     glm::vec4 data4;
 };
 
+/// @brief A pipeline and how to build it, so it can be rebuilt when its
+/// shaders change.
+struct ReloadablePipeline {
+    /// File names of the shader sources it is built from.
+    std::vector<std::string_view> shaders;
+    /// @return The pipeline, or `VK_NULL_HANDLE` if its shaders failed to
+    /// load. Safe to call from any thread.
+    std::function<VkPipeline()> build;
+    /// Where the pipeline is read from when recording.
+    VkPipeline* pipeline;
+};
+
 struct ComputeEffect {
     const char* name;
     VkPipeline pipeline;
@@ -46,7 +98,108 @@ struct ComputeEffect {
     ComputePushConstants data;
 };
 
-constexpr unsigned int FRAME_OVERLAP = 2;
+/// @brief Per frame data read by the chunk shaders. Must match `SceneData`
+/// in `chunk_common.glsl`.
+struct GpuSceneData {
+    glm::mat4 viewProj;
+    /// The block the camera is in. `w` is unused.
+    glm::ivec4 cameraBlock;
+    /// The camera position within `cameraBlock`. `w` is unused.
+    glm::vec4 cameraFraction;
+};
+
+/// @brief A chunk slot as the GPU reads it. Must match `GpuChunk` in
+/// `chunk_common.glsl`.
+struct GpuChunk {
+    /// Position of the first chunk of its `mesh::LodCell` in chunks, and the
+    /// number of quads in `w`. Empty slots have no quads, and are skipped by
+    /// culling.
+    glm::ivec4 position;
+    /// Address of the chunk's `mesh::PackedQuad` buffer.
+    VkDeviceAddress quadBuffer;
+    /// The cell's level of detail, so each block of the mesh is `2^lod`
+    /// blocks across.
+    uint32_t lod;
+    uint32_t padding;
+};
+
+static_assert(sizeof(GpuChunk) == 32);
+
+/// @brief Must match the push constants of `chunk.vert`.
+struct ChunkPushConstants {
+    VkDeviceAddress sceneData;
+    VkDeviceAddress chunkBuffer;
+    /// Index of the block texture array in `bindlessTextures`.
+    uint32_t blockTextures;
+    uint32_t padding;
+};
+
+/// @brief Must match the push constants of `chunk_cull.comp`.
+struct CullPushConstants {
+    VkDeviceAddress sceneData;
+    VkDeviceAddress chunkBuffer;
+    VkDeviceAddress drawBuffer;
+    VkDeviceAddress countBuffer;
+    /// Address of the slots of the chunks `VisibilityGraph` found visible.
+    VkDeviceAddress visibleBuffer;
+    uint32_t visibleCount;
+};
+
+/// @brief The GPU copy of one chunk's mesh.
+struct ChunkMeshBuffer {
+    /// The chunk's `mesh::PackedQuad`s.
+    GeometryAllocation geometry;
+    /// Slot in `VulkanEngine::chunkBuffer_`.
+    SlotHandle slot;
+    uint32_t quadCount;
+};
+
+/// @brief A chunk mesh waiting for its upload to finish before its slot
+/// points at it.
+struct PendingChunkMesh {
+    mesh::LodCell cell;
+    /// No quads when the chunk's mesh is being removed.
+    ChunkMeshBuffer mesh;
+    /// `UploadQueue` timeline value at which the mesh has been copied.
+    uint64_t uploadValue;
+};
+
+/// @brief A level of detail cell meshed on a worker, waiting for the render
+/// thread to upload it.
+struct LodMeshResult {
+    mesh::LodCell cell;
+    std::vector<mesh::PackedQuad> quads;
+    mesh::ChunkVisibility visibility;
+};
+
+/// @brief The cells drawn within one of the coarsest level of detail cells.
+///
+/// When the camera moves, the cells wanted may change. They are meshed in the
+/// background, and only replace the cells drawn once all of them are ready,
+/// so nothing goes missing in between.
+struct LodRoot {
+    mesh::LodCell cell;
+    std::vector<mesh::LodCell> drawn;
+    std::vector<mesh::LodCell> wanted;
+};
+
+/// @brief Milliseconds spent on each part of startup.
+struct StartupTimes {
+    /// Creating the instance, device and allocator.
+    double vulkan = 0;
+    double pipelines = 0;
+    /// Generating, meshing and uploading the starting chunks.
+    double world = 0;
+    /// From the start of `VulkanEngine::init()` to presenting the first frame.
+    double firstFrame = 0;
+};
+
+/// How many chunks can have meshes on the GPU at once.
+constexpr uint32_t MAX_GPU_CHUNKS = 16384;
+
+/// How many frames can be recorded ahead of the GPU at most. How many
+/// actually are is `VulkanEngine::framesInFlight_`.
+constexpr unsigned int MAX_FRAMES_IN_FLIGHT = 3;
 
 class VulkanEngine {
   public:
@@ -54,22 +207,55 @@ class VulkanEngine {
     int frameNumber_ = 0;
     bool stopRendering_ = false;
     VkExtent2D windowExtent_{1700, 900};
+    /// Null when headless.
     struct SDL_Window* window_ = nullptr;
+    LaunchOptions options_;
+
+    jobs::JobSystem* jobSystem_ = nullptr; // shared worker pool, owned by the client
 
     VkInstance instance_;                     // library handle
     VkDebugUtilsMessengerEXT debugMessenger_; // debug stuff
     VkPhysicalDevice chosenGPU_;              // gpu chosen as default device
     VkDevice device_;                         // device for commands
-    VkSurfaceKHR surface_;                    // window surface
+    VkSurfaceKHR surface_ = VK_NULL_HANDLE;   // window surface, none when headless
 
     VkSwapchainKHR swapchain_;
     VkFormat swapchainImageFormat_;
+    /// The present mode asked for, and once the swapchain is built the one it
+    /// got, which falls back to FIFO where the mode is not supported.
+    VkPresentModeKHR presentMode_ = VK_PRESENT_MODE_FIFO_KHR;
+    std::vector<VkPresentModeKHR> supportedPresentModes_;
+    /// Set when the window changes size or the swapchain stops matching it,
+    /// so the next frame rebuilds it first.
+    bool resizeRequested_ = false;
 
     std::vector<VkImage> swapchainImages_;
     std::vector<VkImageView> swapchainImageViews_;
     VkExtent2D swapchainExtent_;
 
-    FrameData frames_[FRAME_OVERLAP];
+    FrameData frames_[MAX_FRAMES_IN_FLIGHT];
+    /// Fewer frames in flight lowers input latency, more keeps the GPU busier.
+    uint32_t framesInFlight_ = 2;
+    FrameLimiter frameLimiter_;
+
+    /// Nanoseconds per timestamp tick.
+    double timestampPeriod_ = 0;
+    /// `0` if the graphics queue cannot write timestamps.
+    uint32_t timestampValidBits_ = 0;
+    GpuTimingHistory gpuTimings_;
+    /// Scales `drawExtent_` to keep the GPU within the target frame rate.
+    ResolutionScaler resolutionScaler_;
+    /// How long each phase of the last `draw()` took on the CPU.
+    std::vector<PhaseTiming> cpuPhases_;
+    /// Of the physical device, written with benchmark results.
+    std::string deviceName_;
+
+    /// Set while a benchmark is recording, see `LaunchOptions::benchmarkPath`.
+    bool benchmarking_ = false;
+    /// Where the benchmark camera path starts.
+    glm::dvec3 benchmarkStart_{0.0};
+    FrameSeries benchmarkCpu_;
+    FrameSeries benchmarkGpu_;
 
     VkQueue graphicsQueue_;
     uint32_t graphicsQueueFamily_;
@@ -78,13 +264,50 @@ class VulkanEngine {
 
     VmaAllocator allocator_;
 
+    /// Rebuilt every frame to record the frame's passes and their barriers.
+    RenderGraph renderGraph_;
+
+    UploadQueue uploadQueue_;
+    /// The upload timeline value the frame being recorded has applied.
+    uint64_t uploadValue_ = 0;
+
     AllocatedImage drawImage_;
+    /// The depth buffer is a render graph transient the size of the draw image.
+    VkFormat depthFormat_ = VK_FORMAT_D32_SFLOAT;
+    /// The part of the draw image drawn to this frame, which the present copy
+    /// stretches over the swapchain image.
     VkExtent2D drawExtent_;
 
-    DescriptorAllocator globalDescriptorAllocator;
+    DescriptorAllocatorGrowable globalDescriptorAllocator;
+    /// Every texture and storage buffer that shaders index by number.
+    BindlessDescriptors bindless_;
     VkDescriptorSet drawImageDescriptors_;
     VkDescriptorSetLayout drawImageDescriptorLayout_;
 
+    /// Shared by every pipeline, and saved to `pipelineCachePath_` so later
+    /// runs skip compiling them again.
+    VkPipelineCache pipelineCache_;
+    std::string pipelineCachePath_;
+    /// Every pipeline built from shaders, pointing into the members that
+    /// hold them.
+    std::vector<ReloadablePipeline> pipelines_;
+
+#ifdef SHADER_HOT_RELOAD
+    /// How often the shader sources are checked for changes.
+    static constexpr std::chrono::milliseconds SHADER_POLL_INTERVAL{500};
+    std::optional<ShaderWatcher> shaderWatcher_;
+    std::chrono::steady_clock::time_point lastShaderPoll_;
+    /// SPIR-V compiled since startup, by source name, used in place of the
+    /// embedded shaders. Only the reload job writes it, while the main
+    /// thread leaves it alone.
+    std::unordered_map<std::string, std::vector<uint32_t>> reloadedShaders_;
+    jobs::JobCounter shaderJobs_;
+    bool reloadingShaders_ = false;
+    /// Built by the reload job, each with where it goes, to swap in once the
+    /// job is done.
+    std::vector<std::pair<VkPipeline*, VkPipeline>> reloadedPipelines_;
+#endif
+
     VkPipeline gradientPipeline_;
     VkPipelineLayout gradientPipelineLayout_;
 
@@ -95,26 +318,142 @@ class VulkanEngine {
     std::vector<ComputeEffect> backgroundEffects_;
     int currentBackgroundEffect_ = 0;
 
-    FrameData& get_current_frame() { return frames_[frameNumber_ % FRAME_OVERLAP]; };
+    VkPipeline chunkPipeline_;
+    VkPipelineLayout chunkPipelineLayout_;
+    VkPipeline chunkCullPipeline_;
+    VkPipelineLayout chunkCullPipelineLayout_;
+    /// A layer for each of `mesh::TEXTURE_NAMES`, with every mip level.
+    AllocatedImage blockTextures_;
+    VkSampler blockSampler_;
+    uint32_t blockTextureIndex_;
+    /// Whether BC7 textures can be sampled, so block textures can be loaded
+    /// precompressed.
+    bool textureCompressionBc_ = false;
+    /// Indices of `mesh::MAX_QUADS_PER_CHUNK` quads, shared by every chunk
+    /// draw since the quads themselves are pulled in the vertex shader.
+    AllocatedBuffer quadIndexBuffer_;
+    /// Every mesh with quads that has reached its slot, by level of detail cell.
+    std::unordered_map<mesh::LodCell, ChunkMeshBuffer, mesh::LodCellHash> chunkMeshes_;
+    /// Holds the quads of every chunk mesh.
+    GeometryHeap chunkHeap_;
+    /// The heap page being emptied, which new meshes avoid.
+    std::optional<uint32_t> compactingPage_;
+    /// Bytes of meshes moved to compact the heap, ever.
+    uint64_t compactedBytes_ = 0;
+    /// A `GpuChunk` for each of `MAX_GPU_CHUNKS` slots, which the GPU turns
+    /// into draw commands for the slots `chunkVisibility_` finds.
+    AllocatedBuffer chunkBuffer_;
+    VkDeviceAddress chunkBufferAddress_;
+    /// Which `chunkBuffer_` slots are in use. Slots are reused last freed
+    /// first, so culling can skip those above the high water mark.
+    SlotAllocator chunkSlots_{MAX_GPU_CHUNKS};
+    /// In upload order, which is also the order they finish in.
+    std::deque<PendingChunkMesh> pendingChunkMeshes_;
+    /// The upload timeline value of the last mesh put in its slot.
+    uint64_t appliedUploadValue_ = 0;
+    /// Every loaded chunk, for finding the visible ones drawn at full
+    /// resolution.
+    VisibilityGraph chunkVisibility_;
+    /// The slots found visible this frame.
+    std::vector<uint32_t> visibleSlots_;
+
+    /// Decides which level of detail cells to draw.
+    LodSelector lodSelector_{192.0};
+    std::vector<LodRoot> lodRoots_;
+    /// Every cell with a mesh wanted, and the `appliedUploadValue_` from
+    /// which the mesh is in its slot, or `LOD_MESHING` while a worker meshes
+    /// it.
+    std::unordered_map<mesh::LodCell, uint64_t, mesh::LodCellHash> lodMeshes_;
+    static constexpr uint64_t LOD_MESHING = UINT64_MAX;
+    /// One per worker, and one for the render thread when it helps out.
+    std::vector<std::unique_ptr<mesh::LodMesher>> lodMeshers_;
+    /// Counts the meshing jobs still running.
+    jobs::JobCounter lodJobs_;
+    std::mutex lodResultsMutex_;
+    /// Meshes finished by workers, guarded by `lodResultsMutex_`.
+    std::vector<LodMeshResult> lodResults_;
+    std::vector<LodMeshResult> lodResultScratch_;
+    std::vector<mesh::LodCell> lodLeafScratch_;
+    /// Boxes and slots of the coarser cells drawn, for frustum culling.
+    AabbSoA lodBoxes_;
+    std::vector<uint32_t> lodSlots_;
+    std::vector<uint8_t> lodInFrustum_;
+
+    world::World world_;
+    world::TerrainGenerator terrain_;
+    Camera mainCamera_;
+
+    struct RetiredSwapchain {
+        VkSwapchainKHR swapchain;
+        std::vector<VkImageView> imageViews;
+        /// The first frame drawn to its replacement.
+        int retiredFrame;
+    };
+    std::vector<RetiredSwapchain> retiredSwapchains_;
+
+    std::chrono::steady_clock::time_point initStart_;
+    StartupTimes startupTimes_;
+
+    FrameData& get_current_frame() { return frames_[frameNumber_ % framesInFlight_]; };
 
     static VulkanEngine& get();
 
-    void init();
+    void init(jobs::JobSystem& jobSystem, const LaunchOptions& options);
 
     void cleanup();
 
     void draw();
 
-    void run();
+    /// @return The exit code of the client, which is not 0 if a headless
+    /// frame did not match the image it was compared against.
+    int run();
+
+    /// @brief Waits for the frames in flight to finish, then keeps up to
+    /// `count` in flight from the next frame on. Call between frames.
+    void setFramesInFlight(uint32_t count);
+
+    /// @brief Rebuilds the swapchain with `mode` at the next frame, or FIFO
+    /// if the surface does not support it.
+    void setPresentMode(VkPresentModeKHR mode);
 
     void immediateSubmit(std::function<void(VkCommandBuffer cmd)>&& function);
 
+    AllocatedBuffer createBuffer(size_t allocSize, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage);
+
+    void destroyBuffer(const AllocatedBuffer& buffer);
+
+    /// @return The device address of a buffer created with
+    /// `VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT`.
+    VkDeviceAddress getBufferAddress(const AllocatedBuffer& buffer);
+
+    /// @brief Starts uploading the mesh of a level of detail cell without
+    /// waiting for it. Once the upload has finished, a later frame points the
+    /// cell's GPU slot at it, replacing any mesh it had. An empty mesh frees
+    /// the slot.
+    /// @return The upload timeline value from which `appliedUploadValue_`
+    /// says the mesh is in its slot.
+    uint64_t uploadChunkMesh(mesh::LodCell cell, std::span<const mesh::PackedQuad> quads);
+
   private:
     void initVulkan();
 
     void initSwapchain();
 
-    void createSwapchain(uint32_t width, uint32_t height);
+    /// @param oldSwapchain The swapchain being replaced, which the new one
+    /// may take resources over from.
+    void createSwapchain(uint32_t width, uint32_t height, VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
+
+    /// @brief Replaces the swapchain with one matching the window, without
+    /// waiting for the device. The old one is destroyed once the frames
+    /// using it have finished.
+    void recreateSwapchain();
+
+    /// @brief Destroys the replaced swapchains no frame in flight uses.
+    /// @param all Destroys them all, once the device is idle.
+    void destroyRetiredSwapchains(bool all);
+
+    /// @brief Destroys what `frame` deferred, once the GPU is done with it.
+    void flushDeletions(FrameData& frame);
 
     void destroySwapchain();
 
@@ -124,13 +463,98 @@ class VulkanEngine {
 
     void initDescriptors();
 
+    /// @brief Creates every pipeline, compiling them in parallel on the job
+    /// system through the pipeline cache.
     void initPipelines();
 
+    /// @brief Creates the layouts of the background effects, and adds each
+    /// effect's pipeline to `pipelines_` to be built.
     void initBackgroundPipelines();
 
+    /// @brief Creates the layouts of the chunk pipelines, and adds the
+    /// pipelines to `pipelines_` to be built.
+    void initChunkPipeline();
+
+    /// @return The SPIR-V of the shader compiled from the source `name`, or
+    /// empty if there is none.
+    std::span<const uint32_t> shaderCode(std::string_view name) const;
+
+#ifdef SHADER_HOT_RELOAD
+    /// @brief Swaps in the pipelines rebuilt by the last reload once they
+    /// are ready, and starts recompiling any shader sources that changed
+    /// since. Called while recording starts, so a frame never sees a swap
+    /// halfway through.
+    void reloadShaders();
+#endif
+
+    void initChunkBuffers();
+
+    /// @brief Loads the block textures into one array image, from
+    /// `textures/blocks.dds` where the device can sample BC7 and otherwise
+    /// generated, with their mips made on the GPU.
+    void initBlockTextures();
+
+    /// @brief Generates the chunks around the origin and uploads their meshes.
+    void initWorld();
+
+    /// @brief Uploads the meshes workers have finished, picks the level of
+    /// detail cells to draw, starts meshing the ones missing, and swaps in
+    /// the cells of each `LodRoot` whose meshes are all ready.
+    void updateChunkLods();
+
+    /// @brief Meshes `cell` on a worker, adding it to `lodResults_`.
+    void requestLodMesh(mesh::LodCell cell);
+
+    /// @brief Frees the mesh of `cell`, if it has one.
+    void releaseLodMesh(mesh::LodCell cell);
+
     void initImgui();
 
+    /// @brief Draws `LaunchOptions::frames` frames without a window, then
+    /// captures and compares the last as the options ask.
+    /// @return As for `run()`.
+    int runHeadless();
+
+    /// @brief Copies what the draw image holds back to the CPU, waiting for
+    /// the device first.
+    CapturedImage captureDrawImage();
+
+    /// @brief Puts the camera where the benchmark path is at the next frame.
+    void stepBenchmarkCamera();
+
+    /// @brief Adds the frame that started at `frameStart` to the benchmark.
+    /// @return True once `LaunchOptions::frames` frames have been added.
+    bool addBenchmarkFrame(std::chrono::steady_clock::time_point frameStart);
+
+    /// @brief Stops recording, reads the GPU times of the frames still in
+    /// flight, and writes the results.
+    /// @return False if the results could not be written.
+    bool finishBenchmark();
+
+    /// @return True once every level of detail cell wanted is meshed and
+    /// drawn, so the frames that follow only change if the camera moves.
+    bool chunkLodsSettled();
+
     void drawBackground(VkCommandBuffer cmd);
 
+    /// @brief Adds the passes of a frame to `renderGraph_`.
+    /// @param swapchainImageIndex The image to present to, or empty when
+    /// headless, which leaves the frame in the draw image.
+    void buildRenderGraph(std::optional<uint32_t> swapchainImageIndex);
+
+    /// @brief Points chunk slots at the meshes whose uploads have finished,
+    /// and destroys the meshes they replace once no frame uses them.
+    void applyChunkUploads(VkCommandBuffer cmd);
+
+    /// @brief Moves a few meshes out of a mostly empty heap page, so it
+    /// can be freed once empty.
+    void compactChunkHeap(VkCommandBuffer cmd);
+
+    /// @brief Finds the chunks that may be visible and writes their draw
+    /// commands, for `drawChunks()`.
+    void cullChunks(VkCommandBuffer cmd);
+
+    void drawChunks(VkCommandBuffer cmd, VkImageView depthView);
+
     void draw_imgui(VkCommandBuffer cmd, VkImageView targetImageView);
 };
\ No newline at end of file
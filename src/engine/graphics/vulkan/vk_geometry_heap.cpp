@@ -0,0 +1,162 @@
+#include "vk_geometry_heap.h"
+#include <cassert>
+
+namespace {
+/// Pages using less than this fraction of their space are emptied into the
+/// others.
+constexpr float COMPACTION_THRESHOLD = 0.25f;
+} // namespace
+
+void GeometryHeap::init(VkDevice device, VmaAllocator allocator, std::span<const uint32_t> queueFamilies) {
+    device_ = device;
+    allocator_ = allocator;
+    assert(!queueFamilies.empty() && queueFamilies.size() <= queueFamilies_.size());
+    queueFamilyCount_ = static_cast<uint32_t>(queueFamilies.size());
+    for (uint32_t i = 0; i < queueFamilyCount_; i++) {
+        queueFamilies_[i] = queueFamilies[i];
+    }
+
+    if (!createPage(0)) {
+        std::println("Failed to create the first chunk geometry page");
+        abort();
+    }
+}
+
+void GeometryHeap::destroy() {
+    for (uint32_t i = 0; i < MAX_PAGES; i++) {
+        if (pages_[i].ranges) {
+            destroyPage(i);
+        }
+    }
+}
+
+std::optional<GeometryAllocation> GeometryHeap::allocate(uint32_t size, std::optional<uint32_t> avoidPage) {
+    for (uint32_t i = 0; i < MAX_PAGES; i++) {
+        if (pages_[i].ranges && i != avoidPage) {
+            if (auto allocation = allocateFrom(i, size)) {
+                return allocation;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < MAX_PAGES; i++) {
+        if (!pages_[i].ranges && createPage(i)) {
+            return allocateFrom(i, size);
+        }
+    }
+    if (avoidPage.has_value() && pages_[*avoidPage].ranges) {
+        return allocateFrom(*avoidPage, size);
+    }
+    return std::nullopt;
+}
+
+std::optional<GeometryAllocation> GeometryHeap::allocateOutside(uint32_t page, uint32_t size) {
+    for (uint32_t i = 0; i < MAX_PAGES; i++) {
+        if (pages_[i].ranges && i != page) {
+            if (auto allocation = allocateFrom(i, size)) {
+                return allocation;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+void GeometryHeap::free(const GeometryAllocation& allocation) {
+    Page& page = pages_[allocation.page];
+    assert(page.ranges && "freeing geometry of a destroyed page");
+    page.ranges->free(allocation.range);
+
+    // the first page stays, so loading a single chunk never creates a buffer
+    if (allocation.page != 0 && page.ranges->allocationCount() == 0) {
+        destroyPage(allocation.page);
+    }
+}
+
+std::optional<uint32_t> GeometryHeap::compactionCandidate() const {
+    std::optional<uint32_t> emptiest;
+    uint64_t emptiestUsed = 0;
+    uint64_t totalFree = 0;
+    for (uint32_t i = 0; i < MAX_PAGES; i++) {
+        if (!pages_[i].ranges) {
+            continue;
+        }
+        const TlsfAllocator::Stats stats = pages_[i].ranges->stats();
+        totalFree += stats.freeBytes;
+        if (i != 0 && (!emptiest.has_value() || stats.usedBytes < emptiestUsed)) {
+            emptiest = i;
+            emptiestUsed = stats.usedBytes;
+        }
+    }
+    if (!emptiest.has_value()) {
+        return std::nullopt;
+    }
+
+    const uint64_t freeElsewhere = totalFree - (PAGE_SIZE - emptiestUsed);
+    // leave half the free space elsewhere spare, as it is fragmented
+    if (emptiestUsed > PAGE_SIZE * COMPACTION_THRESHOLD || emptiestUsed * 2 > freeElsewhere) {
+        return std::nullopt;
+    }
+    return emptiest;
+}
+
+GeometryHeapStats GeometryHeap::stats() const {
+    GeometryHeapStats stats{};
+    for (const Page& page : pages_) {
+        if (!page.ranges) {
+            continue;
+        }
+        const TlsfAllocator::Stats pageStats = page.ranges->stats();
+        stats.pageCount += 1;
+        stats.capacity += PAGE_SIZE;
+        stats.usedBytes += pageStats.usedBytes;
+        stats.allocationCount += pageStats.allocationCount;
+        stats.freeBlockCount += pageStats.freeBlockCount;
+        if (pageStats.largestFreeBlock > stats.largestFreeBlock) {
+            stats.largestFreeBlock = pageStats.largestFreeBlock;
+        }
+    }
+    return stats;
+}
+
+bool GeometryHeap::createPage(uint32_t index) {
+    VkBufferCreateInfo bufferInfo = {.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    bufferInfo.size = PAGE_SIZE;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                       VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    if (queueFamilyCount_ > 1) {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = queueFamilyCount_;
+        bufferInfo.pQueueFamilyIndices = queueFamilies_.data();
+    }
+
+    VmaAllocationCreateInfo vmaallocInfo = {};
+    vmaallocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    // each page is big enough to be worth a block of its own
+    vmaallocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+    Page& page = pages_[index];
+    if (vmaCreateBuffer(allocator_, &bufferInfo, &vmaallocInfo, &page.buffer.buffer, &page.buffer.allocation,
+                        &page.buffer.info) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkBufferDeviceAddressInfo addressInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO};
+    addressInfo.buffer = page.buffer.buffer;
+    page.address = vkGetBufferDeviceAddress(device_, &addressInfo);
+    page.ranges = std::make_unique<TlsfAllocator>(PAGE_SIZE, 16);
+    return true;
+}
+
+void GeometryHeap::destroyPage(uint32_t index) {
+    Page& page = pages_[index];
+    vmaDestroyBuffer(allocator_, page.buffer.buffer, page.buffer.allocation);
+    page.ranges.reset();
+}
+
+std::optional<GeometryAllocation> GeometryHeap::allocateFrom(uint32_t index, uint32_t size) {
+    const Page& page = pages_[index];
+    const std::optional<TlsfAllocator::Allocation> range = page.ranges->allocate(size);
+    if (!range.has_value()) {
+        return std::nullopt;
+    }
+    return GeometryAllocation{index, *range, page.buffer.buffer, page.address + range->offset};
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../tlsf_allocator.h"
+#include "vk_types.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+
+/// @brief A range of a `GeometryHeap` page.
+struct GeometryAllocation {
+    uint32_t page;
+    TlsfAllocator::Allocation range;
+    VkBuffer buffer;
+    VkDeviceAddress address;
+};
+
+struct GeometryHeapStats {
+    uint32_t pageCount;
+    uint64_t capacity;
+    uint64_t usedBytes;
+    uint32_t allocationCount;
+    uint32_t freeBlockCount;
+    /// Largest free block of any page.
+    uint64_t largestFreeBlock;
+};
+
+/// @brief Chunk geometry sub-allocated from a few large device local
+/// buffers, rather than one buffer and allocation per chunk.
+///
+/// Each page is one `PAGE_SIZE` buffer with a `TlsfAllocator` over it. Pages
+/// are added when no page has room, and destroyed once they are empty, except
+/// for the first.
+///
+/// Freeing is immediate, so frees of geometry the GPU may still be reading
+/// must be deferred until the frames using it have finished, for example
+/// through `FrameData::freedGeometry_`.
+///
+/// # Thread Safety
+///
+/// Not thread safe.
+class GeometryHeap {
+  public:
+    static constexpr uint32_t PAGE_SIZE = 64u * 1024 * 1024;
+    static constexpr uint32_t MAX_PAGES = 16;
+
+    /// @param queueFamilies Every queue family that uses the geometry. Pages
+    /// are shared concurrently if there is more than one.
+    void init(VkDevice device, VmaAllocator allocator, std::span<const uint32_t> queueFamilies);
+
+    void destroy();
+
+    /// @return `size` bytes of geometry, or empty if every page is full and
+    /// no more can be made.
+    /// @param avoidPage A page to only use as a last resort.
+    std::optional<GeometryAllocation> allocate(uint32_t size, std::optional<uint32_t> avoidPage = std::nullopt);
+
+    /// @return `size` bytes of geometry in an existing page other than
+    /// `page`, or empty if none has room.
+    std::optional<GeometryAllocation> allocateOutside(uint32_t page, uint32_t size);
+
+    void free(const GeometryAllocation& allocation);
+
+    /// @return A page worth emptying by moving its geometry into the others,
+    /// if one is both mostly empty and fits in the free space of the rest.
+    std::optional<uint32_t> compactionCandidate() const;
+
+    GeometryHeapStats stats() const;
+
+  private:
+    struct Page {
+        AllocatedBuffer buffer;
+        VkDeviceAddress address;
+        std::unique_ptr<TlsfAllocator> ranges;
+    };
+
+    bool createPage(uint32_t index);
+
+    void destroyPage(uint32_t index);
+
+    std::optional<GeometryAllocation> allocateFrom(uint32_t index, uint32_t size);
+
+    VkDevice device_;
+    VmaAllocator allocator_;
+    std::array<uint32_t, 2> queueFamilies_;
+    uint32_t queueFamilyCount_;
+
+    /// Pages without `ranges` are not created.
+    std::array<Page, MAX_PAGES> pages_;
+};
@@ -7,4 +7,11 @@ void transition_image(VkCommandBuffer cmd, VkImage image, VkImageLayout currentL
 
 void copy_image_to_image(VkCommandBuffer cmd, VkImage source, VkImage destination, VkExtent2D srcSize,
                          VkExtent2D dstSize);
+
+/// @brief Fills every mip level of `image` from level 0, each level of every
+/// layer with a single blit. The image must be in
+/// `VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL`, and is left in
+/// `VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL`.
+void generate_mipmaps(VkCommandBuffer cmd, VkImage image, VkExtent2D imageSize, uint32_t mipLevels,
+                      uint32_t layerCount);
 } // namespace vkutil
\ No newline at end of file
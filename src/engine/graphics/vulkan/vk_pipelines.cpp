@@ -1,43 +1,42 @@
 #include "vk_pipelines.h"
+#include "../pipeline_cache_file.h"
 #include "vk_initializers.h"
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <iterator>
+#include <string>
 #include <vector>
 
-bool vkutil::load_shader_module(const char* filePath, VkDevice device, VkShaderModule* outShaderModule) {
-    // open the file. With cursor at the end
-    std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+namespace {
+PipelineCacheKey pipeline_cache_key(VkPhysicalDevice gpu) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(gpu, &properties);
 
-    if (!file.is_open()) {
+    PipelineCacheKey key{};
+    key.vendorId = properties.vendorID;
+    key.deviceId = properties.deviceID;
+    key.driverVersion = properties.driverVersion;
+    std::memcpy(key.cacheUuid.data(), properties.pipelineCacheUUID, VK_UUID_SIZE);
+    return key;
+}
+} // namespace
+
+bool vkutil::load_shader_module(std::span<const uint32_t> code, VkDevice device, VkShaderModule* outShaderModule) {
+    if (code.empty()) {
         return false;
     }
 
-    // find what the size of the file is by looking up the location of the cursor
-    // because the cursor is at the end, it gives the size directly in bytes
-    size_t fileSize = (size_t)file.tellg();
-
-    // spirv expects the buffer to be on uint32, so make sure to reserve a int
-    // vector big enough for the entire file
-    std::vector<uint32_t> buffer(fileSize / sizeof(uint32_t));
-
-    // put file cursor at beginning
-    file.seekg(0);
-
-    // load the entire file into the buffer
-    file.read((char*)buffer.data(), fileSize);
-
-    // now that the file is loaded into the buffer, we can close it
-    file.close();
-
-    // create a new shader module, using the buffer we loaded
+    // create a new shader module, using the code we were given
     VkShaderModuleCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
     createInfo.pNext = nullptr;
 
-    // codeSize has to be in bytes, so multply the ints in the buffer by size of
-    // int to know the real size of the buffer
-    createInfo.codeSize = buffer.size() * sizeof(uint32_t);
-    createInfo.pCode = buffer.data();
+    // codeSize has to be in bytes, so multply the ints in the code by size of
+    // int to know the real size of the code
+    createInfo.codeSize = code.size() * sizeof(uint32_t);
+    createInfo.pCode = code.data();
 
     // check that the creation goes well.
     VkShaderModule shaderModule;
@@ -47,3 +46,184 @@ bool vkutil::load_shader_module(const char* filePath, VkDevice device, VkShaderM
     *outShaderModule = shaderModule;
     return true;
 }
+
+VkPipelineCache vkutil::load_pipeline_cache(VkDevice device, VkPhysicalDevice gpu, const char* filePath) {
+    std::vector<uint8_t> file;
+    if (std::ifstream in(filePath, std::ios::binary); in.is_open()) {
+        file.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    VkPipelineCacheCreateInfo createInfo = {.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    const auto data = decodePipelineCache(pipeline_cache_key(gpu), file);
+    if (data.has_value()) {
+        createInfo.initialDataSize = data->size();
+        createInfo.pInitialData = data->data();
+    } else if (!file.empty()) {
+        std::println("Ignoring pipeline cache {}, it is from another device or driver", filePath);
+    }
+
+    VkPipelineCache cache;
+    if (vkCreatePipelineCache(device, &createInfo, nullptr, &cache) != VK_SUCCESS) {
+        // the driver may still refuse data that passed our checks, so fall back to an empty cache
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+        VK_CHECK(vkCreatePipelineCache(device, &createInfo, nullptr, &cache));
+    }
+    return cache;
+}
+
+void vkutil::save_pipeline_cache(VkDevice device, VkPhysicalDevice gpu, VkPipelineCache cache,
+                                 const char* filePath) {
+    size_t size = 0;
+    VK_CHECK(vkGetPipelineCacheData(device, cache, &size, nullptr));
+    std::vector<uint8_t> data(size);
+    VK_CHECK(vkGetPipelineCacheData(device, cache, &size, data.data()));
+    data.resize(size);
+
+    const std::vector<uint8_t> file = encodePipelineCache(pipeline_cache_key(gpu), data);
+    const std::string tempPath = std::string(filePath) + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            std::println("Failed to write the pipeline cache to {}", tempPath);
+            return;
+        }
+        out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+        if (!out.good()) {
+            std::println("Failed to write the pipeline cache to {}", tempPath);
+            return;
+        }
+    }
+    // rename replaces the old file in one step where it can, but Windows wants it gone first
+    if (std::rename(tempPath.c_str(), filePath) != 0 &&
+        (std::remove(filePath) != 0 || std::rename(tempPath.c_str(), filePath) != 0)) {
+        std::println("Failed to replace the pipeline cache at {}", filePath);
+    }
+}
+
+void PipelineBuilder::clear() {
+    inputAssembly_ = {.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+    rasterizer_ = {.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+    colorBlendAttachment_ = {};
+    multisampling_ = {.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
+    pipelineLayout_ = {};
+    depthStencil_ = {.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO};
+    renderInfo_ = {.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO};
+    colorAttachmentformat_ = VK_FORMAT_UNDEFINED;
+    shaderStages_.clear();
+}
+
+VkPipeline PipelineBuilder::buildPipeline(VkDevice device, VkPipelineCache cache) {
+    VkPipelineViewportStateCreateInfo viewportState = {.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+    viewportState.pNext = nullptr;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    // no blending is used, but the attachment still needs its write mask
+    VkPipelineColorBlendStateCreateInfo colorBlending = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
+    colorBlending.pNext = nullptr;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.logicOp = VK_LOGIC_OP_COPY;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment_;
+
+    // vertices are pulled from buffers in the shaders, so there is no vertex input
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+
+    VkDynamicState state[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicInfo = {.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+    dynamicInfo.pDynamicStates = &state[0];
+    dynamicInfo.dynamicStateCount = 2;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo = {.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+    // dynamic rendering takes the attachment formats through pNext instead of a render pass
+    pipelineInfo.pNext = &renderInfo_;
+    pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages_.size());
+    pipelineInfo.pStages = shaderStages_.data();
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly_;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer_;
+    pipelineInfo.pMultisampleState = &multisampling_;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDepthStencilState = &depthStencil_;
+    pipelineInfo.pDynamicState = &dynamicInfo;
+    pipelineInfo.layout = pipelineLayout_;
+
+    VkPipeline newPipeline;
+    if (vkCreateGraphicsPipelines(device, cache, 1, &pipelineInfo, nullptr, &newPipeline) != VK_SUCCESS) {
+        std::println("failed to create pipeline");
+        return VK_NULL_HANDLE;
+    }
+    return newPipeline;
+}
+
+void PipelineBuilder::setShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader) {
+    shaderStages_.clear();
+    shaderStages_.push_back(vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_VERTEX_BIT, vertexShader));
+    shaderStages_.push_back(vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader));
+}
+
+void PipelineBuilder::setInputTopology(VkPrimitiveTopology topology) {
+    inputAssembly_.topology = topology;
+    inputAssembly_.primitiveRestartEnable = VK_FALSE;
+}
+
+void PipelineBuilder::setPolygonMode(VkPolygonMode mode) {
+    rasterizer_.polygonMode = mode;
+    rasterizer_.lineWidth = 1.f;
+}
+
+void PipelineBuilder::setCullMode(VkCullModeFlags cullMode, VkFrontFace frontFace) {
+    rasterizer_.cullMode = cullMode;
+    rasterizer_.frontFace = frontFace;
+}
+
+void PipelineBuilder::setMultisamplingNone() {
+    multisampling_.sampleShadingEnable = VK_FALSE;
+    multisampling_.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling_.minSampleShading = 1.0f;
+    multisampling_.pSampleMask = nullptr;
+    multisampling_.alphaToCoverageEnable = VK_FALSE;
+    multisampling_.alphaToOneEnable = VK_FALSE;
+}
+
+void PipelineBuilder::disableBlending() {
+    colorBlendAttachment_.colorWriteMask =
+        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment_.blendEnable = VK_FALSE;
+}
+
+void PipelineBuilder::setColorAttachmentFormat(VkFormat format) {
+    colorAttachmentformat_ = format;
+    renderInfo_.colorAttachmentCount = 1;
+    renderInfo_.pColorAttachmentFormats = &colorAttachmentformat_;
+}
+
+void PipelineBuilder::setDepthFormat(VkFormat format) { renderInfo_.depthAttachmentFormat = format; }
+
+void PipelineBuilder::disableDepthtest() {
+    depthStencil_.depthTestEnable = VK_FALSE;
+    depthStencil_.depthWriteEnable = VK_FALSE;
+    depthStencil_.depthCompareOp = VK_COMPARE_OP_NEVER;
+    depthStencil_.depthBoundsTestEnable = VK_FALSE;
+    depthStencil_.stencilTestEnable = VK_FALSE;
+    depthStencil_.front = {};
+    depthStencil_.back = {};
+    depthStencil_.minDepthBounds = 0.f;
+    depthStencil_.maxDepthBounds = 1.f;
+}
+
+void PipelineBuilder::enableDepthtest(bool depthWriteEnable, VkCompareOp op) {
+    depthStencil_.depthTestEnable = VK_TRUE;
+    depthStencil_.depthWriteEnable = depthWriteEnable;
+    depthStencil_.depthCompareOp = op;
+    depthStencil_.depthBoundsTestEnable = VK_FALSE;
+    depthStencil_.stencilTestEnable = VK_FALSE;
+    depthStencil_.front = {};
+    depthStencil_.back = {};
+    depthStencil_.minDepthBounds = 0.f;
+    depthStencil_.maxDepthBounds = 1.f;
+}
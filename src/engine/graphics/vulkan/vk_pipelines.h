@@ -1,7 +1,66 @@
 #pragma once
 
 #include "vk_types.h"
+#include <span>
+#include <vector>
 
 namespace vkutil {
-bool load_shader_module(const char* filePath, VkDevice device, VkShaderModule* outShaderModule);
-}
\ No newline at end of file
+/// @param code SPIR-V, such as from `embeddedShaders()`.
+bool load_shader_module(std::span<const uint32_t> code, VkDevice device, VkShaderModule* outShaderModule);
+
+/// @brief Creates a pipeline cache, seeded from the file at `filePath` if it
+/// was saved by the same device and driver. Anything else starts it empty.
+/// The cache is internally synchronized, so pipelines can be created with it
+/// from several threads at once.
+VkPipelineCache load_pipeline_cache(VkDevice device, VkPhysicalDevice gpu, const char* filePath);
+
+/// @brief Writes the contents of `cache` to `filePath`, through a temporary
+/// file so that a crash never leaves half a cache behind.
+void save_pipeline_cache(VkDevice device, VkPhysicalDevice gpu, VkPipelineCache cache, const char* filePath);
+} // namespace vkutil
+
+/// @brief Fills in the many create info structs of a graphics pipeline for
+/// dynamic rendering. Viewport and scissor are always dynamic state.
+class PipelineBuilder {
+  public:
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStages_;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly_;
+    VkPipelineRasterizationStateCreateInfo rasterizer_;
+    VkPipelineColorBlendAttachmentState colorBlendAttachment_;
+    VkPipelineMultisampleStateCreateInfo multisampling_;
+    VkPipelineLayout pipelineLayout_;
+    VkPipelineDepthStencilStateCreateInfo depthStencil_;
+    VkPipelineRenderingCreateInfo renderInfo_;
+    VkFormat colorAttachmentformat_;
+
+    PipelineBuilder() { clear(); }
+
+    void clear();
+
+    /// @brief Safe to call from several threads at once, each with its own
+    /// builder.
+    VkPipeline buildPipeline(VkDevice device, VkPipelineCache cache = VK_NULL_HANDLE);
+
+    void setShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader);
+
+    void setInputTopology(VkPrimitiveTopology topology);
+
+    void setPolygonMode(VkPolygonMode mode);
+
+    void setCullMode(VkCullModeFlags cullMode, VkFrontFace frontFace);
+
+    void setMultisamplingNone();
+
+    void disableBlending();
+
+    void setColorAttachmentFormat(VkFormat format);
+
+    void setDepthFormat(VkFormat format);
+
+    void disableDepthtest();
+
+    /// @param op Use `VK_COMPARE_OP_GREATER_OR_EQUAL`, as depth is reversed
+    /// with 1 at the near plane.
+    void enableDepthtest(bool depthWriteEnable, VkCompareOp op);
+};
@@ -0,0 +1,644 @@
+#include "vk_render_graph.h"
+#include "vk_initializers.h"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+struct AccessInfo {
+    VkPipelineStageFlags2 stages;
+    VkAccessFlags2 access;
+    /// Only meaningful for images.
+    VkImageLayout layout;
+    bool writes;
+};
+
+AccessInfo access_info(ResourceAccess access) {
+    switch (access) {
+    case ResourceAccess::None:
+        return {VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED, false};
+    case ResourceAccess::SwapchainAcquire:
+        return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED, false};
+    case ResourceAccess::IndirectRead:
+        return {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+                VK_IMAGE_LAYOUT_UNDEFINED, false};
+    case ResourceAccess::VertexStorageRead:
+        return {VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                false};
+    case ResourceAccess::ComputeStorageRead:
+        return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                false};
+    case ResourceAccess::ComputeStorageWrite:
+        return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                true};
+    case ResourceAccess::ComputeImageWrite:
+        return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                true};
+    case ResourceAccess::ColorAttachmentWrite:
+        return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true};
+    case ResourceAccess::DepthAttachmentWrite:
+        return {VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, true};
+    case ResourceAccess::TransferRead:
+        return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false};
+    case ResourceAccess::TransferWrite:
+        return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true};
+    case ResourceAccess::Present:
+        // only ever the last thing in the command buffer, so waiting on everything costs nothing
+        return {VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false};
+    }
+    return {};
+}
+
+constexpr VkAccessFlags2 WRITE_ACCESS = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+                                        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+                                        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                        VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+} // namespace
+
+RenderGraph::SyncState RenderGraph::importedState(std::initializer_list<ResourceAccess> previous) {
+    SyncState state;
+    bool written = false;
+    for (ResourceAccess access : previous) {
+        written |= access_info(access).writes;
+    }
+    for (ResourceAccess access : previous) {
+        const AccessInfo info = access_info(access);
+        if (written) {
+            // nothing says whether the reads came after the writes, so wait for all of them and flush the writes
+            state.writeStages |= info.stages;
+            state.writeAccess |= info.access & WRITE_ACCESS;
+        } else {
+            state.readStages |= info.stages;
+        }
+    }
+    return state;
+}
+
+bool RenderGraph::TransientImageDesc::operator==(const TransientImageDesc& other) const {
+    return format == other.format && extent.width == other.extent.width && extent.height == other.extent.height &&
+           usage == other.usage && aspect == other.aspect;
+}
+
+bool RenderGraph::Barriers::empty() const {
+    return images.empty() && memory.srcStageMask == 0 && memory.dstStageMask == 0;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::use(ImageHandle image, ResourceAccess access) {
+    graph_.addUse(pass_, true, image.index, access);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::use(BufferHandle buffer, ResourceAccess access) {
+    graph_.addUse(pass_, false, buffer.index, access);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::parallel() {
+    graph_.passes_[pass_].parallel = true;
+    return *this;
+}
+
+void RenderGraph::init(VkDevice device, VmaAllocator allocator) {
+    device_ = device;
+    allocator_ = allocator;
+}
+
+void RenderGraph::destroy() {
+    for (const PhysicalImage& physical : physicalImages_) {
+        vkDestroyImageView(device_, physical.view, nullptr);
+        vkDestroyImage(device_, physical.image, nullptr);
+    }
+    for (const AliasGroup& group : aliasGroups_) {
+        vmaFreeMemory(allocator_, group.allocation);
+    }
+    physicalImages_.clear();
+    aliasGroups_.clear();
+    reset();
+}
+
+void RenderGraph::reset() {
+    passes_.clear();
+    images_.clear();
+    buffers_.clear();
+    transients_.clear();
+    finalBarriers_ = {};
+}
+
+RenderGraph::ImageHandle RenderGraph::importImage(VkImage image, VkImageView view, VkImageAspectFlags aspect,
+                                                  std::initializer_list<ResourceAccess> previous, bool keepContents,
+                                                  VkImageLayout currentLayout) {
+    SyncState state = importedState(previous);
+    state.layout = keepContents ? currentLayout : VK_IMAGE_LAYOUT_UNDEFINED;
+
+    images_.push_back(Image{image, view, aspect, state, NOT_TRANSIENT, false, ResourceAccess::None});
+    return ImageHandle{static_cast<uint32_t>(images_.size() - 1)};
+}
+
+RenderGraph::ImageHandle RenderGraph::createImage(const TransientImageDesc& desc) {
+    const uint32_t index = static_cast<uint32_t>(images_.size());
+    transients_.push_back(Transient{index, desc, Lifetime{UINT32_MAX, 0}, 0});
+    images_.push_back(Image{VK_NULL_HANDLE, VK_NULL_HANDLE, desc.aspect, SyncState{},
+                            static_cast<uint32_t>(transients_.size() - 1), false, ResourceAccess::None});
+    return ImageHandle{index};
+}
+
+RenderGraph::BufferHandle RenderGraph::importBuffer(std::initializer_list<ResourceAccess> previous) {
+    const SyncState state = importedState(previous);
+
+    buffers_.push_back(state);
+    return BufferHandle{static_cast<uint32_t>(buffers_.size() - 1)};
+}
+
+void RenderGraph::exportImage(ImageHandle image, ResourceAccess access) {
+    images_[image.index].exported = true;
+    images_[image.index].exportAccess = access;
+}
+
+RenderGraph::PassBuilder RenderGraph::addPass(const char* name, std::function<void(VkCommandBuffer cmd)>&& record) {
+    passes_.push_back(Pass{name, std::move(record), {}, {}, false});
+    return PassBuilder(*this, static_cast<uint32_t>(passes_.size() - 1));
+}
+
+void RenderGraph::addUse(uint32_t pass, bool isImage, uint32_t resource, ResourceAccess access) {
+    const AccessInfo info = access_info(access);
+    std::vector<Use>& uses = passes_[pass].uses;
+
+    auto existing = std::find_if(uses.begin(), uses.end(), [&](const Use& use) {
+        return use.isImage == isImage && use.resource == resource;
+    });
+    if (existing != uses.end()) {
+        // one pass can only have an image in one layout
+        assert(!isImage || existing->layout == info.layout);
+        existing->stages |= info.stages;
+        existing->access |= info.access;
+        existing->writes |= info.writes;
+    } else {
+        uses.push_back(Use{isImage, resource, info.stages, info.access, info.layout, info.writes});
+    }
+
+    if (isImage && images_[resource].transient != NOT_TRANSIENT) {
+        Lifetime& lifetime = transients_[images_[resource].transient].lifetime;
+        lifetime.firstPass = std::min(lifetime.firstPass, pass);
+        lifetime.lastPass = std::max(lifetime.lastPass, pass);
+    }
+}
+
+std::vector<uint32_t> RenderGraph::assignAliasGroups(std::span<const Lifetime> lifetimes) {
+    std::vector<uint32_t> order(lifetimes.size());
+    for (uint32_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&](uint32_t a, uint32_t b) { return lifetimes[a].firstPass < lifetimes[b].firstPass; });
+
+    // the last pass using each group so far
+    std::vector<uint32_t> groupEnds;
+    std::vector<uint32_t> groups(lifetimes.size());
+    for (uint32_t i : order) {
+        const Lifetime& lifetime = lifetimes[i];
+        auto free = std::find_if(groupEnds.begin(), groupEnds.end(),
+                                 [&](uint32_t end) { return end < lifetime.firstPass; });
+        if (free != groupEnds.end()) {
+            groups[i] = static_cast<uint32_t>(free - groupEnds.begin());
+            *free = lifetime.lastPass;
+        } else {
+            groups[i] = static_cast<uint32_t>(groupEnds.size());
+            groupEnds.push_back(lifetime.lastPass);
+        }
+    }
+    return groups;
+}
+
+void RenderGraph::compile(DeletionQueue& deletionQueue) {
+    realizeTransients(deletionQueue);
+    planBarriers();
+}
+
+void RenderGraph::realizeTransients(DeletionQueue& deletionQueue) {
+    // depth and colour images can need different memory types, so only like images share memory
+    std::vector<uint32_t> aspects;
+    std::vector<Lifetime> lifetimes;
+    for (const Transient& transient : transients_) {
+        if (std::find(aspects.begin(), aspects.end(), transient.desc.aspect) == aspects.end()) {
+            aspects.push_back(transient.desc.aspect);
+        }
+    }
+    uint32_t groupBase = 0;
+    for (uint32_t aspect : aspects) {
+        lifetimes.clear();
+        std::vector<uint32_t> members;
+        for (uint32_t i = 0; i < transients_.size(); i++) {
+            if (transients_[i].desc.aspect == aspect) {
+                lifetimes.push_back(transients_[i].lifetime);
+                members.push_back(i);
+            }
+        }
+        const std::vector<uint32_t> groups = assignAliasGroups(lifetimes);
+        uint32_t groupCount = 0;
+        for (uint32_t i = 0; i < members.size(); i++) {
+            transients_[members[i]].group = groupBase + groups[i];
+            groupCount = std::max(groupCount, groups[i] + 1);
+        }
+        groupBase += groupCount;
+    }
+
+    bool unchanged = physicalImages_.size() == transients_.size();
+    for (uint32_t i = 0; unchanged && i < transients_.size(); i++) {
+        unchanged = physicalImages_[i].desc == transients_[i].desc && physicalImages_[i].group == transients_[i].group;
+    }
+
+    if (!unchanged) {
+        // frames in flight may still be using the old images
+        // the queue destroys the last pushed first, so the memory goes after the images bound to it
+        for (const AliasGroup& group : aliasGroups_) {
+            deletionQueue.pushMemory(group.allocation);
+        }
+        for (const PhysicalImage& physical : physicalImages_) {
+            deletionQueue.push(physical.image);
+            deletionQueue.push(physical.view);
+        }
+        physicalImages_.clear();
+        aliasGroups_.assign(groupBase, AliasGroup{VK_NULL_HANDLE, 0, 0});
+
+        std::vector<VkMemoryRequirements> groupRequirements(groupBase, VkMemoryRequirements{0, 1, ~0u});
+        for (const Transient& transient : transients_) {
+            const VkExtent3D extent = {transient.desc.extent.width, transient.desc.extent.height, 1};
+            VkImageCreateInfo imageInfo =
+                vkinit::image_create_info(transient.desc.format, transient.desc.usage, extent);
+
+            PhysicalImage physical{transient.desc, transient.group, VK_NULL_HANDLE, VK_NULL_HANDLE};
+            VK_CHECK(vkCreateImage(device_, &imageInfo, nullptr, &physical.image));
+
+            VkMemoryRequirements requirements;
+            vkGetImageMemoryRequirements(device_, physical.image, &requirements);
+            VkMemoryRequirements& group = groupRequirements[transient.group];
+            group.size = std::max(group.size, requirements.size);
+            group.alignment = std::max(group.alignment, requirements.alignment);
+            group.memoryTypeBits &= requirements.memoryTypeBits;
+
+            physicalImages_.push_back(physical);
+        }
+
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        allocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        for (uint32_t i = 0; i < groupBase; i++) {
+            VK_CHECK(vmaAllocateMemory(allocator_, &groupRequirements[i], &allocInfo, &aliasGroups_[i].allocation,
+                                       nullptr));
+        }
+
+        for (PhysicalImage& physical : physicalImages_) {
+            VK_CHECK(vmaBindImageMemory(allocator_, aliasGroups_[physical.group].allocation, physical.image));
+
+            VkImageViewCreateInfo viewInfo =
+                vkinit::imageview_create_info(physical.desc.format, physical.image, physical.desc.aspect);
+            VK_CHECK(vkCreateImageView(device_, &viewInfo, nullptr, &physical.view));
+        }
+    }
+
+    for (uint32_t i = 0; i < transients_.size(); i++) {
+        images_[transients_[i].image].image = physicalImages_[i].image;
+        images_[transients_[i].image].view = physicalImages_[i].view;
+    }
+}
+
+void RenderGraph::applyUse(const Use& use, SyncState& state, VkImage image, VkImageAspectFlags aspect,
+                           Barriers& barriers) {
+    const VkImageLayout oldLayout = state.layout;
+    const bool transition = use.isImage && oldLayout != use.layout;
+
+    VkPipelineStageFlags2 srcStages = 0;
+    VkAccessFlags2 srcAccess = 0;
+    bool needed = false;
+    if (use.writes || transition) {
+        // reads since the last write already waited for it and made it available, so waiting for them is enough
+        const bool read = state.readStages != 0;
+        srcStages = read ? state.readStages : state.writeStages;
+        srcAccess = read ? VK_ACCESS_2_NONE : state.writeAccess;
+        needed = transition || srcStages != 0;
+
+        state.layout = use.isImage ? use.layout : state.layout;
+        state.writeStages = use.stages;
+        state.writeAccess = use.writes ? use.access & WRITE_ACCESS : 0;
+        state.readStages = use.writes ? 0 : use.stages;
+        // a write is not visible to anyone until the next barrier, while a transition is to its own stages
+        state.visibleStages = use.writes ? 0 : use.stages;
+        state.visibleAccess = use.writes ? 0 : use.access;
+    } else {
+        const bool visible =
+            (use.stages & ~state.visibleStages) == 0 && (use.access & ~state.visibleAccess) == 0;
+        if (state.writeStages != 0 && !visible) {
+            srcStages = state.writeStages;
+            srcAccess = state.writeAccess;
+            needed = true;
+            state.visibleStages |= use.stages;
+            state.visibleAccess |= use.access;
+        }
+        state.readStages |= use.stages;
+    }
+
+    if (!needed) {
+        return;
+    }
+
+    if (use.isImage) {
+        VkImageMemoryBarrier2 barrier{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
+        barrier.srcStageMask = srcStages;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstStageMask = use.stages;
+        barrier.dstAccessMask = use.access;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = use.layout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange = vkinit::image_subresource_range(aspect);
+        barriers.images.push_back(barrier);
+    } else {
+        barriers.memory.srcStageMask |= srcStages;
+        barriers.memory.srcAccessMask |= srcAccess;
+        barriers.memory.dstStageMask |= use.stages;
+        barriers.memory.dstAccessMask |= use.access;
+    }
+}
+
+void RenderGraph::planBarriers() {
+    for (uint32_t p = 0; p < passes_.size(); p++) {
+        Pass& pass = passes_[p];
+        pass.barriers = {};
+        pass.barriers.memory = {.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+
+        for (const Use& use : pass.uses) {
+            if (!use.isImage) {
+                applyUse(use, buffers_[use.resource], VK_NULL_HANDLE, 0, pass.barriers);
+                continue;
+            }
+
+            Image& image = images_[use.resource];
+            if (image.transient != NOT_TRANSIENT) {
+                const Transient& transient = transients_[image.transient];
+                AliasGroup& group = aliasGroups_[transient.group];
+                if (transient.lifetime.firstPass == p) {
+                    // whatever last used the memory, in this frame or the last, has to finish first
+                    image.state = SyncState{};
+                    image.state.writeStages = group.lastStages;
+                    image.state.writeAccess = group.lastWriteAccess;
+                }
+                applyUse(use, image.state, image.image, image.aspect, pass.barriers);
+                if (transient.lifetime.lastPass == p) {
+                    group.lastStages = image.state.writeStages | image.state.readStages;
+                    group.lastWriteAccess = image.state.writeAccess;
+                }
+                continue;
+            }
+
+            applyUse(use, image.state, image.image, image.aspect, pass.barriers);
+        }
+    }
+
+    finalBarriers_ = {};
+    finalBarriers_.memory = {.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+    for (uint32_t i = 0; i < images_.size(); i++) {
+        Image& image = images_[i];
+        if (!image.exported) {
+            continue;
+        }
+        const AccessInfo info = access_info(image.exportAccess);
+        const Use use{true, i, info.stages, info.access, info.layout, info.writes};
+        applyUse(use, image.state, image.image, image.aspect, finalBarriers_);
+    }
+}
+
+void RenderGraph::recordBarriers(VkCommandBuffer cmd, const Barriers& barriers) {
+    if (barriers.empty()) {
+        return;
+    }
+
+    VkDependencyInfo depInfo{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    const bool hasMemory = barriers.memory.srcStageMask != 0 || barriers.memory.dstStageMask != 0;
+    depInfo.memoryBarrierCount = hasMemory ? 1 : 0;
+    depInfo.pMemoryBarriers = &barriers.memory;
+    depInfo.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.images.size());
+    depInfo.pImageMemoryBarriers = barriers.images.data();
+
+    vkCmdPipelineBarrier2(cmd, &depInfo);
+}
+
+void RenderGraph::execute(VkCommandBuffer cmd, GpuTimestamps* timestamps, jobs::JobSystem* jobSystem,
+                          SecondaryCommandPools* secondaries) {
+    for (const RecordingRun& run : recordingRuns()) {
+        if (run.parallel && jobSystem != nullptr && secondaries != nullptr) {
+            recordInParallel(cmd, run, timestamps, *jobSystem, *secondaries);
+            continue;
+        }
+        for (uint32_t i = run.firstPass; i < run.firstPass + run.passCount; i++) {
+            const Pass& pass = passes_[i];
+            const GpuZone zone(timestamps, cmd, pass.name);
+            recordBarriers(cmd, pass.barriers);
+            pass.record(cmd);
+        }
+    }
+    recordBarriers(cmd, finalBarriers_);
+}
+
+void RenderGraph::recordInParallel(VkCommandBuffer cmd, const RecordingRun& run, GpuTimestamps* timestamps,
+                                   jobs::JobSystem& jobSystem, SecondaryCommandPools& secondaries) {
+    secondaryBuffers_.resize(run.passCount);
+    // the frame is waiting on these, so they go ahead of background work like meshing
+    jobSystem.parallelFor(
+        0, run.passCount, 1,
+        [&](uint32_t i) {
+            uint32_t thread = jobs::JobSystem::currentWorkerIndex();
+            if (thread == jobs::JobSystem::NOT_A_WORKER) {
+                thread = secondaries.threadCount() - 1;
+            }
+            VkCommandBuffer secondary = secondaries.begin(device_, thread);
+            passes_[run.firstPass + i].record(secondary);
+            VK_CHECK(vkEndCommandBuffer(secondary));
+            secondaryBuffers_[i] = secondary;
+        },
+        jobs::JobPriority::High);
+
+    // in pass order, however the recording was spread over threads
+    for (uint32_t i = 0; i < run.passCount; i++) {
+        const Pass& pass = passes_[run.firstPass + i];
+        const GpuZone zone(timestamps, cmd, pass.name);
+        recordBarriers(cmd, pass.barriers);
+        vkCmdExecuteCommands(cmd, 1, &secondaryBuffers_[i]);
+    }
+}
+
+std::vector<RenderGraph::RecordingRun> RenderGraph::recordingRuns() const {
+    std::vector<RecordingRun> runs;
+    for (uint32_t pass = 0; pass < passes_.size(); pass++) {
+        const bool parallel = passes_[pass].parallel;
+        if (!runs.empty() && runs.back().parallel == parallel) {
+            runs.back().passCount++;
+        } else {
+            runs.push_back(RecordingRun{pass, 1, parallel});
+        }
+    }
+    for (RecordingRun& run : runs) {
+        run.parallel = run.parallel && run.passCount > 1;
+    }
+    return runs;
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+namespace {
+VkImage fake_image(uintptr_t value) { return reinterpret_cast<VkImage>(value); }
+
+void no_op(VkCommandBuffer) {}
+} // namespace
+
+TEST_SUITE("RenderGraph") {
+    TEST_CASE("images are transitioned waiting only on the stages before them") {
+        RenderGraph graph;
+        DeletionQueue deletionQueue;
+        const auto draw = graph.importImage(fake_image(1), VK_NULL_HANDLE, VK_IMAGE_ASPECT_COLOR_BIT,
+                                            {ResourceAccess::TransferRead});
+        graph.addPass("background", no_op).use(draw, ResourceAccess::ComputeImageWrite);
+        graph.addPass("geometry", no_op).use(draw, ResourceAccess::ColorAttachmentWrite);
+        graph.compile(deletionQueue);
+
+        const RenderGraph::Barriers& first = graph.passBarriers(0);
+        REQUIRE(first.images.size() == 1);
+        CHECK(first.images[0].oldLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+        CHECK(first.images[0].newLayout == VK_IMAGE_LAYOUT_GENERAL);
+        // the last frame only read it, so there is nothing to flush
+        CHECK(first.images[0].srcStageMask == VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT);
+        CHECK(first.images[0].srcAccessMask == VK_ACCESS_2_NONE);
+        CHECK(first.images[0].dstStageMask == VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+        const RenderGraph::Barriers& second = graph.passBarriers(1);
+        REQUIRE(second.images.size() == 1);
+        CHECK(second.images[0].oldLayout == VK_IMAGE_LAYOUT_GENERAL);
+        CHECK(second.images[0].newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        CHECK(second.images[0].srcStageMask == VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+        CHECK(second.images[0].srcAccessMask == VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+        CHECK(second.images[0].dstStageMask == VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+    }
+
+    TEST_CASE("buffer barriers merge into one memory barrier per pass") {
+        RenderGraph graph;
+        DeletionQueue deletionQueue;
+        const auto commands = graph.importBuffer({});
+        const auto count = graph.importBuffer({});
+        graph.addPass("cull", no_op)
+            .use(count, ResourceAccess::TransferWrite)
+            .use(count, ResourceAccess::ComputeStorageWrite)
+            .use(commands, ResourceAccess::ComputeStorageWrite);
+        graph.addPass("draw", no_op)
+            .use(commands, ResourceAccess::IndirectRead)
+            .use(count, ResourceAccess::IndirectRead);
+        graph.compile(deletionQueue);
+
+        // nothing came before the first writes
+        CHECK(graph.passBarriers(0).empty());
+
+        const RenderGraph::Barriers& draw = graph.passBarriers(1);
+        CHECK(draw.images.empty());
+        CHECK(draw.memory.srcStageMask ==
+              (VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT));
+        CHECK(draw.memory.srcAccessMask == (VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT));
+        CHECK(draw.memory.dstStageMask == VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
+        CHECK(draw.memory.dstAccessMask == VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+    }
+
+    TEST_CASE("reads of visible data need no barrier, and writes after reads only wait") {
+        RenderGraph graph;
+        DeletionQueue deletionQueue;
+        const auto slots = graph.importBuffer({});
+        graph.addPass("upload", no_op).use(slots, ResourceAccess::TransferWrite);
+        graph.addPass("cull", no_op).use(slots, ResourceAccess::ComputeStorageRead);
+        graph.addPass("cull again", no_op).use(slots, ResourceAccess::ComputeStorageRead);
+        graph.addPass("draw", no_op).use(slots, ResourceAccess::VertexStorageRead);
+        graph.addPass("rewrite", no_op).use(slots, ResourceAccess::TransferWrite);
+        graph.compile(deletionQueue);
+
+        CHECK(graph.passBarriers(0).empty());
+        CHECK(graph.passBarriers(1).memory.dstStageMask == VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+        CHECK(graph.passBarriers(2).empty());
+        // a new stage still needs the write made visible to it
+        CHECK(graph.passBarriers(3).memory.srcAccessMask == VK_ACCESS_2_TRANSFER_WRITE_BIT);
+        CHECK(graph.passBarriers(3).memory.dstStageMask == VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+
+        const RenderGraph::Barriers& rewrite = graph.passBarriers(4);
+        CHECK(rewrite.memory.srcStageMask ==
+              (VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT));
+        CHECK(rewrite.memory.srcAccessMask == VK_ACCESS_2_NONE);
+    }
+
+    TEST_CASE("exports are transitioned after the last pass") {
+        RenderGraph graph;
+        DeletionQueue deletionQueue;
+        const auto swapchain = graph.importImage(fake_image(2), VK_NULL_HANDLE, VK_IMAGE_ASPECT_COLOR_BIT,
+                                                 {ResourceAccess::SwapchainAcquire});
+        graph.addPass("copy", no_op).use(swapchain, ResourceAccess::TransferWrite);
+        graph.addPass("ui", no_op).use(swapchain, ResourceAccess::ColorAttachmentWrite);
+        graph.exportImage(swapchain, ResourceAccess::Present);
+        graph.compile(deletionQueue);
+
+        // the acquire semaphore is waited on at the transfer stage, which the first transition chains onto
+        CHECK(graph.passBarriers(0).images[0].srcStageMask == VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT);
+
+        REQUIRE(graph.finalBarriers().images.size() == 1);
+        const VkImageMemoryBarrier2& present = graph.finalBarriers().images[0];
+        CHECK(present.oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        CHECK(present.newLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        CHECK(present.srcAccessMask == VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
+    }
+
+    TEST_CASE("parallel passes next to each other are recorded together") {
+        RenderGraph graph;
+        graph.addPass("uploads", no_op);
+        graph.addPass("background", no_op).parallel();
+        graph.addPass("cull", no_op).parallel();
+        graph.addPass("chunks", no_op).parallel();
+        graph.addPass("readback", no_op);
+        graph.addPass("ui", no_op).parallel();
+
+        const std::vector<RenderGraph::RecordingRun> runs = graph.recordingRuns();
+        REQUIRE(runs.size() == 4);
+        CHECK(runs[0].firstPass == 0);
+        CHECK_FALSE(runs[0].parallel);
+        CHECK(runs[1].firstPass == 1);
+        CHECK(runs[1].passCount == 3);
+        CHECK(runs[1].parallel);
+        CHECK(runs[2].firstPass == 4);
+        CHECK_FALSE(runs[2].parallel);
+        // alone, it is recorded like the rest
+        CHECK(runs[3].firstPass == 5);
+        CHECK(runs[3].passCount == 1);
+        CHECK_FALSE(runs[3].parallel);
+    }
+
+    TEST_CASE("passes are recorded in order without workers") {
+        RenderGraph graph;
+        DeletionQueue deletionQueue;
+        std::vector<int> recorded;
+        graph.addPass("first", [&](VkCommandBuffer) { recorded.push_back(0); });
+        graph.addPass("second", [&](VkCommandBuffer) { recorded.push_back(1); }).parallel();
+        graph.addPass("third", [&](VkCommandBuffer) { recorded.push_back(2); }).parallel();
+        graph.compile(deletionQueue);
+        graph.execute(VK_NULL_HANDLE);
+        CHECK(recorded == std::vector<int>{0, 1, 2});
+    }
+
+    TEST_CASE("transients alias when their passes do not overlap") {
+        const RenderGraph::Lifetime lifetimes[] = {{0, 1}, {1, 2}, {2, 3}, {4, 4}, {3, 5}};
+        const std::vector<uint32_t> groups = RenderGraph::assignAliasGroups(lifetimes);
+        CHECK(groups == std::vector<uint32_t>{0, 1, 0, 0, 1});
+    }
+}
+
+#endif
@@ -0,0 +1,306 @@
+#pragma once
+
+#include "../../jobs/job_system.h"
+#include "vk_command_pools.h"
+#include "vk_deletion_queue.h"
+#include "vk_timestamps.h"
+#include "vk_types.h"
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <span>
+#include <vector>
+
+/// @brief How a pass uses an image or buffer. Each maps to the exact
+/// pipeline stages, access flags and image layout the use needs, which the
+/// render graph builds its barriers from.
+enum class ResourceAccess : uint8_t {
+    /// Not used at all, such as a fresh swapchain image.
+    None,
+    /// A swapchain image as the acquire semaphore hands it over. The frame
+    /// must wait on that semaphore at `VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT`,
+    /// where the image is first used.
+    SwapchainAcquire,
+    IndirectRead,
+    VertexStorageRead,
+    ComputeStorageRead,
+    /// Read and written, as atomics do.
+    ComputeStorageWrite,
+    /// A storage image written in `VK_IMAGE_LAYOUT_GENERAL`.
+    ComputeImageWrite,
+    /// Loaded and written, so draws can go over what is already there.
+    ColorAttachmentWrite,
+    DepthAttachmentWrite,
+    TransferRead,
+    TransferWrite,
+    Present,
+};
+
+/// @brief Records the passes of a frame in order, with the fewest and
+/// tightest barriers between them that keep them correct.
+///
+/// Each frame, passes are declared along with every image and buffer they
+/// use and how. `compile()` then walks them in order, tracking each
+/// resource's layout, the stages that last wrote it and the stages its
+/// contents are already visible to. A pass only waits on the stages it
+/// actually depends on, reads of data already made visible need no barrier,
+/// and all the barriers before a pass go out in one `vkCmdPipelineBarrier2`.
+/// Buffers are only tracked for dependencies, all of their barriers merge
+/// into one global memory barrier.
+///
+/// Transient images are created by the graph and live for one frame.
+/// Transients whose passes do not overlap share memory, and the images are
+/// kept from frame to frame as long as the frame declares the same ones.
+///
+/// Passes marked `parallel()` that follow one another are recorded at the
+/// same time on job system workers, each into a secondary command buffer,
+/// which are then executed in pass order so the frame comes out the same
+/// whichever thread recorded what. Barriers and timestamps stay in the
+/// primary command buffer.
+///
+/// # Thread Safety
+///
+/// Not thread safe.
+class RenderGraph {
+  public:
+    struct ImageHandle {
+        uint32_t index;
+    };
+
+    struct BufferHandle {
+        uint32_t index;
+    };
+
+    struct TransientImageDesc {
+        VkFormat format;
+        VkExtent2D extent;
+        VkImageUsageFlags usage;
+        VkImageAspectFlags aspect;
+
+        bool operator==(const TransientImageDesc& other) const;
+    };
+
+    /// @brief The passes, first to last, that use a transient image.
+    struct Lifetime {
+        uint32_t firstPass;
+        uint32_t lastPass;
+    };
+
+    /// @brief Passes recorded one after another, or all at once.
+    struct RecordingRun {
+        uint32_t firstPass;
+        uint32_t passCount;
+        bool parallel;
+    };
+
+    struct Barriers {
+        std::vector<VkImageMemoryBarrier2> images;
+        /// Covers every buffer. Unused if both stage masks are empty.
+        VkMemoryBarrier2 memory;
+
+        bool empty() const;
+    };
+
+    class PassBuilder {
+      public:
+        /// @brief Declares that the pass uses `image` as `access`. Declaring
+        /// an image twice merges the uses, which must share a layout.
+        PassBuilder& use(ImageHandle image, ResourceAccess access);
+
+        PassBuilder& use(BufferHandle buffer, ResourceAccess access);
+
+        /// @brief Lets the pass be recorded on another thread, at the same
+        /// time as the parallel passes next to it. Its callback may read
+        /// what earlier passes that are not parallel changed on the CPU, but
+        /// must not change anything another parallel pass reads.
+        PassBuilder& parallel();
+
+      private:
+        friend class RenderGraph;
+
+        PassBuilder(RenderGraph& graph, uint32_t pass) : graph_(graph), pass_(pass) {}
+
+        RenderGraph& graph_;
+        uint32_t pass_;
+    };
+
+    void init(VkDevice device, VmaAllocator allocator);
+
+    /// @brief Destroys the transient images. The GPU must be done with them.
+    void destroy();
+
+    /// @brief Forgets the passes and resources of the last frame.
+    void reset();
+
+    /// @brief Adds an image the graph does not own.
+    /// @param previous Every way the image was used since the GPU last
+    /// synchronized with it, such as by the previous frame, which the first
+    /// pass using it must wait for.
+    /// @param keepContents If false the contents are discarded at the first
+    /// use, which lets the layout start from undefined.
+    /// @param currentLayout The layout the image is in, if `keepContents`.
+    ImageHandle importImage(VkImage image, VkImageView view, VkImageAspectFlags aspect,
+                            std::initializer_list<ResourceAccess> previous, bool keepContents = false,
+                            VkImageLayout currentLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+    /// @brief Adds an image that only lives for this frame.
+    ImageHandle createImage(const TransientImageDesc& desc);
+
+    /// @brief Adds a buffer, or any group of buffers always used together.
+    /// @param previous As for `importImage()`.
+    BufferHandle importBuffer(std::initializer_list<ResourceAccess> previous);
+
+    /// @brief Leaves `image` ready for `access` once every pass has run.
+    void exportImage(ImageHandle image, ResourceAccess access);
+
+    /// @brief Adds a pass that runs after every pass added before it.
+    PassBuilder addPass(const char* name, std::function<void(VkCommandBuffer cmd)>&& record);
+
+    /// @brief Works out the barriers and creates any transient images that
+    /// changed since the last frame.
+    /// @param deletionQueue Destroys replaced transient images once the
+    /// frames in flight are done with them.
+    void compile(DeletionQueue& deletionQueue);
+
+    /// @brief Records every pass with its barriers into `cmd`.
+    /// @param timestamps If given, times each pass and the barriers before
+    /// it as a zone named after the pass.
+    /// @param jobSystem Records parallel passes on its workers, into
+    /// `secondaries` indexed by worker, with the calling thread last. Without
+    /// them every pass is recorded straight into `cmd`.
+    void execute(VkCommandBuffer cmd, GpuTimestamps* timestamps = nullptr, jobs::JobSystem* jobSystem = nullptr,
+                 SecondaryCommandPools* secondaries = nullptr);
+
+    VkImage image(ImageHandle handle) const { return images_[handle.index].image; }
+
+    VkImageView imageView(ImageHandle handle) const { return images_[handle.index].view; }
+
+    uint32_t passCount() const { return static_cast<uint32_t>(passes_.size()); }
+
+    const char* passName(uint32_t pass) const { return passes_[pass].name; }
+
+    /// @return The barriers recorded before `pass`, after `compile()`.
+    const Barriers& passBarriers(uint32_t pass) const { return passes_[pass].barriers; }
+
+    /// @return The barriers recorded after the last pass, for exports.
+    const Barriers& finalBarriers() const { return finalBarriers_; }
+
+    /// @return The passes in order, grouped into runs of parallel passes.
+    /// A parallel pass on its own is recorded like any other, as it would
+    /// gain nothing from another thread.
+    std::vector<RecordingRun> recordingRuns() const;
+
+    /// @brief Puts transients into groups that can share memory, as few as
+    /// the lifetimes allow.
+    /// @param lifetimes In any order.
+    /// @return The group of each lifetime, in the same order.
+    static std::vector<uint32_t> assignAliasGroups(std::span<const Lifetime> lifetimes);
+
+  private:
+    /// @brief What is known about a resource at a point in the frame.
+    struct SyncState {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        /// Stages of the last write, or of the last barrier that changed the
+        /// layout, which later uses must wait for.
+        VkPipelineStageFlags2 writeStages = 0;
+        /// Writes not yet made available.
+        VkAccessFlags2 writeAccess = 0;
+        /// Stages that read since the last write, which a new write must
+        /// wait for.
+        VkPipelineStageFlags2 readStages = 0;
+        /// What the last write has been made visible to.
+        VkPipelineStageFlags2 visibleStages = 0;
+        VkAccessFlags2 visibleAccess = 0;
+    };
+
+    struct Use {
+        bool isImage;
+        uint32_t resource;
+        VkPipelineStageFlags2 stages;
+        VkAccessFlags2 access;
+        VkImageLayout layout;
+        bool writes;
+    };
+
+    struct Pass {
+        const char* name;
+        std::function<void(VkCommandBuffer cmd)> record;
+        std::vector<Use> uses;
+        Barriers barriers;
+        bool parallel;
+    };
+
+    struct Image {
+        VkImage image;
+        VkImageView view;
+        VkImageAspectFlags aspect;
+        SyncState state;
+        /// Index into `transients_`, or `NOT_TRANSIENT`.
+        uint32_t transient;
+        bool exported;
+        ResourceAccess exportAccess;
+    };
+
+    struct Transient {
+        uint32_t image;
+        TransientImageDesc desc;
+        Lifetime lifetime;
+        uint32_t group;
+    };
+
+    /// @brief Memory shared by transients, and the images made in it.
+    struct AliasGroup {
+        VmaAllocation allocation;
+        /// Every stage that touched the memory last, which the next image
+        /// placed in it must wait for.
+        VkPipelineStageFlags2 lastStages;
+        VkAccessFlags2 lastWriteAccess;
+    };
+
+    struct PhysicalImage {
+        TransientImageDesc desc;
+        uint32_t group;
+        VkImage image;
+        VkImageView view;
+    };
+
+    static constexpr uint32_t NOT_TRANSIENT = UINT32_MAX;
+
+    /// @brief The state of a resource after the uses it had before the frame.
+    static SyncState importedState(std::initializer_list<ResourceAccess> previous);
+
+    void addUse(uint32_t pass, bool isImage, uint32_t resource, ResourceAccess access);
+
+    /// @brief Creates the transient images, unless the last frame had the
+    /// same ones.
+    void realizeTransients(DeletionQueue& deletionQueue);
+
+    /// @brief Works out the barriers `use` needs and moves `state` past it.
+    static void applyUse(const Use& use, SyncState& state, VkImage image, VkImageAspectFlags aspect,
+                         Barriers& barriers);
+
+    void planBarriers();
+
+    void recordBarriers(VkCommandBuffer cmd, const Barriers& barriers);
+
+    /// @brief Records the passes of `run` on every thread there is, then
+    /// executes them into `cmd` in order.
+    void recordInParallel(VkCommandBuffer cmd, const RecordingRun& run, GpuTimestamps* timestamps,
+                          jobs::JobSystem& jobSystem, SecondaryCommandPools& secondaries);
+
+    VkDevice device_ = VK_NULL_HANDLE;
+    VmaAllocator allocator_ = VK_NULL_HANDLE;
+
+    std::vector<Pass> passes_;
+    std::vector<Image> images_;
+    std::vector<SyncState> buffers_;
+    std::vector<Transient> transients_;
+    Barriers finalBarriers_;
+
+    /// Kept from frame to frame, in the order the transients were declared.
+    std::vector<PhysicalImage> physicalImages_;
+    std::vector<AliasGroup> aliasGroups_;
+
+    /// The secondary command buffer of each pass of a parallel run.
+    std::vector<VkCommandBuffer> secondaryBuffers_;
+};
@@ -0,0 +1,70 @@
+#include "vk_timestamps.h"
+#include <algorithm>
+
+void GpuTimestamps::init(VkDevice device) {
+    VkQueryPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = MAX_ZONES * 2;
+    VK_CHECK(vkCreateQueryPool(device, &poolInfo, nullptr, &pool_));
+
+    names_.reserve(MAX_ZONES);
+    results_.resize(MAX_ZONES * 2);
+}
+
+void GpuTimestamps::destroy(VkDevice device) {
+    vkDestroyQueryPool(device, pool_, nullptr);
+    pool_ = VK_NULL_HANDLE;
+}
+
+bool GpuTimestamps::collect(VkDevice device, double period, uint32_t validBits, std::vector<GpuZoneTiming>& zones,
+                            double& frameMilliseconds) {
+    zones.clear();
+    if (names_.empty()) {
+        return false;
+    }
+
+    const auto queryCount = static_cast<uint32_t>(names_.size() * 2);
+    // no wait flag, the fence says the queries are done
+    const VkResult result =
+        vkGetQueryPoolResults(device, pool_, 0, queryCount, queryCount * sizeof(uint64_t), results_.data(),
+                              sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) {
+        names_.clear();
+        return false;
+    }
+
+    uint64_t first = results_[0];
+    uint64_t last = results_[1];
+    for (uint32_t i = 0; i < names_.size(); i++) {
+        const uint64_t begin = results_[i * 2];
+        const uint64_t end = results_[i * 2 + 1];
+        zones.push_back(GpuZoneTiming{names_[i], timestampMilliseconds(begin, end, period, validBits)});
+        first = std::min(first, begin);
+        last = std::max(last, end);
+    }
+    frameMilliseconds = timestampMilliseconds(first, last, period, validBits);
+    names_.clear();
+    return true;
+}
+
+void GpuTimestamps::beginFrame(VkCommandBuffer cmd) {
+    names_.clear();
+    vkCmdResetQueryPool(cmd, pool_, 0, MAX_ZONES * 2);
+}
+
+uint32_t GpuTimestamps::beginZone(VkCommandBuffer cmd, const char* name) {
+    if (names_.size() >= MAX_ZONES) {
+        return NO_ZONE;
+    }
+    const auto zone = static_cast<uint32_t>(names_.size());
+    names_.push_back(name);
+    // written once everything before has finished, so zones do not overlap
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, pool_, zone * 2);
+    return zone;
+}
+
+void GpuTimestamps::endZone(VkCommandBuffer cmd, uint32_t zone) {
+    if (zone != NO_ZONE) {
+        vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, pool_, zone * 2 + 1);
+    }
+}
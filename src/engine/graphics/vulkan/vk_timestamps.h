@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../gpu_timings.h"
+#include "vk_types.h"
+#include <cstdint>
+#include <vector>
+
+/// @brief Times named zones of one frame's command buffer with timestamp
+/// queries, one pool per frame in flight.
+///
+/// The results are read once the frame's fence has been waited on, which is
+/// when the frame data comes round again, so reading never stalls. With two
+/// frames in flight the timings shown are from frame N-2.
+///
+/// # Thread Safety
+///
+/// Not thread safe.
+class GpuTimestamps {
+  public:
+    /// Zones past this many in a frame are not timed.
+    static constexpr uint32_t MAX_ZONES = 64;
+
+    void init(VkDevice device);
+
+    void destroy(VkDevice device);
+
+    /// @brief Reads the zones recorded since the last `beginFrame()`. Must
+    /// only be called once the GPU is done with them, and does nothing the
+    /// second time.
+    /// @param period Nanoseconds per tick.
+    /// @param validBits How many bits of a timestamp the queue writes.
+    /// @param frameMilliseconds Set to the time from the first zone's start
+    /// to the last zone's end.
+    /// @return False if there was nothing to read.
+    bool collect(VkDevice device, double period, uint32_t validBits, std::vector<GpuZoneTiming>& zones,
+                 double& frameMilliseconds);
+
+    /// @brief Resets the queries at the start of a command buffer.
+    void beginFrame(VkCommandBuffer cmd);
+
+    /// @return The zone to pass to `endZone()`, or `NO_ZONE` if the frame
+    /// ran out of zones.
+    uint32_t beginZone(VkCommandBuffer cmd, const char* name);
+
+    void endZone(VkCommandBuffer cmd, uint32_t zone);
+
+    static constexpr uint32_t NO_ZONE = UINT32_MAX;
+
+  private:
+    VkQueryPool pool_ = VK_NULL_HANDLE;
+    /// Must outlive the frame, string literals are.
+    std::vector<const char*> names_;
+    std::vector<uint64_t> results_;
+};
+
+/// @brief Times everything recorded into `cmd` while it is alive. Times
+/// nothing if `timestamps` is null.
+class GpuZone {
+  public:
+    GpuZone(GpuTimestamps* timestamps, VkCommandBuffer cmd, const char* name)
+        : timestamps_(timestamps), cmd_(cmd),
+          zone_(timestamps != nullptr ? timestamps->beginZone(cmd, name) : GpuTimestamps::NO_ZONE) {}
+
+    ~GpuZone() {
+        if (timestamps_ != nullptr) {
+            timestamps_->endZone(cmd_, zone_);
+        }
+    }
+
+    GpuZone(const GpuZone&) = delete;
+    GpuZone& operator=(const GpuZone&) = delete;
+
+  private:
+    GpuTimestamps* timestamps_;
+    VkCommandBuffer cmd_;
+    uint32_t zone_;
+};
@@ -0,0 +1,152 @@
+#include "vk_upload.h"
+#include "vk_initializers.h"
+#include <cstdlib>
+#include <cstring>
+
+void UploadQueue::init(VkDevice device, VmaAllocator allocator, VkQueue queue, uint32_t queueFamily) {
+    device_ = device;
+    allocator_ = allocator;
+    queue_ = queue;
+    queueFamily_ = queueFamily;
+
+    VkSemaphoreTypeCreateInfo timelineInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo = vkinit::semaphore_create_info();
+    semaphoreInfo.pNext = &timelineInfo;
+    VK_CHECK(vkCreateSemaphore(device_, &semaphoreInfo, nullptr, &timeline_));
+
+    VkBufferCreateInfo bufferInfo = {.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    bufferInfo.size = STAGING_SIZE;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+    VmaAllocationCreateInfo vmaallocInfo = {};
+    vmaallocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+    vmaallocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VK_CHECK(vmaCreateBuffer(allocator_, &bufferInfo, &vmaallocInfo, &staging_.buffer, &staging_.allocation,
+                             &staging_.info));
+
+    VkCommandPoolCreateInfo poolInfo = vkinit::command_pool_create_info(queueFamily_);
+    for (Batch& batch : batches_) {
+        VK_CHECK(vkCreateCommandPool(device_, &poolInfo, nullptr, &batch.pool));
+
+        VkCommandBufferAllocateInfo cmdAllocInfo = vkinit::command_buffer_allocate_info(batch.pool, 1);
+        VK_CHECK(vkAllocateCommandBuffers(device_, &cmdAllocInfo, &batch.cmd));
+        batch.value = 0;
+    }
+}
+
+void UploadQueue::destroy() {
+    flush();
+    waitFor(nextValue_ - 1);
+
+    for (Batch& batch : batches_) {
+        vkDestroyCommandPool(device_, batch.pool, nullptr);
+    }
+    vmaDestroyBuffer(allocator_, staging_.buffer, staging_.allocation);
+    vkDestroySemaphore(device_, timeline_, nullptr);
+}
+
+uint64_t UploadQueue::uploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+    const uint64_t stagingOffset = allocateStaging(size);
+    std::memcpy(static_cast<uint8_t*>(staging_.info.pMappedData) + stagingOffset, data, size);
+
+    if (!recording_) {
+        beginBatch();
+    }
+
+    VkBufferCopy copy{};
+    copy.srcOffset = stagingOffset;
+    copy.dstOffset = dstOffset;
+    copy.size = size;
+    vkCmdCopyBuffer(batches_[currentBatch_].cmd, staging_.buffer, dst, 1, &copy);
+
+    return nextValue_;
+}
+
+void UploadQueue::flush() {
+    if (!recording_) {
+        return;
+    }
+
+    Batch& batch = batches_[currentBatch_];
+    VK_CHECK(vkEndCommandBuffer(batch.cmd));
+
+    VkCommandBufferSubmitInfo cmdInfo = vkinit::command_buffer_submit_info(batch.cmd);
+    VkSemaphoreSubmitInfo signalInfo = vkinit::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, timeline_);
+    signalInfo.value = nextValue_;
+
+    VkSubmitInfo2 submit = vkinit::submit_info(&cmdInfo, &signalInfo, nullptr);
+    VK_CHECK(vkQueueSubmit2(queue_, 1, &submit, VK_NULL_HANDLE));
+
+    batch.value = nextValue_;
+    inFlight_.push_back(InFlight{nextValue_, ring_.head()});
+
+    nextValue_ += 1;
+    currentBatch_ = (currentBatch_ + 1) % MAX_BATCHES;
+    recording_ = false;
+}
+
+uint64_t UploadQueue::completedValue() {
+    VK_CHECK(vkGetSemaphoreCounterValue(device_, timeline_, &completed_));
+
+    while (!inFlight_.empty() && inFlight_.front().value <= completed_) {
+        ring_.releaseUpTo(inFlight_.front().ringEnd);
+        inFlight_.pop_front();
+    }
+    return completed_;
+}
+
+void UploadQueue::waitFor(uint64_t value) {
+    if (value == 0 || completedValue() >= value) {
+        return;
+    }
+
+    VkSemaphoreWaitInfo waitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timeline_;
+    waitInfo.pValues = &value;
+    VK_CHECK(vkWaitSemaphores(device_, &waitInfo, UINT64_MAX));
+
+    completedValue();
+}
+
+void UploadQueue::beginBatch() {
+    Batch& batch = batches_[currentBatch_];
+    // every batch is in flight, so wait for the oldest
+    waitFor(batch.value);
+
+    VK_CHECK(vkResetCommandPool(device_, batch.pool, 0));
+
+    VkCommandBufferBeginInfo beginInfo = vkinit::command_buffer_begin_info(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    VK_CHECK(vkBeginCommandBuffer(batch.cmd, &beginInfo));
+    recording_ = true;
+}
+
+uint64_t UploadQueue::allocateStaging(VkDeviceSize size) {
+    if (size > STAGING_SIZE) {
+        std::println("Upload of {} bytes is bigger than the {} byte staging buffer", size, STAGING_SIZE);
+        abort();
+    }
+
+    std::optional<uint64_t> offset = ring_.allocate(size);
+    if (offset.has_value()) {
+        return *offset;
+    }
+
+    // the ring is full of copies that have not run yet, so submit them and
+    // wait for batches to finish until there is room
+    flush();
+    completedValue();
+    while (!(offset = ring_.allocate(size)).has_value()) {
+        // an empty ring fits any upload that passed the size check above
+        if (inFlight_.empty()) {
+            std::println("Staging ring has no room for {} bytes with nothing in flight", size);
+            abort();
+        }
+        waitFor(inFlight_.front().value);
+    }
+    return *offset;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "../ring_allocator.h"
+#include "vk_types.h"
+#include <array>
+#include <cstdint>
+#include <deque>
+
+/// @brief Copies data into GPU buffers without the CPU waiting for the copies
+/// to finish.
+///
+/// Data is written into a persistently mapped staging ring buffer, and the
+/// copies out of it are recorded into a batch that `flush()` submits, on a
+/// dedicated transfer queue when the device has one. Each batch signals the
+/// next value of a timeline semaphore, so finished uploads are found by
+/// reading the semaphore's value rather than waiting on a fence.
+///
+/// Buffers written on a separate transfer queue must be created with
+/// concurrent sharing between `queueFamily()` and the queues reading them.
+///
+/// The CPU only ever waits when the staging ring or every batch is in use.
+///
+/// # Thread Safety
+///
+/// Not thread safe. Only the render thread should upload.
+class UploadQueue {
+  public:
+    static constexpr uint64_t STAGING_SIZE = 64ull * 1024 * 1024;
+    /// Batches that can be in flight at once.
+    static constexpr uint32_t MAX_BATCHES = 8;
+
+    void init(VkDevice device, VmaAllocator allocator, VkQueue queue, uint32_t queueFamily);
+
+    /// @brief Waits for every upload and destroys the queue's objects.
+    void destroy();
+
+    /// @brief Stages `size` bytes of `data` to be copied to `dst` at
+    /// `dstOffset`, in the batch `flush()` submits next.
+    /// @return The timeline value at which the copy has finished.
+    uint64_t uploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+    /// @brief Submits every copy staged since the last flush.
+    void flush();
+
+    /// @return The highest timeline value reached, so every upload returning
+    /// a value up to it has finished. Frees the staging space they used.
+    uint64_t completedValue();
+
+    /// @return The value of the most recent upload, or 0 if there were none.
+    uint64_t lastUploadValue() const { return recording_ ? nextValue_ : nextValue_ - 1; }
+
+    VkSemaphore timelineSemaphore() const { return timeline_; }
+
+    VkQueue queue() const { return queue_; }
+
+    uint32_t queueFamily() const { return queueFamily_; }
+
+  private:
+    struct Batch {
+        VkCommandPool pool;
+        VkCommandBuffer cmd;
+        /// Timeline value signalled when the batch finishes, or 0 if unused.
+        uint64_t value;
+    };
+
+    struct InFlight {
+        uint64_t value;
+        /// `RingAllocator::head()` when the batch was submitted.
+        uint64_t ringEnd;
+    };
+
+    /// @brief Waits until the timeline reaches `value`.
+    void waitFor(uint64_t value);
+
+    void beginBatch();
+
+    /// @return The staging offset of `size` free bytes, flushing and waiting
+    /// for earlier batches if the ring is full.
+    uint64_t allocateStaging(VkDeviceSize size);
+
+    VkDevice device_;
+    VmaAllocator allocator_;
+    VkQueue queue_;
+    uint32_t queueFamily_;
+
+    VkSemaphore timeline_;
+    AllocatedBuffer staging_;
+    RingAllocator ring_{STAGING_SIZE};
+
+    std::array<Batch, MAX_BATCHES> batches_;
+    uint32_t currentBatch_ = 0;
+    /// Whether `batches_[currentBatch_]` is being recorded.
+    bool recording_ = false;
+    /// The value the batch being recorded, or the next one, will signal.
+    uint64_t nextValue_ = 1;
+    uint64_t completed_ = 0;
+    std::deque<InFlight> inFlight_;
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace jobs {
+/// @brief Lock-free work-stealing deque (Chase-Lev, with the memory orderings
+/// from Le et al. 2013). The owning thread pushes and pops at the bottom,
+/// any other thread may steal from the top.
+///
+/// `T` must be trivially copyable, and is generally a pointer.
+///
+/// # Thread Safety
+///
+/// `push()` and `pop()` may only be called by the owning thread. `steal()`
+/// may be called from any thread.
+template <typename T> class ChaseLevDeque {
+    static_assert(std::is_trivially_copyable_v<T>, "ChaseLevDeque elements must be trivially copyable");
+
+  public:
+    explicit ChaseLevDeque(int64_t initialCapacity = 256) {
+        int64_t capacity = 1;
+        while (capacity < initialCapacity) {
+            capacity <<= 1;
+        }
+        auto array = std::make_unique<Array>(capacity);
+        array_.store(array.get(), std::memory_order_relaxed);
+        arrays_.push_back(std::move(array));
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+    ChaseLevDeque(ChaseLevDeque&&) = delete;
+    ChaseLevDeque& operator=(ChaseLevDeque&&) = delete;
+
+    /// @brief Pushes an item onto the bottom of the deque, growing it if
+    /// needed. Owner thread only.
+    void push(T item) {
+        const int64_t b = bottom_.load(std::memory_order_relaxed);
+        const int64_t t = top_.load(std::memory_order_acquire);
+        Array* array = array_.load(std::memory_order_relaxed);
+        if (b - t > array->capacity - 1) {
+            array = grow(array, b, t);
+        }
+        array->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /// @brief Pops the most recently pushed item. Owner thread only.
+    /// @return `true` and writes `out` if an item was taken.
+    bool pop(T& out) {
+        const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* array = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // empty
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        T item = array->get(b);
+        if (t == b) {
+            // last item, race against thieves for it
+            const bool won =
+                top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            if (!won) {
+                return false;
+            }
+        }
+        out = item;
+        return true;
+    }
+
+    /// @brief Steals the oldest item. Safe from any thread.
+    /// @return `true` and writes `out` if an item was taken. A `false` return
+    /// may also mean another thread won the race, not only that the deque is
+    /// empty.
+    bool steal(T& out) {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+
+        Array* array = array_.load(std::memory_order_acquire);
+        T item = array->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;
+        }
+        out = item;
+        return true;
+    }
+
+    /// @return An approximation of the number of items, only exact when no
+    /// other thread is using the deque.
+    int64_t sizeApprox() const {
+        const int64_t b = bottom_.load(std::memory_order_relaxed);
+        const int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+  private:
+    struct Array {
+        int64_t capacity;
+        int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> data;
+
+        explicit Array(int64_t inCapacity)
+            : capacity(inCapacity), mask(inCapacity - 1), data(new std::atomic<T>[static_cast<size_t>(inCapacity)]) {}
+
+        T get(int64_t index) const { return data[index & mask].load(std::memory_order_relaxed); }
+
+        void put(int64_t index, T item) { data[index & mask].store(item, std::memory_order_relaxed); }
+    };
+
+    Array* grow(Array* old, int64_t bottom, int64_t top) {
+        auto grown = std::make_unique<Array>(old->capacity * 2);
+        for (int64_t i = top; i < bottom; i++) {
+            grown->put(i, old->get(i));
+        }
+        Array* raw = grown.get();
+        // Thieves may still be reading the old array, so it is only freed
+        // with the deque itself.
+        arrays_.push_back(std::move(grown));
+        array_.store(raw, std::memory_order_release);
+        return raw;
+    }
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    alignas(64) std::atomic<Array*> array_{nullptr};
+    std::vector<std::unique_ptr<Array>> arrays_;
+};
+} // namespace jobs
@@ -0,0 +1,354 @@
+#include "job_system.h"
+
+using jobs::Job;
+using jobs::JobCounter;
+using jobs::JobSystem;
+
+namespace {
+thread_local const JobSystem* tlsOwner = nullptr;
+thread_local uint32_t tlsWorkerIndex = JobSystem::NOT_A_WORKER;
+thread_local uint32_t tlsStealSeed = 0x9E3779B9u;
+
+/// How many times an idle worker looks for work before going to sleep.
+constexpr uint32_t IDLE_SPIN_LIMIT = 64;
+
+uint32_t nextStealVictim() {
+    // xorshift32
+    uint32_t x = tlsStealSeed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    tlsStealSeed = x;
+    return x;
+}
+} // namespace
+
+JobSystem::JobSystem(uint32_t workerCount) {
+    if (workerCount == 0) {
+        const uint32_t hardware = std::thread::hardware_concurrency();
+        workerCount = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    workers_.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    // Only start the threads once every worker exists, as they steal from
+    // each other immediately.
+    for (uint32_t i = 0; i < workerCount; i++) {
+        workers_[i]->thread = std::thread([this, i]() { this->workerLoop(i); });
+    }
+}
+
+JobSystem::~JobSystem() noexcept {
+    {
+        std::lock_guard lock(sleepMutex_);
+        stopping_.store(true);
+    }
+    sleepCondition_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+uint32_t JobSystem::currentWorkerIndex() { return tlsWorkerIndex; }
+
+uint32_t JobSystem::localWorkerIndex() const { return tlsOwner == this ? tlsWorkerIndex : NOT_A_WORKER; }
+
+void JobSystem::schedule(Job* job) {
+    const uint32_t priority = static_cast<uint32_t>(job->priority_);
+    const uint32_t workerIndex = localWorkerIndex();
+    if (workerIndex != NOT_A_WORKER) {
+        workers_[workerIndex]->queues[priority].push(job);
+    } else {
+        std::lock_guard lock(injectMutex_);
+        injected_[priority].push_back(job);
+    }
+
+    queuedJobs_.fetch_add(1);
+    if (sleepingWorkers_.load() > 0) {
+        // Taking the lock orders this with a worker that is between checking
+        // for work and going to sleep, so the notify cannot be lost.
+        { std::lock_guard lock(sleepMutex_); }
+        sleepCondition_.notify_one();
+    }
+}
+
+void JobSystem::scheduleAfter(JobCounter& dependency, Job* job) {
+    {
+        std::lock_guard lock(dependency.waitersMutex_);
+        if (dependency.pending_.load(std::memory_order_acquire) != 0) {
+            dependency.waiters_.push_back(job);
+            return;
+        }
+    }
+    schedule(job);
+}
+
+Job* JobSystem::findJob(uint32_t workerIndex) {
+    const uint32_t workerCount = this->workerCount();
+
+    for (uint32_t priority = 0; priority < JOB_PRIORITY_COUNT; priority++) {
+        Job* job = nullptr;
+
+        if (workerIndex != NOT_A_WORKER && workers_[workerIndex]->queues[priority].pop(job)) {
+            queuedJobs_.fetch_sub(1);
+            return job;
+        }
+
+        {
+            std::lock_guard lock(injectMutex_);
+            if (!injected_[priority].empty()) {
+                job = injected_[priority].front();
+                injected_[priority].pop_front();
+            }
+        }
+        if (job != nullptr) {
+            queuedJobs_.fetch_sub(1);
+            return job;
+        }
+
+        const uint32_t start = nextStealVictim();
+        for (uint32_t i = 0; i < workerCount; i++) {
+            const uint32_t victim = (start + i) % workerCount;
+            if (victim == workerIndex) {
+                continue;
+            }
+            if (workers_[victim]->queues[priority].steal(job)) {
+                queuedJobs_.fetch_sub(1);
+                return job;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(Job* job) {
+    job->run();
+    JobCounter* counter = job->counter_;
+    delete job;
+
+    if (counter == nullptr) {
+        return;
+    }
+
+    std::vector<Job*> ready;
+    {
+        // Decrementing under the lock guarantees `wait()` cannot return, and
+        // the counter be destroyed, while this thread still uses it.
+        std::lock_guard lock(counter->waitersMutex_);
+        if (counter->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ready.swap(counter->waiters_);
+        }
+    }
+    for (Job* dependent : ready) {
+        schedule(dependent);
+    }
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    const uint32_t workerIndex = localWorkerIndex();
+    while (!counter.isDone()) {
+        if (Job* job = findJob(workerIndex)) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    // The job that finished the counter may still be inside `execute()`.
+    std::lock_guard lock(counter.waitersMutex_);
+}
+
+void JobSystem::workerLoop(uint32_t workerIndex) {
+    tlsOwner = this;
+    tlsWorkerIndex = workerIndex;
+    tlsStealSeed = 0x9E3779B9u * (workerIndex + 1);
+
+    uint32_t idleSpins = 0;
+    while (true) {
+        if (Job* job = findJob(workerIndex)) {
+            execute(job);
+            idleSpins = 0;
+            continue;
+        }
+
+        if (stopping_.load()) {
+            break;
+        }
+
+        if (++idleSpins < IDLE_SPIN_LIMIT) {
+            std::this_thread::yield();
+            continue;
+        }
+        idleSpins = 0;
+
+        std::unique_lock lock(sleepMutex_);
+        sleepingWorkers_.fetch_add(1);
+        sleepCondition_.wait(lock, [this]() { return queuedJobs_.load() > 0 || stopping_.load(); });
+        sleepingWorkers_.fetch_sub(1);
+    }
+
+    tlsOwner = nullptr;
+    tlsWorkerIndex = NOT_A_WORKER;
+}
+
+#ifndef NO_TESTS
+
+#include <chrono>
+#include <doctest.h>
+
+using jobs::ChaseLevDeque;
+using jobs::JobPriority;
+
+TEST_SUITE("Jobs") {
+    TEST_CASE("deque pops newest and steals oldest") {
+        ChaseLevDeque<uintptr_t> deque(4);
+        for (uintptr_t i = 1; i <= 100; i++) {
+            deque.push(i);
+        }
+        CHECK(deque.sizeApprox() == 100);
+
+        uintptr_t item = 0;
+        REQUIRE(deque.pop(item));
+        CHECK(item == 100);
+        REQUIRE(deque.steal(item));
+        CHECK(item == 1);
+
+        uintptr_t count = 2;
+        while (deque.pop(item)) {
+            count++;
+        }
+        CHECK(count == 100);
+        CHECK_FALSE(deque.steal(item));
+    }
+
+    TEST_CASE("deque items are taken exactly once under contention") {
+        constexpr uintptr_t ITEMS = 20000;
+        ChaseLevDeque<uintptr_t> deque(16);
+        std::atomic<uint64_t> stolenSum{0};
+        std::atomic<bool> done{false};
+
+        std::vector<std::thread> thieves;
+        for (int t = 0; t < 3; t++) {
+            thieves.emplace_back([&]() {
+                uintptr_t item = 0;
+                while (!done.load() || deque.sizeApprox() > 0) {
+                    if (deque.steal(item)) {
+                        stolenSum.fetch_add(item);
+                    }
+                }
+            });
+        }
+
+        uint64_t poppedSum = 0;
+        uintptr_t item = 0;
+        for (uintptr_t i = 1; i <= ITEMS; i++) {
+            deque.push(i);
+            if (i % 3 == 0 && deque.pop(item)) {
+                poppedSum += item;
+            }
+        }
+        while (deque.pop(item)) {
+            poppedSum += item;
+        }
+        done.store(true);
+        for (auto& thief : thieves) {
+            thief.join();
+        }
+
+        CHECK(poppedSum + stolenSum.load() == static_cast<uint64_t>(ITEMS) * (ITEMS + 1) / 2);
+    }
+
+    TEST_CASE("submit and wait on a counter") {
+        JobSystem jobSystem(4);
+        JobCounter counter;
+        std::atomic<int> ran{0};
+
+        for (int i = 0; i < 1000; i++) {
+            jobSystem.submit([&ran]() { ran.fetch_add(1); }, &counter,
+                             static_cast<JobPriority>(i % jobs::JOB_PRIORITY_COUNT));
+        }
+        jobSystem.wait(counter);
+        CHECK(ran.load() == 1000);
+        CHECK(counter.isDone());
+    }
+
+    TEST_CASE("dependent jobs run after their dependency") {
+        JobSystem jobSystem(3);
+        JobCounter first;
+        JobCounter second;
+        std::atomic<int> firstRan{0};
+        std::atomic<bool> orderedCorrectly{true};
+
+        // Submitted before the dependency has any work, then held back once it does.
+        for (int i = 0; i < 64; i++) {
+            jobSystem.submit(
+                [&firstRan]() {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    firstRan.fetch_add(1);
+                },
+                &first);
+        }
+        for (int i = 0; i < 16; i++) {
+            jobSystem.submitAfter(
+                first,
+                [&]() {
+                    if (firstRan.load() != 64) {
+                        orderedCorrectly.store(false);
+                    }
+                },
+                &second);
+        }
+        jobSystem.wait(second);
+        CHECK(orderedCorrectly.load());
+        CHECK(first.isDone());
+    }
+
+    TEST_CASE("parallel for visits every index once") {
+        JobSystem jobSystem(4);
+        std::vector<std::atomic<int>> hits(10007);
+        jobSystem.parallelFor(0, static_cast<uint32_t>(hits.size()), 64,
+                              [&hits](uint32_t i) { hits[i].fetch_add(1); });
+
+        bool allOnce = true;
+        for (auto& hit : hits) {
+            allOnce &= hit.load() == 1;
+        }
+        CHECK(allOnce);
+    }
+
+    TEST_CASE("nested parallel for does not deadlock a single worker") {
+        JobSystem jobSystem(1);
+        std::atomic<uint64_t> sum{0};
+        JobCounter counter;
+        jobSystem.submit(
+            [&]() {
+                jobSystem.parallelFor(0, 100, 7, [&](uint32_t i) {
+                    jobSystem.parallelFor(0, 10, 3, [&](uint32_t j) { sum.fetch_add(i * 10 + j); });
+                });
+            },
+            &counter);
+        jobSystem.wait(counter);
+        CHECK(sum.load() == 999ull * 1000ull / 2ull);
+    }
+
+    TEST_CASE("worker index is only set on workers") {
+        JobSystem jobSystem(2);
+        CHECK(JobSystem::currentWorkerIndex() == JobSystem::NOT_A_WORKER);
+
+        std::atomic<uint32_t> seen{JobSystem::NOT_A_WORKER};
+        JobCounter counter;
+        jobSystem.submit([&seen]() { seen.store(JobSystem::currentWorkerIndex()); }, &counter);
+        // Spin rather than wait, as waiting would let this thread run the job itself.
+        while (!counter.isDone()) {
+            std::this_thread::yield();
+        }
+        jobSystem.wait(counter);
+        CHECK(seen.load() < jobSystem.workerCount());
+    }
+}
+
+#endif
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "chase_lev_deque.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jobs {
+/// @brief Workers always take the highest priority job available, first from
+/// their own queue, then from other threads.
+enum class JobPriority : uint8_t {
+    High = 0,
+    Normal = 1,
+    Low = 2,
+};
+
+constexpr uint32_t JOB_PRIORITY_COUNT = 3;
+
+class JobSystem;
+class JobCounter;
+
+/// @brief Type erased unit of work. Created by `JobSystem::submit()` and
+/// deleted once it has run.
+class Job {
+  public:
+    virtual ~Job() = default;
+
+    virtual void run() = 0;
+
+  private:
+    friend class JobSystem;
+
+    JobCounter* counter_ = nullptr;
+    JobPriority priority_ = JobPriority::Normal;
+};
+
+namespace detail {
+template <typename F> class FunctionJob final : public Job {
+  public:
+    explicit FunctionJob(F&& fn) : fn_(std::move(fn)) {}
+
+    void run() override { fn_(); }
+
+  private:
+    F fn_;
+};
+} // namespace detail
+
+/// @brief Tracks how many jobs attached to it are still outstanding. Other
+/// jobs may depend on a counter through `JobSystem::submitAfter()`, and will
+/// be scheduled once it reaches zero.
+///
+/// A counter may be reused once it reaches zero. Only destroy a counter after
+/// `JobSystem::wait()` on it has returned, as the last finishing job may
+/// otherwise still be touching it.
+class JobCounter {
+  public:
+    JobCounter() = default;
+
+    JobCounter(const JobCounter&) = delete;
+    JobCounter(JobCounter&&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+    JobCounter& operator=(JobCounter&&) = delete;
+
+    ~JobCounter() noexcept = default;
+
+    /// @return `true` if every job attached to this counter has finished.
+    bool isDone() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+    uint32_t pending() const { return pending_.load(std::memory_order_acquire); }
+
+  private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> pending_{0};
+    std::mutex waitersMutex_;
+    std::vector<Job*> waiters_;
+};
+
+/// @brief Fixed pool of worker threads, each owning a work-stealing deque per
+/// priority. Shared by the client and the server for chunk generation,
+/// meshing, lighting and packet processing.
+///
+/// Jobs must not throw. Any thread may submit and wait. Threads that are not
+/// workers (such as the main thread) push into a shared injection queue, and
+/// run jobs themselves while they `wait()`.
+class JobSystem {
+  public:
+    static constexpr uint32_t NOT_A_WORKER = UINT32_MAX;
+
+    /// @brief Starts the worker threads.
+    /// @param workerCount How many workers to start. `0` uses one per hardware
+    /// thread, minus one for the calling thread.
+    explicit JobSystem(uint32_t workerCount = 0);
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+
+    /// @brief Finishes every scheduled job, then joins the workers. Jobs still
+    /// waiting on an unfinished dependency are never run.
+    ~JobSystem() noexcept;
+
+    uint32_t workerCount() const { return static_cast<uint32_t>(workers_.size()); }
+
+    /// @brief Schedules `fn` to run on any worker.
+    /// @param counter Optional counter incremented now and decremented once
+    /// `fn` has run.
+    template <typename F>
+    void submit(F&& fn, JobCounter* counter = nullptr, JobPriority priority = JobPriority::Normal) {
+        schedule(makeJob(std::forward<F>(fn), counter, priority));
+    }
+
+    /// @brief Schedules `fn` to run once `dependency` reaches zero. If it
+    /// already has, this behaves like `submit()`.
+    /// @param counter Optional counter incremented now and decremented once
+    /// `fn` has run.
+    template <typename F>
+    void submitAfter(JobCounter& dependency, F&& fn, JobCounter* counter = nullptr,
+                     JobPriority priority = JobPriority::Normal) {
+        scheduleAfter(dependency, makeJob(std::forward<F>(fn), counter, priority));
+    }
+
+    /// @brief Calls `fn(i)` for every `i` in [begin, end), split into batches
+    /// of `grainSize` indices that run in parallel. Blocks until every batch
+    /// has run, with the calling thread helping out. Safe to call from inside
+    /// a job.
+    template <typename F>
+    void parallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, F&& fn,
+                     JobPriority priority = JobPriority::Normal) {
+        if (begin >= end) {
+            return;
+        }
+        grainSize = std::max(grainSize, 1u);
+
+        JobCounter counter;
+        for (uint32_t start = begin; start < end;) {
+            const uint32_t stop = end - start > grainSize ? start + grainSize : end;
+            submit(
+                [&fn, start, stop]() {
+                    for (uint32_t i = start; i < stop; i++) {
+                        fn(i);
+                    }
+                },
+                &counter, priority);
+            start = stop;
+        }
+        wait(counter);
+    }
+
+    /// @brief Blocks until `counter` reaches zero. The calling thread runs
+    /// other jobs in the meantime, so waiting from inside a job cannot
+    /// deadlock the pool.
+    void wait(JobCounter& counter);
+
+    /// @return The index of the calling worker thread within its job
+    /// system, or `NOT_A_WORKER` if called from any other thread.
+    static uint32_t currentWorkerIndex();
+
+  private:
+    template <typename F> Job* makeJob(F&& fn, JobCounter* counter, JobPriority priority) {
+        using Fn = std::decay_t<F>;
+        Job* job = new detail::FunctionJob<Fn>(Fn(std::forward<F>(fn)));
+        job->counter_ = counter;
+        job->priority_ = priority;
+        if (counter != nullptr) {
+            counter->pending_.fetch_add(1, std::memory_order_acq_rel);
+        }
+        return job;
+    }
+
+    void schedule(Job* job);
+
+    void scheduleAfter(JobCounter& dependency, Job* job);
+
+    Job* findJob(uint32_t workerIndex);
+
+    void execute(Job* job);
+
+    void workerLoop(uint32_t workerIndex);
+
+    uint32_t localWorkerIndex() const;
+
+    struct Worker {
+        ChaseLevDeque<Job*> queues[JOB_PRIORITY_COUNT];
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    std::mutex injectMutex_;
+    std::deque<Job*> injected_[JOB_PRIORITY_COUNT];
+
+    /// Jobs pushed but not yet taken. May briefly dip below zero when a job
+    /// is stolen before its push is counted.
+    std::atomic<int32_t> queuedJobs_{0};
+    std::atomic<uint32_t> sleepingWorkers_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCondition_;
+};
+} // namespace jobs
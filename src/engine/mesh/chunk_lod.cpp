@@ -0,0 +1,166 @@
+#include "chunk_lod.h"
+#include <array>
+
+using mesh::LodCell;
+using world::BlockId;
+using world::Chunk;
+using world::CHUNK_SIZE;
+
+void mesh::downsampleCell(const world::World& world, LodCell cell, Chunk& out) {
+    const int32_t scale = cell.scale();
+    // coarse blocks per chunk of the cell along each axis
+    const int32_t perChunk = CHUNK_SIZE / scale;
+    const world::ChunkPos first = cell.firstChunk();
+
+    for (int32_t cy = 0; cy < scale; cy++) {
+        for (int32_t cz = 0; cz < scale; cz++) {
+            for (int32_t cx = 0; cx < scale; cx++) {
+                const Chunk* source = world.chunk(first.offset(cx, cy, cz));
+
+                for (int32_t y = 0; y < perChunk; y++) {
+                    for (int32_t z = 0; z < perChunk; z++) {
+                        for (int32_t x = 0; x < perChunk; x++) {
+                            BlockId coarse = world::blocks::AIR;
+                            // the first layer down with anything solid picks the block
+                            for (int32_t fy = scale - 1; source != nullptr && fy >= 0; fy--) {
+                                std::array<uint32_t, world::blocks::COUNT> counts{};
+                                uint32_t best = 0;
+                                for (int32_t fz = 0; fz < scale; fz++) {
+                                    for (int32_t fx = 0; fx < scale; fx++) {
+                                        const BlockId id =
+                                            source->block(x * scale + fx, y * scale + fy, z * scale + fz);
+                                        if (!world::blockProperties(id).solid) {
+                                            continue;
+                                        }
+                                        counts[id]++;
+                                        // ties go to the lowest id, so the result does not depend on order
+                                        if (counts[id] > best || (counts[id] == best && id < coarse)) {
+                                            best = counts[id];
+                                            coarse = id;
+                                        }
+                                    }
+                                }
+                                if (best != 0) {
+                                    break;
+                                }
+                            }
+                            out.setBlock(cx * perChunk + x, cy * perChunk + y, cz * perChunk + z, coarse);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+mesh::LodMesher::LodMesher() : coarse_(std::make_unique<Chunk>(world::ChunkPos{})) {}
+
+void mesh::LodMesher::mesh(const world::World& world, LodCell cell, ChunkMesh& out) {
+    if (cell.level == 0) {
+        mesher_.mesh(ChunkNeighbourhood::gather(world, cell.pos), out);
+        return;
+    }
+
+    downsampleCell(world, cell, *coarse_);
+    ChunkNeighbourhood alone;
+    alone.chunks[ChunkNeighbourhood::index(0, 0, 0)] = coarse_.get();
+    mesher_.mesh(alone, out);
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+namespace blocks = world::blocks;
+
+TEST_SUITE("ChunkLod") {
+    TEST_CASE("cells nest") {
+        const LodCell cell{world::ChunkPos{-1, 0, 2}, 2};
+        CHECK(cell.firstChunk() == world::ChunkPos{-4, 0, 8});
+        CHECK(cell.child(0) == LodCell{world::ChunkPos{-2, 0, 4}, 1});
+        CHECK(cell.child(7) == LodCell{world::ChunkPos{-1, 1, 5}, 1});
+        CHECK(LodCell::containing(world::ChunkPos{-4, 3, 11}, 2) == cell);
+        CHECK(LodCell::containing(world::ChunkPos{-5, 0, 8}, 2).pos.x == -2);
+    }
+
+    TEST_CASE("coarse blocks keep anything solid") {
+        world::World world;
+        Chunk& chunk = world.getOrCreateChunk(world::ChunkPos{1, 0, 0});
+        // one block in the cell's second chunk along x
+        chunk.setBlock(3, 0, 0, blocks::STONE);
+        // a torch is not solid, so it does not count
+        chunk.setBlock(0, 5, 0, blocks::TORCH);
+
+        Chunk coarse(world::ChunkPos{});
+        mesh::downsampleCell(world, LodCell{world::ChunkPos{0, 0, 0}, 1}, coarse);
+        CHECK(coarse.block(17, 0, 0) == blocks::STONE);
+        CHECK(coarse.block(16, 0, 0) == blocks::AIR);
+        CHECK(coarse.block(16, 2, 0) == blocks::AIR);
+        CHECK(coarse.block(1, 0, 0) == blocks::AIR);
+    }
+
+    TEST_CASE("the top layer picks the block") {
+        world::World world;
+        Chunk& chunk = world.getOrCreateChunk(world::ChunkPos{0, 0, 0});
+        // mostly stone, under a grass layer with a patch of sand
+        for (int32_t y = 0; y < 4; y++) {
+            for (int32_t z = 0; z < 4; z++) {
+                for (int32_t x = 0; x < 4; x++) {
+                    chunk.setBlock(x, y, z, y < 3 ? blocks::STONE : blocks::GRASS);
+                }
+            }
+        }
+        chunk.setBlock(0, 3, 0, blocks::SAND);
+        chunk.setBlock(1, 3, 0, blocks::SAND);
+
+        Chunk coarse(world::ChunkPos{});
+        mesh::downsampleCell(world, LodCell{world::ChunkPos{0, 0, 0}, 2}, coarse);
+        CHECK(coarse.block(0, 0, 0) == blocks::GRASS);
+
+        // an even split goes to the lower id
+        for (int32_t x = 0; x < 4; x++) {
+            for (int32_t z = 0; z < 4; z++) {
+                chunk.setBlock(x, 3, z, z < 2 ? blocks::SAND : blocks::DIRT);
+            }
+        }
+        mesh::downsampleCell(world, LodCell{world::ChunkPos{0, 0, 0}, 2}, coarse);
+        CHECK(coarse.block(0, 0, 0) == blocks::DIRT);
+    }
+
+    TEST_CASE("coarse meshes keep their border faces as skirts") {
+        world::World world;
+        for (int32_t z = 0; z < 2; z++) {
+            for (int32_t x = 0; x < 2; x++) {
+                for (int32_t y = 0; y < 2; y++) {
+                    Chunk& chunk = world.getOrCreateChunk(world::ChunkPos{x, y, z});
+                    for (uint32_t i = 0; i < world::CHUNK_VOLUME; i++) {
+                        chunk.setBlock(i, blocks::STONE);
+                    }
+                }
+            }
+        }
+        // the neighbouring chunks would hide the border at full resolution
+        world.getOrCreateChunk(world::ChunkPos{2, 0, 0}).setBlock(0, 0, 0, blocks::STONE);
+
+        mesh::LodMesher mesher;
+        mesh::ChunkMesh coarse;
+        mesher.mesh(world, LodCell{world::ChunkPos{0, 0, 0}, 1}, coarse);
+        // a solid cube of one block merges into a quad per face
+        REQUIRE(coarse.quads.size() == mesh::FACE_COUNT);
+        for (const mesh::MeshQuad& quad : coarse.quads) {
+            CHECK(quad.width == CHUNK_SIZE);
+            CHECK(quad.height == CHUNK_SIZE);
+        }
+
+        mesh::ChunkMesh full;
+        mesher.mesh(world, LodCell{world::ChunkPos{1, 0, 0}, 0}, full);
+        // only the unloaded sides of the chunk show, less the block against +x
+        uint32_t posX = 0;
+        for (const mesh::MeshQuad& quad : full.quads) {
+            posX += quad.face == mesh::Face::PosX ? quad.width * quad.height : 0;
+        }
+        CHECK(posX == CHUNK_SIZE * CHUNK_SIZE - 1);
+    }
+}
+
+#endif
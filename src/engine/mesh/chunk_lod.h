@@ -0,0 +1,82 @@
+#pragma once
+
+#include "chunk_mesher.h"
+#include <cstdint>
+#include <memory>
+
+namespace mesh {
+/// Levels of detail, from 0 at full resolution to `LOD_LEVELS - 1`, where
+/// each block of a mesh is 8 blocks across.
+constexpr uint32_t LOD_LEVELS = 4;
+
+/// @brief A cube of chunks meshed together at one level of detail. A cell at
+/// `level` spans `2^level` chunks along each axis, downsampled to a single
+/// chunk's worth of blocks each `2^level` blocks across.
+struct LodCell {
+    /// Position in cells of this level, so the first chunk of the cell is
+    /// `pos * 2^level`.
+    world::ChunkPos pos;
+    uint32_t level;
+
+    bool operator==(const LodCell&) const = default;
+
+    /// @return How many chunks, or blocks of the mesh, the cell spans.
+    int32_t scale() const { return 1 << level; }
+
+    world::ChunkPos firstChunk() const { return world::ChunkPos{pos.x * scale(), pos.y * scale(), pos.z * scale()}; }
+
+    /// @return One of the 8 cells of the next finer level inside this one,
+    /// with bit 0 of `index` picking the x half, bit 1 y and bit 2 z.
+    LodCell child(uint32_t index) const {
+        return LodCell{world::ChunkPos{pos.x * 2 + static_cast<int32_t>(index & 1),
+                                       pos.y * 2 + static_cast<int32_t>(index >> 1 & 1),
+                                       pos.z * 2 + static_cast<int32_t>(index >> 2 & 1)},
+                       level - 1};
+    }
+
+    /// @return The cell of `level` that holds `chunk`.
+    static LodCell containing(world::ChunkPos chunk, uint32_t level) {
+        // arithmetic shifts round towards negative infinity, as cells do
+        return LodCell{world::ChunkPos{chunk.x >> level, chunk.y >> level, chunk.z >> level}, level};
+    }
+};
+
+struct LodCellHash {
+    size_t operator()(const LodCell& cell) const noexcept {
+        return world::ChunkPosHash{}(cell.pos) * 31 + cell.level;
+    }
+};
+
+/// @brief Fills `out` with the blocks of `cell` downsampled to one block per
+/// `2^level` blocks along each axis. `out`'s position is left alone.
+///
+/// A coarse block is solid if any block it covers is, so coarse meshes
+/// enclose everything the finer ones would draw. It takes the most common
+/// solid block of the highest layer it covers that has any, which keeps grass
+/// on top of hills. Chunks that are not loaded count as air.
+void downsampleCell(const world::World& world, LodCell cell, world::Chunk& out);
+
+/// @brief Meshes cells at any level of detail.
+///
+/// Level 0 cells are meshed like any chunk, hiding faces against the chunks
+/// around them. Coarser cells are downsampled and meshed on their own, so
+/// every face on the border of the cell is kept. Those faces hang down over
+/// the step where a coarser cell meets a finer one, as skirts that hide the
+/// crack between them, since the coarser surface is never below the finer.
+///
+/// # Thread Safety
+///
+/// Holds scratch space, so give each thread its own. The world must not
+/// change while `mesh()` runs.
+class LodMesher {
+  public:
+    LodMesher();
+
+    void mesh(const world::World& world, LodCell cell, ChunkMesh& out);
+
+  private:
+    ChunkMesher mesher_;
+    /// Too large for the stack.
+    std::unique_ptr<world::Chunk> coarse_;
+};
+} // namespace mesh
@@ -0,0 +1,674 @@
+#include "chunk_mesher.h"
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+using mesh::ChunkMesh;
+using mesh::ChunkMesher;
+using mesh::ChunkNeighbourhood;
+using mesh::Face;
+using mesh::MeshQuad;
+using world::BlockId;
+using world::Chunk;
+using world::CHUNK_SIZE;
+
+namespace {
+constexpr uint32_t BLOCK_COUNT = world::blocks::COUNT;
+
+constexpr std::array<uint8_t, BLOCK_COUNT> OPAQUE = [] {
+    std::array<uint8_t, BLOCK_COUNT> opaque{};
+    for (uint32_t i = 0; i < BLOCK_COUNT; i++) {
+        opaque[i] = world::BLOCK_PROPERTIES[i].opaque ? 1 : 0;
+    }
+    return opaque;
+}();
+
+/// Distance between neighbouring padded blocks along each axis.
+constexpr std::array<int32_t, 3> PADDED_STRIDE = {1, (CHUNK_SIZE + 2) * (CHUNK_SIZE + 2), CHUNK_SIZE + 2};
+
+/// @return `id`, or air if it is not a known block.
+inline BlockId knownBlock(BlockId id) { return id < BLOCK_COUNT ? id : world::blocks::AIR; }
+
+/// @return Where padded coordinate `p` comes from, as a chunk offset from
+/// -1 to 1 and a coordinate within that chunk.
+inline std::pair<int32_t, int32_t> paddedSource(int32_t p) {
+    const int32_t offset = p == 0 ? -1 : (p == CHUNK_SIZE + 1 ? 1 : 0);
+    return {offset, (p - 1) & world::CHUNK_MASK};
+}
+
+/// Direction of each quad corner along the quad's `u` and `v` axes, in the
+/// order corners are stored in `MeshQuad::ao`.
+constexpr std::array<int32_t, 4> CORNER_U = {-1, 1, 1, -1};
+constexpr std::array<int32_t, 4> CORNER_V = {-1, -1, 1, 1};
+
+MeshQuad makeQuad(const std::array<int32_t, 3>& pos, Face face, int32_t width, int32_t height, BlockId id,
+                  uint8_t ao) {
+    MeshQuad quad;
+    quad.x = static_cast<uint8_t>(pos[0]);
+    quad.y = static_cast<uint8_t>(pos[1]);
+    quad.z = static_cast<uint8_t>(pos[2]);
+    quad.face = face;
+    quad.width = static_cast<uint8_t>(width);
+    quad.height = static_cast<uint8_t>(height);
+    quad.block = id;
+    quad.ao = ao;
+    return quad;
+}
+
+/// @brief Transposes a 64x64 bit matrix in place, so bit `j` of row `i`
+/// becomes bit `i` of row `j`, by swapping ever smaller blocks.
+void transposeBits(std::array<uint64_t, 64>& rows) {
+    uint64_t mask = 0x00000000FFFFFFFFull;
+    for (int32_t width = 32; width != 0; width >>= 1, mask ^= mask << width) {
+        for (int32_t k = 0; k < 64; k = (k + width + 1) & ~width) {
+            const uint64_t swap = ((rows[k] >> width) ^ rows[k + width]) & mask;
+            rows[k + width] ^= swap;
+            rows[k] ^= swap << width;
+        }
+    }
+}
+} // namespace
+
+ChunkNeighbourhood ChunkNeighbourhood::gather(const world::World& world, world::ChunkPos pos) {
+    ChunkNeighbourhood out;
+    for (int32_t dy = -1; dy <= 1; dy++) {
+        for (int32_t dz = -1; dz <= 1; dz++) {
+            for (int32_t dx = -1; dx <= 1; dx++) {
+                out.chunks[index(dx, dy, dz)] = world.chunk(pos.offset(dx, dy, dz));
+            }
+        }
+    }
+    return out;
+}
+
+ChunkMesher::ChunkMesher()
+    : blocks_(static_cast<size_t>(PADDED) * PADDED_AREA), filled_(world::CHUNK_VOLUME / 64) {
+    for (int axis = 0; axis < 3; axis++) {
+        solidColumns_[axis].resize(PADDED_AREA);
+        opaqueColumns_[axis].resize(PADDED_AREA);
+    }
+}
+
+void ChunkMesher::mesh(const ChunkNeighbourhood& input, ChunkMesh& out) {
+    out.clear();
+    if (input.center() == nullptr) {
+        return;
+    }
+
+    loadBlocks(input);
+    buildColumns();
+    for (uint32_t f = 0; f < FACE_COUNT; f++) {
+        out.faceOffsets[f] = static_cast<uint32_t>(out.quads.size());
+        collectFaces(static_cast<Face>(f));
+        mergeFaces(static_cast<Face>(f), out);
+    }
+    out.faceOffsets[FACE_COUNT] = static_cast<uint32_t>(out.quads.size());
+    findVisibility(out);
+}
+
+void ChunkMesher::findVisibility(ChunkMesh& out) {
+    out.visibility = mesh::ChunkVisibility{};
+    std::fill(filled_.begin(), filled_.end(), 0);
+
+    const auto open = [&](int32_t x, int32_t y, int32_t z) {
+        return OPAQUE[blocks_[paddedIndex(x + 1, y + 1, z + 1)]] == 0;
+    };
+    // marks the block filled, and says whether it was not already
+    const auto fill = [&](uint32_t index) {
+        const uint64_t bit = uint64_t(1) << (index & 63);
+        const bool fresh = (filled_[index >> 6] & bit) == 0;
+        filled_[index >> 6] |= bit;
+        return fresh;
+    };
+
+    for (int32_t y = 0; y < CHUNK_SIZE; y++) {
+        for (int32_t z = 0; z < CHUNK_SIZE; z++) {
+            for (int32_t x = 0; x < CHUNK_SIZE; x++) {
+                if (!open(x, y, z) || !fill(Chunk::index(x, y, z))) {
+                    continue;
+                }
+
+                // the faces this region of open blocks touches
+                uint32_t faces = 0;
+                floodStack_.push_back(static_cast<uint16_t>(Chunk::index(x, y, z)));
+                while (!floodStack_.empty()) {
+                    const uint32_t index = floodStack_.back();
+                    floodStack_.pop_back();
+                    const int32_t bx = static_cast<int32_t>(index) & world::CHUNK_MASK;
+                    const int32_t bz = static_cast<int32_t>(index >> world::CHUNK_SHIFT) & world::CHUNK_MASK;
+                    const int32_t by = static_cast<int32_t>(index >> (2 * world::CHUNK_SHIFT));
+
+                    faces |= (bx == CHUNK_SIZE - 1 ? 1u << static_cast<uint32_t>(Face::PosX) : 0) |
+                             (bx == 0 ? 1u << static_cast<uint32_t>(Face::NegX) : 0) |
+                             (by == CHUNK_SIZE - 1 ? 1u << static_cast<uint32_t>(Face::PosY) : 0) |
+                             (by == 0 ? 1u << static_cast<uint32_t>(Face::NegY) : 0) |
+                             (bz == CHUNK_SIZE - 1 ? 1u << static_cast<uint32_t>(Face::PosZ) : 0) |
+                             (bz == 0 ? 1u << static_cast<uint32_t>(Face::NegZ) : 0);
+
+                    const auto spread = [&](int32_t nx, int32_t ny, int32_t nz) {
+                        if (open(nx, ny, nz) && fill(Chunk::index(nx, ny, nz))) {
+                            floodStack_.push_back(static_cast<uint16_t>(Chunk::index(nx, ny, nz)));
+                        }
+                    };
+                    if (bx > 0) {
+                        spread(bx - 1, by, bz);
+                    }
+                    if (bx < CHUNK_SIZE - 1) {
+                        spread(bx + 1, by, bz);
+                    }
+                    if (by > 0) {
+                        spread(bx, by - 1, bz);
+                    }
+                    if (by < CHUNK_SIZE - 1) {
+                        spread(bx, by + 1, bz);
+                    }
+                    if (bz > 0) {
+                        spread(bx, by, bz - 1);
+                    }
+                    if (bz < CHUNK_SIZE - 1) {
+                        spread(bx, by, bz + 1);
+                    }
+                }
+
+                out.visibility.connectFaces(faces);
+                if (out.visibility == mesh::ChunkVisibility::all()) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+void ChunkMesher::loadBlocks(const ChunkNeighbourhood& input) {
+    for (int32_t py = 0; py < PADDED; py++) {
+        const auto [dy, y] = paddedSource(py);
+        for (int32_t pz = 0; pz < PADDED; pz++) {
+            const auto [dz, z] = paddedSource(pz);
+            BlockId* row = &blocks_[paddedIndex(0, py, pz)];
+
+            const Chunk* middle = input.chunks[ChunkNeighbourhood::index(0, dy, dz)];
+            if (middle != nullptr) {
+                const BlockId* src = &middle->blocks()[Chunk::index(0, y, z)];
+                for (int32_t x = 0; x < CHUNK_SIZE; x++) {
+                    row[x + 1] = knownBlock(src[x]);
+                }
+            } else {
+                std::fill(row + 1, row + 1 + CHUNK_SIZE, world::blocks::AIR);
+            }
+
+            const Chunk* left = input.chunks[ChunkNeighbourhood::index(-1, dy, dz)];
+            const Chunk* right = input.chunks[ChunkNeighbourhood::index(1, dy, dz)];
+            row[0] = left != nullptr ? knownBlock(left->block(CHUNK_SIZE - 1, y, z)) : world::blocks::AIR;
+            row[PADDED - 1] = right != nullptr ? knownBlock(right->block(0, y, z)) : world::blocks::AIR;
+        }
+    }
+}
+
+void ChunkMesher::buildColumns() {
+    std::vector<uint64_t>& solidX = solidColumns_[0];
+    std::vector<uint64_t>& opaqueX = opaqueColumns_[0];
+    for (int32_t y = 0; y < PADDED; y++) {
+        for (int32_t z = 0; z < PADDED; z++) {
+            const BlockId* row = &blocks_[paddedIndex(0, y, z)];
+            uint64_t solid = 0;
+            uint64_t opaque = 0;
+            for (int32_t x = 0; x < PADDED; x++) {
+                solid |= static_cast<uint64_t>(row[x] != world::blocks::AIR) << x;
+                opaque |= static_cast<uint64_t>(OPAQUE[row[x]]) << x;
+            }
+            solidX[columnIndex(0, y, z)] = solid;
+            opaqueX[columnIndex(0, y, z)] = opaque;
+        }
+    }
+
+    // The y and z columns are the x columns turned sideways: with z fixed,
+    // the x columns stacked by y form a bit matrix whose transpose is the y
+    // columns stacked by x, and likewise with y fixed for z.
+    std::array<uint64_t, 64> matrix;
+    for (int kind = 0; kind < 2; kind++) {
+        const std::vector<uint64_t>& x = kind == 0 ? solidX : opaqueX;
+        std::vector<uint64_t>& yColumns = kind == 0 ? solidColumns_[1] : opaqueColumns_[1];
+        std::vector<uint64_t>& zColumns = kind == 0 ? solidColumns_[2] : opaqueColumns_[2];
+
+        for (int32_t z = 0; z < PADDED; z++) {
+            matrix.fill(0);
+            for (int32_t y = 0; y < PADDED; y++) {
+                matrix[y] = x[columnIndex(0, y, z)];
+            }
+            transposeBits(matrix);
+            for (int32_t px = 0; px < PADDED; px++) {
+                yColumns[columnIndex(1, z, px)] = matrix[px];
+            }
+        }
+        for (int32_t y = 0; y < PADDED; y++) {
+            matrix.fill(0);
+            for (int32_t z = 0; z < PADDED; z++) {
+                matrix[z] = x[columnIndex(0, y, z)];
+            }
+            transposeBits(matrix);
+            for (int32_t px = 0; px < PADDED; px++) {
+                zColumns[columnIndex(2, px, y)] = matrix[px];
+            }
+        }
+    }
+}
+
+void ChunkMesher::collectFaces(Face face) {
+    const int axis = faceAxis(face);
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+    const bool negative = (static_cast<uint32_t>(face) & 1) != 0;
+    const int32_t toNeighbour = negative ? -PADDED_STRIDE[axis] : PADDED_STRIDE[axis];
+    // Shifting a padded column right by this lines up the layer in front of
+    // each face with the face's own bit.
+    const int32_t frontShift = negative ? 0 : 2;
+
+    const std::vector<uint64_t>& solidColumns = solidColumns_[axis];
+    const std::vector<uint64_t>& opaqueColumns = opaqueColumns_[axis];
+    for (int32_t pu = 1; pu <= CHUNK_SIZE; pu++) {
+        for (int32_t pv = 1; pv <= CHUNK_SIZE; pv++) {
+            const uint32_t column = columnIndex(axis, pu, pv);
+            const uint64_t solid = solidColumns[column];
+            const uint64_t opaque = opaqueColumns[column];
+            // A face shows wherever the next block along the face's normal is
+            // not opaque. Dropping the border bits leaves one bit per layer.
+            const uint64_t visible = negative ? solid & ~(opaque << 1) : solid & ~(opaque >> 1);
+            uint32_t layers = static_cast<uint32_t>(visible >> 1);
+            if (layers == 0) {
+                continue;
+            }
+
+            // Opaque blocks around the block in front of each face, indexed
+            // [du + 1][dv + 1]. Any of them darkens a corner of the face.
+            std::array<std::array<uint32_t, 3>, 3> around{};
+            uint32_t occluded = 0;
+            for (int32_t du = -1; du <= 1; du++) {
+                for (int32_t dv = -1; dv <= 1; dv++) {
+                    if (du != 0 || dv != 0) {
+                        const uint64_t next = opaqueColumns[columnIndex(axis, pu + du, pv + dv)];
+                        around[du + 1][dv + 1] = static_cast<uint32_t>(next >> frontShift);
+                        occluded |= around[du + 1][dv + 1];
+                    }
+                }
+            }
+
+            const int32_t columnBase = PADDED_STRIDE[u] * pu + PADDED_STRIDE[v] * pv;
+            while (layers != 0) {
+                const int32_t layer = std::countr_zero(layers);
+                layers &= layers - 1;
+
+                const int32_t index = columnBase + PADDED_STRIDE[axis] * (layer + 1);
+                const BlockId id = blocks_[index];
+                // Faces between two of the same see-through block are hidden too.
+                if (!OPAQUE[id] && id == blocks_[index + toNeighbour]) {
+                    continue;
+                }
+
+                uint8_t ao = 0;
+                if (((occluded >> layer) & 1) != 0) {
+                    for (uint32_t corner = 0; corner < 4; corner++) {
+                        const int32_t du = CORNER_U[corner];
+                        const int32_t dv = CORNER_V[corner];
+                        const uint32_t side1 = (around[du + 1][1] >> layer) & 1;
+                        const uint32_t side2 = (around[1][dv + 1] >> layer) & 1;
+                        const uint32_t diagonal = (around[du + 1][dv + 1] >> layer) & 1;
+                        const uint32_t level = side1 & side2 ? 3 : side1 + side2 + diagonal;
+                        ao |= static_cast<uint8_t>(level << (corner * 2));
+                    }
+                }
+                planeFor(layer, id, ao)[pu - 1] |= 1u << (pv - 1);
+            }
+        }
+    }
+}
+
+uint32_t* ChunkMesher::planeFor(int32_t layer, BlockId id, uint8_t ao) {
+    const uint32_t key = (static_cast<uint32_t>(id) << 8) | ao;
+    std::vector<PlaneSlot>& slots = layerPlanes_[layer];
+    // Layers rarely hold more than a handful of kinds of face.
+    for (const PlaneSlot& slot : slots) {
+        if (slot.key == key) {
+            return planes_[slot.plane].data();
+        }
+    }
+    if (planesUsed_ == planes_.size()) {
+        planes_.emplace_back();
+    }
+    slots.push_back(PlaneSlot{key, planesUsed_});
+    return planes_[planesUsed_++].data();
+}
+
+void ChunkMesher::mergeFaces(Face face, ChunkMesh& out) {
+    const int axis = faceAxis(face);
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+
+    for (int32_t layer = 0; layer < CHUNK_SIZE; layer++) {
+        for (const PlaneSlot& slot : layerPlanes_[layer]) {
+            const BlockId id = static_cast<BlockId>(slot.key >> 8);
+            const uint8_t ao = static_cast<uint8_t>(slot.key & 0xFF);
+            uint32_t* rows = planes_[slot.plane].data();
+            for (int32_t row = 0; row < CHUNK_SIZE; row++) {
+                while (rows[row] != 0) {
+                    const int32_t start = std::countr_zero(rows[row]);
+                    const int32_t run = std::countr_one(rows[row] >> start);
+                    const uint32_t span = static_cast<uint32_t>(((uint64_t{1} << run) - 1) << start);
+                    rows[row] &= ~span;
+
+                    // Grow the run into the following rows for as long as
+                    // they have all of it.
+                    int32_t width = 1;
+                    while (row + width < CHUNK_SIZE && (rows[row + width] & span) == span) {
+                        rows[row + width] &= ~span;
+                        width++;
+                    }
+
+                    std::array<int32_t, 3> pos{};
+                    pos[axis] = layer;
+                    pos[u] = row;
+                    pos[v] = start;
+                    out.quads.push_back(makeQuad(pos, face, width, run, id, ao));
+                }
+            }
+        }
+        layerPlanes_[layer].clear();
+    }
+    planesUsed_ = 0;
+}
+
+#ifndef NO_TESTS
+
+#include "../world/terrain.h"
+#include "packed_quad.h"
+#include <chrono>
+#include <doctest.h>
+#include <print>
+#include <random>
+#include <set>
+#include <tuple>
+
+namespace {
+namespace blocks = world::blocks;
+
+/// A single block face, as chunk local x, y, z, face and ambient occlusion.
+using UnitFace = std::tuple<int32_t, int32_t, int32_t, int, int>;
+
+std::multiset<UnitFace> expandQuads(const ChunkMesh& mesh) {
+    std::multiset<UnitFace> faces;
+    for (const MeshQuad& quad : mesh.quads) {
+        const int axis = mesh::faceAxis(quad.face);
+        for (int32_t a = 0; a < quad.width; a++) {
+            for (int32_t b = 0; b < quad.height; b++) {
+                std::array<int32_t, 3> pos = {quad.x, quad.y, quad.z};
+                pos[(axis + 1) % 3] += a;
+                pos[(axis + 2) % 3] += b;
+                faces.insert({pos[0], pos[1], pos[2], static_cast<int>(quad.face), quad.ao});
+            }
+        }
+    }
+    return faces;
+}
+
+/// Visits blocks one at a time, the slow and obvious way.
+std::multiset<UnitFace> referenceFaces(const world::World& world, world::ChunkPos pos) {
+    static constexpr std::array<std::array<int32_t, 3>, mesh::FACE_COUNT> NORMALS = {
+        {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}}};
+    std::multiset<UnitFace> faces;
+    const Chunk& chunk = *world.chunk(pos);
+    for (int32_t y = 0; y < CHUNK_SIZE; y++) {
+        for (int32_t z = 0; z < CHUNK_SIZE; z++) {
+            for (int32_t x = 0; x < CHUNK_SIZE; x++) {
+                const BlockId id = chunk.block(x, y, z);
+                if (id == blocks::AIR) {
+                    continue;
+                }
+                for (int f = 0; f < static_cast<int>(mesh::FACE_COUNT); f++) {
+                    const auto& n = NORMALS[f];
+                    const BlockId next = world.block(chunk.blockPos(x + n[0], y + n[1], z + n[2]));
+                    if (world::blockProperties(next).opaque || next == id) {
+                        continue;
+                    }
+
+                    const int axis = f / 2;
+                    const auto opaqueAt = [&](int32_t du, int32_t dv) {
+                        std::array<int32_t, 3> pos = {x + n[0], y + n[1], z + n[2]};
+                        pos[(axis + 1) % 3] += du;
+                        pos[(axis + 2) % 3] += dv;
+                        return world::blockProperties(world.block(chunk.blockPos(pos[0], pos[1], pos[2]))).opaque ? 1
+                                                                                                                  : 0;
+                    };
+                    int ao = 0;
+                    constexpr int32_t CORNERS[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+                    for (int corner = 0; corner < 4; corner++) {
+                        const int side1 = opaqueAt(CORNERS[corner][0], 0);
+                        const int side2 = opaqueAt(0, CORNERS[corner][1]);
+                        const int level =
+                            side1 && side2 ? 3 : side1 + side2 + opaqueAt(CORNERS[corner][0], CORNERS[corner][1]);
+                        ao |= level << (corner * 2);
+                    }
+                    faces.insert({x, y, z, f, ao});
+                }
+            }
+        }
+    }
+    return faces;
+}
+
+ChunkMesh meshAt(const world::World& world, world::ChunkPos pos) {
+    ChunkMesher mesher;
+    ChunkMesh mesh;
+    mesher.mesh(ChunkNeighbourhood::gather(world, pos), mesh);
+    return mesh;
+}
+} // namespace
+
+TEST_SUITE("ChunkMesher") {
+    TEST_CASE("single block and full chunk") {
+        world::World world;
+        Chunk& chunk = world.getOrCreateChunk(world::ChunkPos{0, 0, 0});
+        chunk.setBlock(5, 6, 7, blocks::STONE);
+
+        ChunkMesh mesh = meshAt(world, chunk.pos());
+        REQUIRE(mesh.quads.size() == 6);
+        for (uint32_t f = 0; f < mesh::FACE_COUNT; f++) {
+            CHECK(mesh.faceOffsets[f] == f);
+            CHECK(mesh.quads[f].face == static_cast<Face>(f));
+            CHECK(mesh.quads[f].x == 5);
+            CHECK(mesh.quads[f].y == 6);
+            CHECK(mesh.quads[f].z == 7);
+        }
+
+        for (uint32_t i = 0; i < world::CHUNK_VOLUME; i++) {
+            chunk.setBlock(i, blocks::STONE);
+        }
+        mesh = meshAt(world, chunk.pos());
+        REQUIRE(mesh.quads.size() == 6);
+        for (const MeshQuad& quad : mesh.quads) {
+            CHECK(quad.width == CHUNK_SIZE);
+            CHECK(quad.height == CHUNK_SIZE);
+        }
+
+        // A full neighbour hides the face against it.
+        Chunk& neighbour = world.getOrCreateChunk(world::ChunkPos{1, 0, 0});
+        for (uint32_t i = 0; i < world::CHUNK_VOLUME; i++) {
+            neighbour.setBlock(i, blocks::DIRT);
+        }
+        mesh = meshAt(world, chunk.pos());
+        CHECK(mesh.quads.size() == 5);
+        CHECK(mesh.faceOffsets[1] == 0);
+    }
+
+    TEST_CASE("see-through and mixed blocks") {
+        world::World world;
+        Chunk& chunk = world.getOrCreateChunk(world::ChunkPos{0, 0, 0});
+        chunk.setBlock(1, 1, 1, blocks::GLASS);
+        chunk.setBlock(2, 1, 1, blocks::GLASS);
+        // Glass merges with glass and hides the face between them.
+        CHECK(meshAt(world, chunk.pos()).quads.size() == 6);
+
+        // Stone shows its face through glass, but glass hides nothing behind stone.
+        chunk.setBlock(3, 1, 1, blocks::STONE);
+        ChunkMesh mesh = meshAt(world, chunk.pos());
+        CHECK(expandQuads(mesh) == referenceFaces(world, chunk.pos()));
+        CHECK(mesh.faceOffsets[2] - mesh.faceOffsets[1] == 2);
+
+        // Different blocks never merge.
+        chunk.setBlock(3, 1, 1, blocks::AIR);
+        chunk.setBlock(1, 1, 1, blocks::STONE);
+        chunk.setBlock(2, 1, 1, blocks::DIRT);
+        mesh = meshAt(world, chunk.pos());
+        CHECK(mesh.faceOffsets[3] - mesh.faceOffsets[2] == 2);
+        CHECK(expandQuads(mesh) == referenceFaces(world, chunk.pos()));
+    }
+
+    TEST_CASE("ambient occlusion in a corner") {
+        world::World world;
+        Chunk& chunk = world.getOrCreateChunk(world::ChunkPos{0, 0, 0});
+        for (int32_t z = 0; z < 4; z++) {
+            for (int32_t x = 0; x < 4; x++) {
+                chunk.setBlock(x, 0, z, blocks::STONE);
+            }
+        }
+        chunk.setBlock(0, 1, 0, blocks::STONE);
+
+        const ChunkMesh mesh = meshAt(world, chunk.pos());
+        CHECK(expandQuads(mesh) == referenceFaces(world, chunk.pos()));
+        // The floor's top faces touching the pillar are shaded; the pillar's
+        // own top is not.
+        int shaded = 0;
+        for (uint32_t i = mesh.faceOffsets[2]; i < mesh.faceOffsets[3]; i++) {
+            const MeshQuad& quad = mesh.quads[i];
+            shaded += quad.ao != 0;
+            if (quad.x == 1 && quad.y == 0 && quad.z == 1) {
+                // Only the corner towards the pillar, (u, v) = (0, 0) in z, x.
+                CHECK(quad.ao == 1);
+            }
+            if (quad.y == 1) {
+                CHECK(quad.ao == 0);
+            }
+        }
+        CHECK(shaded == 3);
+    }
+
+    TEST_CASE("matches per-block faces on random chunks") {
+        world::World world;
+        std::mt19937 rng(7);
+        for (int32_t dy = -1; dy <= 1; dy++) {
+            for (int32_t dz = -1; dz <= 1; dz++) {
+                for (int32_t dx = -1; dx <= 1; dx++) {
+                    // Leave a few neighbours unloaded.
+                    if ((dx + dy + dz) % 3 == 2) {
+                        continue;
+                    }
+                    Chunk& chunk = world.getOrCreateChunk(world::ChunkPos{dx, dy, dz});
+                    for (uint32_t i = 0; i < world::CHUNK_VOLUME; i++) {
+                        const uint32_t roll = rng() % 16;
+                        chunk.setBlock(i, roll < 8 ? blocks::AIR : static_cast<BlockId>(roll % blocks::COUNT));
+                    }
+                }
+            }
+        }
+
+        const ChunkMesh mesh = meshAt(world, world::ChunkPos{0, 0, 0});
+        CHECK(expandQuads(mesh) == referenceFaces(world, world::ChunkPos{0, 0, 0}));
+        for (uint32_t f = 0; f < mesh::FACE_COUNT; f++) {
+            for (uint32_t i = mesh.faceOffsets[f]; i < mesh.faceOffsets[f + 1]; i++) {
+                CHECK(mesh.quads[i].face == static_cast<Face>(f));
+            }
+        }
+    }
+
+    TEST_CASE("faces connect through open blocks") {
+        world::World world;
+        Chunk& chunk = world.getOrCreateChunk(world::ChunkPos{0, 0, 0});
+        ChunkMesher mesher;
+        ChunkMesh mesh;
+
+        mesher.mesh(ChunkNeighbourhood::gather(world, chunk.pos()), mesh);
+        CHECK(mesh.visibility == mesh::ChunkVisibility::all());
+
+        for (uint32_t i = 0; i < world::CHUNK_VOLUME; i++) {
+            chunk.setBlock(i, blocks::STONE);
+        }
+        mesher.mesh(ChunkNeighbourhood::gather(world, chunk.pos()), mesh);
+        CHECK(mesh.visibility == mesh::ChunkVisibility{});
+
+        // a sealed cave connects nothing
+        for (int32_t y = 10; y < 20; y++) {
+            chunk.setBlock(12, y, 12, blocks::AIR);
+        }
+        mesher.mesh(ChunkNeighbourhood::gather(world, chunk.pos()), mesh);
+        CHECK(mesh.visibility == mesh::ChunkVisibility{});
+
+        // a tunnel through along x, with glass letting the view through
+        for (int32_t x = 0; x < CHUNK_SIZE; x++) {
+            chunk.setBlock(x, 15, 12, x == 5 ? blocks::GLASS : blocks::AIR);
+        }
+        mesher.mesh(ChunkNeighbourhood::gather(world, chunk.pos()), mesh);
+        CHECK(mesh.visibility.connects(Face::PosX, Face::NegX));
+        CHECK(mesh.visibility.connects(Face::NegX, Face::PosX));
+        CHECK_FALSE(mesh.visibility.connects(Face::PosX, Face::PosY));
+        CHECK_FALSE(mesh.visibility.connects(Face::PosZ, Face::NegZ));
+
+        // and a shaft up from the tunnel to the top
+        for (int32_t y = 16; y < CHUNK_SIZE; y++) {
+            chunk.setBlock(20, y, 12, blocks::AIR);
+        }
+        mesher.mesh(ChunkNeighbourhood::gather(world, chunk.pos()), mesh);
+        CHECK(mesh.visibility.connects(Face::PosY, Face::NegX));
+        CHECK(mesh.visibility.connects(Face::PosY, Face::PosX));
+        CHECK_FALSE(mesh.visibility.connects(Face::PosY, Face::NegY));
+    }
+
+    TEST_CASE("benchmark terrain chunks per second" * doctest::skip()) {
+        world::World world;
+        const world::TerrainGenerator generator;
+        constexpr int32_t RADIUS = 4;
+        for (int32_t y = -1; y <= 2; y++) {
+            for (int32_t z = -RADIUS - 1; z <= RADIUS; z++) {
+                for (int32_t x = -RADIUS - 1; x <= RADIUS; x++) {
+                    generator.generate(world.getOrCreateChunk(world::ChunkPos{x, y, z}));
+                }
+            }
+        }
+
+        std::vector<ChunkNeighbourhood> inputs;
+        for (int32_t y = 0; y <= 1; y++) {
+            for (int32_t z = -RADIUS; z < RADIUS; z++) {
+                for (int32_t x = -RADIUS; x < RADIUS; x++) {
+                    inputs.push_back(ChunkNeighbourhood::gather(world, world::ChunkPos{x, y, z}));
+                }
+            }
+        }
+
+        ChunkMesher mesher;
+        ChunkMesh mesh;
+        size_t quads = 0;
+        size_t faces = 0;
+        for (const ChunkNeighbourhood& input : inputs) {
+            mesher.mesh(input, mesh);
+            quads += mesh.quads.size();
+            faces += expandQuads(mesh).size();
+        }
+
+        constexpr int ROUNDS = 20;
+        const auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < ROUNDS; round++) {
+            for (const ChunkNeighbourhood& input : inputs) {
+                mesher.mesh(input, mesh);
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double chunks = static_cast<double>(inputs.size()) * ROUNDS;
+        std::println("{:.0f} chunks/s, {:.1f} us per chunk", chunks / seconds, seconds * 1e6 / chunks);
+        std::println("{:.0f} quads per chunk, from {:.0f} block faces", static_cast<double>(quads) / inputs.size(),
+                     static_cast<double>(faces) / inputs.size());
+        // Four vertices of position, normal, uv and occlusion as floats, against one packed quad.
+        constexpr double FLOAT_QUAD_BYTES = 4 * 9 * sizeof(float);
+        std::println("{:.1f} KiB per chunk packed, {:.1f} KiB as float vertices",
+                     static_cast<double>(quads * sizeof(mesh::PackedQuad)) / inputs.size() / 1024.0,
+                     static_cast<double>(quads) * FLOAT_QUAD_BYTES / inputs.size() / 1024.0);
+    }
+}
+
+#endif
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "../world/world.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace mesh {
+/// @brief The direction a quad faces. The order matches the axis, so
+/// `axis = face / 2`, and odd faces point towards negative coordinates.
+enum class Face : uint8_t {
+    PosX,
+    NegX,
+    PosY,
+    NegY,
+    PosZ,
+    NegZ,
+};
+
+constexpr uint32_t FACE_COUNT = 6;
+
+/// @return The axis (0 = x, 1 = y, 2 = z) that `face` points along.
+constexpr int faceAxis(Face face) { return static_cast<int>(face) / 2; }
+
+/// @brief A greedily merged rectangle of block faces, all of the same block
+/// and with the same ambient occlusion.
+///
+/// A quad spans `width` blocks along axis `(faceAxis + 1) % 3` and `height`
+/// blocks along axis `(faceAxis + 2) % 3`, so for example a `PosY` quad is
+/// `width` blocks along z and `height` blocks along x.
+struct MeshQuad {
+    /// Chunk local position of the block in the quad's minimum corner.
+    uint8_t x;
+    uint8_t y;
+    uint8_t z;
+    Face face;
+    uint8_t width;
+    uint8_t height;
+    world::BlockId block;
+    /// Ambient occlusion of each corner, 2 bits each from 0 (open) to 3
+    /// (fully enclosed). Corners are stored at `(u, v)` = (0, 0), (1, 0),
+    /// (1, 1), then (0, 1), from the lowest bits up.
+    uint8_t ao;
+};
+
+/// @brief Which faces of a chunk can see each other through its open
+/// blocks, so the renderer can skip chunks that are sealed off from the
+/// camera, such as caves underground.
+///
+/// Two faces connect when one region of connected non-opaque blocks touches
+/// both of them.
+class ChunkVisibility {
+  public:
+    /// @return Every face connected to every other, as an empty chunk is.
+    static constexpr ChunkVisibility all() {
+        ChunkVisibility visibility;
+        visibility.connectFaces((1u << FACE_COUNT) - 1);
+        return visibility;
+    }
+
+    /// @brief Connects every pair of faces in `faces`, a mask with bit `f`
+    /// set for `Face` `f`.
+    constexpr void connectFaces(uint32_t faces) {
+        for (uint32_t a = 0; a < FACE_COUNT; a++) {
+            if ((faces >> a & 1) != 0) {
+                // every face in the mask other than `a` itself
+                bits_ |= static_cast<uint64_t>(faces & ~(1u << a)) << (a * FACE_COUNT);
+            }
+        }
+    }
+
+    constexpr bool connects(Face a, Face b) const {
+        return (bits_ >> (static_cast<uint32_t>(a) * FACE_COUNT + static_cast<uint32_t>(b)) & 1) != 0;
+    }
+
+    constexpr bool operator==(const ChunkVisibility&) const = default;
+
+  private:
+    /// Bit `a * FACE_COUNT + b` is set when face `a` connects to face `b`.
+    uint64_t bits_ = 0;
+};
+
+struct ChunkMesh {
+    /// Quads grouped by face, in `Face` order.
+    std::vector<MeshQuad> quads;
+    /// Quads facing `f` are `quads[faceOffsets[f]]` up to
+    /// `quads[faceOffsets[f + 1]]`.
+    std::array<uint32_t, FACE_COUNT + 1> faceOffsets{};
+    ChunkVisibility visibility = ChunkVisibility::all();
+
+    void clear() {
+        quads.clear();
+        faceOffsets.fill(0);
+        visibility = ChunkVisibility::all();
+    }
+};
+
+/// @brief A chunk and the 26 chunks around it, which decide which faces on
+/// its borders are visible.
+struct ChunkNeighbourhood {
+    /// Indexed by `(dx + 1) + 3 * ((dz + 1) + 3 * (dy + 1))`. Chunks that
+    /// are not loaded are null, and mesh as if they were air.
+    std::array<const world::Chunk*, 27> chunks{};
+
+    static constexpr uint32_t index(int32_t dx, int32_t dy, int32_t dz) {
+        return static_cast<uint32_t>((dx + 1) + 3 * ((dz + 1) + 3 * (dy + 1)));
+    }
+
+    const world::Chunk* center() const { return chunks[index(0, 0, 0)]; }
+
+    static ChunkNeighbourhood gather(const world::World& world, world::ChunkPos pos);
+};
+
+/// @brief Turns chunks into quads with binary greedy meshing.
+///
+/// The chunk and a one block border are packed into 64-bit columns of
+/// occupancy bits along each axis, 34 bits per column. Visible faces of a
+/// whole column then come out of a single shift and mask against its opaque
+/// neighbours, and each 32x32 layer of faces is merged into rectangles per
+/// block type by scanning runs of set bits, rather than visiting blocks one
+/// at a time.
+///
+/// Opaque blocks hide any face against them. Other blocks, such as glass,
+/// only hide faces against the same block.
+///
+/// Which faces have corners darkened by ambient occlusion is found for whole
+/// columns at once from the opaque columns around them. Faces only merge with
+/// faces of the same block and the same occlusion, so merging never blurs it.
+///
+/// Which faces of the chunk connect through its open blocks is flood filled
+/// into `ChunkMesh::visibility` at the same time.
+///
+/// # Thread Safety
+///
+/// A mesher holds its scratch space, so give each thread its own. The chunks
+/// being meshed must not change while `mesh()` runs.
+class ChunkMesher {
+  public:
+    ChunkMesher();
+
+    ChunkMesher(const ChunkMesher&) = delete;
+    ChunkMesher& operator=(const ChunkMesher&) = delete;
+
+    /// @brief Replaces `out` with the mesh of `input.center()`, which is
+    /// empty if there is no center chunk.
+    void mesh(const ChunkNeighbourhood& input, ChunkMesh& out);
+
+  private:
+    /// Chunk width plus a block of border on both sides.
+    static constexpr int32_t PADDED = world::CHUNK_SIZE + 2;
+    static constexpr uint32_t PADDED_AREA = PADDED * PADDED;
+
+    static constexpr uint32_t paddedIndex(int32_t x, int32_t y, int32_t z) {
+        return static_cast<uint32_t>(x + PADDED * (z + PADDED * y));
+    }
+
+    /// @return Where the column along `axis` through padded coordinates `u`
+    /// and `v` of the other two axes is stored. Columns are laid out so that
+    /// x varies fastest wherever x is not the column's own axis.
+    static constexpr uint32_t columnIndex(int axis, int32_t u, int32_t v) {
+        return static_cast<uint32_t>(axis == 2 ? v * PADDED + u : u * PADDED + v);
+    }
+
+    void loadBlocks(const ChunkNeighbourhood& input);
+
+    void buildColumns();
+
+    /// @brief Finds the faces pointing along `face` and sorts them into
+    /// planes by layer, block and ambient occlusion.
+    void collectFaces(Face face);
+
+    /// @return The plane for faces of `id` with occlusion `ao` in `layer`,
+    /// taking a cleared one from `planes_` if there is none yet.
+    uint32_t* planeFor(int32_t layer, world::BlockId id, uint8_t ao);
+
+    /// @brief Merges the planes filled by `collectFaces()` into quads and
+    /// clears them.
+    void mergeFaces(Face face, ChunkMesh& out);
+
+    /// @brief Flood fills the chunk's non-opaque blocks to find which faces
+    /// connect.
+    void findVisibility(ChunkMesh& out);
+
+    /// Block ids of the chunk and its border, indexed by `paddedIndex()`.
+    std::vector<world::BlockId> blocks_;
+    /// Bit `i` of a column is the block at padded coordinate `i` along the
+    /// axis, indexed by `columnIndex()` with the padded coordinates of the
+    /// other two axes, `u = (axis + 1) % 3` and `v = (axis + 2) % 3`.
+    std::array<std::vector<uint64_t>, 3> solidColumns_;
+    std::array<std::vector<uint64_t>, 3> opaqueColumns_;
+    struct PlaneSlot {
+        /// Block id in the high bits, ambient occlusion in the low 8.
+        uint32_t key;
+        uint32_t plane;
+    };
+
+    /// 32x32 bit planes of faces, one row per `u` with bits along `v`.
+    /// Reused from face to face, and only ever grows.
+    std::vector<std::array<uint32_t, world::CHUNK_SIZE>> planes_;
+    uint32_t planesUsed_ = 0;
+    /// The planes in use by each layer of the current face.
+    std::array<std::vector<PlaneSlot>, world::CHUNK_SIZE> layerPlanes_;
+    /// A bit per block of the chunk, set once the flood fill reached it.
+    std::vector<uint64_t> filled_;
+    /// Blocks the flood fill has yet to spread from, as `world::Chunk::index()`.
+    std::vector<uint16_t> floodStack_;
+};
+} // namespace mesh
@@ -0,0 +1,104 @@
+#include "packed_quad.h"
+
+using mesh::Face;
+using mesh::MeshQuad;
+using mesh::PackedQuad;
+using world::BlockId;
+
+namespace {
+struct BlockTextures {
+    uint16_t top;
+    uint16_t side;
+    uint16_t bottom;
+};
+
+/// Texture layers of each block, indexed by block id. Air is never drawn.
+constexpr std::array<BlockTextures, world::blocks::COUNT> BLOCK_TEXTURES = {{
+    {0, 0, 0}, // air
+    {0, 0, 0}, // stone
+    {1, 1, 1}, // dirt
+    {2, 3, 1}, // grass
+    {4, 4, 4}, // sand
+    {5, 5, 5}, // glass
+    {6, 6, 6}, // glowstone
+    {7, 7, 7}, // torch
+}};
+} // namespace
+
+uint16_t mesh::textureLayer(BlockId id, Face face) {
+    const BlockTextures& textures = BLOCK_TEXTURES[id < world::blocks::COUNT ? id : world::blocks::AIR];
+    if (face == Face::PosY) {
+        return textures.top;
+    }
+    return face == Face::NegY ? textures.bottom : textures.side;
+}
+
+PackedQuad mesh::packQuad(const MeshQuad& quad) {
+    PackedQuad packed;
+    packed.position = static_cast<uint32_t>(quad.x) | (static_cast<uint32_t>(quad.y) << 5) |
+                      (static_cast<uint32_t>(quad.z) << 10) | (static_cast<uint32_t>(quad.width - 1) << 15) |
+                      (static_cast<uint32_t>(quad.height - 1) << 20) | (static_cast<uint32_t>(quad.face) << 25);
+    packed.appearance =
+        static_cast<uint32_t>(textureLayer(quad.block, quad.face)) | (static_cast<uint32_t>(quad.ao) << 16);
+    return packed;
+}
+
+void mesh::packMesh(const ChunkMesh& mesh, std::vector<PackedQuad>& out) {
+    out.resize(mesh.quads.size());
+    for (size_t i = 0; i < mesh.quads.size(); i++) {
+        out[i] = packQuad(mesh.quads[i]);
+    }
+}
+
+void mesh::buildQuadIndices(uint32_t quadCount, std::vector<uint32_t>& out) {
+    out.resize(static_cast<size_t>(quadCount) * INDICES_PER_QUAD);
+    for (uint32_t quad = 0; quad < quadCount; quad++) {
+        const uint32_t first = quad * 4;
+        uint32_t* indices = &out[static_cast<size_t>(quad) * INDICES_PER_QUAD];
+        indices[0] = first;
+        indices[1] = first + 1;
+        indices[2] = first + 2;
+        indices[3] = first;
+        indices[4] = first + 2;
+        indices[5] = first + 3;
+    }
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+TEST_SUITE("PackedQuad") {
+    TEST_CASE("fields land in their bits") {
+        MeshQuad quad;
+        quad.x = 31;
+        quad.y = 0;
+        quad.z = 17;
+        quad.face = Face::NegZ;
+        quad.width = 32;
+        quad.height = 1;
+        quad.block = world::blocks::GRASS;
+        quad.ao = 0b11'10'01'00;
+
+        const PackedQuad packed = mesh::packQuad(quad);
+        CHECK((packed.position & 31) == 31);
+        CHECK(((packed.position >> 5) & 31) == 0);
+        CHECK(((packed.position >> 10) & 31) == 17);
+        CHECK(((packed.position >> 15) & 31) == 31);
+        CHECK(((packed.position >> 20) & 31) == 0);
+        CHECK(((packed.position >> 25) & 7) == static_cast<uint32_t>(Face::NegZ));
+        CHECK((packed.appearance & 0xFFFF) == 3);
+        CHECK(((packed.appearance >> 16) & 0xFF) == quad.ao);
+
+        quad.face = Face::PosY;
+        CHECK((mesh::packQuad(quad).appearance & 0xFFFF) == 2);
+    }
+
+    TEST_CASE("quad indices") {
+        std::vector<uint32_t> indices;
+        mesh::buildQuadIndices(2, indices);
+        CHECK(indices == std::vector<uint32_t>{0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7});
+    }
+}
+
+#endif
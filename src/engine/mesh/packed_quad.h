@@ -0,0 +1,48 @@
+#pragma once
+
+#include "chunk_mesher.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace mesh {
+/// @brief A chunk mesh quad as the GPU reads it, 8 bytes in place of four
+/// full vertices. `chunk.vert` expands it into its corners by
+/// `gl_VertexIndex`, so the layout here must match the shader.
+///
+/// `position` holds, from the lowest bit up, x, y and z in 5 bits each,
+/// `width - 1` and `height - 1` in 5 bits each, then the face in 3 bits.
+/// `appearance` holds the texture layer in 16 bits, then the ambient
+/// occlusion of `MeshQuad::ao` in 8 bits.
+struct PackedQuad {
+    uint32_t position;
+    uint32_t appearance;
+};
+
+static_assert(sizeof(PackedQuad) == 8);
+
+/// Worst case number of quads in one chunk's mesh: every other block set, in
+/// a 3D checkerboard, so every face shows and none merge.
+constexpr uint32_t MAX_QUADS_PER_CHUNK = world::CHUNK_VOLUME / 2 * FACE_COUNT;
+
+/// Indices per quad in the shared index buffer, two triangles over corners
+/// 0, 1, 2 and 0, 2, 3.
+constexpr uint32_t INDICES_PER_QUAD = 6;
+
+/// @brief Names of the block textures, in texture layer order.
+inline constexpr std::array<const char*, 8> TEXTURE_NAMES = {
+    "stone", "dirt", "grass_top", "grass_side", "sand", "glass", "glowstone", "torch",
+};
+
+/// @return The texture layer drawn on `face` of `id`.
+uint16_t textureLayer(world::BlockId id, Face face);
+
+PackedQuad packQuad(const MeshQuad& quad);
+
+/// @brief Packs every quad of `mesh` into `out`, replacing its contents.
+void packMesh(const ChunkMesh& mesh, std::vector<PackedQuad>& out);
+
+/// @brief Fills `out` with the indices of `quadCount` quads, for the index
+/// buffer shared by every chunk draw.
+void buildQuadIndices(uint32_t quadCount, std::vector<uint32_t>& out);
+} // namespace mesh
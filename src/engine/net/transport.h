@@ -57,11 +57,9 @@ class ReceiveBytes {
 class ReceiveTransportBytes : public ReceiveBytes {
   public:
     TransportAddress addr;
-    uint8_t* bytes;
-    int len;
 
     ReceiveTransportBytes(TransportAddress inAddr, uint8_t* inBytes, int inLen)
-        : addr(inAddr), ReceiveBytes(inBytes, inLen) {}
+        : ReceiveBytes(inBytes, inLen), addr(inAddr) {}
 
     ~ReceiveTransportBytes() noexcept = default;
 
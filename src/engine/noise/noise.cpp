@@ -0,0 +1,284 @@
+#include "noise.h"
+
+#define NOISE_KERNEL_NAMESPACE scalar
+#include "noise_kernels.h"
+
+#include <exception>
+#include <iostream>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+using noise::FractalSettings;
+using noise::Grid2D;
+using noise::Grid3D;
+using noise::SimdLevel;
+using noise::detail::GridKernels;
+
+namespace {
+bool cpuSupports(SimdLevel level) {
+    if (level == SimdLevel::Scalar) {
+        return true;
+    }
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (level == SimdLevel::Sse41) {
+        return __builtin_cpu_supports("sse4.1");
+    }
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    if (level == SimdLevel::Sse41) {
+        return sse41;
+    }
+    // AVX state must also be enabled by the OS, not just present in the CPU.
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+GridKernels kernelsFor(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Avx2:
+        return noise::detail::avx2Kernels();
+    case SimdLevel::Sse41:
+        return noise::detail::sse41Kernels();
+    case SimdLevel::Scalar:
+    default:
+        return noise::detail::scalarKernels();
+    }
+}
+
+GridKernels requireKernels(SimdLevel level) {
+    if (!noise::isSimdLevelSupported(level)) {
+        try {
+            std::cerr << "Noise kernels for " << noise::simdLevelName(level)
+                      << " are not available on this CPU or build" << std::endl;
+        } catch (...) {
+        }
+        std::terminate();
+    }
+    return kernelsFor(level);
+}
+
+const GridKernels& bestKernels() {
+    static const GridKernels kernels = kernelsFor(noise::detectSimdLevel());
+    return kernels;
+}
+} // namespace
+
+noise::detail::GridKernels noise::detail::scalarKernels() {
+    return GridKernels{&scalar::fill2D<scalar::ScalarOps>, &scalar::fill3D<scalar::ScalarOps>};
+}
+
+bool noise::isSimdLevelSupported(SimdLevel level) {
+    const GridKernels kernels = kernelsFor(level);
+    return kernels.fill2D != nullptr && kernels.fill3D != nullptr && cpuSupports(level);
+}
+
+SimdLevel noise::detectSimdLevel() {
+    static const SimdLevel level = []() {
+        if (isSimdLevelSupported(SimdLevel::Avx2)) {
+            return SimdLevel::Avx2;
+        }
+        if (isSimdLevelSupported(SimdLevel::Sse41)) {
+            return SimdLevel::Sse41;
+        }
+        return SimdLevel::Scalar;
+    }();
+    return level;
+}
+
+const char* noise::simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Avx2:
+        return "AVX2";
+    case SimdLevel::Sse41:
+        return "SSE4.1";
+    case SimdLevel::Scalar:
+    default:
+        return "Scalar";
+    }
+}
+
+void noise::fillGrid2D(const FractalSettings& settings, const Grid2D& grid, float* out) {
+    bestKernels().fill2D(settings, grid, out);
+}
+
+void noise::fillGrid2D(const FractalSettings& settings, const Grid2D& grid, float* out, SimdLevel level) {
+    requireKernels(level).fill2D(settings, grid, out);
+}
+
+void noise::fillGrid3D(const FractalSettings& settings, const Grid3D& grid, float* out) {
+    bestKernels().fill3D(settings, grid, out);
+}
+
+void noise::fillGrid3D(const FractalSettings& settings, const Grid3D& grid, float* out, SimdLevel level) {
+    requireKernels(level).fill3D(settings, grid, out);
+}
+
+float noise::sample2D(const FractalSettings& settings, float x, float z) {
+    const detail::scalar::FractalPlan plan(settings);
+    return detail::scalar::fractal2<detail::scalar::ScalarOps>(settings, plan, x, z);
+}
+
+float noise::sample3D(const FractalSettings& settings, float x, float y, float z) {
+    const detail::scalar::FractalPlan plan(settings);
+    return detail::scalar::fractal3<detail::scalar::ScalarOps>(settings, plan, x, y, z);
+}
+
+#ifndef NO_TESTS
+
+#include <chrono>
+#include <cstring>
+#include <doctest.h>
+#include <print>
+#include <vector>
+
+using noise::NoiseType;
+
+TEST_SUITE("Noise") {
+    constexpr SimdLevel ALL_LEVELS[] = {SimdLevel::Scalar, SimdLevel::Sse41, SimdLevel::Avx2};
+    constexpr NoiseType ALL_TYPES[] = {NoiseType::Value, NoiseType::Perlin, NoiseType::Simplex};
+
+    FractalSettings testSettings(NoiseType type, bool warp) {
+        FractalSettings settings;
+        settings.type = type;
+        settings.seed = 1337;
+        settings.frequency = 0.037f;
+        settings.octaves = 3;
+        settings.warpAmplitude = warp ? 12.5f : 0.0f;
+        settings.warpFrequency = 0.02f;
+        return settings;
+    }
+
+    TEST_CASE("scalar kernels are always supported") {
+        CHECK(noise::isSimdLevelSupported(SimdLevel::Scalar));
+        CHECK(noise::isSimdLevelSupported(noise::detectSimdLevel()));
+    }
+
+    TEST_CASE("2D kernels are bit-identical to scalar") {
+        // Odd sizes so every SIMD kernel also runs its scalar tail.
+        const Grid2D grid{.originX = -71.25f, .originZ = -3.5f, .step = 0.75f, .sizeX = 37, .sizeZ = 11};
+        std::vector<float> expected(grid.count());
+        std::vector<float> actual(grid.count());
+
+        for (NoiseType type : ALL_TYPES) {
+            for (bool warp : {false, true}) {
+                const FractalSettings settings = testSettings(type, warp);
+                noise::fillGrid2D(settings, grid, expected.data(), SimdLevel::Scalar);
+                for (SimdLevel level : ALL_LEVELS) {
+                    if (!noise::isSimdLevelSupported(level)) {
+                        continue;
+                    }
+                    noise::fillGrid2D(settings, grid, actual.data(), level);
+                    CHECK(std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(float)) == 0);
+                }
+            }
+        }
+    }
+
+    TEST_CASE("3D kernels are bit-identical to scalar") {
+        const Grid3D grid{
+            .originX = -40.0f, .originY = 13.0f, .originZ = -1.0f, .step = 1.0f, .sizeX = 19, .sizeY = 5, .sizeZ = 7};
+        std::vector<float> expected(grid.count());
+        std::vector<float> actual(grid.count());
+
+        for (NoiseType type : ALL_TYPES) {
+            for (bool warp : {false, true}) {
+                const FractalSettings settings = testSettings(type, warp);
+                noise::fillGrid3D(settings, grid, expected.data(), SimdLevel::Scalar);
+                for (SimdLevel level : ALL_LEVELS) {
+                    if (!noise::isSimdLevelSupported(level)) {
+                        continue;
+                    }
+                    noise::fillGrid3D(settings, grid, actual.data(), level);
+                    CHECK(std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(float)) == 0);
+                }
+            }
+        }
+    }
+
+    TEST_CASE("single samples match the grid") {
+        const FractalSettings settings = testSettings(NoiseType::Simplex, true);
+        const Grid3D grid{.originX = 5.0f, .originY = -9.0f, .originZ = 100.0f, .sizeX = 8, .sizeY = 2, .sizeZ = 2};
+        std::vector<float> values(grid.count());
+        noise::fillGrid3D(settings, grid, values.data());
+
+        const float sample = noise::sample3D(settings, 5.0f + 3.0f, -9.0f + 1.0f, 100.0f + 1.0f);
+        CHECK(sample == values[3 + grid.sizeX * (1 + grid.sizeZ * 1)]);
+    }
+
+    TEST_CASE("values stay in range and depend on the seed") {
+        const Grid2D grid{.originX = -500.0f, .originZ = -500.0f, .step = 3.1f, .sizeX = 64, .sizeZ = 64};
+        std::vector<float> a(grid.count());
+        std::vector<float> b(grid.count());
+
+        for (NoiseType type : ALL_TYPES) {
+            FractalSettings settings = testSettings(type, false);
+            noise::fillGrid2D(settings, grid, a.data());
+            settings.seed += 1;
+            noise::fillGrid2D(settings, grid, b.data());
+
+            bool anyDifferent = false;
+            for (size_t i = 0; i < a.size(); i++) {
+                CHECK(a[i] >= -1.1f);
+                CHECK(a[i] <= 1.1f);
+                anyDifferent |= a[i] != b[i];
+            }
+            CHECK(anyDifferent);
+        }
+    }
+
+    // Run with `GameTests -ts=Noise --no-skip`.
+    TEST_CASE("benchmark chunk columns per second" * doctest::skip()) {
+        // One column is a warped 2D heightmap plus a 3D density field for
+        // caves, which is what terrain generation asks for per chunk column.
+        constexpr uint32_t COLUMN_WIDTH = 32;
+        constexpr uint32_t COLUMN_HEIGHT = 64;
+        constexpr int COLUMNS = 256;
+
+        FractalSettings height = testSettings(NoiseType::Simplex, true);
+        height.octaves = 6;
+        FractalSettings caves = testSettings(NoiseType::Perlin, false);
+
+        std::vector<float> heightmap(COLUMN_WIDTH * COLUMN_WIDTH);
+        std::vector<float> density(COLUMN_WIDTH * COLUMN_WIDTH * COLUMN_HEIGHT);
+
+        for (SimdLevel level : ALL_LEVELS) {
+            if (!noise::isSimdLevelSupported(level)) {
+                std::println("{:>8}: unsupported", noise::simdLevelName(level));
+                continue;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            for (int c = 0; c < COLUMNS; c++) {
+                const float originX = static_cast<float>(c * static_cast<int>(COLUMN_WIDTH));
+                noise::fillGrid2D(height,
+                                  Grid2D{.originX = originX, .originZ = 0.0f, .sizeX = COLUMN_WIDTH,
+                                         .sizeZ = COLUMN_WIDTH},
+                                  heightmap.data(), level);
+                noise::fillGrid3D(caves,
+                                  Grid3D{.originX = originX,
+                                         .sizeX = COLUMN_WIDTH,
+                                         .sizeY = COLUMN_HEIGHT,
+                                         .sizeZ = COLUMN_WIDTH},
+                                  density.data(), level);
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            std::println("{:>8}: {:.1f} chunk columns/sec", noise::simdLevelName(level), COLUMNS / elapsed.count());
+        }
+    }
+}
+
+#endif
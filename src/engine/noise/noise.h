@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+
+namespace noise {
+enum class NoiseType : uint8_t {
+    Value,
+    Perlin,
+    Simplex,
+};
+
+/// @brief Instruction set used by the grid kernels. Every level produces
+/// bit-identical output, so the choice only affects throughput.
+enum class SimdLevel : uint8_t {
+    Scalar,
+    Sse41,
+    Avx2,
+};
+
+/// @brief Describes a fractal (fBm) noise field, optionally with its input
+/// coordinates displaced by a domain warp.
+struct FractalSettings {
+    NoiseType type = NoiseType::Simplex;
+    int32_t seed = 0;
+    /// Frequency of the first octave, in cycles per world unit.
+    float frequency = 0.01f;
+    int octaves = 4;
+    /// Frequency multiplier between octaves.
+    float lacunarity = 2.0f;
+    /// Amplitude multiplier between octaves.
+    float gain = 0.5f;
+    /// How far, in world units, the domain warp may displace a sample.
+    /// A value of `0` disables the warp.
+    float warpAmplitude = 0.0f;
+    float warpFrequency = 0.005f;
+};
+
+/// @brief A regular 2D lattice of sample points on the XZ plane. Samples are
+/// written `x` fastest, so `out[x + sizeX * z]`.
+struct Grid2D {
+    float originX = 0.0f;
+    float originZ = 0.0f;
+    float step = 1.0f;
+    uint32_t sizeX = 0;
+    uint32_t sizeZ = 0;
+
+    uint32_t count() const { return sizeX * sizeZ; }
+};
+
+/// @brief A regular 3D lattice of sample points. Samples are written `x`
+/// fastest, then `z`, then `y`, so `out[x + sizeX * (z + sizeZ * y)]`.
+struct Grid3D {
+    float originX = 0.0f;
+    float originY = 0.0f;
+    float originZ = 0.0f;
+    float step = 1.0f;
+    uint32_t sizeX = 0;
+    uint32_t sizeY = 0;
+    uint32_t sizeZ = 0;
+
+    uint32_t count() const { return sizeX * sizeY * sizeZ; }
+};
+
+/// @return The widest instruction set supported by the executing CPU that
+/// this build has kernels for.
+SimdLevel detectSimdLevel();
+
+/// @return `true` if kernels for `level` were compiled in and the executing
+/// CPU supports them.
+bool isSimdLevelSupported(SimdLevel level);
+
+const char* simdLevelName(SimdLevel level);
+
+/// @brief Fills `out` with fractal noise sampled at every point of `grid`,
+/// using the widest kernel the CPU supports. This is the primary API, and
+/// should be preferred over per-sample calls whenever a chunk worth of
+/// values is needed.
+/// @param out Must hold at least `grid.count()` floats. Values are roughly
+/// within [-1, 1].
+void fillGrid2D(const FractalSettings& settings, const Grid2D& grid, float* out);
+
+/// @brief Same as `fillGrid2D()`, but forces a specific kernel. Terminates
+/// if `level` is not supported. Mainly for tests and benchmarks.
+void fillGrid2D(const FractalSettings& settings, const Grid2D& grid, float* out, SimdLevel level);
+
+/// @brief Fills `out` with fractal noise sampled at every point of `grid`,
+/// using the widest kernel the CPU supports.
+/// @param out Must hold at least `grid.count()` floats. Values are roughly
+/// within [-1, 1].
+void fillGrid3D(const FractalSettings& settings, const Grid3D& grid, float* out);
+
+/// @brief Same as `fillGrid3D()`, but forces a specific kernel. Terminates
+/// if `level` is not supported. Mainly for tests and benchmarks.
+void fillGrid3D(const FractalSettings& settings, const Grid3D& grid, float* out, SimdLevel level);
+
+/// @brief Samples a single point. Bit-identical to the grid value at the same
+/// coordinate, but far slower per sample.
+float sample2D(const FractalSettings& settings, float x, float z);
+
+/// @brief Samples a single point. Bit-identical to the grid value at the same
+/// coordinate, but far slower per sample.
+float sample3D(const FractalSettings& settings, float x, float y, float z);
+
+namespace detail {
+using Fill2DFn = void (*)(const FractalSettings&, const Grid2D&, float*);
+using Fill3DFn = void (*)(const FractalSettings&, const Grid3D&, float*);
+
+struct GridKernels {
+    Fill2DFn fill2D;
+    Fill3DFn fill3D;
+};
+
+GridKernels scalarKernels();
+/// @return The SSE4.1 kernels, or null function pointers if they were not
+/// compiled for this target.
+GridKernels sse41Kernels();
+/// @return The AVX2 kernels, or null function pointers if they were not
+/// compiled for this target.
+GridKernels avx2Kernels();
+} // namespace detail
+} // namespace noise
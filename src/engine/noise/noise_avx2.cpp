@@ -0,0 +1,59 @@
+#include "noise.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#define NOISE_KERNEL_NAMESPACE avx2
+#include "noise_kernels.h"
+#include <immintrin.h>
+
+namespace noise::detail::avx2 {
+struct Avx2Ops {
+    static constexpr uint32_t WIDTH = 8;
+
+    using F = __m256;
+    using I = __m256i;
+    using M = __m256;
+
+    static F set(float v) { return _mm256_set1_ps(v); }
+    static I seti(uint32_t v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+    static F iota() { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+    static void store(float* out, F v) { _mm256_storeu_ps(out, v); }
+
+    static F add(F a, F b) { return _mm256_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+    static F floor(F a) { return _mm256_floor_ps(a); }
+    static I toInt(F a) { return _mm256_cvttps_epi32(a); }
+    static F toFloat(I a) { return _mm256_cvtepi32_ps(a); }
+
+    static I addi(I a, I b) { return _mm256_add_epi32(a, b); }
+    static I muli(I a, I b) { return _mm256_mullo_epi32(a, b); }
+    static I xori(I a, I b) { return _mm256_xor_si256(a, b); }
+    static I andi(I a, I b) { return _mm256_and_si256(a, b); }
+    template <int N> static I srl(I a) { return _mm256_srli_epi32(a, N); }
+
+    static M lt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static M ge(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+    static M eqi(I a, I b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+    static M andm(M a, M b) { return _mm256_and_ps(a, b); }
+    static M orm(M a, M b) { return _mm256_or_ps(a, b); }
+    static M andnotm(M a, M b) { return _mm256_andnot_ps(a, b); }
+    static M notm(M a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+
+    static F select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+    static I selecti(M m, I a, I b) {
+        return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a), m));
+    }
+    static F negIf(M m, F a) { return _mm256_xor_ps(a, _mm256_and_ps(m, _mm256_set1_ps(-0.0f))); }
+};
+} // namespace noise::detail::avx2
+
+noise::detail::GridKernels noise::detail::avx2Kernels() {
+    return GridKernels{&avx2::fill2D<avx2::Avx2Ops>, &avx2::fill3D<avx2::Avx2Ops>};
+}
+
+#else
+
+noise::detail::GridKernels noise::detail::avx2Kernels() { return GridKernels{nullptr, nullptr}; }
+
+#endif
@@ -0,0 +1,502 @@
+// Internal to the noise library. Every kernel translation unit includes this
+// once, after defining NOISE_KERNEL_NAMESPACE, and is compiled with its own
+// instruction set flags. The per-ISA namespace keeps the template
+// instantiations of different translation units apart, so the linker can
+// never fold an AVX2 compiled instantiation into the scalar path.
+//
+// All noise functions are written once against an "ops" type. The scalar ops
+// and the SIMD ops perform the exact same IEEE operations in the same order,
+// which is what makes every kernel bit-identical to the scalar fallback. Do
+// not introduce approximations (rcp, rsqrt, fma) in only one of them.
+
+#ifndef NOISE_KERNEL_NAMESPACE
+#error "NOISE_KERNEL_NAMESPACE must be defined before including noise_kernels.h"
+#endif
+
+#include "noise.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace noise::detail::NOISE_KERNEL_NAMESPACE {
+
+struct ScalarOps {
+    static constexpr uint32_t WIDTH = 1;
+
+    using F = float;
+    using I = uint32_t;
+    using M = bool;
+
+    static F set(float v) { return v; }
+    static I seti(uint32_t v) { return v; }
+    static F iota() { return 0.0f; }
+    static void store(float* out, F v) { *out = v; }
+
+    static F add(F a, F b) { return a + b; }
+    static F sub(F a, F b) { return a - b; }
+    static F mul(F a, F b) { return a * b; }
+    static F floor(F a) { return std::floor(a); }
+    static I toInt(F a) { return static_cast<uint32_t>(static_cast<int32_t>(a)); }
+    static F toFloat(I a) { return static_cast<float>(static_cast<int32_t>(a)); }
+
+    static I addi(I a, I b) { return a + b; }
+    static I muli(I a, I b) { return a * b; }
+    static I xori(I a, I b) { return a ^ b; }
+    static I andi(I a, I b) { return a & b; }
+    template <int N> static I srl(I a) { return a >> N; }
+
+    static M lt(F a, F b) { return a < b; }
+    static M ge(F a, F b) { return a >= b; }
+    static M eqi(I a, I b) { return a == b; }
+    static M andm(M a, M b) { return a && b; }
+    static M orm(M a, M b) { return a || b; }
+    /// `!a && b`, matching the SSE `andnot` operand order.
+    static M andnotm(M a, M b) { return !a && b; }
+    static M notm(M a) { return !a; }
+
+    static F select(M m, F a, F b) { return m ? a : b; }
+    static I selecti(M m, I a, I b) { return m ? a : b; }
+    static F negIf(M m, F a) { return m ? -a : a; }
+};
+
+constexpr uint32_t PRIME_X = 501125321u;
+constexpr uint32_t PRIME_Y = 1136930381u;
+constexpr uint32_t PRIME_Z = 1720413743u;
+constexpr uint32_t HASH_MUL = 0x27d4eb2du;
+constexpr uint32_t WARP_SEED_X = 0x5f3759dfu;
+constexpr uint32_t WARP_SEED_Y = 0x2545f491u;
+constexpr uint32_t WARP_SEED_Z = 0x9e3779b9u;
+
+template <typename O> typename O::I finishHash(typename O::I h) {
+    h = O::muli(h, O::seti(HASH_MUL));
+    return O::xori(h, O::template srl<15>(h));
+}
+
+/// Inputs are lattice coordinates already multiplied by their prime.
+template <typename O> typename O::I hash2(typename O::I seed, typename O::I xp, typename O::I yp) {
+    return finishHash<O>(O::xori(O::xori(seed, xp), yp));
+}
+
+template <typename O>
+typename O::I hash3(typename O::I seed, typename O::I xp, typename O::I yp, typename O::I zp) {
+    return finishHash<O>(O::xori(O::xori(O::xori(seed, xp), yp), zp));
+}
+
+template <typename O> typename O::F lerp(typename O::F a, typename O::F b, typename O::F t) {
+    return O::add(a, O::mul(t, O::sub(b, a)));
+}
+
+/// Quintic fade curve, t * t * t * (t * (t * 6 - 15) + 10).
+template <typename O> typename O::F fade(typename O::F t) {
+    using F = typename O::F;
+    const F inner = O::add(O::mul(t, O::sub(O::mul(t, O::set(6.0f)), O::set(15.0f))), O::set(10.0f));
+    return O::mul(O::mul(O::mul(t, t), t), inner);
+}
+
+/// Maps a hash to a lattice value within [-1, 1].
+template <typename O> typename O::F latticeValue(typename O::I h) {
+    const typename O::F v = O::toFloat(O::andi(h, O::seti(0xFFFFFFu)));
+    return O::sub(O::mul(v, O::set(2.0f / 16777215.0f)), O::set(1.0f));
+}
+
+template <typename O> typename O::M hashBit(typename O::I h, uint32_t bit) {
+    return O::eqi(O::andi(h, O::seti(bit)), O::seti(bit));
+}
+
+/// 8 gradient directions, as used by Gustavson's noise1234.
+template <typename O> typename O::F grad2(typename O::I h, typename O::F x, typename O::F y) {
+    using F = typename O::F;
+    using M = typename O::M;
+    const M low = O::eqi(O::andi(h, O::seti(4)), O::seti(0));
+    const F u = O::select(low, x, y);
+    const F v = O::select(low, y, x);
+    return O::add(O::negIf(hashBit<O>(h, 1), u), O::negIf(hashBit<O>(h, 2), O::mul(O::set(2.0f), v)));
+}
+
+/// 12 cube edge gradients (16 with repeats), as used by improved Perlin noise.
+template <typename O> typename O::F grad3(typename O::I h, typename O::F x, typename O::F y, typename O::F z) {
+    using F = typename O::F;
+    using M = typename O::M;
+    const M below8 = O::eqi(O::andi(h, O::seti(8)), O::seti(0));
+    const M below4 = O::eqi(O::andi(h, O::seti(12)), O::seti(0));
+    const M is12or14 = O::eqi(O::andi(h, O::seti(13)), O::seti(12));
+    const F u = O::select(below8, x, y);
+    const F v = O::select(below4, y, O::select(is12or14, x, z));
+    return O::add(O::negIf(hashBit<O>(h, 1), u), O::negIf(hashBit<O>(h, 2), v));
+}
+
+template <typename O> typename O::F value2(typename O::I seed, typename O::F x, typename O::F y) {
+    using F = typename O::F;
+    using I = typename O::I;
+    const F x0 = O::floor(x);
+    const F y0 = O::floor(y);
+    const F u = fade<O>(O::sub(x, x0));
+    const F v = fade<O>(O::sub(y, y0));
+    const I xp0 = O::muli(O::toInt(x0), O::seti(PRIME_X));
+    const I yp0 = O::muli(O::toInt(y0), O::seti(PRIME_Y));
+    const I xp1 = O::addi(xp0, O::seti(PRIME_X));
+    const I yp1 = O::addi(yp0, O::seti(PRIME_Y));
+
+    const F a = lerp<O>(latticeValue<O>(hash2<O>(seed, xp0, yp0)), latticeValue<O>(hash2<O>(seed, xp1, yp0)), u);
+    const F b = lerp<O>(latticeValue<O>(hash2<O>(seed, xp0, yp1)), latticeValue<O>(hash2<O>(seed, xp1, yp1)), u);
+    return lerp<O>(a, b, v);
+}
+
+template <typename O>
+typename O::F value3(typename O::I seed, typename O::F x, typename O::F y, typename O::F z) {
+    using F = typename O::F;
+    using I = typename O::I;
+    const F x0 = O::floor(x);
+    const F y0 = O::floor(y);
+    const F z0 = O::floor(z);
+    const F u = fade<O>(O::sub(x, x0));
+    const F v = fade<O>(O::sub(y, y0));
+    const F w = fade<O>(O::sub(z, z0));
+    const I xp0 = O::muli(O::toInt(x0), O::seti(PRIME_X));
+    const I yp0 = O::muli(O::toInt(y0), O::seti(PRIME_Y));
+    const I zp0 = O::muli(O::toInt(z0), O::seti(PRIME_Z));
+    const I xp1 = O::addi(xp0, O::seti(PRIME_X));
+    const I yp1 = O::addi(yp0, O::seti(PRIME_Y));
+    const I zp1 = O::addi(zp0, O::seti(PRIME_Z));
+
+    const F a = lerp<O>(latticeValue<O>(hash3<O>(seed, xp0, yp0, zp0)),
+                        latticeValue<O>(hash3<O>(seed, xp1, yp0, zp0)), u);
+    const F b = lerp<O>(latticeValue<O>(hash3<O>(seed, xp0, yp1, zp0)),
+                        latticeValue<O>(hash3<O>(seed, xp1, yp1, zp0)), u);
+    const F c = lerp<O>(latticeValue<O>(hash3<O>(seed, xp0, yp0, zp1)),
+                        latticeValue<O>(hash3<O>(seed, xp1, yp0, zp1)), u);
+    const F d = lerp<O>(latticeValue<O>(hash3<O>(seed, xp0, yp1, zp1)),
+                        latticeValue<O>(hash3<O>(seed, xp1, yp1, zp1)), u);
+    return lerp<O>(lerp<O>(a, b, v), lerp<O>(c, d, v), w);
+}
+
+template <typename O> typename O::F perlin2(typename O::I seed, typename O::F x, typename O::F y) {
+    using F = typename O::F;
+    using I = typename O::I;
+    const F x0 = O::floor(x);
+    const F y0 = O::floor(y);
+    const F fx0 = O::sub(x, x0);
+    const F fy0 = O::sub(y, y0);
+    const F fx1 = O::sub(fx0, O::set(1.0f));
+    const F fy1 = O::sub(fy0, O::set(1.0f));
+    const F u = fade<O>(fx0);
+    const F v = fade<O>(fy0);
+    const I xp0 = O::muli(O::toInt(x0), O::seti(PRIME_X));
+    const I yp0 = O::muli(O::toInt(y0), O::seti(PRIME_Y));
+    const I xp1 = O::addi(xp0, O::seti(PRIME_X));
+    const I yp1 = O::addi(yp0, O::seti(PRIME_Y));
+
+    const F a = lerp<O>(grad2<O>(hash2<O>(seed, xp0, yp0), fx0, fy0), grad2<O>(hash2<O>(seed, xp1, yp0), fx1, fy0), u);
+    const F b = lerp<O>(grad2<O>(hash2<O>(seed, xp0, yp1), fx0, fy1), grad2<O>(hash2<O>(seed, xp1, yp1), fx1, fy1), u);
+    return O::mul(O::set(0.507f), lerp<O>(a, b, v));
+}
+
+template <typename O>
+typename O::F perlin3(typename O::I seed, typename O::F x, typename O::F y, typename O::F z) {
+    using F = typename O::F;
+    using I = typename O::I;
+    const F x0 = O::floor(x);
+    const F y0 = O::floor(y);
+    const F z0 = O::floor(z);
+    const F fx0 = O::sub(x, x0);
+    const F fy0 = O::sub(y, y0);
+    const F fz0 = O::sub(z, z0);
+    const F fx1 = O::sub(fx0, O::set(1.0f));
+    const F fy1 = O::sub(fy0, O::set(1.0f));
+    const F fz1 = O::sub(fz0, O::set(1.0f));
+    const F u = fade<O>(fx0);
+    const F v = fade<O>(fy0);
+    const F w = fade<O>(fz0);
+    const I xp0 = O::muli(O::toInt(x0), O::seti(PRIME_X));
+    const I yp0 = O::muli(O::toInt(y0), O::seti(PRIME_Y));
+    const I zp0 = O::muli(O::toInt(z0), O::seti(PRIME_Z));
+    const I xp1 = O::addi(xp0, O::seti(PRIME_X));
+    const I yp1 = O::addi(yp0, O::seti(PRIME_Y));
+    const I zp1 = O::addi(zp0, O::seti(PRIME_Z));
+
+    const F a = lerp<O>(grad3<O>(hash3<O>(seed, xp0, yp0, zp0), fx0, fy0, fz0),
+                        grad3<O>(hash3<O>(seed, xp1, yp0, zp0), fx1, fy0, fz0), u);
+    const F b = lerp<O>(grad3<O>(hash3<O>(seed, xp0, yp1, zp0), fx0, fy1, fz0),
+                        grad3<O>(hash3<O>(seed, xp1, yp1, zp0), fx1, fy1, fz0), u);
+    const F c = lerp<O>(grad3<O>(hash3<O>(seed, xp0, yp0, zp1), fx0, fy0, fz1),
+                        grad3<O>(hash3<O>(seed, xp1, yp0, zp1), fx1, fy0, fz1), u);
+    const F d = lerp<O>(grad3<O>(hash3<O>(seed, xp0, yp1, zp1), fx0, fy1, fz1),
+                        grad3<O>(hash3<O>(seed, xp1, yp1, zp1), fx1, fy1, fz1), u);
+    return O::mul(O::set(0.936f), lerp<O>(lerp<O>(a, b, v), lerp<O>(c, d, v), w));
+}
+
+/// Contribution of one simplex corner, `max(0, r - |d|^2)^4 * grad`.
+template <typename O> typename O::F simplexCorner(typename O::F t, typename O::F gradient) {
+    using F = typename O::F;
+    const F t2 = O::mul(t, t);
+    const F n = O::mul(O::mul(t2, t2), gradient);
+    return O::select(O::lt(t, O::set(0.0f)), O::set(0.0f), n);
+}
+
+template <typename O> typename O::F simplex2(typename O::I seed, typename O::F x, typename O::F y) {
+    using F = typename O::F;
+    using I = typename O::I;
+    using M = typename O::M;
+    constexpr float F2 = 0.366025403f; // 0.5 * (sqrt(3) - 1)
+    constexpr float G2 = 0.211324865f; // (3 - sqrt(3)) / 6
+
+    const F s = O::mul(O::add(x, y), O::set(F2));
+    const F i = O::floor(O::add(x, s));
+    const F j = O::floor(O::add(y, s));
+    const F t = O::mul(O::add(i, j), O::set(G2));
+    const F x0 = O::sub(x, O::sub(i, t));
+    const F y0 = O::sub(y, O::sub(j, t));
+
+    // lower or upper triangle of the skewed cell
+    const M xFirst = O::lt(y0, x0);
+    const F i1 = O::select(xFirst, O::set(1.0f), O::set(0.0f));
+    const F j1 = O::select(xFirst, O::set(0.0f), O::set(1.0f));
+
+    const F x1 = O::add(O::sub(x0, i1), O::set(G2));
+    const F y1 = O::add(O::sub(y0, j1), O::set(G2));
+    const F x2 = O::add(O::sub(x0, O::set(1.0f)), O::set(2.0f * G2));
+    const F y2 = O::add(O::sub(y0, O::set(1.0f)), O::set(2.0f * G2));
+
+    const I xp0 = O::muli(O::toInt(i), O::seti(PRIME_X));
+    const I yp0 = O::muli(O::toInt(j), O::seti(PRIME_Y));
+    const I xp1 = O::addi(xp0, O::selecti(xFirst, O::seti(PRIME_X), O::seti(0)));
+    const I yp1 = O::addi(yp0, O::selecti(xFirst, O::seti(0), O::seti(PRIME_Y)));
+    const I xp2 = O::addi(xp0, O::seti(PRIME_X));
+    const I yp2 = O::addi(yp0, O::seti(PRIME_Y));
+
+    const F t0 = O::sub(O::sub(O::set(0.5f), O::mul(x0, x0)), O::mul(y0, y0));
+    const F t1 = O::sub(O::sub(O::set(0.5f), O::mul(x1, x1)), O::mul(y1, y1));
+    const F t2 = O::sub(O::sub(O::set(0.5f), O::mul(x2, x2)), O::mul(y2, y2));
+
+    const F n0 = simplexCorner<O>(t0, grad2<O>(hash2<O>(seed, xp0, yp0), x0, y0));
+    const F n1 = simplexCorner<O>(t1, grad2<O>(hash2<O>(seed, xp1, yp1), x1, y1));
+    const F n2 = simplexCorner<O>(t2, grad2<O>(hash2<O>(seed, xp2, yp2), x2, y2));
+    return O::mul(O::set(40.0f), O::add(O::add(n0, n1), n2));
+}
+
+template <typename O>
+typename O::F simplex3(typename O::I seed, typename O::F x, typename O::F y, typename O::F z) {
+    using F = typename O::F;
+    using I = typename O::I;
+    using M = typename O::M;
+    constexpr float F3 = 1.0f / 3.0f;
+    constexpr float G3 = 1.0f / 6.0f;
+
+    const F s = O::mul(O::add(O::add(x, y), z), O::set(F3));
+    const F i = O::floor(O::add(x, s));
+    const F j = O::floor(O::add(y, s));
+    const F k = O::floor(O::add(z, s));
+    const F t = O::mul(O::add(O::add(i, j), k), O::set(G3));
+    const F x0 = O::sub(x, O::sub(i, t));
+    const F y0 = O::sub(y, O::sub(j, t));
+    const F z0 = O::sub(z, O::sub(k, t));
+
+    // Rank the offsets to find which of the six tetrahedra we are in. The
+    // first corner steps along the largest axis, the second along every axis
+    // except the smallest.
+    const M xy = O::ge(x0, y0);
+    const M yz = O::ge(y0, z0);
+    const M xz = O::ge(x0, z0);
+    const M i1 = O::andm(xy, xz);
+    const M j1 = O::andnotm(xy, yz);
+    const M k1 = O::andnotm(xz, O::notm(yz));
+    const M i2 = O::orm(xy, xz);
+    const M j2 = O::orm(O::notm(xy), yz);
+    const M k2 = O::notm(O::andm(xz, yz));
+
+    const F one = O::set(1.0f);
+    const F zero = O::set(0.0f);
+    const F x1 = O::add(O::sub(x0, O::select(i1, one, zero)), O::set(G3));
+    const F y1 = O::add(O::sub(y0, O::select(j1, one, zero)), O::set(G3));
+    const F z1 = O::add(O::sub(z0, O::select(k1, one, zero)), O::set(G3));
+    const F x2 = O::add(O::sub(x0, O::select(i2, one, zero)), O::set(2.0f * G3));
+    const F y2 = O::add(O::sub(y0, O::select(j2, one, zero)), O::set(2.0f * G3));
+    const F z2 = O::add(O::sub(z0, O::select(k2, one, zero)), O::set(2.0f * G3));
+    const F x3 = O::add(O::sub(x0, one), O::set(3.0f * G3));
+    const F y3 = O::add(O::sub(y0, one), O::set(3.0f * G3));
+    const F z3 = O::add(O::sub(z0, one), O::set(3.0f * G3));
+
+    const I px = O::seti(PRIME_X);
+    const I py = O::seti(PRIME_Y);
+    const I pz = O::seti(PRIME_Z);
+    const I none = O::seti(0);
+    const I xp0 = O::muli(O::toInt(i), px);
+    const I yp0 = O::muli(O::toInt(j), py);
+    const I zp0 = O::muli(O::toInt(k), pz);
+    const I h0 = hash3<O>(seed, xp0, yp0, zp0);
+    const I h1 = hash3<O>(seed, O::addi(xp0, O::selecti(i1, px, none)), O::addi(yp0, O::selecti(j1, py, none)),
+                          O::addi(zp0, O::selecti(k1, pz, none)));
+    const I h2 = hash3<O>(seed, O::addi(xp0, O::selecti(i2, px, none)), O::addi(yp0, O::selecti(j2, py, none)),
+                          O::addi(zp0, O::selecti(k2, pz, none)));
+    const I h3 = hash3<O>(seed, O::addi(xp0, px), O::addi(yp0, py), O::addi(zp0, pz));
+
+    const F r = O::set(0.6f);
+    const F t0 = O::sub(O::sub(O::sub(r, O::mul(x0, x0)), O::mul(y0, y0)), O::mul(z0, z0));
+    const F t1 = O::sub(O::sub(O::sub(r, O::mul(x1, x1)), O::mul(y1, y1)), O::mul(z1, z1));
+    const F t2 = O::sub(O::sub(O::sub(r, O::mul(x2, x2)), O::mul(y2, y2)), O::mul(z2, z2));
+    const F t3 = O::sub(O::sub(O::sub(r, O::mul(x3, x3)), O::mul(y3, y3)), O::mul(z3, z3));
+
+    const F n0 = simplexCorner<O>(t0, grad3<O>(h0, x0, y0, z0));
+    const F n1 = simplexCorner<O>(t1, grad3<O>(h1, x1, y1, z1));
+    const F n2 = simplexCorner<O>(t2, grad3<O>(h2, x2, y2, z2));
+    const F n3 = simplexCorner<O>(t3, grad3<O>(h3, x3, y3, z3));
+    return O::mul(O::set(32.0f), O::add(O::add(O::add(n0, n1), n2), n3));
+}
+
+template <typename O>
+typename O::F noise2(NoiseType type, typename O::I seed, typename O::F x, typename O::F y) {
+    switch (type) {
+    case NoiseType::Value:
+        return value2<O>(seed, x, y);
+    case NoiseType::Perlin:
+        return perlin2<O>(seed, x, y);
+    case NoiseType::Simplex:
+    default:
+        return simplex2<O>(seed, x, y);
+    }
+}
+
+template <typename O>
+typename O::F noise3(NoiseType type, typename O::I seed, typename O::F x, typename O::F y, typename O::F z) {
+    switch (type) {
+    case NoiseType::Value:
+        return value3<O>(seed, x, y, z);
+    case NoiseType::Perlin:
+        return perlin3<O>(seed, x, y, z);
+    case NoiseType::Simplex:
+    default:
+        return simplex3<O>(seed, x, y, z);
+    }
+}
+
+/// Per-octave constants. Computed with plain scalar code so that every kernel
+/// broadcasts the exact same values.
+struct FractalPlan {
+    static constexpr int MAX_OCTAVES = 16;
+
+    int octaves;
+    float frequency[MAX_OCTAVES];
+    float amplitude[MAX_OCTAVES];
+    float normalise;
+
+    explicit FractalPlan(const FractalSettings& settings) {
+        octaves = settings.octaves < 1 ? 1 : (settings.octaves > MAX_OCTAVES ? MAX_OCTAVES : settings.octaves);
+        float freq = settings.frequency;
+        float amp = 1.0f;
+        float total = 0.0f;
+        for (int o = 0; o < octaves; o++) {
+            frequency[o] = freq;
+            amplitude[o] = amp;
+            total += amp;
+            freq *= settings.lacunarity;
+            amp *= settings.gain;
+        }
+        normalise = 1.0f / total;
+    }
+};
+
+template <typename O>
+typename O::F fractal2(const FractalSettings& settings, const FractalPlan& plan, typename O::F x, typename O::F y) {
+    using F = typename O::F;
+    const uint32_t seed = static_cast<uint32_t>(settings.seed);
+
+    if (settings.warpAmplitude != 0.0f) {
+        const F wx = O::mul(x, O::set(settings.warpFrequency));
+        const F wy = O::mul(y, O::set(settings.warpFrequency));
+        const F dx = noise2<O>(settings.type, O::seti(seed ^ WARP_SEED_X), wx, wy);
+        const F dy = noise2<O>(settings.type, O::seti(seed ^ WARP_SEED_Y), wx, wy);
+        x = O::add(x, O::mul(dx, O::set(settings.warpAmplitude)));
+        y = O::add(y, O::mul(dy, O::set(settings.warpAmplitude)));
+    }
+
+    F sum = O::set(0.0f);
+    for (int o = 0; o < plan.octaves; o++) {
+        const F freq = O::set(plan.frequency[o]);
+        const F n = noise2<O>(settings.type, O::seti(seed + static_cast<uint32_t>(o)), O::mul(x, freq), O::mul(y, freq));
+        sum = O::add(sum, O::mul(n, O::set(plan.amplitude[o])));
+    }
+    return O::mul(sum, O::set(plan.normalise));
+}
+
+template <typename O>
+typename O::F fractal3(const FractalSettings& settings, const FractalPlan& plan, typename O::F x, typename O::F y,
+                       typename O::F z) {
+    using F = typename O::F;
+    const uint32_t seed = static_cast<uint32_t>(settings.seed);
+
+    if (settings.warpAmplitude != 0.0f) {
+        const F wx = O::mul(x, O::set(settings.warpFrequency));
+        const F wy = O::mul(y, O::set(settings.warpFrequency));
+        const F wz = O::mul(z, O::set(settings.warpFrequency));
+        const F dx = noise3<O>(settings.type, O::seti(seed ^ WARP_SEED_X), wx, wy, wz);
+        const F dy = noise3<O>(settings.type, O::seti(seed ^ WARP_SEED_Y), wx, wy, wz);
+        const F dz = noise3<O>(settings.type, O::seti(seed ^ WARP_SEED_Z), wx, wy, wz);
+        x = O::add(x, O::mul(dx, O::set(settings.warpAmplitude)));
+        y = O::add(y, O::mul(dy, O::set(settings.warpAmplitude)));
+        z = O::add(z, O::mul(dz, O::set(settings.warpAmplitude)));
+    }
+
+    F sum = O::set(0.0f);
+    for (int o = 0; o < plan.octaves; o++) {
+        const F freq = O::set(plan.frequency[o]);
+        const F n = noise3<O>(settings.type, O::seti(seed + static_cast<uint32_t>(o)), O::mul(x, freq),
+                              O::mul(y, freq), O::mul(z, freq));
+        sum = O::add(sum, O::mul(n, O::set(plan.amplitude[o])));
+    }
+    return O::mul(sum, O::set(plan.normalise));
+}
+
+/// X coordinates of the lanes starting at column `x`. The scalar tail goes
+/// through the same expression, so partial rows stay bit-identical.
+template <typename O> typename O::F rowCoordinates(float origin, float step, uint32_t x) {
+    return O::add(O::set(origin), O::mul(O::add(O::set(static_cast<float>(x)), O::iota()), O::set(step)));
+}
+
+template <typename O>
+void fillRow2D(const FractalSettings& settings, const FractalPlan& plan, const Grid2D& grid, float z, float* row) {
+    uint32_t x = 0;
+    for (; x + O::WIDTH <= grid.sizeX; x += O::WIDTH) {
+        const typename O::F xs = rowCoordinates<O>(grid.originX, grid.step, x);
+        O::store(row + x, fractal2<O>(settings, plan, xs, O::set(z)));
+    }
+    for (; x < grid.sizeX; x++) {
+        const float xs = rowCoordinates<ScalarOps>(grid.originX, grid.step, x);
+        row[x] = fractal2<ScalarOps>(settings, plan, xs, z);
+    }
+}
+
+template <typename O>
+void fillRow3D(const FractalSettings& settings, const FractalPlan& plan, const Grid3D& grid, float y, float z,
+               float* row) {
+    uint32_t x = 0;
+    for (; x + O::WIDTH <= grid.sizeX; x += O::WIDTH) {
+        const typename O::F xs = rowCoordinates<O>(grid.originX, grid.step, x);
+        O::store(row + x, fractal3<O>(settings, plan, xs, O::set(y), O::set(z)));
+    }
+    for (; x < grid.sizeX; x++) {
+        const float xs = rowCoordinates<ScalarOps>(grid.originX, grid.step, x);
+        row[x] = fractal3<ScalarOps>(settings, plan, xs, y, z);
+    }
+}
+
+template <typename O> void fill2D(const FractalSettings& settings, const Grid2D& grid, float* out) {
+    const FractalPlan plan(settings);
+    for (uint32_t z = 0; z < grid.sizeZ; z++) {
+        const float zs = grid.originZ + static_cast<float>(z) * grid.step;
+        fillRow2D<O>(settings, plan, grid, zs, out + static_cast<size_t>(z) * grid.sizeX);
+    }
+}
+
+template <typename O> void fill3D(const FractalSettings& settings, const Grid3D& grid, float* out) {
+    const FractalPlan plan(settings);
+    for (uint32_t y = 0; y < grid.sizeY; y++) {
+        const float ys = grid.originY + static_cast<float>(y) * grid.step;
+        for (uint32_t z = 0; z < grid.sizeZ; z++) {
+            const float zs = grid.originZ + static_cast<float>(z) * grid.step;
+            const size_t rowStart = (static_cast<size_t>(y) * grid.sizeZ + z) * grid.sizeX;
+            fillRow3D<O>(settings, plan, grid, ys, zs, out + rowStart);
+        }
+    }
+}
+
+} // namespace noise::detail::NOISE_KERNEL_NAMESPACE
@@ -0,0 +1,59 @@
+#include "noise.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#define NOISE_KERNEL_NAMESPACE sse41
+#include "noise_kernels.h"
+#include <smmintrin.h>
+
+namespace noise::detail::sse41 {
+struct Sse41Ops {
+    static constexpr uint32_t WIDTH = 4;
+
+    using F = __m128;
+    using I = __m128i;
+    using M = __m128;
+
+    static F set(float v) { return _mm_set1_ps(v); }
+    static I seti(uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); }
+    static F iota() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+    static void store(float* out, F v) { _mm_storeu_ps(out, v); }
+
+    static F add(F a, F b) { return _mm_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+    static F floor(F a) { return _mm_floor_ps(a); }
+    static I toInt(F a) { return _mm_cvttps_epi32(a); }
+    static F toFloat(I a) { return _mm_cvtepi32_ps(a); }
+
+    static I addi(I a, I b) { return _mm_add_epi32(a, b); }
+    static I muli(I a, I b) { return _mm_mullo_epi32(a, b); }
+    static I xori(I a, I b) { return _mm_xor_si128(a, b); }
+    static I andi(I a, I b) { return _mm_and_si128(a, b); }
+    template <int N> static I srl(I a) { return _mm_srli_epi32(a, N); }
+
+    static M lt(F a, F b) { return _mm_cmplt_ps(a, b); }
+    static M ge(F a, F b) { return _mm_cmpge_ps(a, b); }
+    static M eqi(I a, I b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+    static M andm(M a, M b) { return _mm_and_ps(a, b); }
+    static M orm(M a, M b) { return _mm_or_ps(a, b); }
+    static M andnotm(M a, M b) { return _mm_andnot_ps(a, b); }
+    static M notm(M a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+
+    static F select(M m, F a, F b) { return _mm_blendv_ps(b, a, m); }
+    static I selecti(M m, I a, I b) {
+        return _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(b), _mm_castsi128_ps(a), m));
+    }
+    static F negIf(M m, F a) { return _mm_xor_ps(a, _mm_and_ps(m, _mm_set1_ps(-0.0f))); }
+};
+} // namespace noise::detail::sse41
+
+noise::detail::GridKernels noise::detail::sse41Kernels() {
+    return GridKernels{&sse41::fill2D<sse41::Sse41Ops>, &sse41::fill3D<sse41::Sse41Ops>};
+}
+
+#else
+
+noise::detail::GridKernels noise::detail::sse41Kernels() { return GridKernels{nullptr, nullptr}; }
+
+#endif
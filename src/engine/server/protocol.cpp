@@ -0,0 +1,290 @@
+#include "protocol.h"
+#include <algorithm>
+
+using server::BlockRun;
+using server::BlockRunsMessage;
+using server::ClientList;
+using server::ClientMessage;
+using server::MessageType;
+
+namespace {
+/// Type byte, three coordinates and the block.
+constexpr size_t SET_BLOCK_SIZE = 1 + 3 * sizeof(int32_t) + sizeof(world::BlockId);
+/// Type byte, three coordinates and the run count.
+constexpr size_t BLOCK_RUNS_HEADER_SIZE = 1 + 3 * sizeof(int32_t) + sizeof(uint16_t);
+constexpr size_t BLOCK_RUN_SIZE = 3 * sizeof(uint16_t);
+constexpr size_t RUNS_PER_DATAGRAM = (net::MAX_SAFE_PAYLOAD_SIZE - BLOCK_RUNS_HEADER_SIZE) / BLOCK_RUN_SIZE;
+
+void writeU16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void writeI32(std::vector<uint8_t>& out, int32_t value) {
+    const uint32_t bits = static_cast<uint32_t>(value);
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<uint8_t>(bits >> shift));
+    }
+}
+
+uint16_t readU16(std::span<const uint8_t> bytes, size_t offset) {
+    return static_cast<uint16_t>(bytes[offset] | (bytes[offset + 1] << 8));
+}
+
+int32_t readI32(std::span<const uint8_t> bytes, size_t offset) {
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; i++) {
+        bits |= static_cast<uint32_t>(bytes[offset + i]) << (8 * i);
+    }
+    return static_cast<int32_t>(bits);
+}
+
+/// @brief Appends `index` to `runs`, extending the last run if it ends just
+/// before `index` with the same block.
+void appendBlock(std::vector<BlockRun>& runs, uint32_t index, world::BlockId block) {
+    if (!runs.empty()) {
+        BlockRun& last = runs.back();
+        if (last.block == block && last.first + last.count == index) {
+            last.count++;
+            return;
+        }
+    }
+    runs.push_back(BlockRun{static_cast<uint16_t>(index), 1, block});
+}
+
+bool sameAddress(const net::TransportAddress& a, const net::TransportAddress& b) {
+    return a.addr_.sin_addr.s_addr == b.addr_.sin_addr.s_addr && a.addr_.sin_port == b.addr_.sin_port;
+}
+} // namespace
+
+std::optional<ClientMessage> server::decodeClientMessage(std::span<const uint8_t> bytes) {
+    if (bytes.empty()) {
+        return std::nullopt;
+    }
+    const MessageType type = static_cast<MessageType>(bytes[0]);
+    switch (type) {
+    case MessageType::Join:
+    case MessageType::Leave:
+        if (bytes.size() != 1) {
+            return std::nullopt;
+        }
+        return ClientMessage{.type = type};
+    case MessageType::SetBlock: {
+        if (bytes.size() != SET_BLOCK_SIZE) {
+            return std::nullopt;
+        }
+        const world::BlockId block = readU16(bytes, 13);
+        // clients only know the blocks the server does
+        if (block >= world::blocks::COUNT) {
+            return std::nullopt;
+        }
+        return ClientMessage{
+            .type = type, .pos = {readI32(bytes, 1), readI32(bytes, 5), readI32(bytes, 9)}, .block = block};
+    }
+    default:
+        return std::nullopt;
+    }
+}
+
+std::vector<uint8_t> server::encodeClientMessage(const ClientMessage& message) {
+    std::vector<uint8_t> out;
+    out.push_back(static_cast<uint8_t>(message.type));
+    if (message.type == MessageType::SetBlock) {
+        writeI32(out, message.pos.x);
+        writeI32(out, message.pos.y);
+        writeI32(out, message.pos.z);
+        writeU16(out, message.block);
+    }
+    return out;
+}
+
+std::vector<std::vector<uint8_t>> server::encodeBlockRuns(const world::Chunk& chunk,
+                                                          const world::ChunkChanges& changes) {
+    std::vector<BlockRun> runs;
+    if (changes.wholeChunk) {
+        for (uint32_t index = 0; index < world::CHUNK_VOLUME; index++) {
+            appendBlock(runs, index, chunk.block(index));
+        }
+    } else {
+        for (const uint16_t index : changes.indices) {
+            appendBlock(runs, index, chunk.block(index));
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> datagrams;
+    for (size_t first = 0; first < runs.size(); first += RUNS_PER_DATAGRAM) {
+        const size_t count = std::min(RUNS_PER_DATAGRAM, runs.size() - first);
+        std::vector<uint8_t>& out = datagrams.emplace_back();
+        out.reserve(BLOCK_RUNS_HEADER_SIZE + count * BLOCK_RUN_SIZE);
+        out.push_back(static_cast<uint8_t>(MessageType::BlockRuns));
+        writeI32(out, changes.pos.x);
+        writeI32(out, changes.pos.y);
+        writeI32(out, changes.pos.z);
+        writeU16(out, static_cast<uint16_t>(count));
+        for (size_t i = first; i < first + count; i++) {
+            writeU16(out, runs[i].first);
+            writeU16(out, runs[i].count);
+            writeU16(out, runs[i].block);
+        }
+    }
+    return datagrams;
+}
+
+std::optional<BlockRunsMessage> server::decodeBlockRuns(std::span<const uint8_t> bytes) {
+    if (bytes.size() < BLOCK_RUNS_HEADER_SIZE || static_cast<MessageType>(bytes[0]) != MessageType::BlockRuns) {
+        return std::nullopt;
+    }
+    const uint16_t count = readU16(bytes, 13);
+    if (bytes.size() != BLOCK_RUNS_HEADER_SIZE + count * BLOCK_RUN_SIZE) {
+        return std::nullopt;
+    }
+
+    BlockRunsMessage message{{readI32(bytes, 1), readI32(bytes, 5), readI32(bytes, 9)}, {}};
+    message.runs.reserve(count);
+    for (size_t offset = BLOCK_RUNS_HEADER_SIZE; offset < bytes.size(); offset += BLOCK_RUN_SIZE) {
+        const BlockRun run{readU16(bytes, offset), readU16(bytes, offset + 2), readU16(bytes, offset + 4)};
+        if (run.count == 0 || run.first + run.count > world::CHUNK_VOLUME || run.block >= world::blocks::COUNT) {
+            return std::nullopt;
+        }
+        message.runs.push_back(run);
+    }
+    return message;
+}
+
+bool ClientList::add(const net::TransportAddress& address) {
+    if (std::any_of(addresses_.begin(), addresses_.end(),
+                    [&](const net::TransportAddress& joined) { return sameAddress(joined, address); })) {
+        return false;
+    }
+    addresses_.push_back(address);
+    return true;
+}
+
+bool ClientList::remove(const net::TransportAddress& address) {
+    const auto found = std::find_if(addresses_.begin(), addresses_.end(),
+                                    [&](const net::TransportAddress& joined) { return sameAddress(joined, address); });
+    if (found == addresses_.end()) {
+        return false;
+    }
+    addresses_.erase(found);
+    return true;
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+TEST_SUITE("Protocol") {
+    TEST_CASE("client messages round trip") {
+        const ClientMessage setBlock{
+            .type = MessageType::SetBlock, .pos = {-40, 7, 1 << 20}, .block = world::blocks::GLOWSTONE};
+        const std::vector<uint8_t> bytes = server::encodeClientMessage(setBlock);
+        CHECK(bytes.size() == SET_BLOCK_SIZE);
+        const std::optional<ClientMessage> decoded = server::decodeClientMessage(bytes);
+        REQUIRE(decoded.has_value());
+        CHECK(decoded->type == MessageType::SetBlock);
+        CHECK(decoded->pos == setBlock.pos);
+        CHECK(decoded->block == world::blocks::GLOWSTONE);
+
+        const std::vector<uint8_t> join = server::encodeClientMessage(ClientMessage{.type = MessageType::Join});
+        CHECK(server::decodeClientMessage(join)->type == MessageType::Join);
+    }
+
+    TEST_CASE("malformed client messages are rejected") {
+        std::vector<uint8_t> bytes =
+            server::encodeClientMessage(ClientMessage{.type = MessageType::SetBlock, .block = world::blocks::STONE});
+        CHECK_FALSE(server::decodeClientMessage(std::span(bytes).first(bytes.size() - 1)).has_value());
+        bytes[13] = static_cast<uint8_t>(world::blocks::COUNT);
+        CHECK_FALSE(server::decodeClientMessage(bytes).has_value());
+
+        const uint8_t longJoin[] = {static_cast<uint8_t>(MessageType::Join), 0};
+        CHECK_FALSE(server::decodeClientMessage(longJoin).has_value());
+        const uint8_t unknown[] = {0xFF};
+        CHECK_FALSE(server::decodeClientMessage(unknown).has_value());
+        CHECK_FALSE(server::decodeClientMessage({}).has_value());
+    }
+
+    TEST_CASE("block changes are sent as runs of their current blocks") {
+        world::Chunk chunk(world::ChunkPos{3, -1, 2});
+        for (int32_t x = 4; x < 10; x++) {
+            chunk.setBlock(x, 5, 5, world::blocks::STONE);
+        }
+        chunk.setBlock(20, 5, 5, world::blocks::TORCH);
+
+        world::ChunkChanges changes{.pos = chunk.pos(), .indices = {}};
+        for (int32_t x = 4; x < 10; x++) {
+            changes.indices.push_back(static_cast<uint16_t>(world::Chunk::index(x, 5, 5)));
+        }
+        changes.indices.push_back(static_cast<uint16_t>(world::Chunk::index(20, 5, 5)));
+        // changed, then changed back
+        changes.indices.push_back(static_cast<uint16_t>(world::Chunk::index(21, 5, 5)));
+
+        const std::vector<std::vector<uint8_t>> datagrams = server::encodeBlockRuns(chunk, changes);
+        REQUIRE(datagrams.size() == 1);
+        const std::optional<BlockRunsMessage> message = server::decodeBlockRuns(datagrams[0]);
+        REQUIRE(message.has_value());
+        CHECK(message->pos == chunk.pos());
+        const uint16_t first = static_cast<uint16_t>(world::Chunk::index(4, 5, 5));
+        const uint16_t torch = static_cast<uint16_t>(world::Chunk::index(20, 5, 5));
+        CHECK(message->runs == std::vector<BlockRun>{{first, 6, world::blocks::STONE},
+                                                     {torch, 1, world::blocks::TORCH},
+                                                     {static_cast<uint16_t>(torch + 1), 1, world::blocks::AIR}});
+    }
+
+    TEST_CASE("a whole chunk is split into datagrams that rebuild it") {
+        world::Chunk chunk(world::ChunkPos{0, 0, 0});
+        // alternating blocks are the worst case, a run per block
+        for (int32_t y = 0; y < 4; y++) {
+            for (int32_t z = 0; z < world::CHUNK_SIZE; z++) {
+                for (int32_t x = 0; x < world::CHUNK_SIZE; x += 2) {
+                    chunk.setBlock(x, y, z, world::blocks::DIRT);
+                }
+            }
+        }
+
+        const std::vector<std::vector<uint8_t>> datagrams =
+            server::encodeBlockRuns(chunk, world::ChunkChanges{.pos = chunk.pos(), .indices = {}, .wholeChunk = true});
+        CHECK(datagrams.size() > 1);
+
+        world::Chunk rebuilt(chunk.pos());
+        rebuilt.setBlock(0, 31, 0, world::blocks::STONE);
+        for (const std::vector<uint8_t>& datagram : datagrams) {
+            CHECK(datagram.size() <= net::MAX_SAFE_PAYLOAD_SIZE);
+            const std::optional<BlockRunsMessage> message = server::decodeBlockRuns(datagram);
+            REQUIRE(message.has_value());
+            for (const BlockRun& run : message->runs) {
+                for (uint32_t index = run.first; index < run.first + run.count; index++) {
+                    rebuilt.setBlock(index, run.block);
+                }
+            }
+        }
+        CHECK(rebuilt.blocks() == chunk.blocks());
+    }
+
+    TEST_CASE("malformed block runs are rejected") {
+        world::Chunk chunk(world::ChunkPos{0, 0, 0});
+        const world::ChunkChanges whole{.pos = chunk.pos(), .indices = {}, .wholeChunk = true};
+        std::vector<uint8_t> datagram = server::encodeBlockRuns(chunk, whole)[0];
+        CHECK(server::decodeBlockRuns(datagram).has_value());
+        CHECK_FALSE(server::decodeBlockRuns(std::span(datagram).first(datagram.size() - 1)).has_value());
+        // one run of every block, pushed one past the end of the chunk
+        datagram[BLOCK_RUNS_HEADER_SIZE] = 1;
+        CHECK_FALSE(server::decodeBlockRuns(datagram).has_value());
+    }
+
+    TEST_CASE("clients join once and leave once") {
+        ClientList clients;
+        const net::TransportAddress a("127.0.0.1", 4000);
+        const net::TransportAddress b("127.0.0.1", 4001);
+        CHECK(clients.add(a));
+        CHECK_FALSE(clients.add(net::TransportAddress("127.0.0.1", 4000)));
+        CHECK(clients.add(b));
+        CHECK(clients.addresses().size() == 2);
+        CHECK(clients.remove(a));
+        CHECK_FALSE(clients.remove(a));
+        REQUIRE(clients.addresses().size() == 1);
+        CHECK(clients.addresses()[0].port() == 4001);
+    }
+}
+
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../net/transport.h"
+#include "../world/chunk.h"
+#include "../world/dirty_set.h"
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace server {
+/// @brief The first byte of every datagram. The rest is little endian, laid
+/// out as each message describes.
+enum class MessageType : uint8_t {
+    /// Client to server, nothing else. Starts replication to the sender.
+    Join = 1,
+    /// Client to server, nothing else. Stops replication to the sender.
+    Leave = 2,
+    /// Client to server, then the block position as three `int32_t` and the
+    /// `BlockId`.
+    SetBlock = 3,
+    /// Server to client, then the chunk position as three `int32_t`, a
+    /// `uint16_t` count of `BlockRun`s, and the runs, each as three
+    /// `uint16_t`. One chunk's changes may take several datagrams.
+    BlockRuns = 4,
+};
+
+/// @brief What a client asked for, decoded from one datagram.
+struct ClientMessage {
+    MessageType type;
+    /// Only for `MessageType::SetBlock`.
+    world::BlockPos pos{};
+    world::BlockId block = world::blocks::AIR;
+};
+
+/// @brief A client message, with who sent it.
+struct ClientInput {
+    net::TransportAddress from;
+    ClientMessage message;
+};
+
+/// @brief Consecutive blocks of a chunk, in `Chunk::index()` order, that
+/// all became `block`.
+struct BlockRun {
+    uint16_t first;
+    uint16_t count;
+    world::BlockId block;
+
+    bool operator==(const BlockRun&) const = default;
+};
+
+struct BlockRunsMessage {
+    world::ChunkPos pos;
+    std::vector<BlockRun> runs;
+};
+
+/// @return Empty if `bytes` is not exactly one well formed client message.
+std::optional<ClientMessage> decodeClientMessage(std::span<const uint8_t> bytes);
+
+std::vector<uint8_t> encodeClientMessage(const ClientMessage& message);
+
+/// @brief Encodes the blocks `changes` lists as they are now in `chunk`,
+/// merging neighbouring blocks of the same type into runs, so a whole chunk
+/// of terrain takes a few datagrams rather than one per block.
+/// @return Datagrams of at most `net::MAX_SAFE_PAYLOAD_SIZE` bytes each.
+std::vector<std::vector<uint8_t>> encodeBlockRuns(const world::Chunk& chunk, const world::ChunkChanges& changes);
+
+/// @return Empty if `bytes` is not exactly one well formed `BlockRuns`
+/// datagram.
+std::optional<BlockRunsMessage> decodeBlockRuns(std::span<const uint8_t> bytes);
+
+/// @brief The addresses of the clients that joined and have not left yet.
+class ClientList {
+  public:
+    /// @return `false` if `address` had already joined.
+    bool add(const net::TransportAddress& address);
+
+    /// @return `false` if `address` had not joined.
+    bool remove(const net::TransportAddress& address);
+
+    std::span<const net::TransportAddress> addresses() const { return addresses_; }
+
+  private:
+    std::vector<net::TransportAddress> addresses_;
+};
+} // namespace server
@@ -0,0 +1,291 @@
+#include "tick_loop.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <thread>
+
+using server::DeferredWork;
+using server::DurationHistogram;
+using server::TickBudget;
+using server::TickClock;
+using server::TickLoop;
+using server::TickLoopConfig;
+using server::TickPhase;
+using server::TickStats;
+
+namespace {
+double toMilliseconds(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/// `sleep_until` alone can overshoot by a whole scheduler quantum, which shows
+/// up directly as tick jitter. Sleep most of the way, then yield until due.
+void sleepUntilPrecise(TickClock::time_point target) {
+    constexpr auto SPIN_WINDOW = std::chrono::milliseconds(1);
+    if (target - TickClock::now() > SPIN_WINDOW) {
+        std::this_thread::sleep_until(target - SPIN_WINDOW);
+    }
+    while (TickClock::now() < target) {
+        std::this_thread::yield();
+    }
+}
+} // namespace
+
+const char* server::tickPhaseName(TickPhase phase) {
+    switch (phase) {
+    case TickPhase::NetworkIngest:
+        return "ingest";
+    case TickPhase::Simulation:
+        return "simulation";
+    case TickPhase::ChunkWork:
+        return "chunk work";
+    case TickPhase::Replication:
+        return "replication";
+    default:
+        return "unknown";
+    }
+}
+
+void DurationHistogram::record(std::chrono::nanoseconds duration) {
+    const uint64_t micros = static_cast<uint64_t>(std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 0));
+    const uint32_t index =
+        std::min<uint32_t>(micros == 0 ? 0 : static_cast<uint32_t>(std::bit_width(micros)) - 1, BUCKET_COUNT - 1);
+
+    buckets_[index]++;
+    count_++;
+    total_ += duration;
+    max_ = std::max(max_, duration);
+}
+
+void DurationHistogram::reset() { *this = DurationHistogram{}; }
+
+std::chrono::nanoseconds DurationHistogram::mean() const {
+    if (count_ == 0) {
+        return std::chrono::nanoseconds{0};
+    }
+    return total_ / static_cast<int64_t>(count_);
+}
+
+std::chrono::nanoseconds DurationHistogram::percentile(double fraction) const {
+    if (count_ == 0) {
+        return std::chrono::nanoseconds{0};
+    }
+    const uint64_t target =
+        std::max<uint64_t>(static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * count_)), 1);
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets_[i];
+        if (seen >= target) {
+            const std::chrono::nanoseconds upper = std::chrono::microseconds(uint64_t{2} << i);
+            return std::min(upper, max_);
+        }
+    }
+    return max_;
+}
+
+void TickStats::reset() { *this = TickStats{}; }
+
+std::string TickStats::summary() const {
+    std::string out = std::format("ticks {} | overruns {} | skipped {} | yields {} | tick p50 {:.2f}ms p99 {:.2f}ms "
+                                  "max {:.2f}ms",
+                                  ticks, overruns, skippedTicks, deferredYields,
+                                  toMilliseconds(tickDuration.percentile(0.5)),
+                                  toMilliseconds(tickDuration.percentile(0.99)), toMilliseconds(tickDuration.max()));
+    for (uint32_t i = 0; i < TICK_PHASE_COUNT; i++) {
+        out += std::format(" | {} p99 {:.2f}ms over {}", tickPhaseName(static_cast<TickPhase>(i)),
+                           toMilliseconds(phaseDuration[i].percentile(0.99)), phaseOverruns[i]);
+    }
+    return out;
+}
+
+std::chrono::nanoseconds TickBudget::remaining() const {
+    const auto left = deadline_ - TickClock::now();
+    return std::max(std::chrono::duration_cast<std::chrono::nanoseconds>(left), std::chrono::nanoseconds{0});
+}
+
+void TickBudget::recordYield() const {
+    if (stats_ != nullptr) {
+        stats_->deferredYields++;
+    }
+}
+
+size_t DeferredWork::run(const TickBudget& budget) {
+    size_t ran = 0;
+    while (!tasks_.empty()) {
+        if (ran > 0 && !budget.hasTimeRemaining()) {
+            budget.recordYield();
+            break;
+        }
+        Task task = std::move(tasks_.front());
+        tasks_.pop_front();
+        task();
+        ran++;
+    }
+    return ran;
+}
+
+TickLoop::TickLoop(const TickLoopConfig& config)
+    : config_(config), interval_(std::chrono::nanoseconds(std::chrono::seconds(1)) /
+                                 static_cast<int64_t>(std::max(config.ticksPerSecond, 1u))) {}
+
+void TickLoop::setPhase(TickPhase phase, PhaseFunction function) {
+    phases_[static_cast<uint32_t>(phase)] = std::move(function);
+}
+
+void TickLoop::tick() { runTick(TickClock::now()); }
+
+void TickLoop::run() {
+    TickClock::time_point next = TickClock::now();
+    while (!stopRequested_.load()) {
+        runTick(next);
+        next += interval_;
+
+        const TickClock::time_point now = TickClock::now();
+        const auto behind = now - next;
+        if (behind > interval_ * static_cast<int64_t>(config_.maxCatchUpTicks)) {
+            // Bursting through many late ticks would only make the next few
+            // late as well, so drop them and start over from now.
+            stats_.skippedTicks += static_cast<uint64_t>(behind / interval_);
+            next = now;
+        } else {
+            sleepUntilPrecise(next);
+        }
+    }
+    stopRequested_.store(false);
+}
+
+void TickLoop::runTick(TickClock::time_point scheduledStart) {
+    const TickClock::time_point tickDeadline = scheduledStart + interval_;
+    const TickClock::time_point tickStart = TickClock::now();
+
+    TickClock::time_point phaseStart = tickStart;
+    for (uint32_t i = 0; i < TICK_PHASE_COUNT; i++) {
+        const auto phaseBudget = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::duration<double, std::nano>(static_cast<double>(interval_.count()) * config_.phaseBudget[i]));
+        const TickBudget budget(std::min(phaseStart + phaseBudget, tickDeadline), tickNumber_, &stats_);
+
+        if (phases_[i]) {
+            phases_[i](budget);
+        }
+
+        const TickClock::time_point phaseEnd = TickClock::now();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(phaseEnd - phaseStart);
+        stats_.phaseDuration[i].record(elapsed);
+        if (elapsed > phaseBudget) {
+            stats_.phaseOverruns[i]++;
+        }
+        phaseStart = phaseEnd;
+    }
+
+    const auto tickElapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(phaseStart - tickStart);
+    stats_.tickDuration.record(tickElapsed);
+    if (tickElapsed > interval_) {
+        stats_.overruns++;
+    }
+    stats_.ticks++;
+    tickNumber_++;
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+#include <vector>
+
+TEST_SUITE("TickLoop") {
+    TEST_CASE("histogram buckets and percentiles") {
+        DurationHistogram histogram;
+        for (int i = 0; i < 99; i++) {
+            histogram.record(std::chrono::microseconds(100)); // bucket 6, [64, 128)
+        }
+        histogram.record(std::chrono::milliseconds(20)); // bucket 14, [16384, 32768)
+
+        CHECK(histogram.count() == 100);
+        CHECK(histogram.bucket(6) == 99);
+        CHECK(histogram.bucket(14) == 1);
+        CHECK(histogram.percentile(0.5) == std::chrono::microseconds(128));
+        CHECK(histogram.percentile(0.99) == std::chrono::microseconds(128));
+        CHECK(histogram.percentile(1.0) == std::chrono::milliseconds(20));
+        CHECK(histogram.max() == std::chrono::milliseconds(20));
+
+        histogram.reset();
+        CHECK(histogram.count() == 0);
+        CHECK(histogram.percentile(0.5) == std::chrono::nanoseconds(0));
+    }
+
+    TEST_CASE("phases run in order once per tick") {
+        TickLoop loop;
+        std::vector<TickPhase> order;
+        for (uint32_t i = 0; i < server::TICK_PHASE_COUNT; i++) {
+            const TickPhase phase = static_cast<TickPhase>(i);
+            loop.setPhase(phase, [&order, phase](const TickBudget&) { order.push_back(phase); });
+        }
+
+        loop.tick();
+        loop.tick();
+
+        REQUIRE(order.size() == 8);
+        CHECK(order[0] == TickPhase::NetworkIngest);
+        CHECK(order[1] == TickPhase::Simulation);
+        CHECK(order[2] == TickPhase::ChunkWork);
+        CHECK(order[3] == TickPhase::Replication);
+        CHECK(order[4] == TickPhase::NetworkIngest);
+        CHECK(loop.stats().ticks == 2);
+        CHECK(loop.tickNumber() == 2);
+    }
+
+    TEST_CASE("slow phases count as overruns and shrink later budgets") {
+        TickLoop loop(TickLoopConfig{.ticksPerSecond = 200});
+        bool chunkWorkHadTime = true;
+        loop.setPhase(TickPhase::Simulation,
+                      [](const TickBudget&) { std::this_thread::sleep_for(std::chrono::milliseconds(8)); });
+        loop.setPhase(TickPhase::ChunkWork,
+                      [&chunkWorkHadTime](const TickBudget& budget) { chunkWorkHadTime = budget.hasTimeRemaining(); });
+
+        loop.tick();
+
+        CHECK(loop.stats().overruns == 1);
+        CHECK(loop.stats().phaseOverruns[static_cast<uint32_t>(TickPhase::Simulation)] == 1);
+        CHECK_FALSE(chunkWorkHadTime);
+    }
+
+    TEST_CASE("deferred work yields once the budget runs out") {
+        TickStats stats;
+        DeferredWork work;
+        int ran = 0;
+        for (int i = 0; i < 10; i++) {
+            work.push([&ran]() { ran++; });
+        }
+
+        const TickBudget expired(TickClock::now() - std::chrono::milliseconds(1), 0, &stats);
+        CHECK(work.run(expired) == 1);
+        CHECK(stats.deferredYields == 1);
+
+        const TickBudget plenty(TickClock::now() + std::chrono::seconds(10), 0, &stats);
+        CHECK(work.run(plenty) == 9);
+        CHECK(work.empty());
+        CHECK(ran == 10);
+        CHECK(stats.deferredYields == 1);
+    }
+
+    TEST_CASE("run holds the tick rate until stopped") {
+        TickLoop loop(TickLoopConfig{.ticksPerSecond = 100});
+        loop.setPhase(TickPhase::Replication, [&loop](const TickBudget& budget) {
+            if (budget.tickNumber() == 9) {
+                loop.stop();
+            }
+        });
+
+        const auto start = TickClock::now();
+        loop.run();
+        const auto elapsed = TickClock::now() - start;
+
+        CHECK(loop.stats().ticks == 10);
+        // 10 ticks at 100Hz, the last one does not wait for its successor.
+        CHECK(elapsed >= std::chrono::milliseconds(85));
+    }
+}
+
+#endif
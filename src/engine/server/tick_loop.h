@@ -0,0 +1,186 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+
+namespace server {
+/// @brief The phases of a server tick, run in this order every tick.
+enum class TickPhase : uint8_t {
+    /// Drain sockets and decode packets.
+    NetworkIngest = 0,
+    /// Entities, block ticks and anything else that must run every tick.
+    Simulation = 1,
+    /// Deferrable work such as chunk generation and saving. Should yield
+    /// once its budget runs out.
+    ChunkWork = 2,
+    /// Send state changes to clients.
+    Replication = 3,
+};
+
+constexpr uint32_t TICK_PHASE_COUNT = 4;
+
+const char* tickPhaseName(TickPhase phase);
+
+using TickClock = std::chrono::steady_clock;
+
+/// @brief Histogram of durations with power of two microsecond buckets.
+/// Bucket 0 holds [0, 2) microseconds, bucket `i` holds [2^i, 2^(i+1)).
+class DurationHistogram {
+  public:
+    static constexpr uint32_t BUCKET_COUNT = 24;
+
+    void record(std::chrono::nanoseconds duration);
+
+    void reset();
+
+    uint64_t count() const { return count_; }
+
+    uint64_t bucket(uint32_t index) const { return buckets_[index]; }
+
+    std::chrono::nanoseconds max() const { return max_; }
+
+    std::chrono::nanoseconds mean() const;
+
+    /// @return The upper bound of the bucket holding the `fraction`
+    /// percentile, clamped to the largest recorded duration. `fraction`
+    /// is within [0, 1].
+    std::chrono::nanoseconds percentile(double fraction) const;
+
+  private:
+    std::array<uint64_t, BUCKET_COUNT> buckets_{};
+    uint64_t count_ = 0;
+    std::chrono::nanoseconds total_{0};
+    std::chrono::nanoseconds max_{0};
+};
+
+struct TickStats {
+    uint64_t ticks = 0;
+    /// Ticks that took longer than the tick interval.
+    uint64_t overruns = 0;
+    /// Ticks dropped because the loop fell too far behind to catch up.
+    uint64_t skippedTicks = 0;
+    /// Times deferrable work stopped early to give the time back.
+    uint64_t deferredYields = 0;
+    DurationHistogram tickDuration;
+    std::array<DurationHistogram, TICK_PHASE_COUNT> phaseDuration;
+    /// Times each phase ran past its own budget.
+    std::array<uint64_t, TICK_PHASE_COUNT> phaseOverruns{};
+
+    void reset();
+
+    /// @return A one line human readable summary, for logging.
+    std::string summary() const;
+};
+
+/// @brief Time allowance handed to a phase. A phase may run past it, but
+/// deferrable work should check `hasTimeRemaining()` between units of work.
+///
+/// The deadline is the earlier of the phase's own budget and the end of the
+/// tick, so when earlier phases overrun, or the tick itself started late,
+/// later phases get less time.
+class TickBudget {
+  public:
+    TickBudget(TickClock::time_point deadline, uint64_t tickNumber, TickStats* stats)
+        : deadline_(deadline), tickNumber_(tickNumber), stats_(stats) {}
+
+    bool hasTimeRemaining() const { return TickClock::now() < deadline_; }
+
+    std::chrono::nanoseconds remaining() const;
+
+    TickClock::time_point deadline() const { return deadline_; }
+
+    uint64_t tickNumber() const { return tickNumber_; }
+
+    /// @brief Records that deferrable work stopped early because of this
+    /// budget.
+    void recordYield() const;
+
+  private:
+    TickClock::time_point deadline_;
+    uint64_t tickNumber_;
+    TickStats* stats_;
+};
+
+/// @brief FIFO of deferrable tasks, such as chunk generation or saving, that
+/// only run while a phase has budget left.
+class DeferredWork {
+  public:
+    using Task = std::function<void()>;
+
+    void push(Task task) { tasks_.push_back(std::move(task)); }
+
+    size_t size() const { return tasks_.size(); }
+
+    bool empty() const { return tasks_.empty(); }
+
+    /// @brief Runs tasks in order until the queue is empty or `budget` runs
+    /// out. At least one task runs per call, so the queue always makes
+    /// progress even while the server is overloaded.
+    /// @return How many tasks ran.
+    size_t run(const TickBudget& budget);
+
+  private:
+    std::deque<Task> tasks_;
+};
+
+struct TickLoopConfig {
+    uint32_t ticksPerSecond = 20;
+    /// Fraction of the tick interval each phase may use, indexed by
+    /// `TickPhase`. Whatever is left over is idle time.
+    std::array<float, TICK_PHASE_COUNT> phaseBudget = {0.15f, 0.35f, 0.25f, 0.15f};
+    /// How many ticks the loop may fall behind before it stops trying to
+    /// catch up and drops them instead.
+    uint32_t maxCatchUpTicks = 5;
+};
+
+/// @brief Fixed timestep server loop. Each tick runs the four phases in
+/// order, then sleeps until the next tick is due.
+class TickLoop {
+  public:
+    using PhaseFunction = std::function<void(const TickBudget&)>;
+
+    explicit TickLoop(const TickLoopConfig& config = {});
+
+    TickLoop(const TickLoop&) = delete;
+    TickLoop& operator=(const TickLoop&) = delete;
+
+    /// @brief Sets the callback run for `phase` every tick. Replaces any
+    /// previous callback.
+    void setPhase(TickPhase phase, PhaseFunction function);
+
+    /// @brief Runs ticks at the configured rate until `stop()` is called.
+    /// Blocks the calling thread.
+    void run();
+
+    /// @brief Runs a single tick immediately, as if it were scheduled to
+    /// start now.
+    void tick();
+
+    /// @brief Makes `run()` return after the current tick. Safe to call from
+    /// any thread, and from a signal handler.
+    void stop() { stopRequested_.store(true); }
+
+    const TickStats& stats() const { return stats_; }
+
+    TickStats& stats() { return stats_; }
+
+    std::chrono::nanoseconds tickInterval() const { return interval_; }
+
+    uint64_t tickNumber() const { return tickNumber_; }
+
+  private:
+    void runTick(TickClock::time_point scheduledStart);
+
+    TickLoopConfig config_;
+    std::chrono::nanoseconds interval_;
+    std::array<PhaseFunction, TICK_PHASE_COUNT> phases_;
+    TickStats stats_;
+    uint64_t tickNumber_ = 0;
+    std::atomic<bool> stopRequested_{false};
+};
+} // namespace server
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace world {
+using BlockId = uint16_t;
+
+struct BlockProperties {
+    const char* name = "";
+    /// Blocks light, and hides the faces of neighbouring blocks.
+    bool opaque = false;
+    /// Entities collide with it.
+    bool solid = false;
+    /// Receives random ticks.
+    bool tickable = false;
+    /// Block light level emitted, from 0 to 15.
+    uint8_t emission = 0;
+};
+
+namespace blocks {
+constexpr BlockId AIR = 0;
+constexpr BlockId STONE = 1;
+constexpr BlockId DIRT = 2;
+constexpr BlockId GRASS = 3;
+constexpr BlockId SAND = 4;
+constexpr BlockId GLASS = 5;
+constexpr BlockId GLOWSTONE = 6;
+constexpr BlockId TORCH = 7;
+
+constexpr uint32_t COUNT = 8;
+} // namespace blocks
+
+inline constexpr std::array<BlockProperties, blocks::COUNT> BLOCK_PROPERTIES = {{
+    {.name = "air"},
+    {.name = "stone", .opaque = true, .solid = true},
+    {.name = "dirt", .opaque = true, .solid = true},
+    {.name = "grass", .opaque = true, .solid = true, .tickable = true},
+    {.name = "sand", .opaque = true, .solid = true},
+    {.name = "glass", .solid = true},
+    {.name = "glowstone", .opaque = true, .solid = true, .emission = 15},
+    {.name = "torch", .emission = 14},
+}};
+
+/// @return The properties of `id`. Unknown ids are treated as air.
+inline const BlockProperties& blockProperties(BlockId id) {
+    return BLOCK_PROPERTIES[id < blocks::COUNT ? id : blocks::AIR];
+}
+} // namespace world
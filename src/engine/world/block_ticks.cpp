@@ -0,0 +1,354 @@
+#include "block_ticks.h"
+#include <algorithm>
+
+using world::BlockBehaviour;
+using world::BlockId;
+using world::BlockPos;
+using world::BlockTicker;
+using world::BlockTickStats;
+using world::ChunkPos;
+using world::LightEngine;
+using world::World;
+
+namespace {
+/// Ticks between sand losing its support and falling one block.
+constexpr uint32_t SAND_FALL_DELAY = 2;
+
+void grassRandomTick(BlockTicker& ticker, BlockPos pos) {
+    World& world = ticker.world();
+    if (world::blockProperties(world.block(pos.offset(0, 1, 0))).opaque) {
+        ticker.setBlock(pos, world::blocks::DIRT);
+        return;
+    }
+
+    const uint32_t r = ticker.random();
+    const BlockPos target = pos.offset(static_cast<int32_t>(r % 3) - 1, static_cast<int32_t>((r / 3) % 3) - 1,
+                                       static_cast<int32_t>((r / 9) % 3) - 1);
+    if (world.block(target) == world::blocks::DIRT &&
+        !world::blockProperties(world.block(target.offset(0, 1, 0))).opaque) {
+        ticker.setBlock(target, world::blocks::GRASS);
+    }
+}
+
+void sandScheduledTick(BlockTicker& ticker, BlockPos pos) {
+    World& world = ticker.world();
+    const BlockPos below = pos.offset(0, -1, 0);
+    if (world.chunk(below.chunk()) == nullptr || world::blockProperties(world.block(below)).solid) {
+        return;
+    }
+    ticker.setBlock(pos, world::blocks::AIR);
+    ticker.setBlock(below, world::blocks::SAND);
+}
+
+void sandNeighbourChanged(BlockTicker& ticker, BlockPos pos) { ticker.schedule(pos, SAND_FALL_DELAY); }
+} // namespace
+
+BlockTicker::BlockTicker(World& world, LightEngine* lightEngine, uint32_t randomTicksPerChunk, uint64_t seed)
+    : world_(world), lightEngine_(lightEngine), randomTicksPerChunk_(randomTicksPerChunk),
+      randomState_(seed != 0 ? seed : 1), behaviours_(blocks::COUNT) {}
+
+void BlockTicker::setBehaviour(BlockId id, BlockBehaviour behaviour) {
+    if (id >= behaviours_.size()) {
+        behaviours_.resize(id + 1);
+    }
+    behaviours_[id] = std::move(behaviour);
+}
+
+const BlockBehaviour* BlockTicker::behaviourOf(BlockId id) const {
+    return id < behaviours_.size() ? &behaviours_[id] : nullptr;
+}
+
+uint32_t BlockTicker::random() {
+    // xorshift64*
+    randomState_ ^= randomState_ >> 12;
+    randomState_ ^= randomState_ << 25;
+    randomState_ ^= randomState_ >> 27;
+    return static_cast<uint32_t>((randomState_ * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+void BlockTicker::onChunkLoaded(ChunkPos pos) { updateActive(pos); }
+
+void BlockTicker::onChunkUnloaded(ChunkPos pos) { setActive(pos, false); }
+
+void BlockTicker::updateActive(ChunkPos pos) {
+    const Chunk* chunk = world_.chunk(pos);
+    setActive(pos, chunk != nullptr && chunk->tickableCount() > 0);
+}
+
+void BlockTicker::setActive(ChunkPos pos, bool active) {
+    auto found = activeIndex_.find(pos);
+    if (active && found == activeIndex_.end()) {
+        activeIndex_.emplace(pos, static_cast<uint32_t>(activeChunks_.size()));
+        activeChunks_.push_back(pos);
+    } else if (!active && found != activeIndex_.end()) {
+        const uint32_t index = found->second;
+        activeIndex_.erase(found);
+        if (index != activeChunks_.size() - 1) {
+            activeChunks_[index] = activeChunks_.back();
+            activeIndex_[activeChunks_[index]] = index;
+        }
+        activeChunks_.pop_back();
+    }
+}
+
+std::optional<BlockId> BlockTicker::setBlock(BlockPos pos, BlockId id) {
+    const std::optional<BlockId> previous = world_.setBlock(pos, id);
+    if (!previous.has_value() || previous.value() == id) {
+        return previous;
+    }
+
+    if (lightEngine_ != nullptr) {
+        lightEngine_->onBlockChanged(pos, previous.value());
+    }
+    dirty_.markBlock(pos);
+    if (blockProperties(previous.value()).tickable != blockProperties(id).tickable) {
+        updateActive(pos.chunk());
+    }
+
+    notifyNeighbourChanged(pos);
+    notifyNeighbourChanged(pos.offset(1, 0, 0));
+    notifyNeighbourChanged(pos.offset(-1, 0, 0));
+    notifyNeighbourChanged(pos.offset(0, 1, 0));
+    notifyNeighbourChanged(pos.offset(0, -1, 0));
+    notifyNeighbourChanged(pos.offset(0, 0, 1));
+    notifyNeighbourChanged(pos.offset(0, 0, -1));
+    return previous;
+}
+
+void BlockTicker::notifyNeighbourChanged(BlockPos pos) {
+    const BlockBehaviour* behaviour = behaviourOf(world_.block(pos));
+    if (behaviour != nullptr && behaviour->neighbourChanged) {
+        behaviour->neighbourChanged(*this, pos);
+    }
+}
+
+bool BlockTicker::schedule(BlockPos pos, uint32_t delay) {
+    if (!scheduledPositions_.insert(pos).second) {
+        return false;
+    }
+
+    delay = std::max(delay, 1u);
+    const ScheduledTick scheduled{pos, world_.block(pos), currentTick_ + delay};
+    if (delay < WHEEL_SIZE) {
+        wheel_[scheduled.due % WHEEL_SIZE].push_back(scheduled);
+    } else {
+        overflow_.push_back(scheduled);
+    }
+    return true;
+}
+
+BlockTickStats BlockTicker::tick() {
+    BlockTickStats stats;
+    const uint64_t now = currentTick_;
+
+    if (now % WHEEL_SIZE == 0) {
+        // Bring in everything due before the wheel next comes back here.
+        for (size_t i = 0; i < overflow_.size();) {
+            if (overflow_[i].due - now < WHEEL_SIZE) {
+                wheel_[overflow_[i].due % WHEEL_SIZE].push_back(overflow_[i]);
+                overflow_[i] = overflow_.back();
+                overflow_.pop_back();
+            } else {
+                i++;
+            }
+        }
+    }
+
+    // Ticks scheduled while these run always land in a later slot.
+    dueScratch_.swap(wheel_[now % WHEEL_SIZE]);
+    for (const ScheduledTick& scheduled : dueScratch_) {
+        scheduledPositions_.erase(scheduled.pos);
+        if (world_.chunk(scheduled.pos.chunk()) == nullptr || world_.block(scheduled.pos) != scheduled.block) {
+            continue;
+        }
+        const BlockBehaviour* behaviour = behaviourOf(scheduled.block);
+        if (behaviour != nullptr && behaviour->scheduledTick) {
+            behaviour->scheduledTick(*this, scheduled.pos);
+            stats.scheduledTicks++;
+        }
+    }
+    dueScratch_.clear();
+
+    // Callbacks may change which chunks are active.
+    activeScratch_.assign(activeChunks_.begin(), activeChunks_.end());
+    for (const ChunkPos& pos : activeScratch_) {
+        const Chunk* chunk = world_.chunk(pos);
+        if (chunk == nullptr || chunk->tickableCount() == 0) {
+            continue;
+        }
+        for (uint32_t i = 0; i < randomTicksPerChunk_; i++) {
+            const uint32_t index = random() & (CHUNK_VOLUME - 1);
+            stats.randomSamples++;
+
+            const BlockId id = chunk->block(index);
+            if (!blockProperties(id).tickable) {
+                continue;
+            }
+            const BlockBehaviour* behaviour = behaviourOf(id);
+            if (behaviour != nullptr && behaviour->randomTick) {
+                const int32_t x = static_cast<int32_t>(index) & CHUNK_MASK;
+                const int32_t z = static_cast<int32_t>(index >> CHUNK_SHIFT) & CHUNK_MASK;
+                const int32_t y = static_cast<int32_t>(index >> (2 * CHUNK_SHIFT));
+                behaviour->randomTick(*this, chunk->blockPos(x, y, z));
+                stats.randomTicks++;
+            }
+        }
+    }
+
+    stats.activeChunks = static_cast<uint32_t>(activeChunks_.size());
+    currentTick_++;
+    return stats;
+}
+
+void world::registerDefaultBehaviours(BlockTicker& ticker) {
+    BlockBehaviour grass;
+    grass.randomTick = grassRandomTick;
+    ticker.setBehaviour(blocks::GRASS, std::move(grass));
+
+    BlockBehaviour sand;
+    sand.scheduledTick = sandScheduledTick;
+    sand.neighbourChanged = sandNeighbourChanged;
+    ticker.setBehaviour(blocks::SAND, std::move(sand));
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+using world::Chunk;
+using world::CHUNK_SIZE;
+using world::LightChannel;
+using world::MAX_LIGHT;
+namespace blocks = world::blocks;
+
+namespace {
+void fillLayer(World& world, int32_t y, BlockId id) {
+    for (int32_t z = 0; z < CHUNK_SIZE; z++) {
+        for (int32_t x = 0; x < CHUNK_SIZE; x++) {
+            world.setBlock(BlockPos{x, y, z}, id);
+        }
+    }
+}
+} // namespace
+
+TEST_SUITE("BlockTicks") {
+    TEST_CASE("scheduled ticks run exactly when due") {
+        World world;
+        world.getOrCreateChunk(ChunkPos{0, 0, 0});
+        BlockTicker ticker(world);
+
+        std::vector<std::pair<BlockPos, uint64_t>> ran;
+        BlockBehaviour recorder;
+        recorder.scheduledTick = [&ran](BlockTicker& t, BlockPos pos) { ran.emplace_back(pos, t.currentTick()); };
+        ticker.setBehaviour(blocks::AIR, std::move(recorder));
+
+        const uint32_t delays[] = {1, 5, 255, 256, 300, 700};
+        for (uint32_t i = 0; i < std::size(delays); i++) {
+            CHECK(ticker.schedule(BlockPos{static_cast<int32_t>(i), 0, 0}, delays[i]));
+        }
+        CHECK_FALSE(ticker.schedule(BlockPos{0, 0, 0}, 3));
+        CHECK(ticker.scheduledCount() == std::size(delays));
+
+        for (int i = 0; i < 800; i++) {
+            ticker.tick();
+        }
+
+        REQUIRE(ran.size() == std::size(delays));
+        for (uint32_t i = 0; i < std::size(delays); i++) {
+            CHECK(ran[i].first == BlockPos{static_cast<int32_t>(i), 0, 0});
+            CHECK(ran[i].second == delays[i]);
+        }
+        CHECK(ticker.scheduledCount() == 0);
+    }
+
+    TEST_CASE("scheduled ticks are dropped if the block changed") {
+        World world;
+        world.getOrCreateChunk(ChunkPos{0, 0, 0});
+        BlockTicker ticker(world);
+        int ran = 0;
+        BlockBehaviour counter;
+        counter.scheduledTick = [&ran](BlockTicker&, BlockPos) { ran++; };
+        ticker.setBehaviour(blocks::STONE, std::move(counter));
+
+        ticker.setBlock(BlockPos{1, 1, 1}, blocks::STONE);
+        ticker.schedule(BlockPos{1, 1, 1}, 4);
+        ticker.setBlock(BlockPos{1, 1, 1}, blocks::DIRT);
+        for (int i = 0; i < 10; i++) {
+            ticker.tick();
+        }
+        CHECK(ran == 0);
+    }
+
+    TEST_CASE("random ticks only sample chunks with tickable blocks") {
+        World world;
+        for (int32_t x = 0; x < 8; x++) {
+            world.getOrCreateChunk(ChunkPos{x, 0, 0});
+        }
+        BlockTicker ticker(world);
+        world.forEachChunk([&ticker](Chunk& chunk) { ticker.onChunkLoaded(chunk.pos()); });
+        CHECK(ticker.activeChunkCount() == 0);
+        CHECK(ticker.tick().randomSamples == 0);
+
+        ticker.setBlock(BlockPos{70, 3, 3}, blocks::GRASS);
+        CHECK(ticker.activeChunkCount() == 1);
+        const BlockTickStats stats = ticker.tick();
+        CHECK(stats.activeChunks == 1);
+        CHECK(stats.randomSamples == BlockTicker::DEFAULT_RANDOM_TICKS_PER_CHUNK);
+
+        ticker.setBlock(BlockPos{70, 3, 3}, blocks::DIRT);
+        CHECK(ticker.activeChunkCount() == 0);
+    }
+
+    TEST_CASE("covered grass dies") {
+        World world;
+        world.getOrCreateChunk(ChunkPos{0, 0, 0});
+        // Sample heavily so the test does not need thousands of ticks.
+        BlockTicker ticker(world, nullptr, 4096);
+        registerDefaultBehaviours(ticker);
+
+        ticker.setBlock(BlockPos{5, 5, 5}, blocks::GRASS);
+        ticker.setBlock(BlockPos{5, 6, 5}, blocks::STONE);
+        for (int i = 0; i < 500 && world.block(BlockPos{5, 5, 5}) == blocks::GRASS; i++) {
+            ticker.tick();
+        }
+        CHECK(world.block(BlockPos{5, 5, 5}) == blocks::DIRT);
+        CHECK(ticker.activeChunkCount() == 0);
+    }
+
+    TEST_CASE("sand falls across a chunk border and lands") {
+        World world;
+        world.getOrCreateChunk(ChunkPos{0, 0, 0});
+        world.getOrCreateChunk(ChunkPos{0, 1, 0});
+        fillLayer(world, 0, blocks::STONE);
+
+        jobs::JobSystem jobSystem(1);
+        LightEngine light(world, jobSystem);
+        light.onChunkLoaded(ChunkPos{0, 1, 0});
+        light.onChunkLoaded(ChunkPos{0, 0, 0});
+        light.update();
+
+        BlockTicker ticker(world, &light);
+        registerDefaultBehaviours(ticker);
+        ticker.dirty().clear();
+
+        ticker.setBlock(BlockPos{4, 40, 4}, blocks::SAND);
+        for (int i = 0; i < 200; i++) {
+            ticker.tick();
+        }
+
+        CHECK(world.block(BlockPos{4, 40, 4}) == blocks::AIR);
+        CHECK(world.block(BlockPos{4, 1, 4}) == blocks::SAND);
+        CHECK(ticker.scheduledCount() == 0);
+
+        light.update();
+        CHECK(world.light(LightChannel::Sky, BlockPos{4, 2, 4}) == MAX_LIGHT);
+        CHECK(world.light(LightChannel::Sky, BlockPos{4, 1, 4}) == 0);
+
+        const std::vector<world::ChunkChanges> changes = ticker.dirty().takeReplication();
+        CHECK(changes.size() == 2);
+        CHECK(ticker.dirty().takeRemesh().size() >= 2);
+        CHECK(ticker.dirty().empty());
+    }
+}
+
+#endif
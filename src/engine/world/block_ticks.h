@@ -0,0 +1,141 @@
+#pragma once
+
+#include "dirty_set.h"
+#include "light_engine.h"
+#include "world.h"
+#include <array>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace world {
+class BlockTicker;
+
+/// @brief Per block type tick callbacks. Any may be left empty.
+struct BlockBehaviour {
+    using Callback = std::function<void(BlockTicker&, BlockPos)>;
+
+    /// Called for randomly sampled blocks. Only blocks whose properties are
+    /// `tickable` are ever sampled.
+    Callback randomTick;
+    /// Called when a tick scheduled with `BlockTicker::schedule()` comes due,
+    /// if the block has not changed since.
+    Callback scheduledTick;
+    /// Called when the block itself, or one of its six neighbours, is changed
+    /// through `BlockTicker::setBlock()`.
+    Callback neighbourChanged;
+};
+
+struct BlockTickStats {
+    uint32_t scheduledTicks = 0;
+    uint32_t randomSamples = 0;
+    uint32_t randomTicks = 0;
+    /// Chunks holding at least one tickable block.
+    uint32_t activeChunks = 0;
+};
+
+/// @brief Runs scheduled and random block ticks on the server, and is the
+/// path every gameplay block edit goes through, so that lighting, the dirty
+/// set and neighbouring blocks all hear about it.
+///
+/// Scheduled ticks live in a timing wheel with one slot per tick, so
+/// scheduling and running a tick are both constant time. Delays longer than
+/// the wheel wait in an overflow list, which is looked at once per turn of
+/// the wheel.
+///
+/// Random ticks sample a few blocks per chunk per tick, the same as sections
+/// in other voxel games, but only in chunks that hold at least one tickable
+/// block. So the cost of a tick follows the active blocks rather than the
+/// loaded ones.
+class BlockTicker {
+  public:
+    static constexpr uint32_t WHEEL_SIZE = 256;
+    static constexpr uint32_t DEFAULT_RANDOM_TICKS_PER_CHUNK = 3;
+
+    /// @param lightEngine Optional, told about every block change.
+    BlockTicker(World& world, LightEngine* lightEngine = nullptr,
+                uint32_t randomTicksPerChunk = DEFAULT_RANDOM_TICKS_PER_CHUNK, uint64_t seed = 0x5DEECE66Dull);
+
+    BlockTicker(const BlockTicker&) = delete;
+    BlockTicker& operator=(const BlockTicker&) = delete;
+
+    void setBehaviour(BlockId id, BlockBehaviour behaviour);
+
+    /// @brief Starts random ticking a newly loaded chunk if it needs it.
+    void onChunkLoaded(ChunkPos pos);
+
+    /// @brief Stops random ticking `pos`. Scheduled ticks in it are dropped
+    /// when they come due.
+    void onChunkUnloaded(ChunkPos pos);
+
+    /// @brief Sets a block, then updates lighting, the dirty set, random
+    /// tick tracking, and calls `neighbourChanged` on the block and its
+    /// neighbours.
+    /// @return The previous block, or empty if the chunk is not loaded.
+    std::optional<BlockId> setBlock(BlockPos pos, BlockId id);
+
+    /// @brief Runs the scheduled tick of the block now at `pos` after
+    /// `delay` ticks, at least 1. Does nothing if `pos` already has a
+    /// scheduled tick pending.
+    /// @return `true` if the tick was scheduled.
+    bool schedule(BlockPos pos, uint32_t delay);
+
+    /// @brief Runs every scheduled tick due now, then the random ticks, then
+    /// moves on to the next tick.
+    BlockTickStats tick();
+
+    uint64_t currentTick() const { return currentTick_; }
+
+    size_t scheduledCount() const { return scheduledPositions_.size(); }
+
+    size_t activeChunkCount() const { return activeChunks_.size(); }
+
+    World& world() { return world_; }
+
+    DirtySet& dirty() { return dirty_; }
+
+    /// @return A random number, for tick callbacks.
+    uint32_t random();
+
+  private:
+    struct ScheduledTick {
+        BlockPos pos;
+        BlockId block;
+        uint64_t due;
+    };
+
+    /// @brief Starts or stops random ticking `pos` to match its tickable
+    /// block count.
+    void updateActive(ChunkPos pos);
+
+    void setActive(ChunkPos pos, bool active);
+
+    void notifyNeighbourChanged(BlockPos pos);
+
+    const BlockBehaviour* behaviourOf(BlockId id) const;
+
+    World& world_;
+    LightEngine* lightEngine_;
+    DirtySet dirty_;
+    uint32_t randomTicksPerChunk_;
+    uint64_t randomState_;
+    std::vector<BlockBehaviour> behaviours_;
+
+    uint64_t currentTick_ = 0;
+    std::array<std::vector<ScheduledTick>, WHEEL_SIZE> wheel_;
+    std::vector<ScheduledTick> overflow_;
+    std::unordered_set<BlockPos, BlockPosHash> scheduledPositions_;
+    std::vector<ScheduledTick> dueScratch_;
+
+    /// Chunks with tickable blocks, and where each sits in `activeChunks_`.
+    std::vector<ChunkPos> activeChunks_;
+    std::unordered_map<ChunkPos, uint32_t, ChunkPosHash> activeIndex_;
+    std::vector<ChunkPos> activeScratch_;
+};
+
+/// @brief Grass that dies when covered and spreads to nearby dirt, and sand
+/// that falls.
+void registerDefaultBehaviours(BlockTicker& ticker);
+} // namespace world
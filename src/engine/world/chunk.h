@@ -0,0 +1,131 @@
+#pragma once
+
+#include "block.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace world {
+constexpr int32_t CHUNK_SIZE = 32;
+constexpr int32_t CHUNK_SHIFT = 5;
+constexpr int32_t CHUNK_MASK = CHUNK_SIZE - 1;
+constexpr uint32_t CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+constexpr uint8_t MAX_LIGHT = 15;
+
+enum class LightChannel : uint8_t {
+    Sky = 0,
+    Block = 1,
+};
+
+constexpr uint32_t LIGHT_CHANNEL_COUNT = 2;
+
+/// @brief Position of a chunk, in chunks.
+struct ChunkPos {
+    int32_t x = 0;
+    int32_t y = 0;
+    int32_t z = 0;
+
+    bool operator==(const ChunkPos&) const = default;
+
+    ChunkPos offset(int32_t dx, int32_t dy, int32_t dz) const { return ChunkPos{x + dx, y + dy, z + dz}; }
+};
+
+struct ChunkPosHash {
+    size_t operator()(const ChunkPos& pos) const noexcept {
+        uint64_t h = static_cast<uint32_t>(pos.x);
+        h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(pos.y);
+        h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(pos.z);
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+};
+
+/// @brief Position of a block, in blocks.
+struct BlockPos {
+    int32_t x = 0;
+    int32_t y = 0;
+    int32_t z = 0;
+
+    bool operator==(const BlockPos&) const = default;
+
+    BlockPos offset(int32_t dx, int32_t dy, int32_t dz) const { return BlockPos{x + dx, y + dy, z + dz}; }
+
+    /// @return The chunk containing this block.
+    ChunkPos chunk() const { return ChunkPos{x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT}; }
+
+    /// @return The index of this block within its chunk.
+    uint32_t localIndex() const;
+};
+
+struct BlockPosHash {
+    size_t operator()(const BlockPos& pos) const noexcept {
+        return ChunkPosHash{}(ChunkPos{pos.x, pos.y, pos.z});
+    }
+};
+
+/// @brief A cubic 32x32x32 section of the world, holding block ids and their
+/// light levels.
+///
+/// Blocks are laid out x fastest, then z, then y, so a horizontal layer is
+/// contiguous.
+class Chunk {
+  public:
+    explicit Chunk(ChunkPos pos) : pos_(pos) {}
+
+    static constexpr uint32_t index(int32_t x, int32_t y, int32_t z) {
+        return static_cast<uint32_t>(x + CHUNK_SIZE * (z + CHUNK_SIZE * y));
+    }
+
+    ChunkPos pos() const { return pos_; }
+
+    /// @return The world position of the block at local `x`, `y`, `z`.
+    BlockPos blockPos(int32_t x, int32_t y, int32_t z) const {
+        return BlockPos{pos_.x * CHUNK_SIZE + x, pos_.y * CHUNK_SIZE + y, pos_.z * CHUNK_SIZE + z};
+    }
+
+    BlockId block(uint32_t index) const { return blocks_[index]; }
+
+    BlockId block(int32_t x, int32_t y, int32_t z) const { return blocks_[index(x, y, z)]; }
+
+    void setBlock(uint32_t index, BlockId id) {
+        tickableCount_ += static_cast<uint32_t>(blockProperties(id).tickable);
+        tickableCount_ -= static_cast<uint32_t>(blockProperties(blocks_[index]).tickable);
+        blocks_[index] = id;
+    }
+
+    void setBlock(int32_t x, int32_t y, int32_t z, BlockId id) { setBlock(index(x, y, z), id); }
+
+    /// @return How many blocks in this chunk receive random ticks.
+    uint32_t tickableCount() const { return tickableCount_; }
+
+    uint8_t light(LightChannel channel, uint32_t index) const {
+        return channel == LightChannel::Sky ? static_cast<uint8_t>(light_[index] >> 4)
+                                            : static_cast<uint8_t>(light_[index] & 0xF);
+    }
+
+    void setLight(LightChannel channel, uint32_t index, uint8_t level) {
+        if (channel == LightChannel::Sky) {
+            light_[index] = static_cast<uint8_t>((light_[index] & 0x0F) | (level << 4));
+        } else {
+            light_[index] = static_cast<uint8_t>((light_[index] & 0xF0) | (level & 0x0F));
+        }
+    }
+
+    uint8_t skyLight(int32_t x, int32_t y, int32_t z) const { return light(LightChannel::Sky, index(x, y, z)); }
+
+    uint8_t blockLight(int32_t x, int32_t y, int32_t z) const { return light(LightChannel::Block, index(x, y, z)); }
+
+    void clearLight() { light_.fill(0); }
+
+    const std::array<BlockId, CHUNK_VOLUME>& blocks() const { return blocks_; }
+
+  private:
+    ChunkPos pos_;
+    std::array<BlockId, CHUNK_VOLUME> blocks_{};
+    /// Sky light in the high nibble, block light in the low nibble.
+    std::array<uint8_t, CHUNK_VOLUME> light_{};
+    uint32_t tickableCount_ = 0;
+};
+
+inline uint32_t BlockPos::localIndex() const { return Chunk::index(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK); }
+} // namespace world
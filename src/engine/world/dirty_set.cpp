@@ -0,0 +1,117 @@
+#include "dirty_set.h"
+#include <algorithm>
+
+using world::BlockPos;
+using world::ChunkChanges;
+using world::ChunkPos;
+using world::DirtySet;
+
+void DirtySet::markBlock(BlockPos pos) {
+    const ChunkPos chunk = pos.chunk();
+    remesh_.insert(chunk);
+
+    // A block on a chunk face also hides or reveals a face of the neighbour.
+    const int32_t x = pos.x & CHUNK_MASK;
+    const int32_t y = pos.y & CHUNK_MASK;
+    const int32_t z = pos.z & CHUNK_MASK;
+    if (x == 0) {
+        remesh_.insert(chunk.offset(-1, 0, 0));
+    } else if (x == CHUNK_MASK) {
+        remesh_.insert(chunk.offset(1, 0, 0));
+    }
+    if (y == 0) {
+        remesh_.insert(chunk.offset(0, -1, 0));
+    } else if (y == CHUNK_MASK) {
+        remesh_.insert(chunk.offset(0, 1, 0));
+    }
+    if (z == 0) {
+        remesh_.insert(chunk.offset(0, 0, -1));
+    } else if (z == CHUNK_MASK) {
+        remesh_.insert(chunk.offset(0, 0, 1));
+    }
+
+    ChunkChanges& changes = changes_[chunk];
+    changes.pos = chunk;
+    if (changes.wholeChunk) {
+        return;
+    }
+    // Duplicates are removed when taken, so counting them here only makes
+    // the fallback to a whole chunk happen a little early.
+    changes.indices.push_back(static_cast<uint16_t>(pos.localIndex()));
+    if (changes.indices.size() > WHOLE_CHUNK_THRESHOLD) {
+        changes.wholeChunk = true;
+        changes.indices.clear();
+        changes.indices.shrink_to_fit();
+    }
+}
+
+void DirtySet::markRemesh(ChunkPos pos) { remesh_.insert(pos); }
+
+void DirtySet::markChunk(ChunkPos pos) {
+    remesh_.insert(pos);
+    ChunkChanges& changes = changes_[pos];
+    changes.pos = pos;
+    changes.wholeChunk = true;
+    changes.indices.clear();
+}
+
+std::vector<ChunkPos> DirtySet::takeRemesh() {
+    std::vector<ChunkPos> out(remesh_.begin(), remesh_.end());
+    remesh_.clear();
+    return out;
+}
+
+std::vector<ChunkChanges> DirtySet::takeReplication() {
+    std::vector<ChunkChanges> out;
+    out.reserve(changes_.size());
+    for (auto& [pos, changes] : changes_) {
+        std::sort(changes.indices.begin(), changes.indices.end());
+        changes.indices.erase(std::unique(changes.indices.begin(), changes.indices.end()), changes.indices.end());
+        out.push_back(std::move(changes));
+    }
+    changes_.clear();
+    return out;
+}
+
+void DirtySet::clear() {
+    remesh_.clear();
+    changes_.clear();
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+TEST_SUITE("DirtySet") {
+    TEST_CASE("blocks on chunk faces remesh the neighbour too") {
+        DirtySet dirty;
+        dirty.markBlock(BlockPos{0, 5, 31});
+        dirty.markBlock(BlockPos{0, 5, 31});
+        dirty.markBlock(BlockPos{10, 5, 10});
+
+        std::vector<ChunkPos> remesh = dirty.takeRemesh();
+        CHECK(remesh.size() == 3);
+        CHECK(std::find(remesh.begin(), remesh.end(), ChunkPos{-1, 0, 0}) != remesh.end());
+        CHECK(std::find(remesh.begin(), remesh.end(), ChunkPos{0, 0, 1}) != remesh.end());
+
+        std::vector<ChunkChanges> changes = dirty.takeReplication();
+        REQUIRE(changes.size() == 1);
+        CHECK(changes[0].pos == ChunkPos{0, 0, 0});
+        CHECK(changes[0].indices.size() == 2);
+        CHECK_FALSE(changes[0].wholeChunk);
+        CHECK(dirty.empty());
+    }
+
+    TEST_CASE("many changes fall back to the whole chunk") {
+        DirtySet dirty;
+        for (int32_t i = 0; i <= static_cast<int32_t>(DirtySet::WHOLE_CHUNK_THRESHOLD); i++) {
+            dirty.markBlock(BlockPos{i % 30 + 1, i / 900 + 1, (i / 30) % 30 + 1});
+        }
+        std::vector<ChunkChanges> changes = dirty.takeReplication();
+        REQUIRE(changes.size() == 1);
+        CHECK(changes[0].wholeChunk);
+        CHECK(changes[0].indices.empty());
+    }
+}
+
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "chunk.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace world {
+/// @brief The blocks of one chunk that changed since the last replication.
+struct ChunkChanges {
+    ChunkPos pos;
+    /// Sorted, unique indices within the chunk. Empty if `wholeChunk`.
+    std::vector<uint16_t> indices;
+    /// So many blocks changed that sending the whole chunk is cheaper.
+    bool wholeChunk = false;
+};
+
+/// @brief Collects what changed in the world, for the systems downstream of
+/// the simulation. Remeshing wants whole chunks, including neighbours whose
+/// faces touch a changed block. Replication wants the changed blocks
+/// themselves.
+class DirtySet {
+  public:
+    /// Changed blocks in one chunk past which the whole chunk is replicated
+    /// instead.
+    static constexpr uint32_t WHOLE_CHUNK_THRESHOLD = 512;
+
+    /// @brief Marks a block changed, for replication and remeshing.
+    void markBlock(BlockPos pos);
+
+    /// @brief Marks a whole chunk for remeshing only, such as after its
+    /// light changed.
+    void markRemesh(ChunkPos pos);
+
+    /// @brief Marks a whole chunk for replication and remeshing.
+    void markChunk(ChunkPos pos);
+
+    bool empty() const { return remesh_.empty() && changes_.empty(); }
+
+    /// @return Every chunk to remesh since the last call.
+    std::vector<ChunkPos> takeRemesh();
+
+    /// @return Every chunk with blocks to replicate since the last call.
+    std::vector<ChunkChanges> takeReplication();
+
+    void clear();
+
+  private:
+    std::unordered_set<ChunkPos, ChunkPosHash> remesh_;
+    std::unordered_map<ChunkPos, ChunkChanges, ChunkPosHash> changes_;
+};
+} // namespace world
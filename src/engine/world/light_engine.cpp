@@ -0,0 +1,655 @@
+#include "light_engine.h"
+#include <array>
+
+using world::BlockId;
+using world::BlockPos;
+using world::Chunk;
+using world::ChunkPos;
+using world::LightChannel;
+using world::LightEngine;
+using world::LightUpdateStats;
+using world::World;
+using world::detail::LightRemoveNode;
+using world::detail::PendingLight;
+
+namespace {
+struct Direction {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+};
+
+constexpr std::array<Direction, 6> DIRECTIONS = {{
+    {1, 0, 0},
+    {-1, 0, 0},
+    {0, 1, 0},
+    {0, -1, 0},
+    {0, 0, 1},
+    {0, 0, -1},
+}};
+
+constexpr uint32_t DOWN = 3;
+
+constexpr uint32_t NEIGHBOURHOOD_SIZE = 27;
+
+/// @brief A chunk and its 26 neighbours, which one light job has exclusive
+/// access to.
+class Neighbourhood {
+  public:
+    Neighbourhood(World& world, ChunkPos centre) : centre_(centre) {
+        for (int32_t dy = -1; dy <= 1; dy++) {
+            for (int32_t dz = -1; dz <= 1; dz++) {
+                for (int32_t dx = -1; dx <= 1; dx++) {
+                    chunks_[slot(dx, dy, dz)] = world.chunk(centre.offset(dx, dy, dz));
+                }
+            }
+        }
+    }
+
+    static constexpr int32_t OUTSIDE = -1;
+
+    /// @return The slot of the chunk holding `pos`, or `OUTSIDE`.
+    int32_t slotOf(const BlockPos& pos) const {
+        const int32_t dx = (pos.x >> world::CHUNK_SHIFT) - centre_.x;
+        const int32_t dy = (pos.y >> world::CHUNK_SHIFT) - centre_.y;
+        const int32_t dz = (pos.z >> world::CHUNK_SHIFT) - centre_.z;
+        if (dx < -1 || dx > 1 || dy < -1 || dy > 1 || dz < -1 || dz > 1) {
+            return OUTSIDE;
+        }
+        return slot(dx, dy, dz);
+    }
+
+    Chunk* chunk(int32_t slot) const { return chunks_[slot]; }
+
+    static ChunkPos chunkPos(ChunkPos centre, int32_t slot) {
+        return centre.offset(slot % 3 - 1, slot / 9 - 1, (slot / 3) % 3 - 1);
+    }
+
+  private:
+    static constexpr int32_t slot(int32_t dx, int32_t dy, int32_t dz) {
+        return (dx + 1) + 3 * ((dz + 1) + 3 * (dy + 1));
+    }
+
+    ChunkPos centre_;
+    std::array<Chunk*, NEIGHBOURHOOD_SIZE> chunks_{};
+};
+
+struct JobOutput {
+    /// Work that left the neighbourhood, or adds found while removing.
+    PendingLight deferred;
+    uint32_t touchedSlots = 0;
+    uint64_t removeNodes = 0;
+    uint64_t addNodes = 0;
+};
+
+uint8_t emissionOf(const Chunk& chunk, uint32_t index) {
+    return world::blockProperties(chunk.block(index)).emission;
+}
+
+void runRemove(const Neighbourhood& hood, LightChannel channel, std::vector<LightRemoveNode>& queue, JobOutput& out) {
+    const uint32_t ch = static_cast<uint32_t>(channel);
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        const LightRemoveNode node = queue[head];
+        out.removeNodes++;
+
+        bool deferred = false;
+        for (uint32_t d = 0; d < DIRECTIONS.size(); d++) {
+            const BlockPos next = node.pos.offset(DIRECTIONS[d].x, DIRECTIONS[d].y, DIRECTIONS[d].z);
+            const int32_t slot = hood.slotOf(next);
+            if (slot == Neighbourhood::OUTSIDE) {
+                // Revisiting a node is harmless, so hand the whole node to
+                // the chunk that owns it, where every neighbour is in reach.
+                if (!deferred) {
+                    out.deferred.remove[ch].push_back(node);
+                    deferred = true;
+                }
+                continue;
+            }
+            Chunk* chunk = hood.chunk(slot);
+            if (chunk == nullptr) {
+                continue;
+            }
+
+            const uint32_t index = next.localIndex();
+            const uint8_t level = chunk->light(channel, index);
+            if (level == 0) {
+                continue;
+            }
+
+            const bool skyColumn = channel == LightChannel::Sky && d == DOWN && node.level == world::MAX_LIGHT;
+            if (level < node.level || skyColumn) {
+                // Light sources never go dark, they are relit from their own
+                // emission once the removal has passed.
+                const uint8_t emission = channel == LightChannel::Block ? emissionOf(*chunk, index) : 0;
+                chunk->setLight(channel, index, emission);
+                out.touchedSlots |= 1u << slot;
+                if (level > emission) {
+                    queue.push_back(LightRemoveNode{next, level});
+                }
+                if (emission > 0) {
+                    out.deferred.add[ch].push_back(next);
+                }
+            } else {
+                // Lit by something else, so it floods back into the gap.
+                out.deferred.add[ch].push_back(next);
+            }
+        }
+    }
+}
+
+void runAdd(const Neighbourhood& hood, LightChannel channel, std::vector<BlockPos>& queue, JobOutput& out) {
+    const uint32_t ch = static_cast<uint32_t>(channel);
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        const BlockPos pos = queue[head];
+        const int32_t ownSlot = hood.slotOf(pos);
+        if (ownSlot == Neighbourhood::OUTSIDE) {
+            out.deferred.add[ch].push_back(pos);
+            continue;
+        }
+        const Chunk* own = hood.chunk(ownSlot);
+        if (own == nullptr) {
+            continue;
+        }
+        const uint8_t level = own->light(channel, pos.localIndex());
+        if (level <= 1) {
+            continue;
+        }
+        out.addNodes++;
+
+        bool deferred = false;
+        for (uint32_t d = 0; d < DIRECTIONS.size(); d++) {
+            const BlockPos next = pos.offset(DIRECTIONS[d].x, DIRECTIONS[d].y, DIRECTIONS[d].z);
+            const int32_t slot = hood.slotOf(next);
+            if (slot == Neighbourhood::OUTSIDE) {
+                if (!deferred) {
+                    out.deferred.add[ch].push_back(pos);
+                    deferred = true;
+                }
+                continue;
+            }
+            Chunk* chunk = hood.chunk(slot);
+            if (chunk == nullptr) {
+                continue;
+            }
+
+            const uint32_t index = next.localIndex();
+            if (world::blockProperties(chunk->block(index)).opaque) {
+                continue;
+            }
+            const bool skyColumn = channel == LightChannel::Sky && d == DOWN && level == world::MAX_LIGHT;
+            const uint8_t target = skyColumn ? world::MAX_LIGHT : static_cast<uint8_t>(level - 1);
+            if (chunk->light(channel, index) < target) {
+                chunk->setLight(channel, index, target);
+                out.touchedSlots |= 1u << slot;
+                queue.push_back(next);
+            }
+        }
+    }
+}
+
+uint32_t colourOf(ChunkPos pos) {
+    const auto mod3 = [](int32_t v) { return static_cast<uint32_t>(((v % 3) + 3) % 3); };
+    return mod3(pos.x) + 3 * (mod3(pos.z) + 3 * mod3(pos.y));
+}
+} // namespace
+
+void LightEngine::pushAdd(LightChannel channel, BlockPos pos) {
+    pending_[pos.chunk()].add[static_cast<uint32_t>(channel)].push_back(pos);
+}
+
+void LightEngine::pushRemove(LightChannel channel, BlockPos pos, uint8_t level) {
+    pending_[pos.chunk()].remove[static_cast<uint32_t>(channel)].push_back(LightRemoveNode{pos, level});
+}
+
+void LightEngine::onChunkLoaded(ChunkPos pos) {
+    Chunk* chunk = world_.chunk(pos);
+    if (chunk == nullptr) {
+        return;
+    }
+    chunk->clearLight();
+    changedChunks_.insert(pos);
+
+    const Chunk* above = world_.chunk(pos.offset(0, 1, 0));
+    for (int32_t z = 0; z < CHUNK_SIZE; z++) {
+        for (int32_t x = 0; x < CHUNK_SIZE; x++) {
+            if (above != nullptr && above->light(LightChannel::Sky, Chunk::index(x, 0, z)) != MAX_LIGHT) {
+                continue;
+            }
+            for (int32_t y = CHUNK_SIZE - 1; y >= 0; y--) {
+                const uint32_t index = Chunk::index(x, y, z);
+                if (blockProperties(chunk->block(index)).opaque) {
+                    break;
+                }
+                chunk->setLight(LightChannel::Sky, index, MAX_LIGHT);
+            }
+        }
+    }
+
+    for (int32_t y = 0; y < CHUNK_SIZE; y++) {
+        for (int32_t z = 0; z < CHUNK_SIZE; z++) {
+            for (int32_t x = 0; x < CHUNK_SIZE; x++) {
+                const uint32_t index = Chunk::index(x, y, z);
+                const uint8_t emission = blockProperties(chunk->block(index)).emission;
+                if (emission > 0) {
+                    chunk->setLight(LightChannel::Block, index, emission);
+                    pushAdd(LightChannel::Block, chunk->blockPos(x, y, z));
+                }
+
+                if (chunk->light(LightChannel::Sky, index) != MAX_LIGHT) {
+                    continue;
+                }
+                // Open columns are already lit, only their edges spread
+                // sideways. Chunk faces are handled below.
+                const auto isDark = [chunk](int32_t nx, int32_t ny, int32_t nz) {
+                    const uint32_t neighbour = Chunk::index(nx, ny, nz);
+                    return !blockProperties(chunk->block(neighbour)).opaque &&
+                           chunk->light(LightChannel::Sky, neighbour) < MAX_LIGHT - 1;
+                };
+                if ((x > 0 && isDark(x - 1, y, z)) || (x < CHUNK_MASK && isDark(x + 1, y, z)) ||
+                    (z > 0 && isDark(x, y, z - 1)) || (z < CHUNK_MASK && isDark(x, y, z + 1)) ||
+                    (y > 0 && isDark(x, y - 1, z))) {
+                    pushAdd(LightChannel::Sky, chunk->blockPos(x, y, z));
+                }
+            }
+        }
+    }
+
+    for (uint32_t d = 0; d < DIRECTIONS.size(); d++) {
+        const Direction dir = DIRECTIONS[d];
+        Chunk* neighbour = world_.chunk(pos.offset(dir.x, dir.y, dir.z));
+        if (neighbour == nullptr) {
+            continue;
+        }
+
+        for (int32_t a = 0; a < CHUNK_SIZE; a++) {
+            for (int32_t b = 0; b < CHUNK_SIZE; b++) {
+                // Local coordinates of the face block inside this chunk, and
+                // the one touching it inside the neighbour.
+                const int32_t axis = dir.x != 0 ? 0 : (dir.y != 0 ? 1 : 2);
+                const bool positive = dir.x + dir.y + dir.z > 0;
+                int32_t inside[3];
+                inside[(axis + 1) % 3] = a;
+                inside[(axis + 2) % 3] = b;
+                inside[axis] = positive ? CHUNK_MASK : 0;
+                int32_t outside[3] = {inside[0], inside[1], inside[2]};
+                outside[axis] = positive ? 0 : CHUNK_MASK;
+
+                const uint32_t insideIndex = Chunk::index(inside[0], inside[1], inside[2]);
+                const uint32_t outsideIndex = Chunk::index(outside[0], outside[1], outside[2]);
+                const BlockPos insidePos = chunk->blockPos(inside[0], inside[1], inside[2]);
+                const BlockPos outsidePos = neighbour->blockPos(outside[0], outside[1], outside[2]);
+
+                if (d == DOWN && neighbour->light(LightChannel::Sky, outsideIndex) == MAX_LIGHT &&
+                    chunk->light(LightChannel::Sky, insideIndex) != MAX_LIGHT) {
+                    // The chunk below assumed it was open to the sky.
+                    neighbour->setLight(LightChannel::Sky, outsideIndex, 0);
+                    pushRemove(LightChannel::Sky, outsidePos, MAX_LIGHT);
+                }
+
+                for (uint32_t ch = 0; ch < LIGHT_CHANNEL_COUNT; ch++) {
+                    const LightChannel channel = static_cast<LightChannel>(ch);
+                    if (chunk->light(channel, insideIndex) > 1) {
+                        pushAdd(channel, insidePos);
+                    }
+                    if (neighbour->light(channel, outsideIndex) > 1) {
+                        pushAdd(channel, outsidePos);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void LightEngine::onChunkUnloaded(ChunkPos pos) {
+    pending_.erase(pos);
+    changedChunks_.erase(pos);
+}
+
+void LightEngine::onBlockChanged(BlockPos pos, BlockId previous) {
+    Chunk* chunk = world_.chunk(pos.chunk());
+    if (chunk == nullptr) {
+        return;
+    }
+    const uint32_t index = pos.localIndex();
+    const BlockProperties& before = blockProperties(previous);
+    const BlockProperties& after = blockProperties(chunk->block(index));
+    if (before.opaque == after.opaque && before.emission == after.emission) {
+        return;
+    }
+
+    for (uint32_t ch = 0; ch < LIGHT_CHANNEL_COUNT; ch++) {
+        const LightChannel channel = static_cast<LightChannel>(ch);
+        uint8_t source = after.emission;
+        if (channel == LightChannel::Sky) {
+            if (before.opaque == after.opaque) {
+                continue;
+            }
+            // Nothing above to flood back down from when the sky is open.
+            const bool openSky =
+                (pos.y & CHUNK_MASK) == CHUNK_MASK && world_.chunk(pos.chunk().offset(0, 1, 0)) == nullptr;
+            source = !after.opaque && openSky ? MAX_LIGHT : 0;
+        }
+
+        const uint8_t level = chunk->light(channel, index);
+        chunk->setLight(channel, index, source);
+        // Removing at the old level darkens whatever this block lit, and also
+        // pulls light from the neighbours back in when the block was opened.
+        pushRemove(channel, pos, level);
+        if (source > 0) {
+            pushAdd(channel, pos);
+        }
+    }
+    changedChunks_.insert(pos.chunk());
+}
+
+bool LightEngine::runRound(Pass pass, LightUpdateStats& stats) {
+    std::array<std::vector<std::pair<ChunkPos, PendingLight>>, NEIGHBOURHOOD_SIZE> colours;
+    bool any = false;
+
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        PendingLight& pending = it->second;
+        if (pass == Pass::Remove ? !pending.hasRemovals() : !pending.hasAdds()) {
+            ++it;
+            continue;
+        }
+
+        PendingLight work;
+        for (uint32_t ch = 0; ch < LIGHT_CHANNEL_COUNT; ch++) {
+            if (pass == Pass::Remove) {
+                work.remove[ch] = std::move(pending.remove[ch]);
+                pending.remove[ch].clear();
+            } else {
+                work.add[ch] = std::move(pending.add[ch]);
+                pending.add[ch].clear();
+            }
+        }
+        colours[colourOf(it->first)].emplace_back(it->first, std::move(work));
+        any = true;
+
+        if (!pending.hasAdds() && !pending.hasRemovals()) {
+            it = pending_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (!any) {
+        return false;
+    }
+
+    std::vector<JobOutput> outputs;
+    for (auto& group : colours) {
+        if (group.empty()) {
+            continue;
+        }
+
+        outputs.clear();
+        outputs.resize(group.size());
+        jobSystem_.parallelFor(0, static_cast<uint32_t>(group.size()), 1, [&](uint32_t i) {
+            const Neighbourhood hood(world_, group[i].first);
+            PendingLight& work = group[i].second;
+            for (uint32_t ch = 0; ch < LIGHT_CHANNEL_COUNT; ch++) {
+                if (pass == Pass::Remove) {
+                    runRemove(hood, static_cast<LightChannel>(ch), work.remove[ch], outputs[i]);
+                } else {
+                    runAdd(hood, static_cast<LightChannel>(ch), work.add[ch], outputs[i]);
+                }
+            }
+        });
+
+        for (size_t i = 0; i < group.size(); i++) {
+            JobOutput& out = outputs[i];
+            stats.chunkJobs++;
+            stats.removeNodes += out.removeNodes;
+            stats.addNodes += out.addNodes;
+
+            for (uint32_t slot = 0; slot < NEIGHBOURHOOD_SIZE; slot++) {
+                if ((out.touchedSlots & (1u << slot)) != 0) {
+                    changedChunks_.insert(Neighbourhood::chunkPos(group[i].first, static_cast<int32_t>(slot)));
+                }
+            }
+
+            for (uint32_t ch = 0; ch < LIGHT_CHANNEL_COUNT; ch++) {
+                for (const LightRemoveNode& node : out.deferred.remove[ch]) {
+                    pending_[node.pos.chunk()].remove[ch].push_back(node);
+                }
+                for (const BlockPos& pos : out.deferred.add[ch]) {
+                    pending_[pos.chunk()].add[ch].push_back(pos);
+                }
+            }
+        }
+    }
+
+    stats.rounds++;
+    return true;
+}
+
+LightUpdateStats LightEngine::update() {
+    LightUpdateStats stats;
+    while (runRound(Pass::Remove, stats)) {
+    }
+    while (runRound(Pass::Add, stats)) {
+    }
+    return stats;
+}
+
+std::vector<ChunkPos> LightEngine::takeChangedChunks() {
+    std::vector<ChunkPos> out(changedChunks_.begin(), changedChunks_.end());
+    changedChunks_.clear();
+    return out;
+}
+
+#ifndef NO_TESTS
+
+#include <chrono>
+#include <doctest.h>
+#include <print>
+#include <random>
+
+namespace {
+using world::CHUNK_SIZE;
+using world::MAX_LIGHT;
+namespace blocks = world::blocks;
+
+/// Creates every chunk in `order` empty, then lights them in that order.
+void loadChunks(World& world, LightEngine& light, const std::vector<ChunkPos>& order) {
+    for (const ChunkPos& pos : order) {
+        world.getOrCreateChunk(pos);
+    }
+    for (const ChunkPos& pos : order) {
+        light.onChunkLoaded(pos);
+    }
+    light.update();
+}
+
+std::vector<ChunkPos> chunkBox(ChunkPos min, ChunkPos max) {
+    std::vector<ChunkPos> out;
+    for (int32_t y = max.y; y >= min.y; y--) {
+        for (int32_t z = min.z; z <= max.z; z++) {
+            for (int32_t x = min.x; x <= max.x; x++) {
+                out.push_back(ChunkPos{x, y, z});
+            }
+        }
+    }
+    return out;
+}
+
+void setBlock(World& world, LightEngine& light, BlockPos pos, BlockId id) {
+    const auto previous = world.setBlock(pos, id);
+    REQUIRE(previous.has_value());
+    light.onBlockChanged(pos, previous.value());
+}
+} // namespace
+
+TEST_SUITE("LightEngine") {
+    TEST_CASE("open sky is fully lit") {
+        jobs::JobSystem jobSystem(2);
+        World world;
+        LightEngine light(world, jobSystem);
+        loadChunks(world, light, chunkBox(ChunkPos{-1, -1, -1}, ChunkPos{0, 0, 0}));
+
+        CHECK(world.light(LightChannel::Sky, BlockPos{-20, -30, 5}) == MAX_LIGHT);
+        CHECK(world.light(LightChannel::Block, BlockPos{-20, -30, 5}) == 0);
+        CHECK_FALSE(light.hasPendingWork());
+    }
+
+    TEST_CASE("torch light crosses chunk borders") {
+        jobs::JobSystem jobSystem(2);
+        World world;
+        LightEngine light(world, jobSystem);
+        loadChunks(world, light, chunkBox(ChunkPos{0, 0, 0}, ChunkPos{1, 0, 1}));
+
+        const BlockPos torch{30, 4, 30};
+        setBlock(world, light, torch, blocks::TORCH);
+        light.update();
+
+        CHECK(world.light(LightChannel::Block, torch) == 14);
+        CHECK(world.light(LightChannel::Block, torch.offset(3, 0, 0)) == 11);
+        CHECK(world.light(LightChannel::Block, torch.offset(3, 0, 3)) == 8);
+        CHECK(world.light(LightChannel::Block, torch.offset(0, 5, 0)) == 9);
+        CHECK(world.light(LightChannel::Block, torch.offset(14, 0, 0)) == 0);
+
+        setBlock(world, light, torch, blocks::AIR);
+        light.update();
+        CHECK(world.light(LightChannel::Block, torch) == 0);
+        CHECK(world.light(LightChannel::Block, torch.offset(3, 0, 3)) == 0);
+    }
+
+    TEST_CASE("a roof shades the chunk below and lifts again") {
+        jobs::JobSystem jobSystem(2);
+        World world;
+        LightEngine light(world, jobSystem);
+        loadChunks(world, light, chunkBox(ChunkPos{-1, -1, -1}, ChunkPos{0, 0, 0}));
+
+        for (int32_t z = -2; z <= 2; z++) {
+            for (int32_t x = -2; x <= 2; x++) {
+                setBlock(world, light, BlockPos{x, 10, z}, blocks::STONE);
+            }
+        }
+        light.update();
+
+        // The nearest open column is three blocks away.
+        CHECK(world.light(LightChannel::Sky, BlockPos{0, 9, 0}) == 12);
+        CHECK(world.light(LightChannel::Sky, BlockPos{0, -20, 0}) == 12);
+        CHECK(world.light(LightChannel::Sky, BlockPos{2, 9, 0}) == 14);
+        CHECK(world.light(LightChannel::Sky, BlockPos{0, 11, 0}) == MAX_LIGHT);
+
+        for (int32_t z = -2; z <= 2; z++) {
+            for (int32_t x = -2; x <= 2; x++) {
+                setBlock(world, light, BlockPos{x, 10, z}, blocks::AIR);
+            }
+        }
+        light.update();
+        CHECK(world.light(LightChannel::Sky, BlockPos{0, 9, 0}) == MAX_LIGHT);
+        CHECK(world.light(LightChannel::Sky, BlockPos{0, -20, 0}) == MAX_LIGHT);
+    }
+
+    TEST_CASE("loading a chunk above closes the sky below it") {
+        jobs::JobSystem jobSystem(2);
+        World world;
+        LightEngine light(world, jobSystem);
+        loadChunks(world, light, {ChunkPos{0, 0, 0}});
+        CHECK(world.light(LightChannel::Sky, BlockPos{16, 0, 16}) == MAX_LIGHT);
+
+        Chunk& roof = world.getOrCreateChunk(ChunkPos{0, 1, 0});
+        for (int32_t z = 0; z < CHUNK_SIZE; z++) {
+            for (int32_t x = 0; x < CHUNK_SIZE; x++) {
+                roof.setBlock(x, 0, z, blocks::STONE);
+            }
+        }
+        light.onChunkLoaded(ChunkPos{0, 1, 0});
+        light.update();
+
+        CHECK(world.light(LightChannel::Sky, BlockPos{16, 0, 16}) == 0);
+        CHECK(world.light(LightChannel::Sky, BlockPos{16, 40, 16}) == MAX_LIGHT);
+    }
+
+    TEST_CASE("incremental edits match lighting from scratch") {
+        jobs::JobSystem jobSystem(3);
+        const std::vector<ChunkPos> box = chunkBox(ChunkPos{-1, -1, -1}, ChunkPos{1, 0, 1});
+
+        World world;
+        LightEngine light(world, jobSystem);
+        loadChunks(world, light, box);
+
+        std::mt19937 rng(1234);
+        std::uniform_int_distribution<int32_t> horizontal(-CHUNK_SIZE, 2 * CHUNK_SIZE - 1);
+        std::uniform_int_distribution<int32_t> vertical(-CHUNK_SIZE, CHUNK_SIZE - 1);
+        const BlockId palette[] = {blocks::STONE, blocks::STONE, blocks::AIR, blocks::GLASS, blocks::TORCH,
+                                   blocks::GLOWSTONE};
+        std::uniform_int_distribution<size_t> pick(0, std::size(palette) - 1);
+
+        for (int edit = 0; edit < 1500; edit++) {
+            // Clustered so edits interact with each other's light.
+            const BlockPos pos{horizontal(rng) / 3, vertical(rng), horizontal(rng) / 3};
+            setBlock(world, light, pos, palette[pick(rng)]);
+            if (edit % 50 == 49) {
+                light.update();
+            }
+        }
+        light.update();
+
+        World fresh;
+        LightEngine freshLight(fresh, jobSystem);
+        // Bottom up, so every chunk first assumes it is open to the sky.
+        std::vector<ChunkPos> reversed(box.rbegin(), box.rend());
+        for (const ChunkPos& pos : reversed) {
+            Chunk& chunk = fresh.getOrCreateChunk(pos);
+            const Chunk* edited = world.chunk(pos);
+            for (uint32_t i = 0; i < world::CHUNK_VOLUME; i++) {
+                chunk.setBlock(i, edited->block(i));
+            }
+            freshLight.onChunkLoaded(pos);
+        }
+        freshLight.update();
+
+        uint64_t mismatches = 0;
+        for (const ChunkPos& pos : box) {
+            const Chunk* a = world.chunk(pos);
+            const Chunk* b = fresh.chunk(pos);
+            for (uint32_t i = 0; i < world::CHUNK_VOLUME; i++) {
+                mismatches += a->light(LightChannel::Sky, i) != b->light(LightChannel::Sky, i);
+                mismatches += a->light(LightChannel::Block, i) != b->light(LightChannel::Block, i);
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+
+    TEST_CASE("benchmark single block relight" * doctest::skip()) {
+        jobs::JobSystem jobSystem;
+        World world;
+        LightEngine light(world, jobSystem);
+        loadChunks(world, light, chunkBox(ChunkPos{-2, -2, -2}, ChunkPos{1, 1, 1}));
+
+        // Fill the lower half with stone so the edits dig into shade.
+        world.forEachChunk([](Chunk& chunk) {
+            if (chunk.pos().y < 0) {
+                for (uint32_t i = 0; i < world::CHUNK_VOLUME; i++) {
+                    chunk.setBlock(i, blocks::STONE);
+                }
+            }
+        });
+        world.forEachChunk([&light](Chunk& chunk) { light.onChunkLoaded(chunk.pos()); });
+        light.update();
+
+        constexpr int EDITS = 2000;
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int32_t> coord(-48, 47);
+        std::chrono::nanoseconds worst{0};
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < EDITS; i++) {
+            const BlockPos pos{coord(rng), coord(rng) / 4 - 1, coord(rng)};
+            setBlock(world, light, pos, i % 2 == 0 ? blocks::AIR : blocks::TORCH);
+            const auto editStart = std::chrono::steady_clock::now();
+            light.update();
+            worst = std::max(worst, std::chrono::steady_clock::now() - editStart);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::println("light: {:.1f} us per edit, worst {:.1f} us", seconds * 1e6 / EDITS,
+                     std::chrono::duration<double, std::micro>(worst).count());
+    }
+}
+
+#endif
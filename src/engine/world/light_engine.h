@@ -0,0 +1,107 @@
+#pragma once
+
+#include "../jobs/job_system.h"
+#include "world.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace world {
+namespace detail {
+struct LightRemoveNode {
+    BlockPos pos;
+    /// The light level the block had before it was cleared.
+    uint8_t level;
+};
+
+/// @brief Flood fill work waiting on one chunk, per channel.
+struct PendingLight {
+    std::vector<BlockPos> add[LIGHT_CHANNEL_COUNT];
+    std::vector<LightRemoveNode> remove[LIGHT_CHANNEL_COUNT];
+
+    bool hasAdds() const { return !add[0].empty() || !add[1].empty(); }
+
+    bool hasRemovals() const { return !remove[0].empty() || !remove[1].empty(); }
+};
+} // namespace detail
+
+struct LightUpdateStats {
+    /// Parallel passes over every chunk with pending work.
+    uint32_t rounds = 0;
+    /// Chunk jobs run across all rounds.
+    uint32_t chunkJobs = 0;
+    uint64_t removeNodes = 0;
+    uint64_t addNodes = 0;
+};
+
+/// @brief Incremental sky and block light, using breadth first flood fills
+/// with separate remove and add queues.
+///
+/// Block edits and chunk loads only queue work. `update()` then relights
+/// just the affected region: every remove queue is drained before any add
+/// queue, so darkness spreads first and light then floods back in from
+/// whatever sources remain.
+///
+/// Queues are kept per chunk, and a chunk's job may read and write that chunk
+/// and its 26 neighbours. Light below 15 travels at most 14 blocks, so
+/// almost all work stays inside that region, and anything that would leave it
+/// (such as sky light falling down a deep shaft) is queued on the chunk it
+/// reached for the next round. Chunks are coloured by their position modulo 3
+/// on each axis, and all chunks of one colour run in parallel, as their
+/// neighbourhoods never overlap.
+///
+/// Sky light of 15 travels straight down without dimming. A chunk with no
+/// loaded chunk above it is treated as open to the sky.
+///
+/// # Thread Safety
+///
+/// All member functions must be called from the same thread, and the world
+/// must not load or unload chunks while `update()` runs.
+class LightEngine {
+  public:
+    LightEngine(World& world, jobs::JobSystem& jobSystem) : world_(world), jobSystem_(jobSystem) {}
+
+    LightEngine(const LightEngine&) = delete;
+    LightEngine& operator=(const LightEngine&) = delete;
+
+    /// @brief Lights a newly loaded chunk from scratch, and queues light to
+    /// flow across its borders with any loaded neighbours.
+    void onChunkLoaded(ChunkPos pos);
+
+    /// @brief Drops any work queued on `pos`. Light that already spread out
+    /// of the chunk is left as is.
+    void onChunkUnloaded(ChunkPos pos);
+
+    /// @brief Queues relighting around `pos` after its block changed from
+    /// `previous` to whatever the world now holds.
+    void onBlockChanged(BlockPos pos, BlockId previous);
+
+    bool hasPendingWork() const { return !pending_.empty(); }
+
+    /// @brief Runs every queued light update to completion, using the job
+    /// system.
+    LightUpdateStats update();
+
+    /// @return Every chunk whose light changed since the last call, so it
+    /// can be remeshed.
+    std::vector<ChunkPos> takeChangedChunks();
+
+  private:
+    enum class Pass : uint8_t {
+        Remove,
+        Add,
+    };
+
+    void pushAdd(LightChannel channel, BlockPos pos);
+
+    void pushRemove(LightChannel channel, BlockPos pos, uint8_t level);
+
+    /// @return `false` if there was no work for `pass`.
+    bool runRound(Pass pass, LightUpdateStats& stats);
+
+    World& world_;
+    jobs::JobSystem& jobSystem_;
+    std::unordered_map<ChunkPos, detail::PendingLight, ChunkPosHash> pending_;
+    std::unordered_set<ChunkPos, ChunkPosHash> changedChunks_;
+};
+} // namespace world
@@ -0,0 +1,120 @@
+#include "terrain.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using world::Chunk;
+using world::TerrainGenerator;
+using world::TerrainSettings;
+
+namespace {
+/// Blocks of dirt between the grass and the stone.
+constexpr int32_t DIRT_DEPTH = 3;
+} // namespace
+
+TerrainGenerator::TerrainGenerator(TerrainSettings settings) : settings_(settings) {
+    height_.type = noise::NoiseType::Simplex;
+    height_.seed = settings.seed;
+    height_.frequency = 0.006f;
+    height_.octaves = 5;
+    height_.warpAmplitude = 30.0f;
+
+    caves_.type = noise::NoiseType::Simplex;
+    caves_.seed = settings.seed + 1;
+    caves_.frequency = 0.025f;
+    caves_.octaves = 2;
+}
+
+int32_t TerrainGenerator::surfaceHeight(int32_t x, int32_t z) const {
+    const float n = noise::sample2D(height_, static_cast<float>(x), static_cast<float>(z));
+    return static_cast<int32_t>(std::floor(settings_.baseHeight + settings_.heightScale * n));
+}
+
+void TerrainGenerator::generate(Chunk& chunk) const {
+    const BlockPos origin = chunk.blockPos(0, 0, 0);
+
+    noise::Grid2D columns;
+    columns.originX = static_cast<float>(origin.x);
+    columns.originZ = static_cast<float>(origin.z);
+    columns.sizeX = CHUNK_SIZE;
+    columns.sizeZ = CHUNK_SIZE;
+    std::vector<float> heights(columns.count());
+    noise::fillGrid2D(height_, columns, heights.data());
+
+    std::vector<int32_t> surface(columns.count());
+    int32_t highest = std::numeric_limits<int32_t>::min();
+    for (uint32_t i = 0; i < columns.count(); i++) {
+        surface[i] = static_cast<int32_t>(std::floor(settings_.baseHeight + settings_.heightScale * heights[i]));
+        highest = std::max(highest, surface[i]);
+    }
+
+    // Caves only matter below the surface, so chunks of open air skip the 3D
+    // noise entirely.
+    std::vector<float> caves;
+    const bool hasCaves = settings_.caveThreshold < 1.0f && origin.y <= highest;
+    if (hasCaves) {
+        noise::Grid3D grid;
+        grid.originX = static_cast<float>(origin.x);
+        grid.originY = static_cast<float>(origin.y);
+        grid.originZ = static_cast<float>(origin.z);
+        grid.sizeX = CHUNK_SIZE;
+        grid.sizeY = CHUNK_SIZE;
+        grid.sizeZ = CHUNK_SIZE;
+        caves.resize(grid.count());
+        noise::fillGrid3D(caves_, grid, caves.data());
+    }
+
+    for (int32_t y = 0; y < CHUNK_SIZE; y++) {
+        const int32_t worldY = origin.y + y;
+        for (int32_t z = 0; z < CHUNK_SIZE; z++) {
+            for (int32_t x = 0; x < CHUNK_SIZE; x++) {
+                const int32_t top = surface[x + CHUNK_SIZE * z];
+                BlockId id = blocks::AIR;
+                if (worldY == top) {
+                    id = blocks::GRASS;
+                } else if (worldY < top) {
+                    id = worldY >= top - DIRT_DEPTH ? blocks::DIRT : blocks::STONE;
+                }
+                const uint32_t index = Chunk::index(x, y, z);
+                if (hasCaves && worldY < top && caves[index] > settings_.caveThreshold) {
+                    id = blocks::AIR;
+                }
+                chunk.setBlock(index, id);
+            }
+        }
+    }
+}
+
+#ifndef NO_TESTS
+
+#include <doctest.h>
+
+TEST_SUITE("Terrain") {
+    TEST_CASE("chunks are deterministic and follow the surface") {
+        TerrainSettings settings;
+        settings.caveThreshold = 2.0f;
+        const TerrainGenerator generator(settings);
+
+        Chunk a(world::ChunkPos{3, 0, -2});
+        Chunk b(world::ChunkPos{3, 0, -2});
+        generator.generate(a);
+        generator.generate(b);
+        CHECK(a.blocks() == b.blocks());
+
+        int mismatches = 0;
+        for (int32_t z = 0; z < world::CHUNK_SIZE; z++) {
+            for (int32_t x = 0; x < world::CHUNK_SIZE; x++) {
+                const world::BlockPos pos = a.blockPos(x, 0, z);
+                const int32_t top = generator.surfaceHeight(pos.x, pos.z);
+                if (top >= 0 && top < world::CHUNK_SIZE) {
+                    mismatches += a.block(x, top, z) != world::blocks::GRASS;
+                    mismatches += top + 1 < world::CHUNK_SIZE && a.block(x, top + 1, z) != world::blocks::AIR;
+                }
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../noise/noise.h"
+#include "chunk.h"
+
+namespace world {
+struct TerrainSettings {
+    int32_t seed = 1337;
+    /// Average height of the surface, in blocks.
+    float baseHeight = 24.0f;
+    /// How far the surface may rise above or sink below `baseHeight`.
+    float heightScale = 20.0f;
+    /// Cave noise above this is carved out. Higher means fewer caves, and
+    /// anything above 1 disables them.
+    float caveThreshold = 0.4f;
+};
+
+/// @brief Fills chunks with rolling hills of grass, dirt and stone, hollowed
+/// out by caves. Any chunk can be generated on its own, in any order, and
+/// always comes out the same for the same settings.
+///
+/// # Thread Safety
+///
+/// `generate()` may be called from any number of threads at once.
+class TerrainGenerator {
+  public:
+    explicit TerrainGenerator(TerrainSettings settings = {});
+
+    /// @brief Overwrites every block of `chunk`. Does not touch lighting.
+    void generate(Chunk& chunk) const;
+
+    /// @return The y coordinate of the grass block at world column `x`, `z`.
+    int32_t surfaceHeight(int32_t x, int32_t z) const;
+
+    const TerrainSettings& settings() const { return settings_; }
+
+  private:
+    TerrainSettings settings_;
+    noise::FractalSettings height_;
+    noise::FractalSettings caves_;
+};
+} // namespace world
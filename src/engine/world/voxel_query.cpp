@@ -0,0 +1,531 @@
+#include "voxel_query.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <limits>
+#include <vector>
+
+using world::Aabb;
+using world::BlockId;
+using world::BlockPos;
+using world::Chunk;
+using world::ChunkPos;
+using world::RaycastHit;
+using world::RaycastQuery;
+using world::SweepQuery;
+using world::SweepResult;
+using world::World;
+
+namespace {
+/// Keeps boxes that exactly touch a block face from counting as inside it.
+constexpr float EPSILON = 1e-4f;
+
+/// Farthest from the origin a query may start or move, leaving room to walk
+/// `MAX_RAYCAST_DISTANCE` blocks without overflowing block coordinates.
+constexpr float MAX_QUERY_COORDINATE = 1 << 30;
+
+/// @return `false` for NaN and infinity too.
+bool inQueryRange(glm::vec3 v) {
+    return std::abs(v.x) < MAX_QUERY_COORDINATE && std::abs(v.y) < MAX_QUERY_COORDINATE &&
+           std::abs(v.z) < MAX_QUERY_COORDINATE;
+}
+
+/// Queries handed to each job by the batched functions.
+constexpr uint32_t BATCH_GRAIN = 64;
+
+/// @brief Block lookups that remember the last chunk, as consecutive
+/// lookups almost always land in the same one.
+class BlockReader {
+  public:
+    explicit BlockReader(const World& world) : world_(world) {}
+
+    /// @return The block at `pos`, or empty if its chunk is not loaded.
+    std::optional<BlockId> block(BlockPos pos) {
+        const ChunkPos chunkPos = pos.chunk();
+        if (!hasCached_ || chunkPos != cachedPos_) {
+            cached_ = world_.chunk(chunkPos);
+            cachedPos_ = chunkPos;
+            hasCached_ = true;
+        }
+        if (cached_ == nullptr) {
+            return std::nullopt;
+        }
+        return cached_->block(pos.localIndex());
+    }
+
+  private:
+    const World& world_;
+    const Chunk* cached_ = nullptr;
+    ChunkPos cachedPos_;
+    bool hasCached_ = false;
+};
+
+std::optional<RaycastHit> raycastWith(BlockReader& reader, const RaycastQuery& query) {
+    const float length = glm::length(query.direction);
+    if (!(length > 0.0f) || !std::isfinite(length)) {
+        return std::nullopt;
+    }
+    // written so NaN fails them too, which would otherwise never end the walk or be cast to a cell
+    if (!inQueryRange(query.origin) || !(query.maxDistance >= 0.0f)) {
+        return std::nullopt;
+    }
+    const float maxDistance = std::min(query.maxDistance, world::MAX_RAYCAST_DISTANCE);
+    const glm::vec3 direction = query.direction / length;
+
+    glm::ivec3 cell(glm::floor(query.origin));
+    glm::ivec3 step(0);
+    glm::vec3 tMax(std::numeric_limits<float>::infinity());
+    glm::vec3 tDelta(std::numeric_limits<float>::infinity());
+    for (int axis = 0; axis < 3; axis++) {
+        if (direction[axis] > 0.0f) {
+            step[axis] = 1;
+            tDelta[axis] = 1.0f / direction[axis];
+            tMax[axis] = (static_cast<float>(cell[axis]) + 1.0f - query.origin[axis]) * tDelta[axis];
+        } else if (direction[axis] < 0.0f) {
+            step[axis] = -1;
+            tDelta[axis] = -1.0f / direction[axis];
+            tMax[axis] = (query.origin[axis] - static_cast<float>(cell[axis])) * tDelta[axis];
+        }
+    }
+
+    glm::ivec3 normal(0);
+    float distance = 0.0f;
+    while (true) {
+        const BlockPos pos{cell.x, cell.y, cell.z};
+        const std::optional<BlockId> id = reader.block(pos);
+        if (id.has_value() && id.value() != world::blocks::AIR &&
+            (query.hitNonSolid || world::blockProperties(id.value()).solid)) {
+            return RaycastHit{pos, id.value(), normal, distance};
+        }
+
+        int axis = tMax.x < tMax.y ? 0 : 1;
+        axis = tMax.z < tMax[axis] ? 2 : axis;
+        if (tMax[axis] > maxDistance) {
+            return std::nullopt;
+        }
+        distance = tMax[axis];
+        cell[axis] += step[axis];
+        tMax[axis] += tDelta[axis];
+        normal = glm::ivec3(0);
+        normal[axis] = -step[axis];
+    }
+}
+
+/// @return `true` if any block of `box`'s cross section at `layer` along
+/// `axis` is solid or unloaded.
+bool layerBlocked(BlockReader& reader, const Aabb& box, int axis, int32_t layer) {
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+    const int32_t uMin = static_cast<int32_t>(std::floor(box.min[u] + EPSILON));
+    const int32_t uMax = static_cast<int32_t>(std::ceil(box.max[u] - EPSILON)) - 1;
+    const int32_t vMin = static_cast<int32_t>(std::floor(box.min[v] + EPSILON));
+    const int32_t vMax = static_cast<int32_t>(std::ceil(box.max[v] - EPSILON)) - 1;
+
+    glm::ivec3 cell(0);
+    cell[axis] = layer;
+    for (int32_t a = uMin; a <= uMax; a++) {
+        cell[u] = a;
+        for (int32_t b = vMin; b <= vMax; b++) {
+            cell[v] = b;
+            const std::optional<BlockId> id = reader.block(BlockPos{cell.x, cell.y, cell.z});
+            if (!id.has_value() || world::blockProperties(id.value()).solid) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/// @return How far `box` can move along `axis`, up to `motion`.
+float clipAxis(BlockReader& reader, const Aabb& box, int axis, float motion) {
+    if (motion > 0.0f) {
+        const float edge = box.max[axis];
+        for (int32_t layer = static_cast<int32_t>(std::ceil(edge - EPSILON));
+             static_cast<float>(layer) < edge + motion; layer++) {
+            if (layerBlocked(reader, box, axis, layer)) {
+                return std::max(static_cast<float>(layer) - edge, 0.0f);
+            }
+        }
+    } else {
+        const float edge = box.min[axis];
+        for (int32_t layer = static_cast<int32_t>(std::floor(edge + EPSILON)) - 1;
+             static_cast<float>(layer + 1) > edge + motion; layer--) {
+            if (layerBlocked(reader, box, axis, layer)) {
+                return std::min(static_cast<float>(layer + 1) - edge, 0.0f);
+            }
+        }
+    }
+    return motion;
+}
+
+SweepResult sweepWith(BlockReader& reader, const SweepQuery& query) {
+    SweepResult result;
+    result.box = query.box;
+    result.motion = glm::vec3(0.0f);
+    // as for raycasts, NaN would never end the walk or be cast to a layer
+    if (!inQueryRange(query.box.min) || !inQueryRange(query.box.max) || !inQueryRange(query.motion)) {
+        return result;
+    }
+
+    // Vertical first, so walking into a step does not also stop falling.
+    constexpr int ORDER[3] = {1, 0, 2};
+    for (const int axis : ORDER) {
+        const float wanted = query.motion[axis];
+        if (wanted == 0.0f) {
+            continue;
+        }
+        const float moved = clipAxis(reader, result.box, axis, wanted);
+        result.box.min[axis] += moved;
+        result.box.max[axis] += moved;
+        result.motion[axis] = moved;
+
+        if (moved != wanted) {
+            (axis == 0 ? result.collidedX : axis == 1 ? result.collidedY : result.collidedZ) = true;
+            result.onGround |= axis == 1 && wanted < 0.0f;
+        }
+    }
+    return result;
+}
+
+/// @return A key that orders positions by chunk, y then z then x.
+uint64_t chunkKey(glm::vec3 pos) {
+    // queries that will be rejected still need a key, and casting one out of range is undefined
+    if (!inQueryRange(pos)) {
+        pos = glm::vec3(0.0f);
+    }
+    const glm::vec3 floored = glm::floor(pos);
+    const ChunkPos chunk =
+        BlockPos{static_cast<int32_t>(floored.x), static_cast<int32_t>(floored.y), static_cast<int32_t>(floored.z)}
+            .chunk();
+    constexpr int64_t BIAS = 1 << 20;
+    constexpr uint64_t MASK = (1u << 21) - 1;
+    return ((static_cast<uint64_t>(chunk.y + BIAS) & MASK) << 42) |
+           ((static_cast<uint64_t>(chunk.z + BIAS) & MASK) << 21) | (static_cast<uint64_t>(chunk.x + BIAS) & MASK);
+}
+
+template <typename Query, typename Result, typename KeyFn, typename QueryFn>
+void runBatch(const World& world, std::span<const Query> queries, std::span<Result> out, jobs::JobSystem* jobSystem,
+              KeyFn&& key, QueryFn&& run) {
+    const uint32_t count = static_cast<uint32_t>(std::min(queries.size(), out.size()));
+
+    std::vector<std::pair<uint64_t, uint32_t>> order(count);
+    for (uint32_t i = 0; i < count; i++) {
+        order[i] = {key(queries[i]), i};
+    }
+    std::sort(order.begin(), order.end());
+
+    const auto runRange = [&](uint32_t begin, uint32_t end) {
+        BlockReader reader(world);
+        for (uint32_t i = begin; i < end; i++) {
+            const uint32_t index = order[i].second;
+            out[index] = run(reader, queries[index]);
+        }
+    };
+
+    if (jobSystem == nullptr || count <= BATCH_GRAIN) {
+        runRange(0, count);
+        return;
+    }
+    const uint32_t batches = (count + BATCH_GRAIN - 1) / BATCH_GRAIN;
+    jobSystem->parallelFor(0, batches, 1, [&](uint32_t batch) {
+        runRange(batch * BATCH_GRAIN, std::min((batch + 1) * BATCH_GRAIN, count));
+    });
+}
+} // namespace
+
+std::optional<RaycastHit> world::raycast(const World& world, const RaycastQuery& query) {
+    BlockReader reader(world);
+    return raycastWith(reader, query);
+}
+
+SweepResult world::sweepAabb(const World& world, const SweepQuery& query) {
+    BlockReader reader(world);
+    return sweepWith(reader, query);
+}
+
+void world::raycastBatch(const World& world, std::span<const RaycastQuery> queries,
+                         std::span<std::optional<RaycastHit>> out, jobs::JobSystem* jobSystem) {
+    runBatch(
+        world, queries, out, jobSystem, [](const RaycastQuery& query) { return chunkKey(query.origin); },
+        [](BlockReader& reader, const RaycastQuery& query) { return raycastWith(reader, query); });
+}
+
+void world::sweepBatch(const World& world, std::span<const SweepQuery> queries, std::span<SweepResult> out,
+                       jobs::JobSystem* jobSystem) {
+    runBatch(
+        world, queries, out, jobSystem, [](const SweepQuery& query) { return chunkKey(query.box.min); },
+        [](BlockReader& reader, const SweepQuery& query) { return sweepWith(reader, query); });
+}
+
+#ifndef NO_TESTS
+
+#include <chrono>
+#include <doctest.h>
+#include <print>
+#include <random>
+
+namespace {
+namespace blocks = world::blocks;
+
+/// Two loaded chunks side by side along x, covering x in [0, 64).
+void makeTwoChunks(World& world) {
+    world.getOrCreateChunk(ChunkPos{0, 0, 0});
+    world.getOrCreateChunk(ChunkPos{1, 0, 0});
+}
+
+RaycastQuery ray(glm::vec3 origin, glm::vec3 direction, float maxDistance = 100.0f) {
+    return RaycastQuery{.origin = origin, .direction = direction, .maxDistance = maxDistance};
+}
+} // namespace
+
+TEST_SUITE("VoxelQuery") {
+    TEST_CASE("raycast hits the first block across a chunk border") {
+        World world;
+        makeTwoChunks(world);
+        world.setBlock(BlockPos{32, 5, 5}, blocks::STONE);
+        world.setBlock(BlockPos{40, 5, 5}, blocks::STONE);
+
+        const auto hit = world::raycast(world, ray(glm::vec3(10.5f, 5.5f, 5.5f), glm::vec3(1, 0, 0)));
+        REQUIRE(hit.has_value());
+        CHECK(hit->block == BlockPos{32, 5, 5});
+        CHECK(hit->normal == glm::ivec3(-1, 0, 0));
+        CHECK(hit->distance == doctest::Approx(21.5f));
+    }
+
+    TEST_CASE("raycast starting exactly on a chunk border") {
+        World world;
+        makeTwoChunks(world);
+        world.setBlock(BlockPos{31, 5, 5}, blocks::STONE);
+
+        const auto hit = world::raycast(world, ray(glm::vec3(32.0f, 5.5f, 5.5f), glm::vec3(-1, 0, 0)));
+        REQUIRE(hit.has_value());
+        CHECK(hit->block == BlockPos{31, 5, 5});
+        CHECK(hit->normal == glm::ivec3(1, 0, 0));
+        CHECK(hit->distance == doctest::Approx(0.0f));
+    }
+
+    TEST_CASE("raycast in negative coordinates") {
+        World world;
+        world.getOrCreateChunk(ChunkPos{-1, 0, 0});
+        world.getOrCreateChunk(ChunkPos{-2, 0, 0});
+        world.setBlock(BlockPos{-33, 0, 0}, blocks::STONE);
+
+        const auto hit = world::raycast(world, ray(glm::vec3(-0.5f, 0.5f, 0.5f), glm::vec3(-1, 0, 0)));
+        REQUIRE(hit.has_value());
+        CHECK(hit->block == BlockPos{-33, 0, 0});
+        CHECK(hit->distance == doctest::Approx(31.5f));
+    }
+
+    TEST_CASE("raycast through a chunk corner does not skip blocks") {
+        World world;
+        for (int32_t y = 0; y <= 1; y++) {
+            for (int32_t x = 0; x <= 1; x++) {
+                world.getOrCreateChunk(ChunkPos{x, y, 0});
+            }
+        }
+        world.setBlock(BlockPos{32, 32, 0}, blocks::STONE);
+
+        const auto hit = world::raycast(world, ray(glm::vec3(31.5f, 31.5f, 0.5f), glm::vec3(1, 1, 0)));
+        REQUIRE(hit.has_value());
+        CHECK(hit->block == BlockPos{32, 32, 0});
+        CHECK(hit->distance == doctest::Approx(std::sqrt(0.5f)));
+    }
+
+    TEST_CASE("raycast limits and misses") {
+        World world;
+        makeTwoChunks(world);
+        world.setBlock(BlockPos{20, 5, 5}, blocks::STONE);
+        world.setBlock(BlockPos{5, 5, 5}, blocks::TORCH);
+
+        CHECK_FALSE(world::raycast(world, ray(glm::vec3(10.5f, 5.5f, 5.5f), glm::vec3(1, 0, 0), 9.0f)).has_value());
+        CHECK(world::raycast(world, ray(glm::vec3(10.5f, 5.5f, 5.5f), glm::vec3(1, 0, 0), 9.5f)).has_value());
+        CHECK_FALSE(world::raycast(world, ray(glm::vec3(10.5f, 5.5f, 5.5f), glm::vec3(0, 0, 0))).has_value());
+        // Leaves the loaded chunks without hitting anything.
+        CHECK_FALSE(world::raycast(world, ray(glm::vec3(10.5f, 5.5f, 5.5f), glm::vec3(0, 1, 0))).has_value());
+        // Empty space without end still ends.
+        CHECK_FALSE(
+            world::raycast(world, ray(glm::vec3(10.5f, 5.5f, 5.5f), glm::vec3(0, 1, 0), INFINITY)).has_value());
+        CHECK_FALSE(world::raycast(world, ray(glm::vec3(10.5f, 5.5f, 5.5f), glm::vec3(1, 0, 0), NAN)).has_value());
+        CHECK_FALSE(world::raycast(world, ray(glm::vec3(NAN, 5.5f, 5.5f), glm::vec3(1, 0, 0))).has_value());
+        CHECK_FALSE(world::raycast(world, ray(glm::vec3(INFINITY, 5.5f, 5.5f), glm::vec3(1, 0, 0))).has_value());
+
+        // Torches are only hit when asked for.
+        CHECK_FALSE(world::raycast(world, ray(glm::vec3(10.5f, 5.5f, 5.5f), glm::vec3(-1, 0, 0))).has_value());
+        RaycastQuery pick = ray(glm::vec3(10.5f, 5.5f, 5.5f), glm::vec3(-1, 0, 0));
+        pick.hitNonSolid = true;
+        CHECK(world::raycast(world, pick)->block == BlockPos{5, 5, 5});
+
+        const auto inside = world::raycast(world, ray(glm::vec3(20.5f, 5.5f, 5.5f), glm::vec3(0, 1, 0)));
+        REQUIRE(inside.has_value());
+        CHECK(inside->normal == glm::ivec3(0));
+        CHECK(inside->distance == 0.0f);
+    }
+
+    TEST_CASE("sweep lands on a floor straddling a chunk border") {
+        World world;
+        makeTwoChunks(world);
+        world.setBlock(BlockPos{32, 4, 5}, blocks::STONE);
+
+        const SweepResult result =
+            world::sweepAabb(world, SweepQuery{Aabb{glm::vec3(31.7f, 10.0f, 5.2f), glm::vec3(32.3f, 11.8f, 5.8f)},
+                                               glm::vec3(0.0f, -20.0f, 0.0f)});
+        CHECK(result.onGround);
+        CHECK(result.collidedY);
+        CHECK(result.box.min.y == doctest::Approx(5.0f));
+        CHECK(result.motion.y == doctest::Approx(-5.0f));
+
+        // Moved off the block it only barely touches.
+        const SweepResult beside =
+            world::sweepAabb(world, SweepQuery{Aabb{glm::vec3(31.0f, 10.0f, 5.2f), glm::vec3(32.0f, 11.8f, 5.8f)},
+                                               glm::vec3(0.0f, -8.0f, 0.0f)});
+        CHECK_FALSE(beside.onGround);
+        CHECK(beside.box.min.y == doctest::Approx(2.0f));
+    }
+
+    TEST_CASE("sweep slides along walls and stops flush") {
+        World world;
+        makeTwoChunks(world);
+        for (int32_t z = 0; z < 10; z++) {
+            for (int32_t y = 0; y < 3; y++) {
+                world.setBlock(BlockPos{33, y, z}, blocks::STONE);
+            }
+        }
+
+        const SweepResult result = world::sweepAabb(
+            world, SweepQuery{Aabb{glm::vec3(31.2f, 0.0f, 2.2f), glm::vec3(31.8f, 1.8f, 2.8f)}, glm::vec3(2, 0, 3)});
+        CHECK(result.collidedX);
+        CHECK_FALSE(result.collidedZ);
+        CHECK(result.box.max.x == doctest::Approx(33.0f));
+        CHECK(result.box.min.z == doctest::Approx(5.2f));
+
+        // Flush against the wall, any further push goes nowhere.
+        const SweepResult again = world::sweepAabb(world, SweepQuery{result.box, glm::vec3(0.5f, 0, 0)});
+        CHECK(again.motion.x == 0.0f);
+        CHECK(again.collidedX);
+    }
+
+    TEST_CASE("sweep treats unloaded chunks as solid") {
+        World world;
+        makeTwoChunks(world);
+
+        const SweepResult result = world::sweepAabb(
+            world, SweepQuery{Aabb{glm::vec3(62.2f, 3.0f, 3.2f), glm::vec3(62.8f, 4.8f, 3.8f)}, glm::vec3(5, 0, 0)});
+        CHECK(result.collidedX);
+        CHECK(result.box.max.x == doctest::Approx(64.0f));
+
+        const SweepResult falling = world::sweepAabb(
+            world, SweepQuery{Aabb{glm::vec3(2.2f, 3.0f, 3.2f), glm::vec3(2.8f, 4.8f, 3.8f)}, glm::vec3(0, -5, 0)});
+        CHECK(falling.onGround);
+        CHECK(falling.box.min.y == doctest::Approx(0.0f));
+    }
+
+    TEST_CASE("sweep leaves non-finite queries where they are") {
+        World world;
+        makeTwoChunks(world);
+        const Aabb box{glm::vec3(2.2f, 3.0f, 3.2f), glm::vec3(2.8f, 4.8f, 3.8f)};
+
+        for (const glm::vec3 motion : {glm::vec3(NAN, 0, 0), glm::vec3(0, -INFINITY, 0), glm::vec3(0, 0, INFINITY)}) {
+            const SweepResult result = world::sweepAabb(world, SweepQuery{box, motion});
+            CHECK(result.box.min == box.min);
+            CHECK(result.box.max == box.max);
+            CHECK(result.motion == glm::vec3(0.0f));
+            CHECK_FALSE(result.onGround);
+        }
+
+        const Aabb nan{glm::vec3(NAN, 3.0f, 3.2f), glm::vec3(2.8f, 4.8f, 3.8f)};
+        CHECK(world::sweepAabb(world, SweepQuery{nan, glm::vec3(0, -5, 0)}).motion == glm::vec3(0.0f));
+        const Aabb infinite{glm::vec3(2.2f, 3.0f, 3.2f), glm::vec3(INFINITY, 4.8f, 3.8f)};
+        CHECK(world::sweepAabb(world, SweepQuery{infinite, glm::vec3(0, -5, 0)}).motion == glm::vec3(0.0f));
+
+        // batched too, whose chunk sort keys must cope
+        const SweepQuery queries[] = {{nan, glm::vec3(0, -5, 0)}, {box, glm::vec3(0, -5, 0)}};
+        SweepResult out[2];
+        world::sweepBatch(world, queries, out);
+        CHECK(out[0].motion == glm::vec3(0.0f));
+        CHECK(out[1].onGround);
+    }
+
+    TEST_CASE("batched queries match single queries") {
+        World world;
+        for (int32_t z = -1; z <= 1; z++) {
+            for (int32_t x = -1; x <= 1; x++) {
+                world.getOrCreateChunk(ChunkPos{x, 0, z});
+            }
+        }
+        std::mt19937 rng(99);
+        std::uniform_real_distribution<float> coord(-30.0f, 62.0f);
+        std::uniform_real_distribution<float> height(0.0f, 30.0f);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        for (int i = 0; i < 4000; i++) {
+            world.setBlock(BlockPos{static_cast<int32_t>(std::floor(coord(rng))), static_cast<int32_t>(height(rng)),
+                                    static_cast<int32_t>(std::floor(coord(rng)))},
+                           blocks::STONE);
+        }
+
+        std::vector<RaycastQuery> rays;
+        std::vector<SweepQuery> sweeps;
+        for (int i = 0; i < 1000; i++) {
+            const glm::vec3 origin(coord(rng), height(rng), coord(rng));
+            rays.push_back(ray(origin, glm::vec3(unit(rng), unit(rng), unit(rng)), 40.0f));
+            sweeps.push_back(SweepQuery{Aabb{origin, origin + glm::vec3(0.6f, 1.8f, 0.6f)},
+                                        glm::vec3(unit(rng), unit(rng) * 3.0f, unit(rng))});
+        }
+
+        jobs::JobSystem jobSystem(3);
+        std::vector<std::optional<RaycastHit>> rayResults(rays.size());
+        std::vector<SweepResult> sweepResults(sweeps.size());
+        world::raycastBatch(world, rays, rayResults, &jobSystem);
+        world::sweepBatch(world, sweeps, sweepResults, &jobSystem);
+
+        int mismatches = 0;
+        for (size_t i = 0; i < rays.size(); i++) {
+            const auto single = world::raycast(world, rays[i]);
+            mismatches += single.has_value() != rayResults[i].has_value() ||
+                          (single.has_value() && single->block != rayResults[i]->block);
+            const SweepResult sweep = world::sweepAabb(world, sweeps[i]);
+            mismatches += sweep.box.min != sweepResults[i].box.min;
+        }
+        CHECK(mismatches == 0);
+    }
+
+    TEST_CASE("benchmark batched entity sweeps" * doctest::skip()) {
+        World world;
+        for (int32_t z = -4; z < 4; z++) {
+            for (int32_t x = -4; x < 4; x++) {
+                Chunk& chunk = world.getOrCreateChunk(ChunkPos{x, 0, z});
+                for (int32_t lz = 0; lz < world::CHUNK_SIZE; lz++) {
+                    for (int32_t lx = 0; lx < world::CHUNK_SIZE; lx++) {
+                        chunk.setBlock(lx, 0, lz, blocks::STONE);
+                    }
+                }
+            }
+        }
+
+        constexpr int ENTITIES = 10000;
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> coord(-120.0f, 120.0f);
+        std::uniform_real_distribution<float> unit(-0.3f, 0.3f);
+        std::vector<SweepQuery> sweeps;
+        for (int i = 0; i < ENTITIES; i++) {
+            const glm::vec3 origin(coord(rng), 1.0f + std::abs(unit(rng)) * 10.0f, coord(rng));
+            sweeps.push_back(SweepQuery{Aabb{origin, origin + glm::vec3(0.6f, 1.8f, 0.6f)},
+                                        glm::vec3(unit(rng), -0.4f, unit(rng))});
+        }
+        std::vector<SweepResult> results(sweeps.size());
+
+        jobs::JobSystem jobSystem;
+        for (jobs::JobSystem* js : {static_cast<jobs::JobSystem*>(nullptr), &jobSystem}) {
+            constexpr int ROUNDS = 50;
+            const auto start = std::chrono::steady_clock::now();
+            for (int round = 0; round < ROUNDS; round++) {
+                world::sweepBatch(world, sweeps, results, js);
+            }
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::println("{} entities, {}: {:.3f} ms per tick", ENTITIES, js == nullptr ? "serial" : "jobs",
+                         seconds * 1000.0 / ROUNDS);
+        }
+    }
+}
+
+#endif
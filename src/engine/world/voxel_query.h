@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../jobs/job_system.h"
+#include "world.h"
+#include <glm/vec3.hpp>
+#include <optional>
+#include <span>
+
+namespace world {
+/// Farthest any raycast walks, whatever its `maxDistance`, so a ray into
+/// empty or unloaded space always ends.
+constexpr float MAX_RAYCAST_DISTANCE = 65536.0f;
+
+struct RaycastQuery {
+    /// A non-finite origin, or one too far out for the walk to stay within
+    /// `int32_t` block coordinates, never hits anything.
+    glm::vec3 origin;
+    /// Does not need to be normalized. A zero direction never hits anything.
+    glm::vec3 direction;
+    /// Clamped to `MAX_RAYCAST_DISTANCE`. NaN never hits anything.
+    float maxDistance;
+    /// Also stop at blocks that are not `solid`, such as torches, for picking
+    /// what the player is looking at.
+    bool hitNonSolid = false;
+};
+
+struct RaycastHit {
+    BlockPos block;
+    BlockId id;
+    /// The face that was hit, pointing out of the block. Zero if the ray
+    /// started inside the block.
+    glm::ivec3 normal;
+    /// Distance along the normalized ray to where it entered the block.
+    float distance;
+};
+
+struct Aabb {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+struct SweepQuery {
+    /// A box with a non-finite corner, or one too far out for block
+    /// coordinates, never moves.
+    Aabb box;
+    /// A non-finite motion never moves the box.
+    glm::vec3 motion;
+};
+
+struct SweepResult {
+    Aabb box;
+    /// How far the box actually moved.
+    glm::vec3 motion;
+    bool collidedX = false;
+    bool collidedY = false;
+    bool collidedZ = false;
+    /// Moving down was stopped by a block.
+    bool onGround = false;
+};
+
+/// @brief Walks the blocks along a ray with a 3D DDA, visiting every block
+/// the ray passes through exactly once, until one is hit.
+///
+/// Unloaded chunks are treated as empty.
+/// @return The first block hit within `query.maxDistance`, if any.
+std::optional<RaycastHit> raycast(const World& world, const RaycastQuery& query);
+
+/// @brief Moves a box by `query.motion` through the grid, one axis at a time
+/// (y, then x, then z), stopping flush against the first solid block on each
+/// axis. A box already overlapping a block may still move out of it.
+///
+/// Unloaded chunks are treated as solid, so nothing falls out of the world
+/// while it streams in.
+SweepResult sweepAabb(const World& world, const SweepQuery& query);
+
+/// @brief Runs many raycasts at once. Queries are sorted by the chunk they
+/// start in, so neighbouring queries share chunk lookups and cache lines,
+/// and split across the job system if one is given.
+/// @param out Must be the same size as `queries`. Results are written in
+/// the order of `queries`.
+void raycastBatch(const World& world, std::span<const RaycastQuery> queries, std::span<std::optional<RaycastHit>> out,
+                  jobs::JobSystem* jobSystem = nullptr);
+
+/// @brief Sweeps many boxes at once, such as every entity in a tick. See
+/// `raycastBatch()`.
+void sweepBatch(const World& world, std::span<const SweepQuery> queries, std::span<SweepResult> out,
+                jobs::JobSystem* jobSystem = nullptr);
+} // namespace world
@@ -0,0 +1,49 @@
+#include "world.h"
+
+using world::BlockId;
+using world::BlockPos;
+using world::Chunk;
+using world::ChunkPos;
+using world::LightChannel;
+using world::World;
+
+Chunk* World::chunk(ChunkPos pos) {
+    auto found = chunks_.find(pos);
+    return found != chunks_.end() ? found->second.get() : nullptr;
+}
+
+const Chunk* World::chunk(ChunkPos pos) const {
+    auto found = chunks_.find(pos);
+    return found != chunks_.end() ? found->second.get() : nullptr;
+}
+
+Chunk& World::getOrCreateChunk(ChunkPos pos) {
+    auto& slot = chunks_[pos];
+    if (slot == nullptr) {
+        slot = std::make_unique<Chunk>(pos);
+    }
+    return *slot;
+}
+
+bool World::unloadChunk(ChunkPos pos) { return chunks_.erase(pos) > 0; }
+
+BlockId World::block(BlockPos pos) const {
+    const Chunk* found = chunk(pos.chunk());
+    return found != nullptr ? found->block(pos.localIndex()) : blocks::AIR;
+}
+
+std::optional<BlockId> World::setBlock(BlockPos pos, BlockId id) {
+    Chunk* found = chunk(pos.chunk());
+    if (found == nullptr) {
+        return std::nullopt;
+    }
+    const uint32_t index = pos.localIndex();
+    const BlockId previous = found->block(index);
+    found->setBlock(index, id);
+    return previous;
+}
+
+uint8_t World::light(LightChannel channel, BlockPos pos) const {
+    const Chunk* found = chunk(pos.chunk());
+    return found != nullptr ? found->light(channel, pos.localIndex()) : 0;
+}
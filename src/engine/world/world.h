@@ -0,0 +1,56 @@
+#pragma once
+
+#include "chunk.h"
+#include <memory>
+#include <optional>
+#include <unordered_map>
+
+namespace world {
+/// @brief Owns every loaded chunk.
+///
+/// # Thread Safety
+///
+/// Loading and unloading chunks is not thread safe. Looking chunks up is, as
+/// long as nothing is loaded or unloaded at the same time.
+class World {
+  public:
+    World() = default;
+
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    /// @return The chunk at `pos`, or `nullptr` if it is not loaded.
+    Chunk* chunk(ChunkPos pos);
+
+    const Chunk* chunk(ChunkPos pos) const;
+
+    /// @return The chunk at `pos`, creating an empty one filled with air if it
+    /// is not loaded.
+    Chunk& getOrCreateChunk(ChunkPos pos);
+
+    /// @return `true` if a chunk was unloaded.
+    bool unloadChunk(ChunkPos pos);
+
+    size_t chunkCount() const { return chunks_.size(); }
+
+    /// @return The block at `pos`, or air if its chunk is not loaded.
+    BlockId block(BlockPos pos) const;
+
+    /// @brief Sets the block at `pos`. Does not update lighting, see
+    /// `LightEngine::onBlockChanged()`.
+    /// @return The previous block, or empty if the chunk is not loaded.
+    std::optional<BlockId> setBlock(BlockPos pos, BlockId id);
+
+    /// @return The light level at `pos`, or 0 if its chunk is not loaded.
+    uint8_t light(LightChannel channel, BlockPos pos) const;
+
+    template <typename F> void forEachChunk(F&& fn) {
+        for (auto& [pos, chunk] : chunks_) {
+            fn(*chunk);
+        }
+    }
+
+  private:
+    std::unordered_map<ChunkPos, std::unique_ptr<Chunk>, ChunkPosHash> chunks_;
+};
+} // namespace world
@@ -107,6 +107,163 @@
 //     }
 // }
 
+#include "engine/jobs/job_system.h"
+#include "engine/net/udp.h"
+#include "engine/server/protocol.h"
+#include "engine/server/tick_loop.h"
+#include "engine/world/block_ticks.h"
+#include "engine/world/light_engine.h"
+#include "engine/world/terrain.h"
+#include <csignal>
 #include <iostream>
 
-int main() {}
+namespace {
+constexpr unsigned short SERVER_PORT = 54000;
+/// How often to log the tick statistics.
+constexpr uint32_t STATS_LOG_SECONDS = 30;
+/// Chunks around the origin generated at startup, the same area the client
+/// generates for itself.
+constexpr int32_t SPAWN_RADIUS = 12;
+constexpr int32_t SPAWN_MIN_Y = 0;
+constexpr int32_t SPAWN_MAX_Y = 2;
+
+server::TickLoop* runningLoop = nullptr;
+
+void onInterrupt(int) {
+    if (runningLoop != nullptr) {
+        runningLoop->stop();
+    }
+}
+/// @brief Sends every datagram to every address, logging any that fail.
+void sendToAll(net::UdpSocket& socket, std::span<const std::vector<uint8_t>> datagrams,
+               std::span<const net::TransportAddress> addresses) {
+    for (const std::vector<uint8_t>& datagram : datagrams) {
+        for (const net::TransportAddress& address : addresses) {
+            auto sendResult = socket.sendTo(datagram.data(), static_cast<uint16_t>(datagram.size()), address);
+            if (sendResult.has_value() == false) {
+                std::cerr << "Failed to send udp bytes " << sendResult.error() << std::endl;
+            }
+        }
+    }
+}
+} // namespace
+
+int main() {
+    using server::TickBudget;
+    using server::TickPhase;
+
+    jobs::JobSystem jobSystem;
+
+    net::UdpSocket socket = net::UdpSocket::create();
+    if (auto bindResult = socket.bind(net::TransportAddress::fromPortAnyAddress(SERVER_PORT));
+        bindResult.has_value() == false) {
+        std::cerr << "Failed to bind server socket: " << bindResult.error() << std::endl;
+        return 1;
+    }
+
+    const server::TickLoopConfig config{};
+    const uint64_t statsLogInterval = static_cast<uint64_t>(config.ticksPerSecond) * STATS_LOG_SECONDS;
+    server::TickLoop loop(config);
+    server::DeferredWork chunkWork;
+
+    world::World world;
+    const world::TerrainGenerator terrain;
+    world::LightEngine lightEngine(world, jobSystem);
+    world::BlockTicker blockTicker(world, &lightEngine);
+    world::registerDefaultBehaviours(blockTicker);
+    server::ClientList clients;
+    // decoded by ingest, applied by the simulation in the order received
+    std::vector<server::ClientInput> inputs;
+
+    // generating takes far longer than a tick, so it is spread over as many as it needs
+    for (int32_t y = SPAWN_MIN_Y; y <= SPAWN_MAX_Y; y++) {
+        for (int32_t z = -SPAWN_RADIUS; z <= SPAWN_RADIUS; z++) {
+            for (int32_t x = -SPAWN_RADIUS; x <= SPAWN_RADIUS; x++) {
+                chunkWork.push([&, pos = world::ChunkPos{x, y, z}] {
+                    terrain.generate(world.getOrCreateChunk(pos));
+                    lightEngine.onChunkLoaded(pos);
+                    blockTicker.onChunkLoaded(pos);
+                    // for the clients that joined before it was generated
+                    blockTicker.dirty().markChunk(pos);
+                });
+            }
+        }
+    }
+
+    loop.setPhase(TickPhase::NetworkIngest, [&](const TickBudget& budget) {
+        while (budget.hasTimeRemaining() && socket.readable(0)) {
+            auto receiveResult = socket.receiveFrom();
+            if (receiveResult.has_value() == false) {
+                std::cerr << "Failed to receive udp bytes " << receiveResult.error() << std::endl;
+                continue;
+            }
+            const std::span<const uint8_t> bytes(receiveResult->bytes, static_cast<size_t>(receiveResult->len));
+            // anything else is not from a client of this server, and is dropped
+            if (const auto message = server::decodeClientMessage(bytes); message.has_value()) {
+                inputs.push_back(server::ClientInput{receiveResult->addr, *message});
+            }
+        }
+    });
+    loop.setPhase(TickPhase::Simulation, [&](const TickBudget&) {
+        for (const server::ClientInput& input : inputs) {
+            switch (input.message.type) {
+            case server::MessageType::Join:
+                if (clients.add(input.from)) {
+                    // the world so far, from then on the dirty set keeps it up to date
+                    world.forEachChunk([&](const world::Chunk& chunk) {
+                        chunkWork.push([&, pos = chunk.pos(), to = input.from] {
+                            if (const world::Chunk* loaded = world.chunk(pos); loaded != nullptr) {
+                                const world::ChunkChanges whole{.pos = pos, .indices = {}, .wholeChunk = true};
+                                sendToAll(socket, server::encodeBlockRuns(*loaded, whole), std::span(&to, 1));
+                            }
+                        });
+                    });
+                }
+                break;
+            case server::MessageType::Leave:
+                clients.remove(input.from);
+                break;
+            case server::MessageType::SetBlock:
+                // edits in chunks that are not loaded are dropped
+                blockTicker.setBlock(input.message.pos, input.message.block);
+                break;
+            case server::MessageType::BlockRuns:
+                // only ever sent by the server, never decoded from a client
+                break;
+            }
+        }
+        inputs.clear();
+        blockTicker.tick();
+    });
+    loop.setPhase(TickPhase::ChunkWork, [&](const TickBudget& budget) {
+        chunkWork.run(budget);
+        // clients light their own copy of the world, so which chunks changed is not needed here
+        if (lightEngine.hasPendingWork()) {
+            lightEngine.update();
+        }
+    });
+    loop.setPhase(TickPhase::Replication, [&](const TickBudget& budget) {
+        for (const world::ChunkChanges& changes : blockTicker.dirty().takeReplication()) {
+            const world::Chunk* chunk = world.chunk(changes.pos);
+            if (chunk != nullptr && !clients.addresses().empty()) {
+                sendToAll(socket, server::encodeBlockRuns(*chunk, changes), clients.addresses());
+            }
+        }
+        // the server never meshes, so the remesh half of the dirty set goes unused
+        blockTicker.dirty().clear();
+
+        if (budget.tickNumber() % statsLogInterval == statsLogInterval - 1) {
+            std::cout << loop.stats().summary() << std::endl;
+            loop.stats().reset();
+        }
+    });
+
+    runningLoop = &loop;
+    std::signal(SIGINT, onInterrupt);
+    std::cout << "Server listening on port " << SERVER_PORT << " at " << config.ticksPerSecond
+              << " ticks per second" << std::endl;
+    loop.run();
+    runningLoop = nullptr;
+
+    std::cout << loop.stats().summary() << std::endl;
+}